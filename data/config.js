@@ -41,6 +41,9 @@ async function fetchConfig() {
     }
 }
 
+const MOISTURE_FILTER_NAMES = ['None', 'Median of 3', 'Moving average', 'Kalman'];
+const BMP_OVERSAMPLING_NAMES = ['Ultra low power', 'Standard', 'High resolution', 'Ultra high resolution'];
+
 function populateGlobalSettings(config) {
     const elements = [
         { id: 'currentTempOffset', value: config.temperatureOffset.toFixed(1) },
@@ -48,17 +51,21 @@ function populateGlobalSettings(config) {
         { id: 'currentSensorUpdateInterval', value: formatDuration(config.sensorUpdateInterval, 'seconds') },
         { id: 'currentLcdUpdateInterval', value: formatDuration(config.lcdUpdateInterval, 'seconds') },
         { id: 'currentSensorPublishInterval', value: formatDuration(config.sensorPublishInterval, 'seconds') },
+        { id: 'currentMoistureFilter', value: MOISTURE_FILTER_NAMES[config.moistureFilter] },
+        { id: 'currentBmpOversampling', value: BMP_OVERSAMPLING_NAMES[config.bmpOversampling] },
         { id: 'tempOffset', value: config.temperatureOffset },
         { id: 'telemetryInterval', value: config.telemetryInterval / 1000 },
         { id: 'sensorUpdateInterval', value: config.sensorUpdateInterval / 1000 },
         { id: 'lcdUpdateInterval', value: config.lcdUpdateInterval / 1000 },
-        { id: 'sensorPublishInterval', value: config.sensorPublishInterval / 1000 }
+        { id: 'sensorPublishInterval', value: config.sensorPublishInterval / 1000 },
+        { id: 'moistureFilter', value: config.moistureFilter },
+        { id: 'bmpOversampling', value: config.bmpOversampling }
     ];
 
     elements.forEach(({ id, value }) => {
         const element = document.getElementById(id);
         if (element) {
-            if (element.tagName === 'INPUT') {
+            if (element.tagName === 'INPUT' || element.tagName === 'SELECT') {
                 element.value = value;
             } else {
                 element.textContent = value;
@@ -82,6 +89,10 @@ function createSensorConfigHTML(sensorConfig, index) {
                 <input type="checkbox" id="relayEnabled_${index}" ${sensorConfig.relayEnabled ? 'checked' : ''}>
                 <label for="relayEnabled_${index}">Enable Relay Control</label>
             </div>
+            <div class="checkbox-wrapper">
+                <input type="checkbox" id="autoTune_${index}" ${sensorConfig.autoTune ? 'checked' : ''}>
+                <label for="autoTune_${index}">Tune Activation Period</label>
+            </div>
         </div>
         <div class="sensor-details">
             <table>
@@ -105,6 +116,21 @@ function createSensorConfigHTML(sensorConfig, index) {
                     <td id="currentWateringInterval_${index}">${formatDuration(sensorConfig.wateringInterval, 'hours')}</td>
                     <td class="input-cell"><div class="input-wrapper"><input type="number" id="wateringInterval_${index}" step="1" min="1" max="120" value="${sensorConfig.wateringInterval / 3600000}"></div></td>
                 </tr>
+                <tr>
+                    <td>Target Moisture (%)</td>
+                    <td id="currentTargetMoisture_${index}">${sensorConfig.targetMoisture.toFixed(1)}${sensorConfig.wateringGain > 0 ? ` (${(sensorConfig.wateringGain / 10).toFixed(2)} %/s learned)` : ''}</td>
+                    <td class="input-cell"><div class="input-wrapper"><input type="number" id="targetMoisture_${index}" step="0.1" min="10" max="90" value="${sensorConfig.targetMoisture}"></div></td>
+                </tr>
+                <tr>
+                    <td>Dry Reading (raw)</td>
+                    <td id="currentDryValue_${index}">${sensorConfig.dryValue}</td>
+                    <td class="input-cell"><div class="input-wrapper"><input type="number" id="dryValue_${index}" step="1" min="0" max="4095" value="${sensorConfig.dryValue}"></div></td>
+                </tr>
+                <tr>
+                    <td>Wet Reading (raw)</td>
+                    <td id="currentWetValue_${index}">${sensorConfig.wetValue}</td>
+                    <td class="input-cell"><div class="input-wrapper"><input type="number" id="wetValue_${index}" step="1" min="0" max="4095" value="${sensorConfig.wetValue}"></div></td>
+                </tr>
             </table>
         </div>
     `;
@@ -133,6 +159,11 @@ function createAndPopulateSensorConfigs(config) {
                 wateringInterval: 0,
                 sensorEnabled: false,
                 relayEnabled: false,
+                dryValue: 2592,
+                wetValue: 975,
+                autoTune: false,
+                targetMoisture: 40,
+                wateringGain: 0,
             };
         }
         const sensorDiv = createSensorConfigHTML(sensorConfig, index);
@@ -141,7 +172,7 @@ function createAndPopulateSensorConfigs(config) {
 }
 
 function addChangeListeners() {
-    document.querySelectorAll('input').forEach(input => {
+    document.querySelectorAll('input, select').forEach(input => {
         input.addEventListener('input', () => {
             hasChanges = true;
             updateSaveButton();
@@ -211,12 +242,18 @@ async function saveConfig() {
         sensorUpdateInterval: parseFloat(document.getElementById('sensorUpdateInterval').value) * 1000,
         lcdUpdateInterval: parseFloat(document.getElementById('lcdUpdateInterval').value) * 1000,
         sensorPublishInterval: parseInt(document.getElementById('sensorPublishInterval').value) * 1000,
+        moistureFilter: parseInt(document.getElementById('moistureFilter').value),
+        bmpOversampling: parseInt(document.getElementById('bmpOversampling').value),
         sensorConfigs: currentConfig.sensorConfigs.map((_, index) => ({
             threshold: parseFloat(document.getElementById(`threshold_${index}`).value),
             activationPeriod: parseInt(document.getElementById(`activationPeriod_${index}`).value) * 1000,
             wateringInterval: parseFloat(document.getElementById(`wateringInterval_${index}`).value) * 3600000,
             sensorEnabled: document.getElementById(`sensorEnabled_${index}`).checked,
             relayEnabled: document.getElementById(`relayEnabled_${index}`).checked,
+            dryValue: parseInt(document.getElementById(`dryValue_${index}`).value),
+            wetValue: parseInt(document.getElementById(`wetValue_${index}`).value),
+            autoTune: document.getElementById(`autoTune_${index}`).checked,
+            targetMoisture: parseFloat(document.getElementById(`targetMoisture_${index}`).value),
         }))
     };
 
@@ -14,7 +14,12 @@ self.addEventListener('install', (event) => {
       sclPin: 22,
       floatSwitchPin: 23,
       sensorPins: [32, 33, 34],
-      relayPins: [25, 26, 27]
+      relayPins: [25, 26, 27],
+      muxSelectPins: [13, 14, 26, 27],
+      muxSignalPins: [32],
+      relayCurrents: [1000, 1000, 1000],
+      powerBudget: 1000,
+      inrushDelay: 500
     }
   };
   
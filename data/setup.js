@@ -35,18 +35,27 @@ function populateForm(config) {
     const floatSwitchPin = document.getElementById('floatSwitchPin');
     const sensorPinsContainer = document.getElementById('sensorPinsContainer');
     const relayPinsContainer = document.getElementById('relayPinsContainer');
+    const relayCurrentsContainer = document.getElementById('relayCurrentsContainer');
 
     // Set current values
     document.getElementById('currentSystemSize').textContent = config.systemSize;
     document.getElementById('currentSdaPin').textContent = config.sdaPin;
     document.getElementById('currentSclPin').textContent = config.sclPin;
     document.getElementById('currentFloatSwitchPin').textContent = config.floatSwitchPin;
+    document.getElementById('currentMuxSelectPins').textContent = config.muxSelectPins.join(', ');
+    document.getElementById('currentMuxSignalPins').textContent = config.muxSignalPins.join(', ');
+    document.getElementById('currentPowerBudget').textContent = config.powerBudget;
+    document.getElementById('currentInrushDelay').textContent = config.inrushDelay;
 
     // Set input values
     if (systemSize) systemSize.value = config.systemSize;
     if (sdaPin) sdaPin.value = config.sdaPin;
     if (sclPin) sclPin.value = config.sclPin;
     if (floatSwitchPin) floatSwitchPin.value = config.floatSwitchPin;
+    document.getElementById('muxSelectPins').value = config.muxSelectPins.join(', ');
+    document.getElementById('muxSignalPins').value = config.muxSignalPins.join(', ');
+    document.getElementById('powerBudget').value = config.powerBudget;
+    document.getElementById('inrushDelay').value = config.inrushDelay;
 
     if (sensorPinsContainer) {
         sensorPinsContainer.innerHTML = '';
@@ -57,16 +66,22 @@ function populateForm(config) {
         relayPinsContainer.innerHTML = '';
         config.relayPins.forEach((pin, index) => addPinInput('relayPinsContainer', pin, index));
     }
+
+    if (relayCurrentsContainer) {
+        relayCurrentsContainer.innerHTML = '';
+        config.relayCurrents.forEach((current, index) => addPinInput('relayCurrentsContainer', current, index));
+    }
 }
 
 function addPinInput(containerId, value = '', index) {
     const container = document.getElementById(containerId);
     if (!container) return;
 
+    const label = containerId === 'relayCurrentsContainer' ? 'Relay' : 'Pin';
     const inputGroup = document.createElement('div');
     inputGroup.className = 'pin-input';
     inputGroup.innerHTML = `
-        <label for="${containerId}-${index}">Pin ${index + 1}:</label>
+        <label for="${containerId}-${index}">${label} ${index + 1}:</label>
         <input type="number" id="${containerId}-${index}" value="${value}" min="0" required>
     `;
     container.appendChild(inputGroup);
@@ -76,13 +91,15 @@ function updatePinInputs() {
     const systemSize = document.getElementById('systemSize');
     const sensorPinsContainer = document.getElementById('sensorPinsContainer');
     const relayPinsContainer = document.getElementById('relayPinsContainer');
+    const relayCurrentsContainer = document.getElementById('relayCurrentsContainer');
 
-    if (!systemSize || !sensorPinsContainer || !relayPinsContainer) return;
+    if (!systemSize || !sensorPinsContainer || !relayPinsContainer || !relayCurrentsContainer) return;
 
     const size = parseInt(systemSize.value);
 
     updatePinContainer(sensorPinsContainer, 'sensorPinsContainer', size);
     updatePinContainer(relayPinsContainer, 'relayPinsContainer', size);
+    updatePinContainer(relayCurrentsContainer, 'relayCurrentsContainer', size);
 }
 
 function updatePinContainer(container, containerId, size) {
@@ -94,6 +111,10 @@ function updatePinContainer(container, containerId, size) {
     }
 }
 
+function parsePinList(text) {
+    return text.split(',').map(pin => parseInt(pin.trim())).filter(pin => !isNaN(pin));
+}
+
 async function saveConfig(event) {
     event.preventDefault();
     const newConfig = {
@@ -102,7 +123,12 @@ async function saveConfig(event) {
         sclPin: parseInt(document.getElementById('sclPin').value),
         floatSwitchPin: parseInt(document.getElementById('floatSwitchPin').value),
         sensorPins: Array.from(document.getElementById('sensorPinsContainer').children).map(child => parseInt(child.querySelector('input').value)),
-        relayPins: Array.from(document.getElementById('relayPinsContainer').children).map(child => parseInt(child.querySelector('input').value))
+        relayPins: Array.from(document.getElementById('relayPinsContainer').children).map(child => parseInt(child.querySelector('input').value)),
+        muxSelectPins: parsePinList(document.getElementById('muxSelectPins').value),
+        muxSignalPins: parsePinList(document.getElementById('muxSignalPins').value),
+        relayCurrents: Array.from(document.getElementById('relayCurrentsContainer').children).map(child => parseInt(child.querySelector('input').value)),
+        powerBudget: parseInt(document.getElementById('powerBudget').value),
+        inrushDelay: parseInt(document.getElementById('inrushDelay').value)
     };
 
     try {
@@ -0,0 +1,71 @@
+#ifndef ADS1115_H
+#define ADS1115_H
+
+#include <cstdint>
+#include "I2CBus.h"
+
+/**
+ * @class Ads1115
+ * @brief Single-shot conversions on an ADS1115 4-channel I2C ADC.
+ *
+ * Starting a conversion and reading its result are separate transactions, so a caller can
+ * start one conversion on every ADS1115 on the bus, do other work while they run in parallel,
+ * and collect the results once CONVERSION_US has passed. There is no polling of the OS bit.
+ *
+ * The input range is ±4.096 V at 860 samples/s. Results are rescaled to the 12-bit range of
+ * the ESP32 ADC (0..4095 over 0..3.3 V), so the dry/wet calibration of a zone means the same
+ * whichever converter reads it.
+ */
+class Ads1115 {
+public:
+    // 1/860 s plus the 10 % oscillator tolerance from the datasheet.
+    static constexpr uint32_t CONVERSION_US = 1300;
+
+    // Starts a single-shot conversion of AIN`channel` against GND.
+    static bool startConversion(I2CBus& bus, uint8_t address, uint8_t channel) {
+        const uint16_t config = CONFIG_OS_SINGLE | ((MUX_SINGLE_ENDED + (channel & 0x03)) << 12) | CONFIG_PGA_4V096 |
+                                CONFIG_MODE_SINGLE | CONFIG_DR_860SPS | CONFIG_COMP_DISABLE;
+        return bus.transact(address, I2CBus::Priority::SENSOR, [address, config](TwoWire& wire) {
+            wire.beginTransmission(address);
+            wire.write(REG_CONFIG);
+            wire.write(static_cast<uint8_t>(config >> 8));
+            wire.write(static_cast<uint8_t>(config & 0xFF));
+            return wire.endTransmission() == 0;
+        });
+    }
+
+    // Reads the last conversion result, rescaled to 0..4095.
+    static bool readConversion(I2CBus& bus, uint8_t address, uint16_t& out) {
+        uint8_t raw[2];
+        const bool ok = bus.transact(address, I2CBus::Priority::SENSOR, [address, &raw](TwoWire& wire) {
+            wire.beginTransmission(address);
+            wire.write(REG_CONVERSION);
+            if (wire.endTransmission() != 0) return false;
+            if (wire.requestFrom(static_cast<uint16_t>(address), static_cast<size_t>(2), true) != 2) return false;
+            raw[0] = static_cast<uint8_t>(wire.read());
+            raw[1] = static_cast<uint8_t>(wire.read());
+            return true;
+        });
+        if (ok) out = toAdcScale(static_cast<int16_t>((raw[0] << 8) | raw[1]));
+        return ok;
+    }
+
+    static uint16_t toAdcScale(int16_t counts) {
+        if (counts <= 0) return 0;
+        const uint32_t scaled = (static_cast<uint32_t>(counts) * 4095 + FULL_SCALE_COUNTS / 2) / FULL_SCALE_COUNTS;
+        return static_cast<uint16_t>(scaled > 4095 ? 4095 : scaled);
+    }
+
+private:
+    static constexpr uint8_t REG_CONVERSION = 0x00;
+    static constexpr uint8_t REG_CONFIG = 0x01;
+    static constexpr uint16_t CONFIG_OS_SINGLE = 0x8000;
+    static constexpr uint16_t MUX_SINGLE_ENDED = 0x4;      // AIN0 vs GND, AIN1..3 follow
+    static constexpr uint16_t CONFIG_PGA_4V096 = 0x0200;
+    static constexpr uint16_t CONFIG_MODE_SINGLE = 0x0100;
+    static constexpr uint16_t CONFIG_DR_860SPS = 0x00E0;
+    static constexpr uint16_t CONFIG_COMP_DISABLE = 0x0003;
+    static constexpr uint32_t FULL_SCALE_COUNTS = 26400;    // 3.3 V at 125 µV per count
+};
+
+#endif // ADS1115_H
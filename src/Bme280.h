@@ -0,0 +1,182 @@
+#ifndef BME280_H
+#define BME280_H
+
+#include <cstdint>
+#include "I2CBus.h"
+#include "SensorDriver.h"
+
+/**
+ * @class Bme280
+ * @brief BME280 temperature, pressure and humidity driver using forced mode.
+ *
+ * Each measurement writes the oversampling settings with a forced-mode trigger, waits the
+ * datasheet maximum measurement time and reads all three results in one burst. Compensation
+ * is the datasheet's integer code (64-bit pressure, Q22.10 humidity).
+ */
+class Bme280 : public SensorDriver<Bme280> {
+public:
+    static constexpr uint8_t ADDRESS = 0x76;
+    static constexpr uint8_t CHIP_ID = 0x60;
+
+    // Same oversampling for temperature, pressure and humidity: 1, 2, 4, 8 or 16.
+    void setOversampling(uint8_t samples) {
+        osrs = 1;
+        while (osrs < 5 && (1u << (osrs - 1)) < samples) osrs++;
+    }
+
+    float getTemperature() const { return temperatureHundredths / 100.0f; }
+    float getPressure() const { return pressureQ24_8 / 256.0f; }         // Pa
+    float getHumidity() const { return humidityQ22_10 / 1024.0f; }       // %RH
+
+private:
+    friend class SensorDriver<Bme280>;
+
+    static constexpr uint8_t REG_CALIB_TP = 0x88;
+    static constexpr uint8_t REG_CALIB_H1 = 0xA1;
+    static constexpr uint8_t REG_CHIP_ID = 0xD0;
+    static constexpr uint8_t REG_CALIB_H2 = 0xE1;
+    static constexpr uint8_t REG_CTRL_HUM = 0xF2;
+    static constexpr uint8_t REG_CTRL_MEAS = 0xF4;
+    static constexpr uint8_t REG_DATA = 0xF7;
+    static constexpr uint8_t MODE_FORCED = 0x01;
+
+    I2CBus* bus = nullptr;
+    uint8_t osrs = 1;   // register encoding, 1 = x1 ... 5 = x16
+
+    uint16_t t1 = 0, p1 = 0;
+    int16_t t2 = 0, t3 = 0, p2 = 0, p3 = 0, p4 = 0, p5 = 0, p6 = 0, p7 = 0, p8 = 0, p9 = 0;
+    uint8_t h1 = 0, h3 = 0;
+    int16_t h2 = 0, h4 = 0, h5 = 0;
+    int8_t h6 = 0;
+
+    int32_t temperatureHundredths = 0;
+    uint32_t pressureQ24_8 = 0;
+    uint32_t humidityQ22_10 = 0;
+
+    bool probe(I2CBus& i2cBus) {
+        bus = &i2cBus;
+        uint8_t id = 0;
+        uint8_t tp[24];
+        uint8_t hum[7];
+        if (!readRegisters(REG_CHIP_ID, &id, 1) || id != CHIP_ID ||
+            !readRegisters(REG_CALIB_TP, tp, sizeof(tp)) ||
+            !readRegisters(REG_CALIB_H1, &h1, 1) ||
+            !readRegisters(REG_CALIB_H2, hum, sizeof(hum))) {
+            return false;
+        }
+        t1 = le16(tp, 0);
+        t2 = static_cast<int16_t>(le16(tp, 2));
+        t3 = static_cast<int16_t>(le16(tp, 4));
+        p1 = le16(tp, 6);
+        p2 = static_cast<int16_t>(le16(tp, 8));
+        p3 = static_cast<int16_t>(le16(tp, 10));
+        p4 = static_cast<int16_t>(le16(tp, 12));
+        p5 = static_cast<int16_t>(le16(tp, 14));
+        p6 = static_cast<int16_t>(le16(tp, 16));
+        p7 = static_cast<int16_t>(le16(tp, 18));
+        p8 = static_cast<int16_t>(le16(tp, 20));
+        p9 = static_cast<int16_t>(le16(tp, 22));
+        h2 = static_cast<int16_t>(le16(hum, 0));
+        h3 = hum[2];
+        h4 = static_cast<int16_t>((static_cast<int8_t>(hum[3]) * 16) | (hum[4] & 0x0F));
+        h5 = static_cast<int16_t>((static_cast<int8_t>(hum[5]) * 16) | (hum[4] >> 4));
+        h6 = static_cast<int8_t>(hum[6]);
+        return true;
+    }
+
+    bool startMeasurement() {
+        // ctrl_hum only takes effect after the following ctrl_meas write
+        if (!writeRegister(REG_CTRL_HUM, osrs) ||
+            !writeRegister(REG_CTRL_MEAS, static_cast<uint8_t>((osrs << 5) | (osrs << 2) | MODE_FORCED))) {
+            return false;
+        }
+        waitUs(measurementUs());
+        return true;
+    }
+
+    bool continueMeasurement() {
+        uint8_t raw[8];
+        if (!readRegisters(REG_DATA, raw, sizeof(raw))) return fail();
+        const int32_t adcP = (raw[0] << 12) | (raw[1] << 4) | (raw[2] >> 4);
+        const int32_t adcT = (raw[3] << 12) | (raw[4] << 4) | (raw[5] >> 4);
+        const int32_t adcH = (raw[6] << 8) | raw[7];
+        const int32_t tFine = computeTFine(adcT);
+        temperatureHundredths = (tFine * 5 + 128) >> 8;
+        pressureQ24_8 = computePressure(adcP, tFine);
+        humidityQ22_10 = computeHumidity(adcH, tFine);
+        return finish();
+    }
+
+    void fill(EnvironmentReading& out) const {
+        out.temperature = getTemperature();
+        out.pressure = getPressure() / 100.0f;
+        out.humidity = getHumidity();
+        out.validMask |= EnvironmentReading::TEMPERATURE | EnvironmentReading::PRESSURE | EnvironmentReading::HUMIDITY;
+    }
+
+    // Datasheet appendix B maximum: 1.25 + 2.3 * T + (2.3 * P + 0.575) + (2.3 * H + 0.575) ms.
+    uint32_t measurementUs() const {
+        const uint32_t samples = 1u << (osrs - 1);
+        return 1250 + 2300 * samples * 3 + 575 * 2;
+    }
+
+    bool writeRegister(uint8_t reg, uint8_t value) {
+        return bus->transact(ADDRESS, I2CBus::Priority::SENSOR, [reg, value](TwoWire& wire) {
+            wire.beginTransmission(ADDRESS);
+            wire.write(reg);
+            wire.write(value);
+            return wire.endTransmission() == 0;
+        });
+    }
+
+    bool readRegisters(uint8_t reg, uint8_t* out, size_t len) {
+        return bus->transact(ADDRESS, I2CBus::Priority::SENSOR, [reg, out, len](TwoWire& wire) {
+            wire.beginTransmission(ADDRESS);
+            wire.write(reg);
+            if (wire.endTransmission() != 0) return false;
+            if (wire.requestFrom(static_cast<uint16_t>(ADDRESS), len, true) != len) return false;
+            for (size_t i = 0; i < len; ++i) {
+                out[i] = static_cast<uint8_t>(wire.read());
+            }
+            return true;
+        });
+    }
+
+    static uint16_t le16(const uint8_t* raw, size_t offset) {
+        return static_cast<uint16_t>(raw[offset] | (raw[offset + 1] << 8));
+    }
+
+    int32_t computeTFine(int32_t adcT) const {
+        const int32_t var1 = ((((adcT >> 3) - (static_cast<int32_t>(t1) << 1))) * t2) >> 11;
+        const int32_t var2 = (((((adcT >> 4) - t1) * ((adcT >> 4) - t1)) >> 12) * t3) >> 14;
+        return var1 + var2;
+    }
+
+    uint32_t computePressure(int32_t adcP, int32_t tFine) const {
+        int64_t var1 = static_cast<int64_t>(tFine) - 128000;
+        int64_t var2 = var1 * var1 * p6;
+        var2 = var2 + ((var1 * p5) << 17);
+        var2 = var2 + (static_cast<int64_t>(p4) << 35);
+        var1 = ((var1 * var1 * p3) >> 8) + ((var1 * p2) << 12);
+        var1 = ((static_cast<int64_t>(1) << 47) + var1) * p1 >> 33;
+        if (var1 == 0) return 0;
+        int64_t p = 1048576 - adcP;
+        p = (((p << 31) - var2) * 3125) / var1;
+        var1 = (static_cast<int64_t>(p9) * (p >> 13) * (p >> 13)) >> 25;
+        var2 = (static_cast<int64_t>(p8) * p) >> 19;
+        p = ((p + var1 + var2) >> 8) + (static_cast<int64_t>(p7) << 4);
+        return static_cast<uint32_t>(p);
+    }
+
+    uint32_t computeHumidity(int32_t adcH, int32_t tFine) const {
+        int32_t v = tFine - 76800;
+        v = (((((adcH << 14) - (static_cast<int32_t>(h4) << 20) - (h5 * v)) + 16384) >> 15) *
+             (((((((v * h6) >> 10) * (((v * h3) >> 11) + 32768)) >> 10) + 2097152) * h2 + 8192) >> 14));
+        v = v - (((((v >> 15) * (v >> 15)) >> 7) * h1) >> 4);
+        v = v < 0 ? 0 : v;
+        v = v > 419430400 ? 419430400 : v;
+        return static_cast<uint32_t>(v >> 12);
+    }
+};
+
+#endif // BME280_H
@@ -0,0 +1,206 @@
+#ifndef BMP085_H
+#define BMP085_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include "I2CBus.h"
+#include "SensorDriver.h"
+
+/**
+ * @class Bmp085
+ * @brief Non-blocking BMP085/BMP180 driver built as a conversion state machine.
+ *
+ * A reading is one temperature conversion followed by one pressure conversion. start() kicks off
+ * the temperature conversion and returns; poll() collects a conversion once its datasheet
+ * conversion time has passed and starts the next one, so the caller keeps doing other work (or
+ * sleeps) in between instead of blocking in delay(). The temperature compensation term (B5) is
+ * computed once per reading and shared by the pressure calculation, where the Adafruit driver
+ * runs a second temperature conversion inside readPressure().
+ *
+ * Every register access is a short SENSOR-priority transaction on the shared I2CBus.
+ * Compensation follows the integer algorithm in the BMP085 datasheet.
+ */
+class Bmp085 : public SensorDriver<Bmp085> {
+public:
+    static constexpr uint8_t ADDRESS = 0x77;
+    static constexpr uint8_t CHIP_ID = 0x55;
+
+    enum Oversampling : uint8_t {
+        ULTRALOWPOWER = 0,
+        STANDARD = 1,
+        HIGHRES = 2,
+        ULTRAHIGHRES = 3,
+    };
+
+    enum class State : uint8_t { IDLE, TEMPERATURE, PRESSURE };
+
+    using SensorDriver<Bmp085>::begin;
+
+    // Reads the chip id and calibration EEPROM. Returns false if the sensor does not answer.
+    bool begin(I2CBus& i2cBus, uint8_t mode) {
+        setOversampling(mode);
+        return begin(i2cBus);
+    }
+
+    // Takes effect with the next pressure conversion.
+    void setOversampling(uint8_t mode) {
+        oversampling = std::min<uint8_t>(mode, ULTRAHIGHRES);
+    }
+
+    uint8_t getOversampling() const { return oversampling; }
+    State getState() const { return isBusy() ? phase : State::IDLE; }
+
+    // Called with the raw UT and 24-bit result register of every reading, e.g. to capture a
+    // sensor trace; nullptr to stop.
+    using RawTap = void (*)(void* context, uint16_t ut, uint32_t result, uint8_t oversampling);
+    void setRawTap(RawTap tap, void* context) {
+        rawTap = tap;
+        rawTapContext = context;
+    }
+
+    // Calibration EEPROM as read by begin(), registers 0xAA..0xBF.
+    const std::array<uint8_t, 22>& getCalibrationRaw() const { return calibrationRaw; }
+
+    // Values of the last completed reading.
+    float getTemperature() const { return temperatureTenths / 10.0f; }
+    int32_t getPressure() const { return pressurePa; }
+
+private:
+    friend class SensorDriver<Bmp085>;
+
+    static constexpr uint8_t REG_CALIBRATION = 0xAA;
+    static constexpr uint8_t REG_CHIP_ID = 0xD0;
+    static constexpr uint8_t REG_CONTROL = 0xF4;
+    static constexpr uint8_t REG_RESULT = 0xF6;
+    static constexpr uint8_t CMD_TEMPERATURE = 0x2E;
+    static constexpr uint8_t CMD_PRESSURE = 0x34;
+    static constexpr uint32_t TEMPERATURE_CONVERSION_US = 4500;
+    // Maximum conversion time per oversampling mode, from the datasheet.
+    static constexpr uint32_t PRESSURE_CONVERSION_US[4] = {4500, 7500, 13500, 25500};
+
+    I2CBus* bus = nullptr;
+    State phase = State::IDLE;
+    uint8_t oversampling = ULTRAHIGHRES;
+    uint8_t conversionOversampling = ULTRAHIGHRES;  // mode the running pressure conversion uses
+
+    RawTap rawTap = nullptr;
+    void* rawTapContext = nullptr;
+    std::array<uint8_t, 22> calibrationRaw{};
+    uint16_t rawUt = 0;
+
+    int16_t ac1 = 0, ac2 = 0, ac3 = 0, b1 = 0, b2 = 0, mc = 0, md = 0;
+    uint16_t ac4 = 0, ac5 = 0, ac6 = 0;
+
+    int32_t b5 = 0;
+    int32_t temperatureTenths = 0;
+    int32_t pressurePa = 0;
+
+    bool probe(I2CBus& i2cBus) {
+        bus = &i2cBus;
+        uint8_t id = 0;
+        std::array<uint8_t, 22>& raw = calibrationRaw;
+        if (!readRegisters(REG_CHIP_ID, &id, 1) || id != CHIP_ID || !readRegisters(REG_CALIBRATION, raw.data(), raw.size())) {
+            return false;
+        }
+        ac1 = int16At(raw.data(), 0);
+        ac2 = int16At(raw.data(), 2);
+        ac3 = int16At(raw.data(), 4);
+        ac4 = static_cast<uint16_t>(int16At(raw.data(), 6));
+        ac5 = static_cast<uint16_t>(int16At(raw.data(), 8));
+        ac6 = static_cast<uint16_t>(int16At(raw.data(), 10));
+        b1 = int16At(raw.data(), 12);
+        b2 = int16At(raw.data(), 14);
+        mc = int16At(raw.data(), 18);
+        md = int16At(raw.data(), 20);
+        return true;
+    }
+
+    bool startMeasurement() {
+        return startConversion(CMD_TEMPERATURE, State::TEMPERATURE, TEMPERATURE_CONVERSION_US);
+    }
+
+    bool continueMeasurement() {
+        uint8_t raw[3];
+        if (phase == State::TEMPERATURE) {
+            if (!readRegisters(REG_RESULT, raw, 2)) return fail();
+            rawUt = static_cast<uint16_t>((raw[0] << 8) | raw[1]);
+            b5 = computeB5(rawUt);
+            temperatureTenths = (b5 + 8) >> 4;
+            if (!startConversion(CMD_PRESSURE + (oversampling << 6), State::PRESSURE, PRESSURE_CONVERSION_US[oversampling])) {
+                return fail();
+            }
+            return false;
+        }
+
+        if (!readRegisters(REG_RESULT, raw, 3)) return fail();
+        const int32_t result = (static_cast<int32_t>(raw[0]) << 16) | (raw[1] << 8) | raw[2];
+        if (rawTap) rawTap(rawTapContext, rawUt, static_cast<uint32_t>(result), conversionOversampling);
+        const int32_t up = result >> (8 - conversionOversampling);
+        pressurePa = computePressure(up, conversionOversampling);
+        return finish();
+    }
+
+    void fill(EnvironmentReading& out) const {
+        out.temperature = getTemperature();
+        out.pressure = pressurePa / 100.0f;
+        out.validMask |= EnvironmentReading::TEMPERATURE | EnvironmentReading::PRESSURE;
+    }
+
+    bool startConversion(uint8_t command, State next, uint32_t conversionUs) {
+        const bool ok = bus->transact(ADDRESS, I2CBus::Priority::SENSOR, [command](TwoWire& wire) {
+            wire.beginTransmission(ADDRESS);
+            wire.write(REG_CONTROL);
+            wire.write(command);
+            return wire.endTransmission() == 0;
+        });
+        if (!ok) return false;
+        conversionOversampling = oversampling;
+        phase = next;
+        waitUs(conversionUs);
+        return true;
+    }
+
+    bool readRegisters(uint8_t reg, uint8_t* out, size_t len) {
+        return bus->transact(ADDRESS, I2CBus::Priority::SENSOR, [reg, out, len](TwoWire& wire) {
+            wire.beginTransmission(ADDRESS);
+            wire.write(reg);
+            if (wire.endTransmission() != 0) return false;
+            if (wire.requestFrom(static_cast<uint16_t>(ADDRESS), len, true) != len) return false;
+            for (size_t i = 0; i < len; ++i) {
+                out[i] = static_cast<uint8_t>(wire.read());
+            }
+            return true;
+        });
+    }
+
+    static int16_t int16At(const uint8_t* raw, size_t offset) {
+        return static_cast<int16_t>((raw[offset] << 8) | raw[offset + 1]);
+    }
+
+    int32_t computeB5(int32_t ut) const {
+        const int32_t x1 = ((ut - ac6) * static_cast<int32_t>(ac5)) >> 15;
+        const int32_t x2 = (static_cast<int32_t>(mc) << 11) / (x1 + md);
+        return x1 + x2;
+    }
+
+    int32_t computePressure(int32_t up, uint8_t oss) const {
+        const int32_t b6 = b5 - 4000;
+        int32_t x1 = (b2 * ((b6 * b6) >> 12)) >> 11;
+        int32_t x2 = (ac2 * b6) >> 11;
+        int32_t x3 = x1 + x2;
+        const int32_t b3 = (((static_cast<int32_t>(ac1) * 4 + x3) << oss) + 2) / 4;
+        x1 = (ac3 * b6) >> 13;
+        x2 = (b1 * ((b6 * b6) >> 12)) >> 16;
+        x3 = ((x1 + x2) + 2) >> 2;
+        const uint32_t b4 = (static_cast<uint32_t>(ac4) * static_cast<uint32_t>(x3 + 32768)) >> 15;
+        const uint32_t b7 = (static_cast<uint32_t>(up) - b3) * (50000 >> oss);
+        int32_t p = b7 < 0x80000000 ? (b7 * 2) / b4 : (b7 / b4) * 2;
+        x1 = (p >> 8) * (p >> 8);
+        x1 = (x1 * 3038) >> 16;
+        x2 = (-7357 * p) >> 16;
+        return p + ((x1 + x2 + 3791) >> 4);
+    }
+};
+
+#endif // BMP085_H
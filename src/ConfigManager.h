@@ -1,7 +1,6 @@
 #ifndef CONFIG_MANAGER_H
 #define CONFIG_MANAGER_H
 
-#include <map>
 #include <string>
 #include <functional>
 #include <array>
@@ -10,8 +9,8 @@
 #include <mutex>
 #include <shared_mutex>
 #include <optional>
-#include <variant>
-#include "Globals.h"
+#include <Arduino.h>
+#include "globals.h"
 #include "ESPLogger.h"
 #include "ConfigTypes.h"
 #include "PreferencesHandler.h"
@@ -37,30 +36,24 @@ public:
         logger.log("ConfigManager", LogLevel::INFO, "Preferences begun successfully");
 
         // Calculate the system size
-        size_t systemSize = getValue<int>(ConfigKey::SYSTEM_SIZE, 0);
+        size_t systemSize = getValue<ConfigKey::SYSTEM_SIZE, int>();
 
         // Initialize or load configurations
-        for (const auto& [key, info] : configMap) {
-            if (info.confType != "sensorConf") {
+        for (const ConfigInfo& info : ConfigSchema::entries) {
+            if (info.confType != ConfigScope::SENSOR) {
                 // Global configurations
-                if (!preferences.isKey(prefsHandler.getPrefKey(key).c_str())) {
+                if (!preferences.isKey(prefsHandler.getPrefKey(info.key).c_str())) {
                     // Key doesn't exist, initialize from default
-                    std::visit([this, key](auto&& arg) {
-                        using T = std::decay_t<decltype(arg)>;
-                        prefsHandler.saveToPreferences(key, arg, 0);
-                    }, info.defaultValue);
-                    logger.log("ConfigManager", LogLevel::INFO, "Initialized global key: %s", info.confKey.c_str());
+                    saveDefault(info, 0);
+                    logger.log("ConfigManager", LogLevel::INFO, "Initialized global key: %s", info.confKey);
                 }
             } else {
                 // Sensor-specific configurations
                 for (size_t i = 0; i < systemSize; ++i) {
-                    if (!preferences.isKey(prefsHandler.getPrefKey(key, i).c_str())) {
+                    if (!preferences.isKey(prefsHandler.getPrefKey(info.key, i).c_str())) {
                         // Key doesn't exist for this sensor, initialize from default
-                        std::visit([this, key, i](auto&& arg) {
-                            using T = std::decay_t<decltype(arg)>;
-                            prefsHandler.saveToPreferences(key, arg, i);
-                        }, info.defaultValue);
-                        logger.log("ConfigManager", LogLevel::INFO, "Initialized sensor key: %s for sensor %d", info.confKey.c_str(), i);
+                        saveDefault(info, i);
+                        logger.log("ConfigManager", LogLevel::INFO, "Initialized sensor key: %s for sensor %d", info.confKey, i);
                     }
                 }
             }
@@ -72,7 +65,7 @@ public:
     
     void initializeConfigurations() {
 
-        size_t newSystemSize = getValue<int>(ConfigKey::SYSTEM_SIZE, 0);
+        size_t newSystemSize = getValue<ConfigKey::SYSTEM_SIZE, int>();
 
         createHardwareConfig(newSystemSize);
         createSoftwareConfig();
@@ -100,12 +93,17 @@ public:
         std::unique_lock lock(mutex);
         bool changed = false;
         
-        if (newConfig.sdaPin) changed |= setAndSave<int>(ConfigKey::SDA_PIN, *newConfig.sdaPin, hwConf.sdaPin);
-        if (newConfig.sclPin) changed |= setAndSave(ConfigKey::SCL_PIN, *newConfig.sclPin, hwConf.sclPin);
-        if (newConfig.floatSwitchPin) changed |= setAndSave(ConfigKey::FLOAT_SWITCH_PIN, *newConfig.floatSwitchPin, hwConf.floatSwitchPin);
-        if (!newConfig.moistureSensorPins.empty()) changed |= setAndSave(ConfigKey::SENSOR_PIN, newConfig.moistureSensorPins, hwConf.moistureSensorPins);
-        if (!newConfig.relayPins.empty()) changed |= setAndSave(ConfigKey::RELAY_PIN, newConfig.relayPins, hwConf.relayPins);
-        if (newConfig.systemSize) changed |= setAndSave(ConfigKey::SYSTEM_SIZE, *newConfig.systemSize, hwConf.systemSize);
+        if (newConfig.sdaPin) changed |= setAndSave<ConfigKey::SDA_PIN>(*newConfig.sdaPin, hwConf.sdaPin);
+        if (newConfig.sclPin) changed |= setAndSave<ConfigKey::SCL_PIN>(*newConfig.sclPin, hwConf.sclPin);
+        if (newConfig.floatSwitchPin) changed |= setAndSave<ConfigKey::FLOAT_SWITCH_PIN>(*newConfig.floatSwitchPin, hwConf.floatSwitchPin);
+        if (!newConfig.moistureSensorPins.empty()) changed |= setAndSave<ConfigKey::SENSOR_PIN>(newConfig.moistureSensorPins, hwConf.moistureSensorPins);
+        if (!newConfig.relayPins.empty()) changed |= setAndSave<ConfigKey::RELAY_PIN>(newConfig.relayPins, hwConf.relayPins);
+        if (!newConfig.muxSelectPins.empty()) changed |= setAndSave<ConfigKey::MUX_SELECT_PIN>(newConfig.muxSelectPins, hwConf.muxSelectPins);
+        if (!newConfig.muxSignalPins.empty()) changed |= setAndSave<ConfigKey::MUX_SIGNAL_PIN>(newConfig.muxSignalPins, hwConf.muxSignalPins);
+        if (!newConfig.relayCurrents.empty()) changed |= setAndSave<ConfigKey::RELAY_CURRENT>(newConfig.relayCurrents, hwConf.relayCurrents);
+        if (newConfig.powerBudget) changed |= setAndSave<ConfigKey::POWER_BUDGET>(*newConfig.powerBudget, hwConf.powerBudget);
+        if (newConfig.inrushDelay) changed |= setAndSave<ConfigKey::INRUSH_DELAY>(*newConfig.inrushDelay, hwConf.inrushDelay);
+        if (newConfig.systemSize) changed |= setAndSave<ConfigKey::SYSTEM_SIZE>(*newConfig.systemSize, hwConf.systemSize);
 
         return changed;
     }
@@ -115,11 +113,13 @@ public:
         std::unique_lock lock(mutex);
         bool changed = false;
         
-        if (newConfig.tempOffset) changed |= setAndSave(ConfigKey::TEMP_OFFSET, *newConfig.tempOffset, swConf.tempOffset);
-        if (newConfig.telemetryInterval) changed |= setAndSave(ConfigKey::TELEMETRY_INTERVAL, *newConfig.telemetryInterval, swConf.telemetryInterval);
-        if (newConfig.sensorUpdateInterval) changed |= setAndSave(ConfigKey::SENSOR_UPDATE_INTERVAL, *newConfig.sensorUpdateInterval, swConf.sensorUpdateInterval);
-        if (newConfig.lcdUpdateInterval) changed |= setAndSave(ConfigKey::LCD_UPDATE_INTERVAL, *newConfig.lcdUpdateInterval, swConf.lcdUpdateInterval);
-        if (newConfig.sensorPublishInterval) changed |= setAndSave(ConfigKey::SENSOR_PUBLISH_INTERVAL, *newConfig.sensorPublishInterval, swConf.sensorPublishInterval);
+        if (newConfig.tempOffset) changed |= setAndSave<ConfigKey::TEMP_OFFSET>(*newConfig.tempOffset, swConf.tempOffset);
+        if (newConfig.telemetryInterval) changed |= setAndSave<ConfigKey::TELEMETRY_INTERVAL>(*newConfig.telemetryInterval, swConf.telemetryInterval);
+        if (newConfig.sensorUpdateInterval) changed |= setAndSave<ConfigKey::SENSOR_UPDATE_INTERVAL>(*newConfig.sensorUpdateInterval, swConf.sensorUpdateInterval);
+        if (newConfig.lcdUpdateInterval) changed |= setAndSave<ConfigKey::LCD_UPDATE_INTERVAL>(*newConfig.lcdUpdateInterval, swConf.lcdUpdateInterval);
+        if (newConfig.sensorPublishInterval) changed |= setAndSave<ConfigKey::SENSOR_PUBLISH_INTERVAL>(*newConfig.sensorPublishInterval, swConf.sensorPublishInterval);
+        if (newConfig.moistureFilter) changed |= setAndSave<ConfigKey::MOISTURE_FILTER>(*newConfig.moistureFilter, swConf.moistureFilter);
+        if (newConfig.bmpOversampling) changed |= setAndSave<ConfigKey::BMP_OVERSAMPLING>(*newConfig.bmpOversampling, swConf.bmpOversampling);
 
         return changed;
     }
@@ -134,12 +134,25 @@ public:
 
         bool changed = false;
         ConfigTypes::SensorConfig& currentConfig = sensorConf[sensorIndex];
+
+        // Both calibration points map to the same reading otherwise
+        const int dryValue = newConfig.dryValue.value_or(currentConfig.dryValue.value_or(0));
+        const int wetValue = newConfig.wetValue.value_or(currentConfig.wetValue.value_or(0));
+        if ((newConfig.dryValue || newConfig.wetValue) && dryValue == wetValue) {
+            logger.log("ConfigManager", LogLevel::ERROR, "Dry and wet calibration values must differ");
+            return false;
+        }
         
-        if (newConfig.threshold) changed |= setAndSave(ConfigKey::SENSOR_THRESHOLD, *newConfig.threshold, currentConfig.threshold, sensorIndex);
-        if (newConfig.activationPeriod) changed |= setAndSave(ConfigKey::SENSOR_ACTIVATION_PERIOD, *newConfig.activationPeriod, currentConfig.activationPeriod, sensorIndex);
-        if (newConfig.wateringInterval) changed |= setAndSave(ConfigKey::SENSOR_WATERING_INTERVAL, *newConfig.wateringInterval, currentConfig.wateringInterval, sensorIndex);
-        if (newConfig.sensorEnabled) changed |= setAndSave(ConfigKey::SENSOR_ENABLED, *newConfig.sensorEnabled, currentConfig.sensorEnabled, sensorIndex);
-        if (newConfig.relayEnabled) changed |= setAndSave(ConfigKey::RELAY_ENABLED, *newConfig.relayEnabled, currentConfig.relayEnabled, sensorIndex);
+        if (newConfig.threshold) changed |= setAndSave<ConfigKey::SENSOR_THRESHOLD>(*newConfig.threshold, currentConfig.threshold, sensorIndex);
+        if (newConfig.activationPeriod) changed |= setAndSave<ConfigKey::SENSOR_ACTIVATION_PERIOD>(*newConfig.activationPeriod, currentConfig.activationPeriod, sensorIndex);
+        if (newConfig.wateringInterval) changed |= setAndSave<ConfigKey::SENSOR_WATERING_INTERVAL>(*newConfig.wateringInterval, currentConfig.wateringInterval, sensorIndex);
+        if (newConfig.sensorEnabled) changed |= setAndSave<ConfigKey::SENSOR_ENABLED>(*newConfig.sensorEnabled, currentConfig.sensorEnabled, sensorIndex);
+        if (newConfig.relayEnabled) changed |= setAndSave<ConfigKey::RELAY_ENABLED>(*newConfig.relayEnabled, currentConfig.relayEnabled, sensorIndex);
+        if (newConfig.dryValue) changed |= setAndSave<ConfigKey::SENSOR_DRY_VALUE>(*newConfig.dryValue, currentConfig.dryValue, sensorIndex);
+        if (newConfig.wetValue) changed |= setAndSave<ConfigKey::SENSOR_WET_VALUE>(*newConfig.wetValue, currentConfig.wetValue, sensorIndex);
+        if (newConfig.autoTune) changed |= setAndSave<ConfigKey::SENSOR_AUTO_TUNE>(*newConfig.autoTune, currentConfig.autoTune, sensorIndex);
+        if (newConfig.targetMoisture) changed |= setAndSave<ConfigKey::SENSOR_TARGET_MOISTURE>(*newConfig.targetMoisture, currentConfig.targetMoisture, sensorIndex);
+        if (newConfig.wateringGain) changed |= setAndSave<ConfigKey::SENSOR_WATERING_GAIN>(*newConfig.wateringGain, currentConfig.wateringGain, sensorIndex);
 
         return changed;
     }
@@ -162,96 +175,122 @@ private:
     ConfigTypes::SoftwareConfig swConf;
     std::vector<ConfigTypes::SensorConfig> sensorConf;
 
-    static inline const std::map<ConfigKey, ConfigInfo>& configMap = ::configMap;
-
     void createSensorConfig(size_t index) {
         ConfigTypes::SensorConfig& conf = sensorConf[index];
-        conf.threshold = getValue<float>(ConfigKey::SENSOR_THRESHOLD, index);
-        conf.activationPeriod = getValue<uint32_t>(ConfigKey::SENSOR_ACTIVATION_PERIOD, index);
-        conf.wateringInterval = getValue<uint32_t>(ConfigKey::SENSOR_WATERING_INTERVAL, index);
-        conf.sensorEnabled = getValue<bool>(ConfigKey::SENSOR_ENABLED, index);
-        conf.relayEnabled = getValue<bool>(ConfigKey::RELAY_ENABLED, index);
+        conf.threshold = getValue<ConfigKey::SENSOR_THRESHOLD, float>(index);
+        conf.activationPeriod = getValue<ConfigKey::SENSOR_ACTIVATION_PERIOD, uint32_t>(index);
+        conf.wateringInterval = getValue<ConfigKey::SENSOR_WATERING_INTERVAL, uint32_t>(index);
+        conf.sensorEnabled = getValue<ConfigKey::SENSOR_ENABLED, bool>(index);
+        conf.relayEnabled = getValue<ConfigKey::RELAY_ENABLED, bool>(index);
+        conf.dryValue = getValue<ConfigKey::SENSOR_DRY_VALUE, int>(index);
+        conf.wetValue = getValue<ConfigKey::SENSOR_WET_VALUE, int>(index);
+        conf.autoTune = getValue<ConfigKey::SENSOR_AUTO_TUNE, bool>(index);
+        conf.targetMoisture = getValue<ConfigKey::SENSOR_TARGET_MOISTURE, float>(index);
+        conf.wateringGain = getValue<ConfigKey::SENSOR_WATERING_GAIN, float>(index);
     }
 
     void createSoftwareConfig() {
-        swConf.tempOffset = getValue<float>(ConfigKey::TEMP_OFFSET);
-        swConf.telemetryInterval = getValue<uint32_t>(ConfigKey::TELEMETRY_INTERVAL);
-        swConf.sensorUpdateInterval = getValue<uint32_t>(ConfigKey::SENSOR_UPDATE_INTERVAL);
-        swConf.lcdUpdateInterval = getValue<uint32_t>(ConfigKey::LCD_UPDATE_INTERVAL);
-        swConf.sensorPublishInterval = getValue<uint32_t>(ConfigKey::SENSOR_PUBLISH_INTERVAL);
+        swConf.tempOffset = getValue<ConfigKey::TEMP_OFFSET, float>();
+        swConf.telemetryInterval = getValue<ConfigKey::TELEMETRY_INTERVAL, uint32_t>();
+        swConf.sensorUpdateInterval = getValue<ConfigKey::SENSOR_UPDATE_INTERVAL, uint32_t>();
+        swConf.lcdUpdateInterval = getValue<ConfigKey::LCD_UPDATE_INTERVAL, uint32_t>();
+        swConf.sensorPublishInterval = getValue<ConfigKey::SENSOR_PUBLISH_INTERVAL, uint32_t>();
+        swConf.moistureFilter = getValue<ConfigKey::MOISTURE_FILTER, int>();
+        swConf.bmpOversampling = getValue<ConfigKey::BMP_OVERSAMPLING, int>();
     }
     
     void createHardwareConfig(size_t systemSize) {
         hwConf.systemSize = systemSize;
-        hwConf.sdaPin = getValue<int>(ConfigKey::SDA_PIN);
-        hwConf.sclPin = getValue<int>(ConfigKey::SCL_PIN);
-        hwConf.floatSwitchPin = getValue<int>(ConfigKey::FLOAT_SWITCH_PIN);
-        hwConf.moistureSensorPins = adjustVector(ConfigKey::SENSOR_PIN, systemSize);
-        hwConf.relayPins = adjustVector(ConfigKey::RELAY_PIN, systemSize);
+        hwConf.sdaPin = getValue<ConfigKey::SDA_PIN, int>();
+        hwConf.sclPin = getValue<ConfigKey::SCL_PIN, int>();
+        hwConf.floatSwitchPin = getValue<ConfigKey::FLOAT_SWITCH_PIN, int>();
+        hwConf.moistureSensorPins = adjustVector<ConfigKey::SENSOR_PIN>(systemSize);
+        hwConf.relayPins = adjustVector<ConfigKey::RELAY_PIN>(systemSize);
+        hwConf.muxSelectPins = getValue<ConfigKey::MUX_SELECT_PIN, std::vector<int>>();
+        hwConf.muxSignalPins = getValue<ConfigKey::MUX_SIGNAL_PIN, std::vector<int>>();
+        hwConf.relayCurrents = adjustVector<ConfigKey::RELAY_CURRENT>(systemSize);
+        hwConf.powerBudget = getValue<ConfigKey::POWER_BUDGET, int>();
+        hwConf.inrushDelay = getValue<ConfigKey::INRUSH_DELAY, int>();
     }
 
-    template<typename T>
-    bool validateValue(ConfigKey key, const T& value) const {
-        const auto& info = configMap.at(key);
-        if (info.minValue && info.maxValue) {
-            return std::visit([&value](const auto& min, const auto& max) -> bool {
-                using MinMaxType = std::decay_t<decltype(min)>;
-                if constexpr (std::is_convertible_v<T, MinMaxType>) {
-                    return static_cast<MinMaxType>(value) >= min && static_cast<MinMaxType>(value) <= max;
-                }
-                return false;
-            }, *info.minValue, *info.maxValue);
+    // Checked against the schema at compile time: T must match the key's value type, and the
+    // bounds are constants, so each call is a couple of comparisons.
+    template<ConfigKey K, typename T>
+    static bool validateValue(const T& value) {
+        constexpr const ConfigInfo& info = configInfo(K);
+        static_assert(configAccepts<T>(info.valueType), "value type does not match the config schema");
+        if constexpr (info.bounded && info.valueType == ConfigValueType::INT) {
+            return static_cast<int64_t>(value) >= info.intMin && static_cast<int64_t>(value) <= info.intMax;
+        } else if constexpr (info.bounded && info.valueType == ConfigValueType::FLOAT) {
+            return value >= info.floatMin && value <= info.floatMax;
         }
         return true;
     }
 
-    template<typename T>
-    T getValue(ConfigKey key, std::optional<size_t> index = std::nullopt) const {
+    template<ConfigKey K, typename T>
+    T getValue(size_t index = 0) const {
+        constexpr const ConfigInfo& info = configInfo(K);
+        static_assert(configAccepts<T>(info.valueType), "value type does not match the config schema");
         std::shared_lock lock(mutex);
-        const auto& info = configMap.at(key);
-        
-        if (info.confType != "sensorConf") {
-            index = 0;  // Use index 0 for non-sensor configs
-        } else if (!index.has_value()) {
-            throw std::runtime_error("Index must be provided for sensor-specific configurations");
+        if constexpr (info.valueType == ConfigValueType::INT) {
+            return prefsHandler.loadFromPreferences<T>(K, static_cast<T>(info.intDefault), index);
+        } else if constexpr (info.valueType == ConfigValueType::FLOAT) {
+            return prefsHandler.loadFromPreferences<T>(K, info.floatDefault, index);
+        } else if constexpr (info.valueType == ConfigValueType::BOOL) {
+            return prefsHandler.loadFromPreferences<T>(K, info.boolDefault, index);
+        } else {
+            // The default list is only built when nothing is stored
+            T values = prefsHandler.loadFromPreferences<T>(K, T(), index);
+            if (values.empty()) return info.listDefault.toVector();
+            return values;
+        }
+    }
+
+    // Writes the schema default of a setting; the schema is walked at runtime here, so the type
+    // is dispatched on the entry.
+    void saveDefault(const ConfigInfo& info, size_t index) {
+        switch (info.valueType) {
+            case ConfigValueType::INT:
+                prefsHandler.saveToPreferences(info.key, static_cast<int>(info.intDefault), index);
+                break;
+            case ConfigValueType::FLOAT:
+                prefsHandler.saveToPreferences(info.key, info.floatDefault, index);
+                break;
+            case ConfigValueType::BOOL:
+                prefsHandler.saveToPreferences(info.key, info.boolDefault, index);
+                break;
+            case ConfigValueType::INT_LIST:
+                prefsHandler.saveToPreferences(info.key, info.listDefault.toVector(), index);
+                break;
         }
-        
-        return std::visit([this, key, index](const auto& defaultVal) -> T {
-            using DefaultType = std::decay_t<decltype(defaultVal)>;
-            if constexpr (std::is_convertible_v<DefaultType, T>) {
-                return prefsHandler.loadFromPreferences<T>(key, static_cast<T>(defaultVal), index.value());
-            } else {
-                throw std::runtime_error("Type mismatch in getValue");
-            }
-        }, info.defaultValue);
     }
 
-    template<typename T>
-    bool setAndSave(ConfigKey key, const T& newValue, T& currentValue, size_t sensorIndex = 0) {
-        if (!validateValue(key, newValue)) {
+    template<ConfigKey K, typename T>
+    bool setAndSave(const T& newValue, T& currentValue, size_t sensorIndex = 0) {
+        if (!validateValue<K>(newValue)) {
             logger.log("ConfigManager", LogLevel::ERROR, "Invalid value for config");
             return false;
         }
 
         if (currentValue != newValue) {
             currentValue = newValue;  // Update runtime cache
-            prefsHandler.saveToPreferences(key, newValue, sensorIndex);  // Update persistent storage
+            prefsHandler.saveToPreferences(K, newValue, sensorIndex);  // Update persistent storage
             return true;
         }
         return false;
     }
 
     // Specialized version for std::optional types
-    template<typename T>
-    bool setAndSave(ConfigKey key, const T& newValue, std::optional<T>& currentValue, size_t sensorIndex = 0) {
-        if (!validateValue(key, newValue)) {
+    template<ConfigKey K, typename T>
+    bool setAndSave(const T& newValue, std::optional<T>& currentValue, size_t sensorIndex = 0) {
+        if (!validateValue<K>(newValue)) {
             logger.log("ConfigManager", LogLevel::ERROR, "Invalid value for config");
             return false;
         }
 
         if (!currentValue || *currentValue != newValue) {
             currentValue = newValue;  // Update runtime cache
-            prefsHandler.saveToPreferences(key, newValue, sensorIndex);  // Update persistent storage
+            prefsHandler.saveToPreferences(K, newValue, sensorIndex);  // Update persistent storage
             return true;
         }
         return false;
@@ -259,32 +298,18 @@ private:
 
     void initializeDefaultValues(size_t systemSize) {
         logger.log("ConfigManager", LogLevel::INFO, "Initializing default values");
-        for (const auto& [key, info] : configMap) {
-            logger.log("ConfigManager", LogLevel::DEBUG, "Initializing key: %d", static_cast<int>(key));
-            std::visit([this, key, &info](auto&& arg) {
-                using T = std::decay_t<decltype(arg)>;
-                if constexpr (
-                            std::is_same_v<T, int> || 
-                            std::is_same_v<T, float> || 
-                            std::is_same_v<T, bool> || 
-                            std::is_same_v<T, uint32_t> ||
-                            std::is_same_v<T, std::vector<int>>) {
-                    logger.log("ConfigManager", LogLevel::DEBUG, "Saving key: %d", static_cast<int>(key));
-                    prefsHandler.saveToPreferences(key, arg, 0);  // Use index 0 for global configs
-                }
-            }, info.defaultValue);
+        for (const ConfigInfo& info : ConfigSchema::entries) {
+            logger.log("ConfigManager", LogLevel::DEBUG, "Initializing key: %d", static_cast<int>(info.key));
+            saveDefault(info, 0);  // Use index 0 for global configs
         }
 
         // For sensor-specific configurations, we need to initialize for each sensor
         for (size_t i = 0; i < systemSize; ++i) {
             logger.log("ConfigManager", LogLevel::DEBUG, "Initializing sensor %d", i);
-            for (const auto& [key, info] : configMap) {
-                if (info.confType == "sensorConf") {
-                    logger.log("ConfigManager", LogLevel::DEBUG, "Initializing sensor key: %d", static_cast<int>(key));
-                    std::visit([this, key, i](auto&& arg) {
-                        logger.log("ConfigManager", LogLevel::DEBUG, "Saving sensor key: %d", static_cast<int>(key));
-                        prefsHandler.saveToPreferences(key, arg, i);
-                    }, info.defaultValue);
+            for (const ConfigInfo& info : ConfigSchema::entries) {
+                if (info.confType == ConfigScope::SENSOR) {
+                    logger.log("ConfigManager", LogLevel::DEBUG, "Saving sensor key: %d", static_cast<int>(info.key));
+                    saveDefault(info, i);
                 }
             }
         }
@@ -294,28 +319,26 @@ private:
 
     void initializeNewSensors(size_t oldSize, size_t newSize) {
         for (size_t i = oldSize; i < newSize; i++) {
-            for (const auto& [key, info] : configMap) {
-                if (info.confType == "sensorConf") {
-                    std::visit([this, key, i](auto&& arg) {
-                        using T = std::decay_t<decltype(arg)>;
-                        prefsHandler.saveToPreferences(key, arg, i);
-                    }, info.defaultValue);
+            for (const ConfigInfo& info : ConfigSchema::entries) {
+                if (info.confType == ConfigScope::SENSOR) {
+                    saveDefault(info, i);
                 }
             }
         }
     }
 
-    std::vector<int> adjustVector(ConfigKey key, size_t newSize) {
-        std::vector<int> vec = getValue<std::vector<int>>(key);
+    template<ConfigKey K>
+    std::vector<int> adjustVector(size_t newSize) {
+        std::vector<int> vec = getValue<K, std::vector<int>>();
         
         if (vec.size() != newSize) {
-            const auto& info = configMap.at(key);
-            const auto& defaultVec = std::get<std::vector<int>>(info.defaultValue);
+            constexpr const ConfigIntList& defaultVec = configInfo(K).listDefault;
+            static_assert(defaultVec.size > 0, "lists resized with the system need a default");
             
             if (vec.size() < newSize) {
                 // Expand
                 while (vec.size() < newSize) {
-                    vec.push_back(defaultVec[vec.size() % defaultVec.size()]);
+                    vec.push_back(defaultVec.values[vec.size() % defaultVec.size]);
                 }
             } else {
                 // Shrink
@@ -323,7 +346,7 @@ private:
             }
             
             // Save the adjusted vector back to preferences
-            prefsHandler.saveToPreferences(key, vec, 0);
+            prefsHandler.saveToPreferences(K, vec, 0);
         }
         
         return vec;
@@ -331,9 +354,9 @@ private:
 
     void cleanupRemovedSensors(size_t newSize, size_t oldSize) {
         for (size_t i = newSize; i < oldSize; i++) {
-            for (const auto& [key, info] : configMap) {
-                if (info.confType == "sensorConf") {
-                    prefsHandler.removeFromPreferences(key, i);
+            for (const ConfigInfo& info : ConfigSchema::entries) {
+                if (info.confType == ConfigScope::SENSOR) {
+                    prefsHandler.removeFromPreferences(info.key, i);
                 }
             }
         }
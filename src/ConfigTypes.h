@@ -1,11 +1,13 @@
 #ifndef CONFIG_TYPES_H
 #define CONFIG_TYPES_H
 
-#include <string>
-#include <variant>
-#include <vector>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
-#include <map>
+#include <type_traits>
+#include <vector>
+#include "globals.h"
 
 // @note std::optional is used in order to facilitate partial updates of the configguration.
 //       This allows us to update only the fields that have changed, without the need to re-send the entire configuration.
@@ -17,6 +19,11 @@ namespace ConfigTypes {
         std::optional<int> floatSwitchPin;
         std::vector<int> moistureSensorPins;
         std::vector<int> relayPins;
+        std::vector<int> muxSelectPins;     // S0..S3, shared by all CD74HC4067 muxes
+        std::vector<int> muxSignalPins;     // ADC pin on the common output of each mux
+        std::vector<int> relayCurrents;     // mA drawn by the pump on each relay
+        std::optional<int> powerBudget;     // mA the pump supply delivers to all relays together
+        std::optional<int> inrushDelay;     // ms between two pump starts
     };
 
     struct SoftwareConfig {
@@ -25,6 +32,8 @@ namespace ConfigTypes {
         std::optional<uint32_t> sensorUpdateInterval;
         std::optional<uint32_t> lcdUpdateInterval;
         std::optional<uint32_t> sensorPublishInterval;
+        std::optional<int> moistureFilter;     // MoistureFilter::Mode
+        std::optional<int> bmpOversampling;    // Bmp085::Oversampling
     };
 
     struct SensorConfig {
@@ -33,55 +42,231 @@ namespace ConfigTypes {
         std::optional<uint32_t> wateringInterval;
         std::optional<bool> sensorEnabled;
         std::optional<bool> relayEnabled;
+        std::optional<int> dryValue;    // raw ADC reading at 0 % moisture
+        std::optional<int> wetValue;    // raw ADC reading at 100 % moisture
+        std::optional<bool> autoTune;           // adapt activationPeriod to reach targetMoisture
+        std::optional<float> targetMoisture;    // % after a watering, in feedback mode
+        std::optional<float> wateringGain;      // learned, tenths of a % per second of watering; 0 until measured
     };
 };
 
+// Indexes ConfigSchema::entries, so the order matters; SYSTEM_SIZE stays last.
 enum class ConfigKey {
     SENSOR_THRESHOLD,
     SENSOR_ACTIVATION_PERIOD,
     SENSOR_WATERING_INTERVAL,
     SENSOR_ENABLED,
     RELAY_ENABLED,
+    SENSOR_DRY_VALUE,
+    SENSOR_WET_VALUE,
+    SENSOR_AUTO_TUNE,
+    SENSOR_TARGET_MOISTURE,
+    SENSOR_WATERING_GAIN,
     SENSOR_PIN,
     RELAY_PIN,
     SDA_PIN,
     SCL_PIN,
     FLOAT_SWITCH_PIN,
+    MUX_SELECT_PIN,
+    MUX_SIGNAL_PIN,
+    RELAY_CURRENT,
+    POWER_BUDGET,
+    INRUSH_DELAY,
     TEMP_OFFSET,
     TELEMETRY_INTERVAL,
     SENSOR_UPDATE_INTERVAL,
     LCD_UPDATE_INTERVAL,
     SENSOR_PUBLISH_INTERVAL,
-    SENSOR_RELAY_MAPPING,
+    MOISTURE_FILTER,
+    BMP_OVERSAMPLING,
     SYSTEM_SIZE,
 };
 
-struct ConfigInfo {
-    std::string confType;
-    std::string confKey;
-    std::string prefKey;
-    std::variant<int, float, bool, std::vector<int>, std::vector<bool>, std::vector<int64_t>> defaultValue;
-    std::optional<std::variant<int, float>> minValue;
-    std::optional<std::variant<int, float>> maxValue;
+// Which group a setting belongs to. SENSOR settings exist once per zone, the others once.
+enum class ConfigScope : uint8_t {
+    SENSOR,
+    HARDWARE,
+    SOFTWARE,
 };
 
-inline const std::map<ConfigKey, ConfigInfo> configMap = {
-    {ConfigKey::SENSOR_THRESHOLD, {"sensorConf", "sensorThreshold", "th", 25, 5, 75}},
-    {ConfigKey::SENSOR_ACTIVATION_PERIOD, {"sensorConf", "activationPeriod", "ap", 5000, 1000, 60000}},
-    {ConfigKey::SENSOR_WATERING_INTERVAL, {"sensorConf", "wateringInterval", "wi", 86400000, 3600000, 604800000}},
-    {ConfigKey::SENSOR_ENABLED, {"sensorConf", "sensorEnabled", "se", true, std::nullopt, std::nullopt}},
-    {ConfigKey::RELAY_ENABLED, {"sensorConf", "relayEnabled", "re", true, std::nullopt, std::nullopt}},
-    {ConfigKey::SENSOR_PIN, {"hwConf", "sensorPin", "sp", std::vector<int>{34, 35, 36, 39}, std::nullopt, std::nullopt}},
-    {ConfigKey::RELAY_PIN, {"hwConf", "relayPin", "rp", std::vector<int>{33, 25, 17, 16}, std::nullopt, std::nullopt}},
-    {ConfigKey::SDA_PIN, {"hwConf", "sdaPin", "sda", 21, std::nullopt, std::nullopt}},
-    {ConfigKey::SCL_PIN, {"hwConf", "sclPin", "scl", 22, std::nullopt, std::nullopt}},
-    {ConfigKey::FLOAT_SWITCH_PIN, {"hwConf", "floatSwitchPin", "fsp", 16, std::nullopt, std::nullopt}},
-    {ConfigKey::TEMP_OFFSET, {"swConf", "tempOffset", "to", 0.0f, -10.0f, 10.0f}},
-    {ConfigKey::TELEMETRY_INTERVAL, {"swConf", "telemetryInterval", "ti", 60000, 10000, 360000}},
-    {ConfigKey::SENSOR_UPDATE_INTERVAL, {"swConf", "sensorUpdateInterval", "sui", 60000, 10000, 360000}},
-    {ConfigKey::LCD_UPDATE_INTERVAL, {"swConf", "lcdUpdateInterval", "lui", 5000, 10000, 60000}},
-    {ConfigKey::SENSOR_PUBLISH_INTERVAL, {"swConf", "sensorPublishInterval", "spi", 60000, 10000, 360000}},
-    {ConfigKey::SYSTEM_SIZE, {"hwConf", "systemSize", "size", 4, 1, 16}},
+// How a setting is stored in NVS and which C++ types may read or write it.
+enum class ConfigValueType : uint8_t {
+    INT,        // int, uint32_t
+    FLOAT,
+    BOOL,
+    INT_LIST,   // std::vector<int>
+};
+
+// Default of an INT_LIST setting, kept as a fixed array so the schema stays constexpr.
+struct ConfigIntList {
+    static constexpr size_t CAPACITY = 4;
+    int32_t values[CAPACITY] = {};
+    uint8_t size = 0;
+
+    std::vector<int> toVector() const {
+        return std::vector<int>(values, values + size);
+    }
+
+    template<size_t N>
+    static constexpr ConfigIntList of(const std::array<int, N>& defaults) {
+        static_assert(N <= CAPACITY, "list default too long");
+        ConfigIntList list;
+        for (size_t i = 0; i < N; ++i) list.values[i] = defaults[i];
+        list.size = N;
+        return list;
+    }
+};
+
+/**
+ * @brief One entry of the configuration schema.
+ *
+ * Only the fields of the entry's value type are meaningful. Bounds apply when `bounded` is
+ * set and are inclusive. Built through the helpers below, which keep every entry constexpr:
+ * the schema lives in flash and needs no static initialization.
+ */
+struct ConfigInfo {
+    ConfigKey key;
+    ConfigScope confType;
+    ConfigValueType valueType;
+    const char* confKey;
+    const char* prefKey;
+    bool bounded = false;
+    int32_t intDefault = 0;
+    int32_t intMin = 0;
+    int32_t intMax = 0;
+    float floatDefault = 0.0f;
+    float floatMin = 0.0f;
+    float floatMax = 0.0f;
+    bool boolDefault = false;
+    ConfigIntList listDefault;
+
+    constexpr ConfigInfo(ConfigKey key, ConfigScope confType, ConfigValueType valueType, const char* confKey,
+                         const char* prefKey)
+        : key(key), confType(confType), valueType(valueType), confKey(confKey), prefKey(prefKey) {}
+
+    static constexpr ConfigInfo intValue(ConfigKey key, ConfigScope scope, const char* confKey, const char* prefKey,
+                                         int32_t def) {
+        ConfigInfo info{key, scope, ConfigValueType::INT, confKey, prefKey};
+        info.intDefault = def;
+        return info;
+    }
+
+    static constexpr ConfigInfo intValue(ConfigKey key, ConfigScope scope, const char* confKey, const char* prefKey,
+                                         int32_t def, int32_t min, int32_t max) {
+        ConfigInfo info = intValue(key, scope, confKey, prefKey, def);
+        info.bounded = true;
+        info.intMin = min;
+        info.intMax = max;
+        return info;
+    }
+
+    static constexpr ConfigInfo floatValue(ConfigKey key, ConfigScope scope, const char* confKey, const char* prefKey,
+                                           float def, float min, float max) {
+        ConfigInfo info{key, scope, ConfigValueType::FLOAT, confKey, prefKey};
+        info.bounded = true;
+        info.floatDefault = def;
+        info.floatMin = min;
+        info.floatMax = max;
+        return info;
+    }
+
+    static constexpr ConfigInfo boolValue(ConfigKey key, ConfigScope scope, const char* confKey, const char* prefKey,
+                                          bool def) {
+        ConfigInfo info{key, scope, ConfigValueType::BOOL, confKey, prefKey};
+        info.boolDefault = def;
+        return info;
+    }
+
+    static constexpr ConfigInfo intList(ConfigKey key, ConfigScope scope, const char* confKey, const char* prefKey,
+                                        ConfigIntList def) {
+        ConfigInfo info{key, scope, ConfigValueType::INT_LIST, confKey, prefKey};
+        info.listDefault = def;
+        return info;
+    }
+
+    constexpr bool defaultInBounds() const {
+        if (!bounded) return true;
+        if (valueType == ConfigValueType::INT) return intDefault >= intMin && intDefault <= intMax;
+        if (valueType == ConfigValueType::FLOAT) return floatDefault >= floatMin && floatDefault <= floatMax;
+        return false;   // only INT and FLOAT settings have bounds
+    }
 };
 
+namespace ConfigSchema {
+    using S = ConfigScope;
+    using K = ConfigKey;
+    using I = ConfigInfo;
+
+    // Indexed by ConfigKey: one entry per key, in declaration order (checked below).
+    inline constexpr ConfigInfo entries[] = {
+        I::floatValue(K::SENSOR_THRESHOLD, S::SENSOR, "sensorThreshold", "th", 25.0f, 5.0f, 75.0f),
+        I::intValue(K::SENSOR_ACTIVATION_PERIOD, S::SENSOR, "activationPeriod", "ap", 5000, 1000, 60000),
+        I::intValue(K::SENSOR_WATERING_INTERVAL, S::SENSOR, "wateringInterval", "wi", 86400000, 3600000, 604800000),
+        I::boolValue(K::SENSOR_ENABLED, S::SENSOR, "sensorEnabled", "se", true),
+        I::boolValue(K::RELAY_ENABLED, S::SENSOR, "relayEnabled", "re", true),
+        I::intValue(K::SENSOR_DRY_VALUE, S::SENSOR, "dryValue", "dv", 2592, 0, 4095),
+        I::intValue(K::SENSOR_WET_VALUE, S::SENSOR, "wetValue", "wv", 975, 0, 4095),
+        I::boolValue(K::SENSOR_AUTO_TUNE, S::SENSOR, "autoTune", "at", false),
+        I::floatValue(K::SENSOR_TARGET_MOISTURE, S::SENSOR, "targetMoisture", "tm", 40.0f, 10.0f, 90.0f),
+        I::floatValue(K::SENSOR_WATERING_GAIN, S::SENSOR, "wateringGain", "wg", 0.0f, 0.0f, 1000.0f),
+        I::intList(K::SENSOR_PIN, S::HARDWARE, "sensorPin", "sp", {{34, 35, 36, 39}, 4}),
+        I::intList(K::RELAY_PIN, S::HARDWARE, "relayPin", "rp", {{33, 25, 17, 16}, 4}),
+        I::intValue(K::SDA_PIN, S::HARDWARE, "sdaPin", "sda", 21),
+        I::intValue(K::SCL_PIN, S::HARDWARE, "sclPin", "scl", 22),
+        I::intValue(K::FLOAT_SWITCH_PIN, S::HARDWARE, "floatSwitchPin", "fsp", 16),
+        I::intList(K::MUX_SELECT_PIN, S::HARDWARE, "muxSelectPins", "msp",
+                   ConfigIntList::of(ConfigConstants::DEFAULT_MUX_SELECT_PINS)),
+        I::intList(K::MUX_SIGNAL_PIN, S::HARDWARE, "muxSignalPins", "mxp",
+                   ConfigIntList::of(ConfigConstants::DEFAULT_MUX_SIGNAL_PINS)),
+        I::intList(K::RELAY_CURRENT, S::HARDWARE, "relayCurrents", "rc",
+                   ConfigIntList::of(ConfigConstants::DEFAULT_RELAY_CURRENTS)),
+        I::intValue(K::POWER_BUDGET, S::HARDWARE, "powerBudget", "pb", ConfigConstants::DEFAULT_POWER_BUDGET, 100, 20000),
+        I::intValue(K::INRUSH_DELAY, S::HARDWARE, "inrushDelay", "ird", ConfigConstants::DEFAULT_INRUSH_DELAY, 0, 5000),
+        I::floatValue(K::TEMP_OFFSET, S::SOFTWARE, "tempOffset", "to", 0.0f, -10.0f, 10.0f),
+        I::intValue(K::TELEMETRY_INTERVAL, S::SOFTWARE, "telemetryInterval", "ti", 60000, 10000, 360000),
+        I::intValue(K::SENSOR_UPDATE_INTERVAL, S::SOFTWARE, "sensorUpdateInterval", "sui", 60000, 10000, 360000),
+        I::intValue(K::LCD_UPDATE_INTERVAL, S::SOFTWARE, "lcdUpdateInterval", "lui", 5000, 1000, 60000),
+        I::intValue(K::SENSOR_PUBLISH_INTERVAL, S::SOFTWARE, "sensorPublishInterval", "spi", 60000, 10000, 360000),
+        I::intValue(K::MOISTURE_FILTER, S::SOFTWARE, "moistureFilter", "mf", 3, 0, 3),
+        I::intValue(K::BMP_OVERSAMPLING, S::SOFTWARE, "bmpOversampling", "bos", 3, 0, 3),
+        I::intValue(K::SYSTEM_SIZE, S::HARDWARE, "systemSize", "size", 4, 1, ConfigConstants::MAX_SYSTEM_SIZE),
+    };
+
+    inline constexpr size_t SIZE = sizeof(entries) / sizeof(entries[0]);
+
+    constexpr bool isOrdered() {
+        for (size_t i = 0; i < SIZE; ++i) {
+            if (static_cast<size_t>(entries[i].key) != i) return false;
+        }
+        return true;
+    }
+
+    constexpr bool defaultsInBounds() {
+        for (size_t i = 0; i < SIZE; ++i) {
+            if (!entries[i].defaultInBounds()) return false;
+        }
+        return true;
+    }
+
+    static_assert(SIZE == static_cast<size_t>(ConfigKey::SYSTEM_SIZE) + 1, "every ConfigKey needs a schema entry");
+    static_assert(isOrdered(), "schema entries must follow the ConfigKey order");
+    static_assert(defaultsInBounds(), "a default lies outside its bounds");
+}
+
+constexpr const ConfigInfo& configInfo(ConfigKey key) {
+    return ConfigSchema::entries[static_cast<size_t>(key)];
+}
+
+// Whether values of type T may be loaded from or stored to a setting of the given type.
+template<typename T>
+constexpr bool configAccepts(ConfigValueType type) {
+    switch (type) {
+        case ConfigValueType::INT: return std::is_same_v<T, int> || std::is_same_v<T, uint32_t>;
+        case ConfigValueType::FLOAT: return std::is_same_v<T, float>;
+        case ConfigValueType::BOOL: return std::is_same_v<T, bool>;
+        case ConfigValueType::INT_LIST: return std::is_same_v<T, std::vector<int>>;
+    }
+    return false;
+}
+
 #endif // CONFIG_TYPES_H
\ No newline at end of file
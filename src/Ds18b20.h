@@ -0,0 +1,81 @@
+#ifndef DS18B20_H
+#define DS18B20_H
+
+#include <OneWire.h>
+#include <cstdint>
+#include "SensorDriver.h"
+
+/**
+ * @class Ds18b20
+ * @brief DS18B20 1-Wire temperature driver for a single probe on its own pin.
+ *
+ * Addresses the probe with Skip ROM, so only one device may sit on the pin. begin() sets the
+ * resolution; at the default 10 bits a conversion takes 187.5 ms instead of 750 ms at 12 bits,
+ * still 0.25 °C steps. The scratchpad is CRC-checked before the temperature is used.
+ */
+class Ds18b20 : public SensorDriver<Ds18b20> {
+public:
+    // Call before begin().
+    void setPin(uint8_t dataPin) { pin = dataPin; }
+
+    // 9 to 12 bits, applied by begin().
+    void setResolution(uint8_t bits) {
+        resolution = bits < 9 ? 9 : (bits > 12 ? 12 : bits);
+    }
+
+    float getTemperature() const { return rawTemperature / 16.0f; }
+
+private:
+    friend class SensorDriver<Ds18b20>;
+
+    static constexpr uint8_t CMD_SKIP_ROM = 0xCC;
+    static constexpr uint8_t CMD_CONVERT_T = 0x44;
+    static constexpr uint8_t CMD_READ_SCRATCHPAD = 0xBE;
+    static constexpr uint8_t CMD_WRITE_SCRATCHPAD = 0x4E;
+    static constexpr uint32_t CONVERSION_12BIT_US = 750000;
+
+    OneWire oneWire;
+    uint8_t pin = 0xFF;
+    uint8_t resolution = 10;
+    int16_t rawTemperature = 0;
+
+    bool probe(I2CBus&) {
+        if (pin == 0xFF) return false;
+        oneWire.begin(pin);
+        if (!oneWire.reset()) return false;
+        oneWire.write(CMD_SKIP_ROM);
+        oneWire.write(CMD_WRITE_SCRATCHPAD);
+        oneWire.write(0x4B);                                        // TH, unused alarm
+        oneWire.write(0x46);                                        // TL, unused alarm
+        oneWire.write(static_cast<uint8_t>(((resolution - 9) << 5) | 0x1F));
+        return true;
+    }
+
+    bool startMeasurement() {
+        if (!oneWire.reset()) return false;
+        oneWire.write(CMD_SKIP_ROM);
+        oneWire.write(CMD_CONVERT_T);
+        waitUs(CONVERSION_12BIT_US >> (12 - resolution));
+        return true;
+    }
+
+    bool continueMeasurement() {
+        uint8_t scratchpad[9];
+        if (!oneWire.reset()) return fail();
+        oneWire.write(CMD_SKIP_ROM);
+        oneWire.write(CMD_READ_SCRATCHPAD);
+        oneWire.read_bytes(scratchpad, sizeof(scratchpad));
+        if (OneWire::crc8(scratchpad, 8) != scratchpad[8]) return fail();
+        // Undefined low bits below the configured resolution are masked off
+        const int16_t mask = static_cast<int16_t>(~((1 << (12 - resolution)) - 1));
+        rawTemperature = static_cast<int16_t>(scratchpad[0] | (scratchpad[1] << 8)) & mask;
+        return finish();
+    }
+
+    void fill(EnvironmentReading& out) const {
+        out.temperature = getTemperature();
+        out.validMask |= EnvironmentReading::TEMPERATURE;
+    }
+};
+
+#endif // DS18B20_H
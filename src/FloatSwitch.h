@@ -0,0 +1,117 @@
+#ifndef FLOAT_SWITCH_H
+#define FLOAT_SWITCH_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <functional>
+#include "esp_timer.h"
+#include "ESPLogger.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/**
+ * @class FloatSwitch
+ * @brief Interrupt-driven, debounced reservoir float switch.
+ *
+ * The pin is pulled up; HIGH means there is enough water. Every edge runs a short ISR that
+ * stamps the time and notifies a small task. The task commits the new level once the pin has
+ * been quiet for DEBOUNCE_MS and calls the level callback, so a reservoir running dry stops the
+ * pump within ~DEBOUNCE_MS instead of at the next sensor cycle or relay timeout.
+ *
+ * @note The ISR only touches atomics and the task notification; logging and the callback run
+ *       in the task. The callback stops the relays, which runs the relay event and web
+ *       notification callbacks, so the task gets the same stack as the other tasks.
+ */
+class FloatSwitch {
+public:
+    using LevelCallback = std::function<void(bool waterOk)>;
+
+    static constexpr uint32_t DEBOUNCE_MS = 50;
+    static constexpr uint32_t TASK_STACK_SIZE = 4096;
+
+    FloatSwitch() : logger(Logger::instance()) {}
+
+    // Configures the pin, latches its current level and attaches the interrupt.
+    void begin(int switchPin) {
+        pin = switchPin;
+        pinMode(pin, INPUT_PULLUP);
+        waterOk.store(digitalRead(pin) == HIGH);
+        attachInterruptArg(digitalPinToInterrupt(pin), onEdge, this, CHANGE);
+        logger.log("FloatSwitch", LogLevel::INFO, "Float switch on pin %d, water level %s", pin, waterOk.load() ? "OK" : "low");
+    }
+
+    void startTask() {
+        if (taskHandle == nullptr) {
+            xTaskCreate(taskFunction, "FloatSwitch", TASK_STACK_SIZE, this, 3, &taskHandle);
+        }
+    }
+
+    TaskHandle_t getTaskHandle() const {
+        return taskHandle;
+    }
+
+    // Set before begin(); called from the float switch task.
+    void setCallback(LevelCallback levelCallback) {
+        callback = std::move(levelCallback);
+    }
+
+    bool isWaterOk() const {
+        return waterOk.load();
+    }
+
+    uint32_t getEdgeCount() const {
+        return edges.load();
+    }
+
+    /**
+     * @brief Wait until the pin has been quiet for DEBOUNCE_MS, then commit its level.
+     *
+     * Run by the task after each notification. Public so host tests can drive it.
+     * @return true if the committed level changed
+     */
+    bool settle() {
+        do {
+            vTaskDelay(pdMS_TO_TICKS(DEBOUNCE_MS));
+        } while (static_cast<uint32_t>(esp_timer_get_time()) - lastEdgeUs.load() < DEBOUNCE_MS * 1000);
+
+        const bool ok = digitalRead(pin) == HIGH;
+        if (waterOk.exchange(ok) == ok) {
+            return false;
+        }
+        logger.log("FloatSwitch", ok ? LogLevel::INFO : LogLevel::WARNING, "Water level %s", ok ? "OK" : "low");
+        if (callback) {
+            callback(ok);
+        }
+        return true;
+    }
+
+private:
+    Logger& logger;
+    int pin = -1;
+    std::atomic<bool> waterOk{true};
+    std::atomic<uint32_t> lastEdgeUs{0};   // truncated to 32 bits, only differences are used
+    std::atomic<uint32_t> edges{0};
+    TaskHandle_t taskHandle = nullptr;
+    LevelCallback callback;
+
+    static void IRAM_ATTR onEdge(void* arg) {
+        FloatSwitch* self = static_cast<FloatSwitch*>(arg);
+        self->lastEdgeUs.store(static_cast<uint32_t>(esp_timer_get_time()));
+        self->edges.fetch_add(1);
+        if (self->taskHandle != nullptr) {
+            BaseType_t woken = pdFALSE;
+            vTaskNotifyGiveFromISR(self->taskHandle, &woken);
+            portYIELD_FROM_ISR(woken);
+        }
+    }
+
+    static void taskFunction(void* arg) {
+        FloatSwitch* self = static_cast<FloatSwitch*>(arg);
+        while (true) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            self->settle();
+        }
+    }
+};
+
+#endif // FLOAT_SWITCH_H
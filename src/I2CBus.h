@@ -0,0 +1,213 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <Wire.h>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "ESPLogger.h"
+
+/**
+ * @class I2CBus
+ * @brief Owns the shared I2C bus and runs every transaction on it, one at a time.
+ *
+ * Callers hand a transaction (a callable taking the TwoWire) to transact() and block until it
+ * has run. Pending transactions wait in a small priority queue served by the bus task: relay
+ * switching goes first, then sensor reads, then display refreshes, FIFO within a priority. Each transaction is accounted to
+ * its device address: count, errors (the callable returned false), bus time, and latency from
+ * queueing to completion.
+ *
+ * Until startTask() is called (during setup, and in host tests) the calling thread services the
+ * queue itself, so ordering and accounting are the same either way.
+ *
+ * @note Transactions must not call transact() themselves; they already own the bus.
+ */
+class I2CBus {
+public:
+    enum class Priority : uint8_t { ACTUATOR = 0, SENSOR = 1, DISPLAY = 2 };
+
+    static constexpr size_t QUEUE_LENGTH = 8;
+    static constexpr size_t MAX_DEVICES = 8;
+
+    struct DeviceStats {
+        uint8_t address = 0;
+        uint32_t transactions = 0;
+        uint32_t errors = 0;
+        uint32_t lastLatencyUs = 0;
+        uint32_t maxLatencyUs = 0;
+        uint64_t busTimeUs = 0;
+    };
+
+    explicit I2CBus(TwoWire& wire = Wire) : wire(wire), logger(Logger::instance()) {}
+
+    void begin(int sdaPin, int sclPin) {
+        wire.begin(sdaPin, sclPin);
+        logger.log("I2CBus", LogLevel::INFO, "I2C initialized on SDA: %d, SCL: %d", sdaPin, sclPin);
+    }
+
+    void startTask() {
+        if (taskHandle == nullptr) {
+            xTaskCreate(taskFunction, "I2CBus", 3072, this, 2, &taskHandle);
+        }
+    }
+
+    /**
+     * @brief Queue a transaction and wait for it to run.
+     *
+     * @param address Device the transaction talks to, used for the statistics
+     * @param work Callable `bool(TwoWire&)`, returning false on a bus or device error
+     * @return What work returned
+     */
+    template<typename Work>
+    bool transact(uint8_t address, Priority priority, Work&& work) {
+        using Callable = std::remove_reference_t<Work>;
+        return enqueueAndWait(address, priority, [](void* ctx, TwoWire& bus) {
+            return static_cast<bool>((*static_cast<Callable*>(ctx))(bus));
+        }, &work);
+    }
+
+    /**
+     * @brief Runs the most urgent queued transaction, if any.
+     *
+     * Run by the bus task. Public so host tests can drive it.
+     * @return false if the queue was empty
+     */
+    bool serviceOne() {
+        std::lock_guard<std::mutex> busLock(busMutex);
+        Request request;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (!pop(request)) return false;
+        }
+
+        const int64_t startUs = esp_timer_get_time();
+        const bool ok = request.call(request.ctx, wire);
+        const int64_t endUs = esp_timer_get_time();
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            record(request.address, ok, endUs - startUs, endUs - request.queuedUs);
+            *request.result = ok;
+            *request.done = true;
+        }
+        changed.notify_all();
+        return true;
+    }
+
+    size_t getQueueDepth() const {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        return queued;
+    }
+
+    // Copies the statistics of one device. Returns false if it never had a transaction.
+    bool getStats(uint8_t address, DeviceStats& out) const {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        for (size_t i = 0; i < deviceCount; ++i) {
+            if (devices[i].address == address) {
+                out = devices[i];
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    using Call = bool (*)(void*, TwoWire&);
+
+    struct Request {
+        uint8_t address = 0;
+        Priority priority = Priority::DISPLAY;
+        uint32_t sequence = 0;
+        int64_t queuedUs = 0;
+        Call call = nullptr;
+        void* ctx = nullptr;
+        bool* result = nullptr;
+        bool* done = nullptr;
+    };
+
+    TwoWire& wire;
+    Logger& logger;
+    TaskHandle_t taskHandle = nullptr;
+
+    mutable std::mutex queueMutex;      // guards the queue and the statistics
+    std::mutex busMutex;                // held while a transaction runs
+    std::condition_variable changed;    // a request was queued or completed
+    std::array<Request, QUEUE_LENGTH> queue;
+    size_t queued = 0;
+    uint32_t nextSequence = 0;
+    std::array<DeviceStats, MAX_DEVICES> devices;
+    size_t deviceCount = 0;
+
+    // Requests live on the caller's stack until done, so nothing here allocates.
+    bool enqueueAndWait(uint8_t address, Priority priority, Call call, void* ctx) {
+        bool result = false;
+        bool done = false;
+        std::unique_lock<std::mutex> lock(queueMutex);
+        changed.wait(lock, [this]() { return queued < QUEUE_LENGTH; });
+        queue[queued++] = Request{address, priority, nextSequence++, esp_timer_get_time(), call, ctx, &result, &done};
+        changed.notify_all();
+
+        while (!done) {
+            if (taskHandle == nullptr && queued > 0) {
+                lock.unlock();
+                serviceOne();
+                lock.lock();
+            } else {
+                changed.wait(lock);
+            }
+        }
+        return result;
+    }
+
+    // Removes the request with the best (priority, sequence). Caller holds queueMutex.
+    bool pop(Request& out) {
+        if (queued == 0) return false;
+        size_t best = 0;
+        for (size_t i = 1; i < queued; ++i) {
+            if (queue[i].priority < queue[best].priority ||
+                (queue[i].priority == queue[best].priority && queue[i].sequence < queue[best].sequence)) {
+                best = i;
+            }
+        }
+        out = queue[best];
+        queue[best] = queue[--queued];
+        changed.notify_all();   // a slot is free
+        return true;
+    }
+
+    // Caller holds queueMutex.
+    void record(uint8_t address, bool ok, int64_t busUs, int64_t latencyUs) {
+        DeviceStats* stats = nullptr;
+        for (size_t i = 0; i < deviceCount && stats == nullptr; ++i) {
+            if (devices[i].address == address) stats = &devices[i];
+        }
+        if (stats == nullptr) {
+            if (deviceCount == MAX_DEVICES) return;
+            stats = &devices[deviceCount++];
+            stats->address = address;
+        }
+        stats->transactions++;
+        if (!ok) stats->errors++;
+        stats->busTimeUs += static_cast<uint64_t>(busUs);
+        stats->lastLatencyUs = static_cast<uint32_t>(latencyUs);
+        if (stats->lastLatencyUs > stats->maxLatencyUs) stats->maxLatencyUs = stats->lastLatencyUs;
+    }
+
+    static void taskFunction(void* pvParameters) {
+        I2CBus* self = static_cast<I2CBus*>(pvParameters);
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(self->queueMutex);
+                self->changed.wait(lock, [self]() { return self->queued > 0; });
+            }
+            self->serviceOne();
+        }
+    }
+};
+
+#endif // I2C_BUS_H
@@ -0,0 +1,82 @@
+#ifndef IO_CHANNEL_H
+#define IO_CHANNEL_H
+
+#include <cstdint>
+
+/**
+ * @brief Decoding of the numbers stored in the sensorPin / relayPin configuration.
+ *
+ * Below 100 a number is a plain ESP32 GPIO, so existing configurations keep working. Higher
+ * numbers address a channel behind an expander, which lets one zone be wired without a
+ * dedicated ADC pin or relay GPIO:
+ *
+ *   sensor pin  100 + 16 * m + c  CD74HC4067 mux m (signal on muxSignalPins[m]), channel c
+ *               200 + 4 * n + c   ADS1115 at 0x48 + n, single-ended input AINc
+ *   relay pin   100 + 8 * n + b   PCF8574 at 0x20 + n, bit b
+ *               200 + 16 * n + b  MCP23017 at 0x20 + n, GPA0..7 then GPB0..7
+ *
+ * A PCF8574 and an MCP23017 cannot share an address, so pick distinct n for the two kinds.
+ */
+namespace IoChannel {
+    enum class Kind : uint8_t { NONE, GPIO, MUX, ADS1115, PCF8574, MCP23017 };
+
+    struct Channel {
+        Kind kind = Kind::NONE;
+        uint8_t device = 0;     // mux, ADC or expander number
+        uint8_t index = 0;      // channel or bit on that device
+        int pin = -1;           // GPIO number for Kind::GPIO
+    };
+
+    constexpr int EXPANDER_BASE = 100;
+    constexpr int SECOND_EXPANDER_BASE = 200;
+
+    constexpr int MUX_CHANNELS = 16;
+    constexpr int MAX_MUXES = 6;
+    constexpr int ADS1115_CHANNELS = 4;
+    constexpr int MAX_ADS1115 = 4;
+    constexpr uint8_t ADS1115_ADDRESS = 0x48;
+    constexpr int PCF8574_BITS = 8;
+    constexpr int MCP23017_BITS = 16;
+    constexpr int MAX_OUTPUT_EXPANDERS = 8;
+    constexpr uint8_t OUTPUT_EXPANDER_ADDRESS = 0x20;
+
+    constexpr int mux(int m, int channel) { return EXPANDER_BASE + MUX_CHANNELS * m + channel; }
+    constexpr int ads1115(int n, int channel) { return SECOND_EXPANDER_BASE + ADS1115_CHANNELS * n + channel; }
+    constexpr int pcf8574(int n, int bit) { return EXPANDER_BASE + PCF8574_BITS * n + bit; }
+    constexpr int mcp23017(int n, int bit) { return SECOND_EXPANDER_BASE + MCP23017_BITS * n + bit; }
+
+    // Kind::NONE for numbers outside the ranges above.
+    constexpr Channel decodeInput(int code) {
+        if (code >= 0 && code < EXPANDER_BASE) {
+            return {Kind::GPIO, 0, 0, code};
+        }
+        if (code >= EXPANDER_BASE && code < mux(MAX_MUXES, 0)) {
+            const int offset = code - EXPANDER_BASE;
+            return {Kind::MUX, static_cast<uint8_t>(offset / MUX_CHANNELS), static_cast<uint8_t>(offset % MUX_CHANNELS), -1};
+        }
+        if (code >= SECOND_EXPANDER_BASE && code < ads1115(MAX_ADS1115, 0)) {
+            const int offset = code - SECOND_EXPANDER_BASE;
+            return {Kind::ADS1115, static_cast<uint8_t>(offset / ADS1115_CHANNELS),
+                    static_cast<uint8_t>(offset % ADS1115_CHANNELS), -1};
+        }
+        return {};
+    }
+
+    constexpr Channel decodeOutput(int code) {
+        if (code >= 0 && code < EXPANDER_BASE) {
+            return {Kind::GPIO, 0, 0, code};
+        }
+        if (code >= EXPANDER_BASE && code < pcf8574(MAX_OUTPUT_EXPANDERS, 0)) {
+            const int offset = code - EXPANDER_BASE;
+            return {Kind::PCF8574, static_cast<uint8_t>(offset / PCF8574_BITS), static_cast<uint8_t>(offset % PCF8574_BITS), -1};
+        }
+        if (code >= SECOND_EXPANDER_BASE && code < mcp23017(MAX_OUTPUT_EXPANDERS, 0)) {
+            const int offset = code - SECOND_EXPANDER_BASE;
+            return {Kind::MCP23017, static_cast<uint8_t>(offset / MCP23017_BITS),
+                    static_cast<uint8_t>(offset % MCP23017_BITS), -1};
+        }
+        return {};
+    }
+}
+
+#endif // IO_CHANNEL_H
@@ -12,30 +12,38 @@ public:
                                       const RelayManager& relayManager, 
                                       const ConfigManager& configManager) {
         JsonDocument doc;
-        const SensorData& sensorData = sensorManager.getSensorData();
+        const SensorData sensorData = sensorManager.getSensorData();
 
         doc["temperature"] = sensorData.temperature;
         doc["pressure"] = sensorData.pressure;
+        if (!std::isnan(sensorData.humidity)) {
+            doc["humidity"] = sensorData.humidity;
+        }
         doc["waterLevel"] = sensorData.waterLevel;
 
         JsonArray plants = doc["plants"].to<JsonArray>();
         JsonArray relays = doc["relays"].to<JsonArray>();
 
+        // One read of the relay mask, so the relays listed are a consistent set
+        const uint32_t relayMask = relayManager.getRelayMask();
         int systemSize = configManager.getHwConfig().systemSize.value();
         for (size_t i = 0; i < systemSize; ++i) {
             const auto& config = configManager.getSensorConfig(i);
             
             JsonObject plant = plants.add<JsonObject>();
             plant["index"] = i;
-            plant["moisture"] = sensorData.moisture[i];
+            plant["moisture"] = sensorData.getMoisture(i);
+            plant["raw"] = sensorData.moistureRaw[i];
             plant["enabled"] = config.sensorEnabled.value();
 
             JsonObject relay = relays.add<JsonObject>();
             relay["index"] = i;
-            relay["active"] = relayManager.getRelayState(i);
+            const bool active = relayMask & (1u << i);
+            relay["active"] = active;
             relay["enabled"] = config.relayEnabled.value();
-            if (relay["active"]) {
+            if (active) {
                 relay["activationTime"] = config.activationPeriod.value();
+                relay["remainingTime"] = relayManager.getRemainingMs(i);
             }
         }
 
@@ -63,6 +71,23 @@ public:
         for (const auto& pin : hwConfig.relayPins) {
             relayPinsArray.add(pin);
         }
+
+        JsonArray muxSelectPinsArray = doc["muxSelectPins"].to<JsonArray>();
+        for (const auto& pin : hwConfig.muxSelectPins) {
+            muxSelectPinsArray.add(pin);
+        }
+
+        JsonArray muxSignalPinsArray = doc["muxSignalPins"].to<JsonArray>();
+        for (const auto& pin : hwConfig.muxSignalPins) {
+            muxSignalPinsArray.add(pin);
+        }
+
+        JsonArray relayCurrentsArray = doc["relayCurrents"].to<JsonArray>();
+        for (const auto& current : hwConfig.relayCurrents) {
+            relayCurrentsArray.add(current);
+        }
+        doc["powerBudget"] = hwConfig.powerBudget.value();
+        doc["inrushDelay"] = hwConfig.inrushDelay.value();
         return doc;
     }
 
@@ -76,6 +101,8 @@ public:
         doc["sensorUpdateInterval"] = swConfig.sensorUpdateInterval.value();
         doc["lcdUpdateInterval"] = swConfig.lcdUpdateInterval.value();
         doc["sensorPublishInterval"] = swConfig.sensorPublishInterval.value();
+        doc["moistureFilter"] = swConfig.moistureFilter.value();
+        doc["bmpOversampling"] = swConfig.bmpOversampling.value();
 
 
         JsonArray sensorConfigs = doc["sensorConfigs"].to<JsonArray>();
@@ -87,6 +114,11 @@ public:
             sensorObj["wateringInterval"] = config.wateringInterval.value();
             sensorObj["sensorEnabled"] = config.sensorEnabled.value();
             sensorObj["relayEnabled"] = config.relayEnabled.value();
+            sensorObj["dryValue"] = config.dryValue.value();
+            sensorObj["wetValue"] = config.wetValue.value();
+            sensorObj["autoTune"] = config.autoTune.value();
+            sensorObj["targetMoisture"] = config.targetMoisture.value();
+            sensorObj["wateringGain"] = config.wateringGain.value();
         }
         return doc;
     }
@@ -104,7 +136,8 @@ public:
     static bool updateConfig(ConfigManager& configManager, const JsonDocument& doc) {
         if (doc.containsKey("temperatureOffset") || doc.containsKey("telemetryInterval") ||
             doc.containsKey("sensorUpdateInterval") || doc.containsKey("lcdUpdateInterval") ||
-            doc.containsKey("sensorPublishInterval")) {
+            doc.containsKey("sensorPublishInterval") || doc.containsKey("moistureFilter") ||
+            doc.containsKey("bmpOversampling")) {
                 ConfigTypes::SoftwareConfig swConfig = configManager.getSwConfig();
                 updateSoftwareConfig(swConfig, doc);
                 configManager.setSoftwareConfig(swConfig);
@@ -136,6 +169,8 @@ private:
         if (doc.containsKey("sensorUpdateInterval")) config.sensorUpdateInterval = doc["sensorUpdateInterval"].as<uint32_t>();
         if (doc.containsKey("lcdUpdateInterval")) config.lcdUpdateInterval = doc["lcdUpdateInterval"].as<uint32_t>();
         if (doc.containsKey("sensorPublishInterval")) config.sensorPublishInterval = doc["sensorPublishInterval"].as<uint32_t>();
+        if (doc.containsKey("moistureFilter")) config.moistureFilter = doc["moistureFilter"].as<int>();
+        if (doc.containsKey("bmpOversampling")) config.bmpOversampling = doc["bmpOversampling"].as<int>();
     }
 
     static void updateSensorConfig(ConfigTypes::SensorConfig& config, const JsonDocument& jsonConfig) {
@@ -144,6 +179,10 @@ private:
         if (jsonConfig.containsKey("wateringInterval")) config.wateringInterval = jsonConfig["wateringInterval"].as<uint32_t>();
         if (jsonConfig.containsKey("sensorEnabled")) config.sensorEnabled = jsonConfig["sensorEnabled"].as<bool>();
         if (jsonConfig.containsKey("relayEnabled")) config.relayEnabled = jsonConfig["relayEnabled"].as<bool>();
+        if (jsonConfig.containsKey("dryValue")) config.dryValue = jsonConfig["dryValue"].as<int>();
+        if (jsonConfig.containsKey("wetValue")) config.wetValue = jsonConfig["wetValue"].as<int>();
+        if (jsonConfig.containsKey("autoTune")) config.autoTune = jsonConfig["autoTune"].as<bool>();
+        if (jsonConfig.containsKey("targetMoisture")) config.targetMoisture = jsonConfig["targetMoisture"].as<float>();
     }
 
     static void updateHardwareConfig(ConfigTypes::HardwareConfig& config, const JsonDocument& doc) {
@@ -151,6 +190,8 @@ private:
         if (doc.containsKey("sdaPin")) config.sdaPin = doc["sdaPin"].as<int>();
         if (doc.containsKey("sclPin")) config.sclPin = doc["sclPin"].as<int>();
         if (doc.containsKey("floatSwitchPin")) config.floatSwitchPin = doc["floatSwitchPin"].as<int>();
+        if (doc.containsKey("powerBudget")) config.powerBudget = doc["powerBudget"].as<int>();
+        if (doc.containsKey("inrushDelay")) config.inrushDelay = doc["inrushDelay"].as<int>();
         if (doc.containsKey("relayPins") && doc["relayPins"].is<JsonArrayConst>()) {
             config.relayPins.clear();
             for (JsonVariantConst v : doc["relayPins"].as<JsonArrayConst>()) {
@@ -163,6 +204,24 @@ private:
                 config.moistureSensorPins.push_back(v.as<int>());
             }
         }
+        if (doc.containsKey("muxSelectPins") && doc["muxSelectPins"].is<JsonArrayConst>()) {
+            config.muxSelectPins.clear();
+            for (JsonVariantConst v : doc["muxSelectPins"].as<JsonArrayConst>()) {
+                config.muxSelectPins.push_back(v.as<int>());
+            }
+        }
+        if (doc.containsKey("muxSignalPins") && doc["muxSignalPins"].is<JsonArrayConst>()) {
+            config.muxSignalPins.clear();
+            for (JsonVariantConst v : doc["muxSignalPins"].as<JsonArrayConst>()) {
+                config.muxSignalPins.push_back(v.as<int>());
+            }
+        }
+        if (doc.containsKey("relayCurrents") && doc["relayCurrents"].is<JsonArrayConst>()) {
+            config.relayCurrents.clear();
+            for (JsonVariantConst v : doc["relayCurrents"].as<JsonArrayConst>()) {
+                config.relayCurrents.push_back(v.as<int>());
+            }
+        }
     }
 };
 
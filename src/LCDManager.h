@@ -2,19 +2,35 @@
 #define LCD_MANAGER_H
 
 #include <LiquidCrystal_I2C.h>
+#include <cstdio>
+#include <cstring>
+#include "I2CBus.h"
 #include "SensorManager.h"
 #include "ConfigManager.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "ESPLogger.h"
 
+/**
+ * Pages are rendered into a RAM frame first. Only lines that differ from what is on the display
+ * are written, each as a single DISPLAY-priority transaction on the I2C bus, so a refresh never
+ * holds the bus for more than one line and sensor reads can go in between.
+ */
 class LCDManager {
 private:
+    static constexpr int COLUMNS = 16;
+    static constexpr int ROWS = 2;
+    using Line = char[COLUMNS + 1];
+
     LiquidCrystal_I2C& lcd;
     SensorManager& sensorManager;
     ConfigManager& configManager;
+    I2CBus& bus;
+    uint8_t lcdAddress;
     TaskHandle_t taskHandle;
     int currentDisplay;
+    Line frame[ROWS] = {};
+    Line shown[ROWS] = {};
     static constexpr uint32_t STARTUP_DELAY_MS = 5000; // 5 second delay
 
     static void taskFunction(void* pvParameters) {
@@ -36,59 +52,92 @@ private:
 
     void updateDisplay() {
         SensorData data = sensorManager.getSensorData();
-        lcd.clear();
 
         switch (currentDisplay) {
             case 0:
-                lcd.setCursor(0, 0);
-                lcd.print("Temp: " + String(data.temperature, 1) + "C");
-                lcd.setCursor(0, 1);
-                lcd.print("Press: " + String(data.pressure, 1) + "hPa");
+                setLine(0, "Temp: %.1fC", data.temperature);
+                setLine(1, "Press: %.1fhPa", data.pressure);
                 break;
             case 1:
-                displayMoistureData(0, 1);
+                displayMoistureData(data, 0, 1);
                 break;
             case 2:
-                displayMoistureData(2, 3);
+                displayMoistureData(data, 2, 3);
                 break;
         }
+        flushFrame();
 
         currentDisplay = (currentDisplay + 1) % 3;
     }
 
-    void displayMoistureData(int sensor1, int sensor2) {
-        lcd.setCursor(0, 0);
-        lcd.print("Moist" + String(sensor1 + 1) + ": " + getMoistureDisplay(sensor1));
-        lcd.setCursor(0, 1);
-        lcd.print("Moist" + String(sensor2 + 1) + ": " + getMoistureDisplay(sensor2));
+    void displayMoistureData(const SensorData& data, int sensor1, int sensor2) {
+        char value[12];
+        setLine(0, "Moist%d: %s", sensor1 + 1, getMoistureDisplay(data, sensor1, value, sizeof(value)));
+        setLine(1, "Moist%d: %s", sensor2 + 1, getMoistureDisplay(data, sensor2, value, sizeof(value)));
     }
 
-    String getMoistureDisplay(int sensorIndex) {
-        const auto& sensorConfig = configManager.getSensorConfig(sensorIndex);
+    const char* getMoistureDisplay(const SensorData& data, int sensorIndex, char* buffer, size_t size) {
         const auto& hwConfig = configManager.getHwConfig();
-    
+        if (sensorIndex >= hwConfig.systemSize.value()) {
+            return "N/A";
+        }
+
+        const auto& sensorConfig = configManager.getSensorConfig(sensorIndex);
         if (sensorConfig.sensorEnabled) {
-            const auto& moistureData = sensorManager.getSensorData().moisture;
-            if ( sensorIndex < moistureData.size() ) {
-                return String(moistureData[sensorIndex], 1) + "%";
-            } else {
-                return "N/A";
+            if (data.isValid(sensorIndex)) {
+                snprintf(buffer, size, "%.1f%%", data.getMoisture(sensorIndex));
+                return buffer;
             }
+            return "N/A";
         } else {
             return "Disabled";
         }
     }
 
+    // Formats one row of the frame, padded with spaces so it overwrites the previous page.
+    template<typename... Args>
+    void setLine(int row, const char* format, Args... args) {
+        char text[COLUMNS + 1];
+        snprintf(text, sizeof(text), format, args...);
+        snprintf(frame[row], sizeof(frame[row]), "%-16s", text);
+    }
+
+    void flushFrame() {
+        for (int row = 0; row < ROWS; ++row) {
+            if (strcmp(frame[row], shown[row]) == 0) continue;
+            const bool ok = bus.transact(lcdAddress, I2CBus::Priority::DISPLAY, [this, row](TwoWire& wire) {
+                lcd.setCursor(0, row);
+                lcd.print(frame[row]);
+                return probe(wire);
+            });
+            // On a failed write the line is retried on the next refresh
+            if (ok) {
+                memcpy(shown[row], frame[row], sizeof(shown[row]));
+            } else {
+                shown[row][0] = '\0';
+            }
+        }
+    }
+
+    // LiquidCrystal_I2C reports no errors, so an address-only write checks the display still answers.
+    bool probe(TwoWire& wire) {
+        wire.beginTransmission(lcdAddress);
+        return wire.endTransmission() == 0;
+    }
+
 public:
-    LCDManager(LiquidCrystal_I2C& lcd, SensorManager& sm, ConfigManager& cm)
-        : lcd(lcd), sensorManager(sm), configManager(cm), taskHandle(NULL), currentDisplay(0) {}
+    LCDManager(LiquidCrystal_I2C& lcd, uint8_t lcdAddress, SensorManager& sm, ConfigManager& cm, I2CBus& bus)
+        : lcd(lcd), sensorManager(sm), configManager(cm), bus(bus), lcdAddress(lcdAddress), taskHandle(NULL), currentDisplay(0) {}
 
     void start() {
-        lcd.init();
-        lcd.backlight();
-        lcd.clear();
-        lcd.setCursor(0, 0);
-        lcd.print("Initializing...");
+        bus.transact(lcdAddress, I2CBus::Priority::DISPLAY, [this](TwoWire& wire) {
+            lcd.init();
+            lcd.backlight();
+            lcd.clear();
+            lcd.setCursor(0, 0);
+            lcd.print("Initializing...");
+            return probe(wire);
+        });
         xTaskCreate(
             taskFunction,
             "LCDUpdateTask",
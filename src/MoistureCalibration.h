@@ -0,0 +1,49 @@
+#ifndef MOISTURE_CALIBRATION_H
+#define MOISTURE_CALIBRATION_H
+
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * @class MoistureCalibration
+ * @brief Two-point calibration of one moisture probe, converted in fixed point.
+ *
+ * dryRaw (probe in air) reads as 0 % and wetRaw (probe in water) as 100 %. The slope is
+ * precomputed in Q16 tenths of a percent per ADC count, so a conversion is one multiply and
+ * a shift with no float or division on the sampling path. Readings beyond the calibrated span
+ * saturate at 0 % / 100 %. Works for probes whose reading rises with moisture too (wetRaw > dryRaw).
+ */
+class MoistureCalibration {
+public:
+    static constexpr int32_t ADC_MAX = 4095;
+    static constexpr int32_t FULL_SCALE_TENTHS = 1000;
+
+    MoistureCalibration() { set(2592, 975); }
+
+    // Returns false and keeps the previous calibration if the points are out of range or equal.
+    bool set(int32_t dryRaw, int32_t wetRaw) {
+        if (dryRaw == wetRaw || dryRaw < 0 || wetRaw < 0 || dryRaw > ADC_MAX || wetRaw > ADC_MAX) {
+            return false;
+        }
+        dry = dryRaw;
+        wet = wetRaw;
+        scaleQ16 = (static_cast<int64_t>(FULL_SCALE_TENTHS) << 16) / (dry - wet);
+        return true;
+    }
+
+    bool matches(int32_t dryRaw, int32_t wetRaw) const {
+        return dry == dryRaw && wet == wetRaw;
+    }
+
+    int16_t toTenths(int32_t raw) const {
+        const int64_t tenths = (static_cast<int64_t>(dry - raw) * scaleQ16 + (1 << 15)) >> 16;
+        return static_cast<int16_t>(std::clamp<int64_t>(tenths, 0, FULL_SCALE_TENTHS));
+    }
+
+private:
+    int32_t dry = 0;
+    int32_t wet = 0;
+    int64_t scaleQ16 = 0;
+};
+
+#endif // MOISTURE_CALIBRATION_H
@@ -0,0 +1,114 @@
+#ifndef MOISTURE_FILTER_H
+#define MOISTURE_FILTER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @class MoistureFilter
+ * @brief Streaming filter for one moisture channel, fed once per sensor update.
+ *
+ * Works on moisture in tenths of a percent and keeps a few scalars per channel:
+ * - MEDIAN: median of the last three readings; a single spike never reaches the output.
+ * - EMA:    exponential moving average, readings further than GATE_TENTHS from it are rejected.
+ * - KALMAN: 1-D random-walk Kalman filter, readings whose innovation exceeds 3 sigma are rejected.
+ *
+ * A rejected reading is not lost for good: after MAX_REJECTS consecutive rejections the filter
+ * accepts that a real step happened (e.g. right after watering) and restarts from the reading.
+ */
+class MoistureFilter {
+public:
+    enum class Mode : uint8_t { NONE = 0, MEDIAN = 1, EMA = 2, KALMAN = 3 };
+
+    static constexpr float EMA_ALPHA = 0.3f;
+    static constexpr float GATE_TENTHS = 150.0f;     // 15 %
+    static constexpr float KALMAN_Q = 4.0f;          // process variance per update, tenths^2
+    static constexpr float KALMAN_R = 100.0f;        // measurement variance, tenths^2 (1 % sigma)
+    static constexpr float KALMAN_GATE_SIGMA2 = 9.0f;
+    static constexpr uint8_t MAX_REJECTS = 3;
+
+    void setMode(Mode newMode) {
+        if (newMode != mode) {
+            mode = newMode;
+            reset();
+        }
+    }
+
+    Mode getMode() const { return mode; }
+
+    void reset() {
+        count = 0;
+        rejects = 0;
+    }
+
+    // Consecutive readings rejected as outliers so far.
+    uint8_t getRejects() const { return rejects; }
+
+    int16_t update(int16_t tenths) {
+        const float x = tenths;
+        switch (mode) {
+            case Mode::NONE:
+                return tenths;
+
+            case Mode::MEDIAN:
+                history[count % 3] = x;
+                count++;
+                if (count < 3) return tenths;
+                return toTenths(std::max(std::min(history[0], history[1]),
+                                         std::min(std::max(history[0], history[1]), history[2])));
+
+            case Mode::EMA:
+                if (count == 0 || isStep(std::fabs(x - estimate) > GATE_TENTHS)) {
+                    restart(x);
+                } else if (rejects == 0) {
+                    estimate += EMA_ALPHA * (x - estimate);
+                }
+                return toTenths(estimate);
+
+            case Mode::KALMAN: {
+                const float predicted = variance + KALMAN_Q;
+                const float innovation = x - estimate;
+                if (count == 0 || isStep(innovation * innovation > KALMAN_GATE_SIGMA2 * (predicted + KALMAN_R))) {
+                    restart(x);
+                } else if (rejects == 0) {
+                    const float gain = predicted / (predicted + KALMAN_R);
+                    estimate += gain * innovation;
+                    variance = (1.0f - gain) * predicted;
+                }
+                return toTenths(estimate);
+            }
+        }
+        return tenths;
+    }
+
+private:
+    Mode mode = Mode::NONE;
+    uint32_t count = 0;
+    uint8_t rejects = 0;
+    float estimate = 0.0f;
+    float variance = 0.0f;
+    float history[3] = {0.0f, 0.0f, 0.0f};
+
+    // Tracks consecutive outliers. Returns true once they persist long enough to be a real step.
+    bool isStep(bool outlier) {
+        if (!outlier) {
+            rejects = 0;
+            return false;
+        }
+        return ++rejects >= MAX_REJECTS;
+    }
+
+    void restart(float x) {
+        estimate = x;
+        variance = KALMAN_R;
+        count = 1;
+        rejects = 0;
+    }
+
+    static int16_t toTenths(float value) {
+        return static_cast<int16_t>(lroundf(value));
+    }
+};
+
+#endif // MOISTURE_FILTER_H
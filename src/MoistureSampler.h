@@ -0,0 +1,199 @@
+#ifndef MOISTURE_SAMPLER_H
+#define MOISTURE_SAMPLER_H
+
+#include <Arduino.h>
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "ScanPlanner.h"
+#include "SensorDriver.h"
+
+/**
+ * @class MoistureSampler
+ * @brief Oversamples all enabled analog capacitive moisture channels in one interleaved scan.
+ *
+ * Each sampling round reads every enabled channel back to back, then waits once for the
+ * sample period. A full scan therefore costs (SAMPLES - 1) * SAMPLE_PERIOD_MS whatever the
+ * number of channels, instead of SAMPLES * SAMPLE_PERIOD_MS per channel.
+ *
+ * The lowest and highest sample of each channel are dropped before averaging, so a single ADC
+ * spike does not skew the scan. Noise across scans is handled by MoistureFilter, which is why
+ * six samples are enough here.
+ *
+ * Channels may sit behind CD74HC4067 muxes or ADS1115 ADCs (see IoChannel). A ScanPlanner
+ * batches the mux switches and ADS1115 conversions of each round; rounds start every
+ * SAMPLE_PERIOD_MS, so the conversion waits come out of the sample period, not on top of it.
+ *
+ * As a SensorDriver the rounds run from poll(), so other drivers convert in between; scan()
+ * runs the same rounds blocking.
+ *
+ * @note The sampler owns its accumulation buffers and takes no locks; callers publish the
+ *       averaged result themselves once the scan is complete.
+ */
+class MoistureSampler : public SensorDriver<MoistureSampler> {
+public:
+    static constexpr int SAMPLES = 6;
+    static constexpr uint32_t SAMPLE_PERIOD_MS = 10;
+    static_assert(SAMPLES > 2, "the lowest and highest sample are trimmed");
+
+    using SensorDriver<MoistureSampler>::begin;
+
+    // The ADC is always there; lets the sampler run before the I2C bus is set up.
+    bool begin() {
+        return setPresent(true);
+    }
+
+    // Wiring of the CD74HC4067 muxes, copied. Takes effect with the next scan.
+    void setMuxPins(const std::vector<int>& selectPins, const std::vector<int>& signalPins) {
+        planner.setMuxPins(selectPins, signalPins);
+    }
+
+    /**
+     * @brief Select the channels for the next measurements.
+     *
+     * @param pins Sensor pin code per channel, see IoChannel
+     * @param enabled Whether each channel should be sampled, same length as pins
+     * @note Both vectors are referenced, not copied, and must outlive the measurement.
+     */
+    void configure(const std::vector<int>& pins, const std::vector<bool>& enabled) {
+        channelPins = &pins;
+        channelEnabled = &enabled;
+    }
+
+    // Rounded, trimmed raw ADC average per channel from the last scan; disabled channels, and
+    // channels with fewer than three samples (failed ADS1115 reads), are left untouched.
+    const std::vector<uint16_t>& getAverages() const { return averages; }
+
+    // One bit per channel whose average the last scan updated; the others hold stale values.
+    uint32_t getSampledMask() const { return sampledMask; }
+
+    // Called with every raw sample as it is read, e.g. to capture a sensor trace; nullptr to stop.
+    using SampleTap = void (*)(void* context, size_t channel, uint16_t value);
+    void setSampleTap(SampleTap tap, void* context) {
+        sampleTap = tap;
+        sampleTapContext = context;
+    }
+
+    // Batching statistics of the last sampling round.
+    const ScanPlanner::Stats& getRoundStats() const { return planner.getStats(); }
+
+    /**
+     * @brief Run one interleaved scan, blocking.
+     *
+     * @param pins Sensor pin code per channel, see IoChannel
+     * @param enabled Whether each channel should be sampled, same length as pins
+     * @param out Receives the averages, see getAverages()
+     */
+    void scan(const std::vector<int>& pins, const std::vector<bool>& enabled, std::vector<uint16_t>& out) {
+        configure(pins, enabled);
+        beginScan();
+        uint32_t waitUs = 0;
+        while (!advance(waitUs)) {
+            vTaskDelay(pdMS_TO_TICKS((waitUs + 999) / 1000));
+        }
+        out = averages;
+    }
+
+private:
+    friend class SensorDriver<MoistureSampler>;
+
+    const std::vector<int>* channelPins = nullptr;
+    const std::vector<bool>* channelEnabled = nullptr;
+    I2CBus* bus = nullptr;
+    ScanPlanner planner;
+    SampleTap sampleTap = nullptr;
+    void* sampleTapContext = nullptr;
+    int round = 0;
+    bool roundStarting = false;
+    int64_t roundStartUs = 0;
+    std::vector<uint32_t> sums;
+    std::vector<uint8_t> counts;
+    std::vector<uint16_t> lowest;
+    std::vector<uint16_t> highest;
+    std::vector<uint16_t> averages;
+    uint32_t sampledMask = 0;
+
+    // Keeps the bus for the ADS1115 channels; the sampler itself is always present.
+    bool probe(I2CBus& i2cBus) {
+        bus = &i2cBus;
+        return true;
+    }
+
+    bool startMeasurement() {
+        if (channelPins == nullptr) return false;
+        beginScan();
+        uint32_t wait = 0;
+        advance(wait);
+        waitUs(wait);
+        return true;
+    }
+
+    bool continueMeasurement() {
+        uint32_t wait = 0;
+        if (!advance(wait)) {
+            waitUs(wait);
+            return false;
+        }
+        return finish();
+    }
+
+    void fill(EnvironmentReading&) const {}
+
+    // Resets the accumulators and plans the rounds.
+    void beginScan() {
+        const size_t channels = channelPins->size();
+        sums.assign(channels, 0);
+        counts.assign(channels, 0);
+        lowest.assign(channels, UINT16_MAX);
+        highest.assign(channels, 0);
+        averages.resize(channels);
+        sampledMask = 0;
+        planner.plan(*channelPins, *channelEnabled);
+        planner.beginRound();
+        roundStarting = true;
+        round = 0;
+    }
+
+    /**
+     * @brief Runs the next step of the scan.
+     *
+     * @param wait Set to the time before the next step is due
+     * @return true after the last round, with averages updated
+     */
+    bool advance(uint32_t& wait) {
+        if (roundStarting) {
+            roundStartUs = esp_timer_get_time();
+            roundStarting = false;
+        }
+        const bool roundDone = planner.runStep(bus, [this](size_t ch, uint16_t value) {
+            if (sampleTap) sampleTap(sampleTapContext, ch, value);
+            sums[ch] += value;
+            counts[ch]++;
+            lowest[ch] = std::min(lowest[ch], value);
+            highest[ch] = std::max(highest[ch], value);
+        }, wait);
+        if (!roundDone) return false;
+
+        if (++round < SAMPLES) {
+            const int64_t remaining = roundStartUs + SAMPLE_PERIOD_MS * 1000 - esp_timer_get_time();
+            wait = remaining > 0 ? static_cast<uint32_t>(remaining) : 0;
+            planner.beginRound();
+            roundStarting = true;
+            return false;
+        }
+
+        const std::vector<bool>& enabled = *channelEnabled;
+        for (size_t ch = 0; ch < channelPins->size(); ++ch) {
+            if (enabled[ch] && counts[ch] > 2) {
+                const uint32_t kept = counts[ch] - 2;
+                averages[ch] = static_cast<uint16_t>((sums[ch] - lowest[ch] - highest[ch] + kept / 2) / kept);
+                if (ch < 32) sampledMask |= 1u << ch;
+            }
+        }
+        return true;
+    }
+};
+
+#endif // MOISTURE_SAMPLER_H
@@ -23,23 +23,61 @@ public:
         preferences = prefs;
     }
 
+    // NVS key of a setting, built in place: NVS keys are at most 15 characters.
+    struct PrefKey {
+        char text[16];
+        const char* c_str() const { return text; }
+    };
+
+    static constexpr const char* SIZE_SUFFIX = "_size";
+
     /**
      * @brief Get the preference key for a given ConfigKey
      * 
      * @param key The ConfigKey to get the preference key for
      * @param sensorIndex The index of the sensor (default is 0)
-     * @return std::string The preference key
+     * @param suffix Appended to the key, e.g. SIZE_SUFFIX for the length of a stored vector
+     * @return PrefKey The preference key, on the stack
      * 
      * @note This method handles the complexity of generating unique keys for per-sensor
      * configurations. It appends the sensor index to the preference key if the configuration
-     * is sensor-specific.
+     * is sensor-specific. No heap is involved, so loading and saving settings never allocates
+     * for the key.
      */
-    std::string getPrefKey(ConfigKey key, size_t sensorIndex = 0) const {
-        const auto& info = configMap.at(key);
-        if (info.confType == "sensorConf") {
-            return info.prefKey + std::to_string(sensorIndex);
-        }      
-        return info.prefKey;    
+    static PrefKey getPrefKey(ConfigKey key, size_t sensorIndex = 0, const char* suffix = "") {
+        const ConfigInfo& info = configInfo(key);
+        PrefKey out;
+        size_t len = append(out, 0, info.prefKey);
+        if (info.confType == ConfigScope::SENSOR) {
+            char digits[10];
+            size_t count = 0;
+            do {
+                digits[count++] = static_cast<char>('0' + sensorIndex % 10);
+                sensorIndex /= 10;
+            } while (sensorIndex > 0 && count < sizeof(digits));
+            while (count > 0 && len < sizeof(out.text) - 1) {
+                out.text[len++] = digits[--count];
+            }
+        }
+        len = append(out, len, suffix);
+        out.text[len] = '\0';
+        return out;
+    }
+
+    // Whether every key fits NVS with the longest zone index and the size suffix appended.
+    static constexpr bool keysFitNvs() {
+        const auto length = [](const char* text) {
+            size_t len = 0;
+            while (text[len] != '\0') ++len;
+            return len;
+        };
+        size_t indexDigits = 1;
+        for (size_t last = ConfigConstants::MAX_SYSTEM_SIZE - 1; last >= 10; last /= 10) ++indexDigits;
+        for (const ConfigInfo& info : ConfigSchema::entries) {
+            const size_t digits = info.confType == ConfigScope::SENSOR ? indexDigits : 0;
+            if (length(info.prefKey) + digits + length(SIZE_SUFFIX) > sizeof(PrefKey::text) - 1) return false;
+        }
+        return true;
     }
 
     /**
@@ -66,12 +104,15 @@ public:
 
         Logger::instance().log("PreferencesHandler", LogLevel::DEBUG, "Attempting to save key: %d, sensorIndex: %d", static_cast<int>(key), sensorIndex);
         
-        std::string prefKey = getPrefKey(key, sensorIndex);
+        const PrefKey prefKey = getPrefKey(key, sensorIndex);
         Logger::instance().log("PreferencesHandler", LogLevel::DEBUG, "Generated preference key: %s", prefKey.c_str());
 
         bool result = false;
         if constexpr (std::is_same_v<T, int>) {
             result = preferences->putInt(prefKey.c_str(), value);
+        } else if constexpr (std::is_same_v<T, uint32_t>) {
+            // Stored like the int defaults in ConfigSchema::entries, so loading finds the same NVS type
+            result = preferences->putInt(prefKey.c_str(), static_cast<int32_t>(value));
         } else if constexpr (std::is_same_v<T, float>) {
             result = preferences->putFloat(prefKey.c_str(), value);
         } else if constexpr (std::is_same_v<T, bool>) {
@@ -110,7 +151,7 @@ public:
             // Store the actual vector data
         bool bytesSuccess = preferences->putBytes(getPrefKey(key, sensorIndex).c_str(), value.data(), value.size() * sizeof(T));
             // Store the number of elements in the vector
-        bool sizeSuccess = preferences->putUInt((getPrefKey(key, sensorIndex) + "_size").c_str(), value.size());
+        bool sizeSuccess = preferences->putUInt(getPrefKey(key, sensorIndex, SIZE_SUFFIX).c_str(), value.size());
         return bytesSuccess && sizeSuccess;
     }
 
@@ -137,7 +178,7 @@ public:
             }
         }
         bool bytesSuccess = preferences->putBytes(getPrefKey(key, sensorIndex).c_str(), buffer.data(), buffer.size());
-        bool sizeSuccess = preferences->putUInt((getPrefKey(key, sensorIndex) + "_size").c_str(), value.size());
+        bool sizeSuccess = preferences->putUInt(getPrefKey(key, sensorIndex, SIZE_SUFFIX).c_str(), value.size());
         return bytesSuccess && sizeSuccess;
     }
 
@@ -159,7 +200,7 @@ public:
      */
     template<typename T>
     T loadFromPreferences(ConfigKey key, const T& defaultValue, size_t sensorIndex) {
-        if constexpr (std::is_same_v<T, int> || std::is_same_v<T, unsigned int>) {
+        if constexpr (std::is_same_v<T, int> || std::is_same_v<T, unsigned int> || std::is_same_v<T, uint32_t>) {
             return preferences->getInt(getPrefKey(key, sensorIndex).c_str(), defaultValue);
         } else if constexpr (std::is_same_v<T, float>) {
             return preferences->getFloat(getPrefKey(key, sensorIndex).c_str(), defaultValue);
@@ -195,7 +236,7 @@ public:
     template<typename T>
     std::vector<T> loadVectorFromPreferences(ConfigKey key, const std::vector<T>& defaultValue, size_t sensorIndex) {
         std::vector<T> vec;
-        size_t size = preferences->getUInt((getPrefKey(key, sensorIndex) + "_size").c_str(), 0);
+        size_t size = preferences->getUInt(getPrefKey(key, sensorIndex, SIZE_SUFFIX).c_str(), 0);
         if (size > 0) {
             vec.resize(size);
             preferences->getBytes(getPrefKey(key, sensorIndex).c_str(), vec.data(), size * sizeof(T));
@@ -228,7 +269,7 @@ public:
         *   @warning getPrefkey+size gives the wrong key value
         *            for sure size should be a single key, and we should grab the pref keys accordingly.
         */          
-        size_t size = preferences->getBytes((getPrefKey(key, sensorIndex) + "_size").c_str(), nullptr, 0);
+        size_t size = preferences->getBytes(getPrefKey(key, sensorIndex, SIZE_SUFFIX).c_str(), nullptr, 0);
         if (size > 0) {
             std::vector<uint8_t> rawData(size);
             preferences->getBytes(getPrefKey(key, sensorIndex).c_str(), rawData.data(), size);
@@ -246,7 +287,7 @@ public:
 
     void removeFromPreferences(ConfigKey key, size_t sensorIndex) {
         preferences->remove(getPrefKey(key, sensorIndex).c_str());
-        preferences->remove((getPrefKey(key, sensorIndex) + "_size").c_str());
+        preferences->remove(getPrefKey(key, sensorIndex, SIZE_SUFFIX).c_str());
     }
 
     bool checkNVSSpace() {
@@ -265,5 +306,16 @@ public:
 private:
     Logger& logger;
     Preferences* preferences;
+
+    // Copies as much of `text` as fits behind `len` characters, returns the new length.
+    static size_t append(PrefKey& key, size_t len, const char* text) {
+        while (*text != '\0' && len < sizeof(key.text) - 1) {
+            key.text[len++] = *text++;
+        }
+        return len;
+    }
 };
+
+static_assert(PreferencesHandler::keysFitNvs(), "a preference key is longer than the 15 characters NVS allows");
+
 #endif // PREFERENCES_HANDLER_H
\ No newline at end of file
@@ -46,46 +46,13 @@ private:
 
     void publishSensorData() {
         while (true) {
-            SensorData data = sensorManager.getSensorData();
-            JsonDocument doc;
-            
-            const auto& hwConf = configManager.getHwConfig();
-            for (size_t i = 0; i < hwConf.systemSize.value(); i++) {
-                const auto& config = configManager.getSensorConfig(i);
-                if (config.sensorEnabled) {
-                    doc["moisture_" + String(i)] = data.moisture[i];
-                }
-            }
-            doc["temperature"] = data.temperature;
-            doc["pressure"] = data.pressure;
-            doc["waterLevel"] = data.waterLevel;
-
-            String payload;
-            serializeJson(doc, payload);
-            
-            if (mqttManager.publish("esp32/sensor_data", payload.c_str())) {
-                logger.log("PublishManager", Logger::Level::INFO, "Published sensor data successfully");
-            } else {
-                logger.log("PublishManager", Logger::Level::ERROR, "Failed to publish sensor data");
-            }
-
-            const auto& softwareConfig = configManager.getSwConfig();
-            uint32_t publishInterval = softwareConfig.sensorPublishInterval.value();
-            vTaskDelay(pdMS_TO_TICKS(publishInterval));
+            vTaskDelay(pdMS_TO_TICKS(publishSensorDataOnce()));
         }
     }
 
     void publishTelemetryData() {
         while (true) {
-            if (telemetry.publishTelemetry()) {
-                logger.log("PublishManager", Logger::Level::INFO, "Published telemetry data successfully");
-            } else {
-                logger.log("PublishManager", Logger::Level::ERROR, "Failed to publish telemetry data");
-            }
-
-            const auto& softwareConfig = configManager.getSwConfig();
-            uint32_t telemetryInterval = softwareConfig.telemetryInterval.value();
-            vTaskDelay(pdMS_TO_TICKS(telemetryInterval));
+            vTaskDelay(pdMS_TO_TICKS(publishTelemetryOnce()));
         }
     }
 
@@ -129,6 +96,49 @@ public:
         }
     }
 
+    /**
+     * @brief Publish the current sensor data once. The sensor publish task calls this in a loop;
+     *        host tests and the simulator call it directly.
+     *
+     * @return Milliseconds until the next publish
+     */
+    uint32_t publishSensorDataOnce() {
+        SensorData data = sensorManager.getSensorData();
+        JsonDocument doc;
+
+        const auto& hwConf = configManager.getHwConfig();
+        for (size_t i = 0; i < hwConf.systemSize.value(); i++) {
+            if (data.isValid(i)) {
+                char key[16];
+                snprintf(key, sizeof(key), "moisture_%u", static_cast<unsigned>(i));
+                doc[key] = data.getMoisture(i);
+            }
+        }
+        doc["temperature"] = data.temperature;
+        doc["pressure"] = data.pressure;
+        doc["waterLevel"] = data.waterLevel;
+
+        String payload;
+        serializeJson(doc, payload);
+
+        if (mqttManager.publish("esp32/sensor_data", payload.c_str())) {
+            logger.log("PublishManager", Logger::Level::INFO, "Published sensor data successfully");
+        } else {
+            logger.log("PublishManager", Logger::Level::ERROR, "Failed to publish sensor data");
+        }
+        return configManager.getSwConfig().sensorPublishInterval.value();
+    }
+
+    // As publishSensorDataOnce(), for telemetry.
+    uint32_t publishTelemetryOnce() {
+        if (telemetry.publishTelemetry()) {
+            logger.log("PublishManager", Logger::Level::INFO, "Published telemetry data successfully");
+        } else {
+            logger.log("PublishManager", Logger::Level::ERROR, "Failed to publish telemetry data");
+        }
+        return configManager.getSwConfig().telemetryInterval.value();
+    }
+
     ESPTelemetry& getTelemetry() {
         return telemetry;
     }
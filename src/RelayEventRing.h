@@ -0,0 +1,114 @@
+#ifndef RELAY_EVENT_RING_H
+#define RELAY_EVENT_RING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief One relay switch: a timestamp word and a word packing relay, state and cause.
+ */
+struct RelayEvent {
+    enum class Cause : uint8_t {
+        MANUAL = 0,       // web interface or API
+        CONTROLLER = 1,   // watering controller
+        TIMER = 2,        // activation period ran out
+        LOW_WATER = 3,    // reservoir ran dry
+        PREEMPTED = 4,    // stopped to make room in the power budget
+    };
+
+    uint32_t timeMs = 0;    // esp_timer time, wraps after 49 days
+    uint8_t relay = 0;
+    bool on = false;
+    Cause cause = Cause::MANUAL;
+
+    uint32_t packInfo() const {
+        return relay | (static_cast<uint32_t>(on) << 8) | (static_cast<uint32_t>(cause) << 16);
+    }
+
+    static RelayEvent unpack(uint32_t timeMs, uint32_t info) {
+        RelayEvent event;
+        event.timeMs = timeMs;
+        event.relay = static_cast<uint8_t>(info);
+        event.on = (info >> 8) & 1;
+        event.cause = static_cast<Cause>(static_cast<uint8_t>(info >> 16));
+        return event;
+    }
+};
+
+/**
+ * @class RelayEventRing
+ * @brief The last CAPACITY relay switches, readable from any task without a lock.
+ *
+ * One writer at a time (RelayManager holds its relay mutex while switching). Readers copy the
+ * ring and then check the sequence number: events the writer may have overwritten during the
+ * copy, or may be writing right now, are dropped instead of being returned torn. Slots are
+ * pairs of 32-bit atomics, which the ESP32 reads and writes without a lock.
+ */
+class RelayEventRing {
+public:
+    static constexpr size_t CAPACITY = 64;
+
+    void push(const RelayEvent& event) {
+        const uint32_t seq = next.load(std::memory_order_relaxed);
+        // Pairs with the reader's acquire fence: a reader that sees any store below also sees
+        // `next` at least at seq, and so drops the event this slot held before
+        std::atomic_thread_fence(std::memory_order_release);
+        Slot& slot = slots[seq % CAPACITY];
+        slot.timeMs.store(event.timeMs, std::memory_order_relaxed);
+        slot.info.store(event.packInfo(), std::memory_order_relaxed);
+        next.store(seq + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy the most recent events, oldest first.
+     *
+     * At most CAPACITY - 1 events come back; the oldest slot may be the one being rewritten.
+     *
+     * @param out Destination for up to `max` events
+     * @return Number of events copied
+     */
+    size_t copyRecent(RelayEvent* out, size_t max) const {
+        const uint32_t end = next.load(std::memory_order_acquire);
+        uint32_t begin = end > CAPACITY ? end - CAPACITY : 0;
+        if (end - begin > max) begin = end - static_cast<uint32_t>(max);
+
+        std::array<uint32_t, CAPACITY> times;
+        std::array<uint32_t, CAPACITY> infos;
+        for (uint32_t seq = begin; seq != end; ++seq) {
+            const Slot& slot = slots[seq % CAPACITY];
+            times[seq - begin] = slot.timeMs.load(std::memory_order_relaxed);
+            infos[seq - begin] = slot.info.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // The slot of sequence number `after` may be half written, and every older slot that
+        // shares its position with a newer sequence number was overwritten during the copy
+        const uint32_t after = next.load(std::memory_order_relaxed);
+        const uint32_t firstIntact = after + 1 > CAPACITY ? after + 1 - CAPACITY : 0;
+        size_t count = 0;
+        for (uint32_t seq = begin; seq != end; ++seq) {
+            if (seq >= firstIntact) {
+                out[count++] = RelayEvent::unpack(times[seq - begin], infos[seq - begin]);
+            }
+        }
+        return count;
+    }
+
+    // Events pushed since boot, including the ones no longer in the ring.
+    uint32_t total() const {
+        return next.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> timeMs{0};
+        std::atomic<uint32_t> info{0};
+    };
+
+    std::array<Slot, CAPACITY> slots;
+    std::atomic<uint32_t> next{0};
+};
+
+#endif // RELAY_EVENT_RING_H
@@ -1,16 +1,25 @@
-// Improvements
-// Use of std::map for lastWateringTime and deactivationTimers: using std::array instead, considering we have a fixed number of relays.
-// Ensure that timers are always deleted when no longer needed to prevent memory leaks.
-// The activeRelayIndex is accessed from multiple threads without synchronization. This leads to deadlocks in many cases, should be carefully considered.
+// Threading
+// Relay state is an atomic bitmask plus per-relay deadlines, so status reads (web handlers, JSON,
+// LCD, the controller) never lock. Every switch happens with relayMutex held: the web handler,
+// the controller task, deactivation timers and the float switch task all go through it.
 
 #ifndef RELAY_MANAGER_H
 #define RELAY_MANAGER_H
 
-#include <map>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <mutex>
+#include <Arduino.h>
 #include "esp_timer.h"
 #include "ConfigManager.h"
 #include "SensorManager.h"
+#include "I2CBus.h"
+#include "RelayEventRing.h"
+#include "RelayOutputs.h"
+#include "WateringHistory.h"
+#include "WateringQueue.h"
+#include "WateringTuner.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "ESPLogger.h"
@@ -20,159 +29,491 @@
 class ESP32WebServer; // Forward declaration
 class RelayManager {
 public:
-    RelayManager(const ConfigManager& configManager, SensorManager& sensorManager)
+    RelayManager(ConfigManager& configManager, SensorManager& sensorManager, I2CBus& i2cBus)
         : logger(Logger::instance()), 
           configManager(configManager), 
           sensorManager(sensorManager), 
-          activeRelayIndex(-1) {}
+          outputs(i2cBus) {
+        for (auto& wateredUs : lastWateringUs) {
+            wateredUs.store(WateringQueue::NEVER_WATERED);
+        }
+    }
+
+    ~RelayManager() {
+        for (DeactivationTimer& timer : deactivationTimers) {
+            if (timer.handle != nullptr) {
+                esp_timer_stop(timer.handle);
+                esp_timer_delete(timer.handle);
+            }
+        }
+    }
 
     using NotifyClientsCallback = std::function<void()>;
+    using RelayEventCallback = std::function<void(int relayIndex, bool active)>;
     
     void setNotifyClientsCallback(NotifyClientsCallback callback) {
         notifyClientsCallback = std::move(callback);
     }
 
+    // Called on every relay switch, after the hardware state changed.
+    void setRelayEventCallback(RelayEventCallback callback) {
+        relayEventCallback = std::move(callback);
+    }
+
+    /**
+     * @brief Persist last-watering times across reboots. Call before the controller starts.
+     *
+     * Zones with a known last watering get their interval counted from that time. While the
+     * clock is not synced yet they count it from boot, and are corrected once it is.
+     */
+    void setWateringHistory(WateringHistory* history) {
+        wateringHistory = history;
+        if (history == nullptr) return;
+        const int64_t nowUs = esp_timer_get_time();
+        std::unique_lock<std::mutex> lock(relayMutex);
+        for (size_t i = 0; i < WateringHistory::MAX_ZONES && i < lastWateringUs.size(); ++i) {
+            if (history->lastWatered(i) != WateringHistory::NEVER) {
+                lastWateringUs[i].store(nowUs);
+                pendingHistoryMask |= 1u << i;
+            }
+        }
+        lock.unlock();
+        restoreWateringHistory();
+    }
+
     void init() {
-        initRelayStates();
+        createDeactivationTimers();
+        sensorManager.setWaterLevelCallback([this](bool waterOk) {
+            if (!waterOk) {
+                stopForLowWater();
+            } else {
+                notifyController();
+            }
+        });
         const auto& hwConfig = configManager.getHwConfig();
+        // Relays are active LOW, all start off
+        if (!outputs.begin(hwConfig.relayPins)) {
+            logger.log("RelayManager", LogLevel::ERROR, "Some relay outputs could not be initialized");
+        }
+        relayMask.store(0);
         for (size_t i = 0; i < hwConfig.relayPins.size(); ++i) {
-            int pin = hwConfig.relayPins[i];
-            pinMode(pin, INPUT);
-            digitalWrite(pin, HIGH);  // Assuming relays are active LOW
-            pinMode(pin, OUTPUT);
-            relayStates[i] = false; // Initialize relay states
-            logger.log("RelayManager", LogLevel::INFO, "Initialized relay %d on pin %d", i, pin);
+            logger.log("RelayManager", LogLevel::INFO, "Initialized relay %d on pin %d", i, hwConfig.relayPins[i]);
         }
         logger.log("RelayManager", LogLevel::INFO, "RelayManager initialized with %d relays", hwConfig.relayPins.size());
     }
     
-    bool activateRelay(int relayIndex) {
-		
-        cancelScheduledDeactivation(relayIndex);
+    /**
+     * @brief Switch a relay on for its zone's activation period.
+     *
+     * A manual start stops running relays until the new one fits the power budget; the
+     * controller only starts relays that fit and gets false otherwise. Either is refused within
+     * the inrush delay of the previous start, so no two pumps start at the same instant.
+     */
+    bool activateRelay(int relayIndex, RelayEvent::Cause cause = RelayEvent::Cause::MANUAL) {
         const auto& hwConfig = configManager.getHwConfig();
+        if (!isValidRelay(relayIndex)) {
+            logger.log("RelayManager", LogLevel::ERROR, "Invalid relay index: %d", relayIndex);
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(relayMutex);
+
         int relayPin = hwConfig.relayPins[relayIndex];
 
-        if (activeRelayIndex == relayIndex) {
+        // Keeps the running deactivation deadline
+        if (getRelayState(relayIndex)) {
             logger.log("RelayManager", LogLevel::INFO, "Relay %d is already active", relayIndex);
             return true;
         }
-                
-        if (relayIndex < 0 || relayIndex >= static_cast<int>(hwConfig.relayPins.size())) {
-            logger.log("RelayManager", LogLevel::ERROR, "Invalid relay index: %d", relayIndex);
-            return false;
-        }
 
         if (!sensorManager.getSensorData().waterLevel) {
             logger.log("RelayManager", LogLevel::WARNING, "Water level too low, cannot activate relay %d", relayIndex);
             return false;
         }
 		
-        // Deactivate currently active relay if any
-        if (activeRelayIndex != -1 && activeRelayIndex != relayIndex) {
-            logger.log("RelayManager", LogLevel::INFO, "Deactivating currently active relay %d before activating relay %d", activeRelayIndex, relayIndex);
-            deactivateRelayInternal(activeRelayIndex);
+        // Stop running relays until the new one fits the power budget. With the default budget
+        // of one pump this is the old rule: whatever runs is switched off first.
+        const int64_t now = esp_timer_get_time();
+        const int64_t earliestStartUs = nextStartUs.load();
+        if (now < earliestStartUs) {
+            logger.log("RelayManager", LogLevel::WARNING, "Relay %d not started, inrush delay of the previous start has %lld ms left",
+                       relayIndex, static_cast<long long>((earliestStartUs - now + 999) / 1000));
+            return false;
         }
 
-        // Activate the requested relay
-        activeRelayIndex = relayIndex;
-        relayStates[relayIndex] = true;
-        lastWateringTime[relayIndex] = esp_timer_get_time();
+        const int current = relayCurrent(relayIndex);
+        if (cause == RelayEvent::Cause::CONTROLLER && !fitsPowerBudget(current)) {
+            return false;
+        }
+        for (int i = 0; i < ConfigConstants::MAX_SYSTEM_SIZE && !fitsPowerBudget(current); ++i) {
+            if (getRelayState(i)) {
+                logger.log("RelayManager", LogLevel::INFO, "Deactivating relay %d to make room for relay %d", i, relayIndex);
+                deactivateRelayInternal(i, RelayEvent::Cause::PREEMPTED);
+            }
+        }
+
+        // Activate the requested relay; the deadline is set before the state bit so a reader
+        // that sees the relay on also sees when it switches off
+        scheduleDeactivation(relayIndex, configManager.getSensorConfig(relayIndex).activationPeriod.value());
+        relayDrawMa[relayIndex] = current;
+        activeDrawMa.fetch_add(current);
+        relayMask.fetch_or(1u << relayIndex);
+        nextStartUs.store(now + static_cast<int64_t>(hwConfig.inrushDelay.value()) * 1000);
+        lastWateringUs[relayIndex].store(now);
+        pendingHistoryMask &= ~(1u << relayIndex);
+        if (wateringHistory != nullptr) {
+            wateringHistory->record(relayIndex);
+        }
         setRelayHardwareState(relayPin, true);
+        sensorManager.setActuating(true);
+        recordEvent(relayIndex, true, cause);
         logger.log("RelayManager", LogLevel::INFO, "Relay %d activated (pin %d)", relayIndex, relayPin);
-
-        // Get the corresponding SensorConfig for this relay
-        const auto& actDuration = configManager.getSensorConfig(relayIndex).activationPeriod;
-		//now scheduele a deactivation here, 
-		scheduleDeactivation(relayIndex, configManager.getSensorConfig(relayIndex).activationPeriod.value());
+        if (relayEventCallback) {
+            relayEventCallback(relayIndex, true);
+        }
         return true;
     }
 
     bool deactivateRelay(int relayIndex) {
-        return deactivateRelayInternal(relayIndex);
+        if (!isValidRelay(relayIndex)) {
+            logger.log("RelayManager", LogLevel::ERROR, "Invalid relay index: %d", relayIndex);
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(relayMutex);
+        return deactivateRelayInternal(relayIndex, RelayEvent::Cause::MANUAL);
     }
 
-    bool isRelayActive(int relayIndex) {
-        logger.log("RelayManager", LogLevel::DEBUG, "Checking if relay %d is active: %s", relayIndex, relayStates[relayIndex] ? "true" : "false");
-        return relayStates[relayIndex];
+    // The status reads below are lock-free and safe from any task.
+    bool isRelayActive(int relayIndex) const {
+        return relayIndex >= 0 && getRelayState(static_cast<size_t>(relayIndex));
     }
 
     bool getRelayState(size_t index) const {
-        if (index >= configManager.getHwConfig().systemSize) return false;
-        return relayStates[index];
+        return index < ConfigConstants::MAX_SYSTEM_SIZE && (relayMask.load(std::memory_order_acquire) & (1u << index));
+    }
+
+    // One bit per relay; read once for a consistent view of all relays.
+    uint32_t getRelayMask() const {
+        return relayMask.load(std::memory_order_acquire);
+    }
+
+    // Milliseconds until an active relay's activation period ends, 0 for an inactive relay.
+    uint32_t getRemainingMs(size_t index) const {
+        if (!getRelayState(index)) return 0;
+        const int32_t remaining = static_cast<int32_t>(deactivationTimers[index].deadlineMs.load(std::memory_order_acquire) - nowMs());
+        return remaining > 0 ? static_cast<uint32_t>(remaining) : 0;
+    }
+
+    // Copies up to `max` of the latest relay switches, oldest first.
+    size_t getRecentEvents(RelayEvent* out, size_t max) const {
+        return relayEvents.copyRecent(out, max);
+    }
+
+    // Relay switches since boot.
+    uint32_t getRelayEventCount() const {
+        return relayEvents.total();
+    }
+
+    static constexpr uint32_t NO_DEADLINE = UINT32_MAX;
+    // Longest single wait of the controller; keeps pdMS_TO_TICKS() from overflowing.
+    static constexpr uint32_t MAX_WAIT_MS = 60 * 60 * 1000;
+
+    /**
+     * @brief One pass of the watering controller, normally run by its task.
+     *
+     * Only zones whose moisture reading or settings changed since the last pass are evaluated,
+     * plus the dry zones still waiting. Dry zones past their watering interval go into the
+     * WateringQueue. While the reservoir has water, zones are started from the top of the queue
+     * as long as their relay currents fit the power budget, one inrush delay apart. Since a
+     * relay switching off wakes the controller, queued zones are served back to back. Public
+     * so host tests can drive it.
+     *
+     * @return Milliseconds until the next waiting zone's interval or the inrush delay runs out
+     *         (at most MAX_WAIT_MS), NO_DEADLINE if only a new snapshot, a relay switching off or the
+     *         reservoir refilling can change the outcome
+     */
+    uint32_t evaluateZones() {
+        SensorData sensorData;
+        const uint32_t version = sensorManager.getSensorData(sensorData);
+        const bool newSnapshot = !evaluatedOnce || version != evaluatedVersion;
+        evaluatedVersion = version;
+        evaluatedOnce = true;
+
+        const auto& hwConfig = configManager.getHwConfig();
+        const size_t zones = std::min<size_t>(hwConfig.systemSize.value(), zoneInputs.size());
+        const int64_t now = esp_timer_get_time();
+        int64_t nextHoldoffUs = INT64_MAX;
+        uint32_t queuedNow = 0;
+        lastZonesEvaluated = 0;
+        restoreWateringHistory();
+
+        for (size_t i = 0; i < zones; ++i) {
+            const auto& config = configManager.getSensorConfig(i);
+            if (tuner.measuring(i)) {
+                observeWatering(i, sensorData, now);
+            }
+
+            ZoneInputs inputs;
+            inputs.enabled = config.relayEnabled.value() && config.sensorEnabled.value();
+            inputs.valid = sensorData.isValid(i);
+            inputs.moistureTenths = sensorData.moistureTenths[i];
+            inputs.threshold = config.threshold.value();
+            inputs.wateringIntervalMs = config.wateringInterval.value();
+
+            const uint32_t bit = 1u << i;
+            if (inputs == zoneInputs[i] && !(waitingMask & bit)) {
+                continue;
+            }
+            zoneInputs[i] = inputs;
+            waitingMask &= ~bit;
+            lastZonesEvaluated++;
+
+            const int32_t deficitTenths = lroundf(inputs.threshold * 10.0f) - inputs.moistureTenths;
+            if (!inputs.enabled || !inputs.valid || deficitTenths <= 0) {
+                wateringQueue.remove(i);
+                continue;
+            }
+
+            // Dry from here on: stays waiting until watered, or until it is no longer dry
+            waitingMask |= bit;
+            const int64_t holdoffUs = wateringHoldoffUs(i, inputs.wateringIntervalMs, now);
+            if (holdoffUs > 0) {
+                wateringQueue.remove(i);
+                nextHoldoffUs = std::min(nextHoldoffUs, holdoffUs);
+                continue;
+            }
+            if (!wateringQueue.contains(i)) {
+                queuedNow |= bit;
+            }
+            wateringQueue.push(i, deficitTenths, lastWateringUs[i].load(), now);
+        }
+
+        // Start queued zones while they fit the power budget, one inrush delay apart. The top zone
+        // is never skipped for a smaller one behind it, so a high-current pump cannot starve.
+        while (!wateringQueue.empty() && sensorData.waterLevel) {
+            const int64_t startUs = esp_timer_get_time();
+            const int64_t earliestStartUs = nextStartUs.load();
+            if (startUs < earliestStartUs) {
+                nextHoldoffUs = std::min(nextHoldoffUs, earliestStartUs - startUs);
+                break;
+            }
+            const int zone = wateringQueue.peek(startUs);
+            if (!fitsPowerBudget(relayCurrent(zone))) {
+                break;      // woken again when a relay switches off
+            }
+            logger.log("RelayManager", LogLevel::INFO, "Activating relay %d due to low moisture, %u zones queued",
+                       zone, static_cast<unsigned>(wateringQueue.size()));
+            if (!activateRelay(zone, RelayEvent::Cause::CONTROLLER)) {
+                break;
+            }
+            wateringQueue.serve(zone, esp_timer_get_time());
+            const auto& config = configManager.getSensorConfig(zone);
+            if (config.autoTune.value()) {
+                tuner.start(zone, config.activationPeriod.value(), zoneInputs[zone].moistureTenths,
+                            config.wateringGain.value(), config.targetMoisture.value());
+            }
+            nextHoldoffUs = std::min<int64_t>(nextHoldoffUs, static_cast<int64_t>(zoneInputs[zone].wateringIntervalMs) * 1000);
+            if (newSnapshot && (queuedNow & (1u << zone))) {
+                recordActuationLatency(sensorData.publishedUs, esp_timer_get_time());
+            }
+        }
+        publishQueueStats();
+
+        if (wateringHistory != nullptr) {
+            wateringHistory->flush();
+            const uint32_t flushInS = wateringHistory->nextFlushInS();
+            if (flushInS != UINT32_MAX) {
+                nextHoldoffUs = std::min<int64_t>(nextHoldoffUs, static_cast<int64_t>(flushInS) * 1000000);
+            }
+        }
+
+        if (nextHoldoffUs == INT64_MAX) {
+            return NO_DEADLINE;
+        }
+        const int64_t waitMs = (nextHoldoffUs + 999) / 1000;
+        return static_cast<uint32_t>(std::min<int64_t>(waitMs, MAX_WAIT_MS));
+    }
+
+    // Zones looked at by the last evaluateZones() pass.
+    size_t getZonesEvaluated() const {
+        return lastZonesEvaluated;
+    }
+
+    // Relays switched on and the current they draw together, in mA.
+    int getActiveRelayCount() const {
+        return __builtin_popcount(getRelayMask());
+    }
+
+    int getActiveCurrentMa() const {
+        return activeDrawMa.load();
+    }
+
+    // Dry zones waiting for the pump after the last controller pass.
+    uint32_t getQueueDepth() const {
+        return queueDepth.load();
+    }
+
+    // Time the last zone served spent queued, and the longest such time since boot.
+    uint32_t getLastQueueWaitMs() const {
+        return lastQueueWaitMs.load();
+    }
+
+    uint32_t getMaxQueueWaitMs() const {
+        return maxQueueWaitMs.load();
+    }
+
+    // Time from a snapshot being published to the relay it made necessary switching on. Zones
+    // that had to queue behind others are covered by the queue wait times instead.
+    uint32_t getActuationLatencyUs() const {
+        return actuationLatencyUs.load();
     }
 
+    uint32_t getMaxActuationLatencyUs() const {
+        return maxActuationLatencyUs.load();
+    }
+
+    // The controller sleeps until SensorManager publishes a snapshot, a relay switches off, the
+    // reservoir refills, or a waiting zone's watering interval runs out; there is no polling.
     void startControlWateringTask() {
+        if (controlTaskHandle.load() != nullptr) {
+            logger.log("RelayManager", LogLevel::WARNING, "Watering control task already running");
+            return;
+        }
+        TaskHandle_t handle = nullptr;
         xTaskCreate(
             controlWateringTaskWrapper,
             "WateringControl",
             4096,
             this,
             1,
-            nullptr
+            &handle
         );
+        controlTaskHandle.store(handle);
+        sensorManager.setSnapshotListener(handle);
         logger.log("RelayManager", LogLevel::INFO, "Watering control task started");
     }
     
 private:
-    const ConfigManager& configManager;
+    ConfigManager& configManager;
     SensorManager& sensorManager;
-    std::map<int, int64_t> lastWateringTime;
-    int activeRelayIndex;
+    RelayOutputs outputs;
+    std::array<std::atomic<int64_t>, ConfigConstants::MAX_SYSTEM_SIZE> lastWateringUs;
+    std::array<int, ConfigConstants::MAX_SYSTEM_SIZE> relayDrawMa{};   // 0 while the relay is off
+    std::atomic<uint32_t> relayMask{0};
+    std::atomic<int> activeDrawMa{0};
+    std::atomic<int64_t> nextStartUs{0};    // no pump starts before this, see inrushDelay
+    RelayEventRing relayEvents;
     Logger& logger;
-    std::vector<bool> relayStates;
     NotifyClientsCallback notifyClientsCallback;
-
-    std::map<int, esp_timer_handle_t> deactivationTimers;
+    RelayEventCallback relayEventCallback;
+
+    // One timer per relay, created in init() and re-armed on every activation. The callback
+    // argument is the entry itself, so a firing timer knows which relay it belongs to. The
+    // deadline is esp_timer time in ms, compared wrap-safe, so it fits a lock-free 32-bit atomic.
+    struct DeactivationTimer {
+        RelayManager* owner = nullptr;
+        int relayIndex = -1;
+        esp_timer_handle_t handle = nullptr;
+        std::atomic<uint32_t> deadlineMs{0};
+    };
+    std::array<DeactivationTimer, ConfigConstants::MAX_SYSTEM_SIZE> deactivationTimers;
     std::mutex relayMutex;
 
-    void initRelayStates() {
-        int systemSize = configManager.getHwConfig().systemSize.value();
-        relayStates.resize(systemSize, false);
+    static uint32_t nowMs() {
+        return static_cast<uint32_t>(esp_timer_get_time() / 1000);
     }
 
-    void scheduleDeactivation(int relayIndex, int64_t delayMs) {
-        esp_timer_handle_t timerHandle;
+    bool isValidRelay(int relayIndex) const {
+        return relayIndex >= 0 && relayIndex < static_cast<int>(configManager.getHwConfig().relayPins.size()) &&
+               relayIndex < ConfigConstants::MAX_SYSTEM_SIZE;
+    }
+
+    void recordEvent(int relayIndex, bool on, RelayEvent::Cause cause) {
+        RelayEvent event;
+        event.timeMs = nowMs();
+        event.relay = static_cast<uint8_t>(relayIndex);
+        event.on = on;
+        event.cause = cause;
+        relayEvents.push(event);
+    }
 
-        esp_timer_create_args_t timerArgs = {
-            .callback = &RelayManager::deactivateRelayCallback,
-            .arg = this,
-            .dispatch_method = ESP_TIMER_TASK,
-            .name = "deactivation_timer"
-        };
+    void createDeactivationTimers() {
+        for (size_t i = 0; i < deactivationTimers.size(); ++i) {
+            DeactivationTimer& timer = deactivationTimers[i];
+            if (timer.handle != nullptr) continue;
+            timer.owner = this;
+            timer.relayIndex = static_cast<int>(i);
+            esp_timer_create_args_t timerArgs = {
+                .callback = &RelayManager::deactivateRelayCallback,
+                .arg = &timer,
+                .dispatch_method = ESP_TIMER_TASK,
+                .name = "deactivation_timer",
+                .skip_unhandled_events = false
+            };
+            if (esp_timer_create(&timerArgs, &timer.handle) != ESP_OK) {
+                timer.handle = nullptr;
+                logger.log("RelayManager", LogLevel::ERROR, "Could not create deactivation timer %d", i);
+            }
+        }
+    }
 
-        esp_timer_create(&timerArgs, &timerHandle);
-        deactivationTimers[relayIndex] = timerHandle;
-        esp_timer_start_once(timerHandle, delayMs * 1000);
+    void scheduleDeactivation(int relayIndex, int64_t delayMs) {
+        DeactivationTimer& timer = deactivationTimers[relayIndex];
+        if (timer.handle == nullptr) {
+            logger.log("RelayManager", LogLevel::ERROR, "No deactivation timer for relay %d", relayIndex);
+            return;
+        }
+        esp_timer_stop(timer.handle);
+        timer.deadlineMs.store(static_cast<uint32_t>((esp_timer_get_time() + delayMs * 1000) / 1000), std::memory_order_release);
+        esp_timer_start_once(timer.handle, delayMs * 1000);
 
         logger.log("RelayManager", LogLevel::DEBUG, "Scheduled deactivation for relay %d in %lld ms", relayIndex, delayMs);
     }
 
     void cancelScheduledDeactivation(int relayIndex) {
-        auto it = deactivationTimers.find(relayIndex);
-        if (it != deactivationTimers.end()) {
-            esp_timer_stop(it->second);
-            esp_timer_delete(it->second);
-            deactivationTimers.erase(it);
-
+        DeactivationTimer& timer = deactivationTimers[relayIndex];
+        if (timer.handle != nullptr && esp_timer_stop(timer.handle) == ESP_OK) {
             logger.log("RelayManager", LogLevel::DEBUG, "Canceled scheduled deactivation for relay %d", relayIndex);
         }
     }
 
+    // A callback already dispatched when its timer was re-armed sees the later deadline and does nothing.
     static void deactivateRelayCallback(void* arg) {
-        RelayManager* self = static_cast<RelayManager*>(arg);
+        DeactivationTimer* timer = static_cast<DeactivationTimer*>(arg);
+        RelayManager* self = timer->owner;
         std::lock_guard<std::mutex> lock(self->relayMutex);
 
-        int relayIndex = self->getActiveRelayIndex();
-        if (relayIndex != -1) {
-            self->deactivateRelayInternal(relayIndex);
+        const int32_t overdueMs = static_cast<int32_t>(nowMs() - timer->deadlineMs.load());
+        if (overdueMs >= 0 && self->getRelayState(timer->relayIndex)) {
+            self->deactivateRelayInternal(timer->relayIndex, RelayEvent::Cause::TIMER);
         }
     }
 
-    bool deactivateRelayInternal(int relayIndex) {
-		cancelScheduledDeactivation(relayIndex);
-		//check if a deactivation task for the relay is currently in order, and if there is one clear it. 
-		
-        if (!relayStates[relayIndex]) {
+    // Runs in the float switch task right after the reservoir runs dry.
+    void stopForLowWater() {
+        std::lock_guard<std::mutex> lock(relayMutex);
+        for (int i = 0; i < ConfigConstants::MAX_SYSTEM_SIZE; ++i) {
+            if (getRelayState(i)) {
+                logger.log("RelayManager", LogLevel::WARNING, "Water level low, stopping relay %d", i);
+                deactivateRelayInternal(i, RelayEvent::Cause::LOW_WATER);
+            }
+        }
+    }
+
+    int relayCurrent(size_t relayIndex) const {
+        const auto& currents = configManager.getHwConfig().relayCurrents;
+        return relayIndex < currents.size() ? currents[relayIndex] : ConfigConstants::DEFAULT_RELAY_CURRENT;
+    }
+
+    // A relay drawing more than the whole budget may still run on its own.
+    bool fitsPowerBudget(int current) const {
+        return getRelayMask() == 0 || activeDrawMa.load() + current <= configManager.getHwConfig().powerBudget.value();
+    }
+
+    // Callers hold relayMutex.
+    bool deactivateRelayInternal(int relayIndex, RelayEvent::Cause cause) {
+        cancelScheduledDeactivation(relayIndex);
+
+        if (!getRelayState(relayIndex)) {
             logger.log("RelayManager", LogLevel::INFO, "Relay %d is already inactive", relayIndex);
             return true;
         }
@@ -180,73 +521,146 @@ private:
         const auto& hwConfig = configManager.getHwConfig();
         int relayPin = hwConfig.relayPins[relayIndex];
     
-        relayStates[relayIndex] = false;
+        const uint32_t remaining = relayMask.fetch_and(~(1u << relayIndex)) & ~(1u << relayIndex);
+        activeDrawMa.fetch_sub(relayDrawMa[relayIndex]);
+        relayDrawMa[relayIndex] = 0;
         setRelayHardwareState(relayPin, false);
+        if (remaining == 0) {
+            sensorManager.setActuating(false);
+        }
+        recordEvent(relayIndex, false, cause);
         logger.log("RelayManager", LogLevel::INFO, "Relay %d deactivated (pin %d)", relayIndex, relayPin);
-
-        if (activeRelayIndex == relayIndex) {
-            activeRelayIndex = -1;
-            logger.log("RelayManager", LogLevel::DEBUG, "Cleared active relay index");
+        if (relayEventCallback) {
+            relayEventCallback(relayIndex, false);
         }
 
+        notifyController();
+
         return true;
     }
 
     void setRelayHardwareState(int relayPin, bool state) {
-        digitalWrite(relayPin, state ? LOW : HIGH);
+        outputs.set(relayPin, state);
         logger.log("RelayManager", LogLevel::DEBUG, "Relay on pin %d hardware state set to %s", relayPin, state ? "ON" : "OFF");
         if (notifyClientsCallback) {
             notifyClientsCallback();
         }    
     }
 
-    static constexpr TickType_t RELAY_CHECK_INTERVAL = pdMS_TO_TICKS(5 * 60 * 1000);  // 5 minutes
-    static constexpr TickType_t INITIAL_DELAY = pdMS_TO_TICKS(10 * 60 * 1000);  // 10 minutes
+    // Inputs a zone was last evaluated with; the zone is evaluated again only once one changes.
+    struct ZoneInputs {
+        int16_t moistureTenths = 0;
+        float threshold = 0.0f;
+        uint32_t wateringIntervalMs = 0;
+        bool valid = false;
+        bool enabled = false;
+
+        bool operator==(const ZoneInputs& other) const {
+            return moistureTenths == other.moistureTenths && threshold == other.threshold &&
+                   wateringIntervalMs == other.wateringIntervalMs && valid == other.valid && enabled == other.enabled;
+        }
+        bool operator!=(const ZoneInputs& other) const { return !(*this == other); }
+    };
+
+    std::atomic<TaskHandle_t> controlTaskHandle{nullptr};
+    std::array<ZoneInputs, ConfigConstants::MAX_SYSTEM_SIZE> zoneInputs{};
+    uint32_t waitingMask = 0;           // dry zones held back, evaluated again on every wake
+    WateringHistory* wateringHistory = nullptr;
+    uint32_t pendingHistoryMask = 0;    // restored zones waiting for a synced clock, under relayMutex
+    uint32_t evaluatedVersion = 0;      // snapshot version zoneInputs were taken from
+    bool evaluatedOnce = false;
+    size_t lastZonesEvaluated = 0;
+    WateringQueue wateringQueue;
+    WateringTuner tuner;
+    std::atomic<uint32_t> queueDepth{0};
+    std::atomic<uint32_t> lastQueueWaitMs{0};
+    std::atomic<uint32_t> maxQueueWaitMs{0};
+    std::atomic<uint32_t> actuationLatencyUs{0};
+    std::atomic<uint32_t> maxActuationLatencyUs{0};
+
+    // Wakes the controller when something other than a new snapshot may let a waiting zone run.
+    void notifyController() {
+        TaskHandle_t task = controlTaskHandle.load();
+        if (task != nullptr) {
+            xTaskNotifyGive(task);
+        }
+    }
 
-    int getActiveRelayIndex() {
-        return activeRelayIndex;
+    // Microseconds until the zone may be watered again, 0 if it may be watered now.
+    // Places restored wall-clock waterings on the esp_timer axis once the clock is synced; they may
+    // lie before boot, so negative. A zone watered since boot keeps its newer time.
+    void restoreWateringHistory() {
+        std::lock_guard<std::mutex> lock(relayMutex);
+        if (pendingHistoryMask == 0 || !wateringHistory->clockValid()) return;
+        const int64_t nowUs = esp_timer_get_time();
+        const uint32_t nowS = wateringHistory->now();
+        for (size_t i = 0; i < lastWateringUs.size(); ++i) {
+            if (!(pendingHistoryMask & (1u << i))) continue;
+            const uint32_t wateredAt = wateringHistory->lastWatered(i);
+            const int64_t ageUs = wateredAt < nowS ? static_cast<int64_t>(nowS - wateredAt) * 1000000 : 0;
+            lastWateringUs[i].store(nowUs - ageUs);
+            waitingMask |= 1u << i;     // re-evaluate with the real interval
+        }
+        pendingHistoryMask = 0;
+        logger.log("RelayManager", LogLevel::INFO, "Watering history restored");
     }
 
-    void controlWateringTask() {
-        // Initial delay
-        vTaskDelay(INITIAL_DELAY);
+    int64_t wateringHoldoffUs(size_t zone, uint32_t intervalMs, int64_t now) {
+        const int64_t wateredUs = lastWateringUs[zone].load();
+        if (wateredUs == WateringQueue::NEVER_WATERED) {
+            return 0;
+        }
+        const int64_t remaining = wateredUs + static_cast<int64_t>(intervalMs) * 1000 - now;
+        return remaining > 0 ? remaining : 0;
+    }
 
-        while (true) {
-            const SensorData& sensorData = sensorManager.getSensorData();
-            const auto& hwConfig = configManager.getHwConfig();
-
-            // Check water level first
-            if (sensorData.waterLevel) {
-                int64_t currentTime = esp_timer_get_time();
-
-                for (size_t i = 0; i < hwConfig.systemSize.value(); ++i) {
-                    const auto& config = configManager.getSensorConfig(i);
-                    
-                    // Skip if relay or sensor is disabled
-                    if (!config.relayEnabled || !config.sensorEnabled) {
-                        continue;
-                    }
-
-                    // Check if enough time has passed since last watering
-                    int64_t timeSinceLastWatering = currentTime - lastWateringTime[i];
-                    if (timeSinceLastWatering < config.wateringInterval) {
-                        continue;
-                    }
-
-                    // Check moisture level
-                    if (sensorData.moisture[i] < config.threshold) {
-                        // All conditions met, activate the relay
-                        logger.log("RelayManager", LogLevel::INFO, "Activating relay %d due to low moisture", i);
-                        activateRelay(i);
-                        break;  // Exit the loop after activating a relay
-                    }
-                }
-            } else {
-                logger.log("RelayManager", LogLevel::WARNING, "Water level too low, skipping relay checks");
-            }
+    // Completes a feedback measurement once the soaked-in reading is there, and stores the
+    // tuned activationPeriod and gain. ConfigManager rejects values outside the configured limits.
+    void observeWatering(size_t zone, const SensorData& sensorData, int64_t now) {
+        const auto& config = configManager.getSensorConfig(zone);
+        if (!config.autoTune.value()) {
+            tuner.cancel(zone);
+            return;
+        }
+        constexpr const ConfigInfo& limits = configInfo(ConfigKey::SENSOR_ACTIVATION_PERIOD);
+        constexpr WateringTuner::Limits bounds{static_cast<uint32_t>(limits.intMin), static_cast<uint32_t>(limits.intMax)};
+
+        WateringTuner::Result tuned;
+        if (!tuner.observe(zone, getRelayState(zone), now, sensorData.publishedUs, sensorData.isValid(zone),
+                           sensorData.moistureTenths[zone], bounds, tuned)) {
+            return;
+        }
+        logger.log("RelayManager", LogLevel::INFO, "Zone %d tuned: activation period %lu ms, gain %.2f %%/s", zone,
+                   static_cast<unsigned long>(tuned.durationMs), tuned.gain / 10.0f);
+        ConfigTypes::SensorConfig update;
+        update.activationPeriod = tuned.durationMs;
+        update.wateringGain = tuned.gain;
+        configManager.setSensorConfig(update, zone);
+    }
+
+    // Copied out of the queue so telemetry can read them from another task.
+    void publishQueueStats() {
+        const WateringQueue::Stats& stats = wateringQueue.getStats();
+        queueDepth.store(static_cast<uint32_t>(wateringQueue.size()));
+        lastQueueWaitMs.store(stats.lastWaitMs);
+        maxQueueWaitMs.store(stats.maxWaitMs);
+    }
+
+    void recordActuationLatency(int64_t publishedUs, int64_t now) {
+        const int64_t latency = now - publishedUs;
+        const uint32_t latencyUs = latency > 0 ? static_cast<uint32_t>(std::min<int64_t>(latency, UINT32_MAX)) : 0;
+        actuationLatencyUs.store(latencyUs);
+        if (latencyUs > maxActuationLatencyUs.load()) {
+            maxActuationLatencyUs.store(latencyUs);
+        }
+    }
 
-            // Always wait for the full interval before the next cycle
-            vTaskDelay(RELAY_CHECK_INTERVAL);
+    void controlWateringTask() {
+        TickType_t wait = 0;
+        while (true) {
+            ulTaskNotifyTake(pdTRUE, wait);
+            const uint32_t nextMs = evaluateZones();
+            wait = nextMs == NO_DEADLINE ? portMAX_DELAY : pdMS_TO_TICKS(nextMs);
         }
     }
 
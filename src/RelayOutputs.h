@@ -0,0 +1,146 @@
+#ifndef RELAY_OUTPUTS_H
+#define RELAY_OUTPUTS_H
+
+#include <Arduino.h>
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "ESPLogger.h"
+#include "I2CBus.h"
+#include "IoChannel.h"
+
+/**
+ * @class RelayOutputs
+ * @brief Drives active-LOW relay inputs on GPIOs, PCF8574 and MCP23017 expanders.
+ *
+ * Relay pin codes are decoded with IoChannel. The output latch of every expander is mirrored
+ * here, so switching one relay is a single write of the byte (or port) it sits on, with no
+ * read-modify-write on the bus. begin() switches all relays of an expander off in one write.
+ *
+ * Expander writes go through the shared I2CBus at ACTUATOR priority, ahead of sensor reads and
+ * display refreshes, so stopping a pump never waits behind a queued LCD line.
+ *
+ * @note Not thread safe; RelayManager calls it with its relay mutex held.
+ */
+class RelayOutputs {
+public:
+    explicit RelayOutputs(I2CBus& bus) : bus(bus), logger(Logger::instance()) {}
+
+    // Sets up every relay pin and turns them all off. Returns false if an expander did not answer.
+    bool begin(const std::vector<int>& codes) {
+        pcfUsed = 0;
+        mcpUsed = 0;
+        for (int code : codes) {
+            const IoChannel::Channel io = IoChannel::decodeOutput(code);
+            switch (io.kind) {
+            case IoChannel::Kind::GPIO:
+                pinMode(io.pin, INPUT);
+                digitalWrite(io.pin, HIGH);
+                pinMode(io.pin, OUTPUT);
+                break;
+            case IoChannel::Kind::PCF8574:
+                pcfUsed |= 1u << io.device;
+                break;
+            case IoChannel::Kind::MCP23017:
+                mcpUsed |= 1u << io.device;
+                break;
+            default:
+                logger.log("RelayOutputs", LogLevel::ERROR, "Invalid relay pin %d", code);
+                break;
+            }
+        }
+
+        bool ok = true;
+        for (uint8_t n = 0; n < IoChannel::MAX_OUTPUT_EXPANDERS; ++n) {
+            if (pcfUsed & (1u << n)) {
+                pcfLatch[n] = 0xFF;
+                ok &= writePcf8574(n);
+            }
+            if (mcpUsed & (1u << n)) {
+                mcpLatch[n] = 0xFFFF;
+                ok &= setupMcp23017(n);
+            }
+        }
+        return ok;
+    }
+
+    // Switches one relay; on drives its input LOW.
+    bool set(int code, bool on) {
+        const IoChannel::Channel io = IoChannel::decodeOutput(code);
+        switch (io.kind) {
+        case IoChannel::Kind::GPIO:
+            digitalWrite(io.pin, on ? LOW : HIGH);
+            return true;
+        case IoChannel::Kind::PCF8574: {
+            const uint8_t mask = static_cast<uint8_t>(1u << io.index);
+            pcfLatch[io.device] = on ? (pcfLatch[io.device] & ~mask) : (pcfLatch[io.device] | mask);
+            return writePcf8574(io.device);
+        }
+        case IoChannel::Kind::MCP23017: {
+            const uint16_t mask = static_cast<uint16_t>(1u << io.index);
+            mcpLatch[io.device] = on ? (mcpLatch[io.device] & ~mask) : (mcpLatch[io.device] | mask);
+            return writeMcp23017Port(io.device, io.index / 8);
+        }
+        default:
+            return false;
+        }
+    }
+
+private:
+    static constexpr uint8_t MCP_IODIRA = 0x00;
+    static constexpr uint8_t MCP_OLATA = 0x14;
+
+    I2CBus& bus;
+    Logger& logger;
+    uint8_t pcfUsed = 0;
+    uint8_t mcpUsed = 0;
+    std::array<uint8_t, IoChannel::MAX_OUTPUT_EXPANDERS> pcfLatch{};
+    std::array<uint16_t, IoChannel::MAX_OUTPUT_EXPANDERS> mcpLatch{};
+
+    bool writePcf8574(uint8_t n) {
+        const uint8_t address = IoChannel::OUTPUT_EXPANDER_ADDRESS + n;
+        const uint8_t value = pcfLatch[n];
+        return check(address, bus.transact(address, I2CBus::Priority::ACTUATOR, [address, value](TwoWire& wire) {
+            wire.beginTransmission(address);
+            wire.write(value);
+            return wire.endTransmission() == 0;
+        }));
+    }
+
+    // Latches high before the pins become outputs, so no relay pulses on power-up.
+    bool setupMcp23017(uint8_t n) {
+        const uint8_t address = IoChannel::OUTPUT_EXPANDER_ADDRESS + n;
+        return check(address, bus.transact(address, I2CBus::Priority::ACTUATOR, [address](TwoWire& wire) {
+            wire.beginTransmission(address);
+            wire.write(MCP_OLATA);
+            wire.write(0xFF);
+            wire.write(0xFF);
+            if (wire.endTransmission() != 0) return false;
+            wire.beginTransmission(address);
+            wire.write(MCP_IODIRA);
+            wire.write(0x00);
+            wire.write(0x00);
+            return wire.endTransmission() == 0;
+        }));
+    }
+
+    bool writeMcp23017Port(uint8_t n, uint8_t port) {
+        const uint8_t address = IoChannel::OUTPUT_EXPANDER_ADDRESS + n;
+        const uint8_t value = static_cast<uint8_t>(mcpLatch[n] >> (8 * port));
+        return check(address, bus.transact(address, I2CBus::Priority::ACTUATOR, [address, port, value](TwoWire& wire) {
+            wire.beginTransmission(address);
+            wire.write(static_cast<uint8_t>(MCP_OLATA + port));
+            wire.write(value);
+            return wire.endTransmission() == 0;
+        }));
+    }
+
+    bool check(uint8_t address, bool ok) {
+        if (!ok) {
+            logger.log("RelayOutputs", LogLevel::ERROR, "Relay expander at 0x%02X did not answer", address);
+        }
+        return ok;
+    }
+};
+
+#endif // RELAY_OUTPUTS_H
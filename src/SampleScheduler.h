@@ -0,0 +1,45 @@
+#ifndef SAMPLE_SCHEDULER_H
+#define SAMPLE_SCHEDULER_H
+
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * @class SampleScheduler
+ * @brief Picks the delay before the next sensor update.
+ *
+ * Samples every MIN_INTERVAL_MS while a pump runs or while any channel moved by at least
+ * CHANGE_THRESHOLD_TENTHS since the previous update. Once readings settle the interval doubles
+ * on every update until it reaches the configured sensorUpdateInterval, which stays the upper
+ * bound. Moisture is flat for hours between waterings, so the task spends most of its time at
+ * the configured interval and only speeds up around a watering.
+ */
+class SampleScheduler {
+public:
+    static constexpr uint32_t MIN_INTERVAL_MS = 5000;
+    static constexpr int16_t CHANGE_THRESHOLD_TENTHS = 10;  // 1 %
+
+    /**
+     * @param maxIntervalMs Configured sensorUpdateInterval
+     * @param actuating Whether a relay is currently on
+     * @param largestChangeTenths Largest moisture change of any channel since the previous update
+     * @return Delay before the next update in ms
+     */
+    uint32_t next(uint32_t maxIntervalMs, bool actuating, int16_t largestChangeTenths) {
+        const uint32_t floor = std::min(MIN_INTERVAL_MS, maxIntervalMs);
+        if (actuating || largestChangeTenths >= CHANGE_THRESHOLD_TENTHS) {
+            interval = floor;
+        } else {
+            interval = interval == 0 ? maxIntervalMs : std::min(interval * 2, maxIntervalMs);
+        }
+        interval = std::clamp(interval, floor, maxIntervalMs);
+        return interval;
+    }
+
+    uint32_t current() const { return interval; }
+
+private:
+    uint32_t interval = 0;
+};
+
+#endif // SAMPLE_SCHEDULER_H
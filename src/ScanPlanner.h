@@ -0,0 +1,255 @@
+#ifndef SCAN_PLANNER_H
+#define SCAN_PLANNER_H
+
+#include <Arduino.h>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "esp_timer.h"
+#include "globals.h"
+#include "Ads1115.h"
+#include "I2CBus.h"
+#include "IoChannel.h"
+
+/**
+ * @class ScanPlanner
+ * @brief Orders one sampling round over direct ADC pins, CD74HC4067 muxes and ADS1115 ADCs.
+ *
+ * plan() sorts the enabled channels into batches so a round switches and converts as little
+ * as possible:
+ *
+ * - All muxes share the S0..S3 select lines, so every mux input with the same channel number
+ *   is read after a single switch. Channels are visited in Gray-code order, so consecutive
+ *   switches usually change one select line instead of up to four.
+ * - Each ADS1115 converts one input at a time, but the chips run in parallel. A conversion
+ *   slot starts one conversion on every chip that still has inputs left, so a round needs as
+ *   many slots as the busiest chip has inputs, not one per input.
+ * - The first slot is started before the direct and mux reads, which then run while the
+ *   ADS1115s convert.
+ *
+ * A round is run in steps by runStep(): step 0 does the GPIO work, every later step collects a
+ * conversion slot and starts the next one. Between steps the caller waits the returned time
+ * (MoistureSampler does so through its SensorDriver state machine). With 16 mux channels and
+ * 4 ADS1115 inputs per chip, a round stays at 16 switches and 4 conversion times however
+ * many muxes and chips are fitted.
+ *
+ * @note Plans live in fixed arrays sized for MAX_SYSTEM_SIZE channels; nothing allocates
+ *       once the planner exists.
+ */
+class ScanPlanner {
+public:
+    static constexpr size_t MAX_CHANNELS = ConfigConstants::MAX_SYSTEM_SIZE;
+    static constexpr size_t SELECT_LINES = 4;
+    // CD74HC4067 on-resistance with the ADC sample capacitor, plus margin for the sensor output.
+    static constexpr uint32_t MUX_SETTLE_US = 20;
+
+    struct Stats {
+        uint16_t directReads = 0;
+        uint16_t muxReads = 0;
+        uint16_t muxSwitches = 0;       // select line changes, one per batch of mux inputs
+        uint16_t selectPinWrites = 0;   // GPIO writes those switches took
+        uint16_t conversionSlots = 0;
+        uint16_t conversions = 0;
+        uint16_t errors = 0;            // failed ADS1115 transactions
+        uint32_t roundUs = 0;           // start of step 0 to the end of the last step
+    };
+
+    // Copies the mux wiring. Inputs on a mux without a signal pin are not planned.
+    void setMuxPins(const std::vector<int>& selectPins, const std::vector<int>& signalPins) {
+        selectCount = std::min(selectPins.size(), SELECT_LINES);
+        std::copy_n(selectPins.begin(), selectCount, select.begin());
+        signalCount = std::min(signalPins.size(), static_cast<size_t>(IoChannel::MAX_MUXES));
+        std::copy_n(signalPins.begin(), signalCount, signal.begin());
+        selectState = -1;
+    }
+
+    /**
+     * @brief Sort the enabled channels into batches.
+     *
+     * @param codes Sensor pin code per channel, see IoChannel
+     * @param enabled Whether each channel is read, same length as codes
+     * @return Number of channels planned; enabled channels with an unusable code are skipped
+     */
+    size_t plan(const std::vector<int>& codes, const std::vector<bool>& enabled) {
+        directCount = muxCount = adsCount = 0;
+        slotCount = 0;
+        std::array<uint8_t, IoChannel::MAX_ADS1115> inputsPerChip{};
+
+        for (size_t ch = 0; ch < codes.size() && ch < MAX_CHANNELS; ++ch) {
+            if (!enabled[ch]) continue;
+            const IoChannel::Channel io = IoChannel::decodeInput(codes[ch]);
+            switch (io.kind) {
+            case IoChannel::Kind::GPIO:
+                direct[directCount++] = Read{static_cast<uint8_t>(ch), 0, io.pin};
+                break;
+            case IoChannel::Kind::MUX:
+                if (io.device < signalCount && selectCount == SELECT_LINES) {
+                    mux[muxCount++] = Read{static_cast<uint8_t>(ch), grayRank(io.index), signal[io.device]};
+                }
+                break;
+            case IoChannel::Kind::ADS1115: {
+                const uint8_t slot = inputsPerChip[io.device]++;
+                ads[adsCount++] = Conversion{static_cast<uint8_t>(ch), slot, io.device, io.index, false};
+                slotCount = std::max<size_t>(slotCount, slot + 1);
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        std::sort(mux.begin(), mux.begin() + muxCount,
+                  [](const Read& a, const Read& b) { return a.order < b.order; });
+        std::sort(ads.begin(), ads.begin() + adsCount,
+                  [](const Conversion& a, const Conversion& b) { return a.slot < b.slot; });
+        return directCount + muxCount + adsCount;
+    }
+
+    // Call before the first step of every round.
+    void beginRound() {
+        step = 0;
+        stats = Stats();
+    }
+
+    /**
+     * @brief Run the next step of the round.
+     *
+     * @param bus Bus the ADS1115s are on, may be null when none is planned
+     * @param sink Callable `void(size_t channel, uint16_t value)` receiving each reading
+     * @param waitUs Set to the time the next step has to wait for
+     * @return true once the round is complete
+     */
+    template<typename Sink>
+    bool runStep(I2CBus* bus, Sink&& sink, uint32_t& waitUs) {
+        const int64_t now = esp_timer_get_time();
+        if (step == 0) {
+            roundStartUs = now;
+            startSlot(bus, 0);
+            for (size_t i = 0; i < directCount; ++i) {
+                stats.directReads++;
+                sink(direct[i].channel, static_cast<uint16_t>(analogRead(direct[i].pin)));
+            }
+            readMuxes(sink);
+        } else {
+            collectSlot(bus, step - 1, sink);
+            startSlot(bus, step);
+        }
+
+        if (step++ < slotCount) {
+            const int64_t remaining = slotStartUs + Ads1115::CONVERSION_US - esp_timer_get_time();
+            waitUs = remaining > 0 ? static_cast<uint32_t>(remaining) : 0;
+            return false;
+        }
+        stats.roundUs = static_cast<uint32_t>(esp_timer_get_time() - roundStartUs);
+        waitUs = 0;
+        return true;
+    }
+
+    // Statistics of the last (or running) round.
+    const Stats& getStats() const { return stats; }
+    size_t getSlotCount() const { return slotCount; }
+
+private:
+    struct Read {
+        uint8_t channel;
+        uint8_t order;      // Gray-code rank of the mux channel, 0 for direct reads
+        int pin;
+    };
+
+    struct Conversion {
+        uint8_t channel;
+        uint8_t slot;
+        uint8_t chip;
+        uint8_t input;
+        bool started;
+    };
+
+    std::array<int, SELECT_LINES> select{};
+    size_t selectCount = 0;
+    std::array<int, IoChannel::MAX_MUXES> signal{};
+    size_t signalCount = 0;
+    int selectState = -1;   // -1 until the select lines were first driven
+
+    std::array<Read, MAX_CHANNELS> direct;
+    std::array<Read, MAX_CHANNELS> mux;
+    std::array<Conversion, MAX_CHANNELS> ads;
+    size_t directCount = 0;
+    size_t muxCount = 0;
+    size_t adsCount = 0;
+    size_t slotCount = 0;
+
+    size_t step = 0;
+    int64_t roundStartUs = 0;
+    int64_t slotStartUs = 0;
+    Stats stats;
+
+    // Position of a mux channel in the sequence 0, 1, 3, 2, 6, 7, 5, 4, ... (inverse Gray code).
+    static uint8_t grayRank(uint8_t channel) {
+        uint8_t rank = channel;
+        for (uint8_t shift = channel >> 1; shift; shift >>= 1) rank ^= shift;
+        return rank;
+    }
+
+    static uint8_t channelAt(uint8_t rank) {
+        return rank ^ (rank >> 1);
+    }
+
+    template<typename Sink>
+    void readMuxes(Sink& sink) {
+        for (size_t i = 0; i < muxCount; ++i) {
+            const uint8_t channel = channelAt(mux[i].order);
+            if (channel != selectState) {
+                selectMuxChannel(channel);
+            }
+            stats.muxReads++;
+            sink(mux[i].channel, static_cast<uint16_t>(analogRead(mux[i].pin)));
+        }
+    }
+
+    // Drives only the select lines that differ from the current channel.
+    void selectMuxChannel(uint8_t channel) {
+        const int changed = selectState < 0 ? 0x0F : (channel ^ selectState);
+        for (size_t line = 0; line < SELECT_LINES; ++line) {
+            if (changed & (1 << line)) {
+                digitalWrite(select[line], (channel >> line) & 1 ? HIGH : LOW);
+                stats.selectPinWrites++;
+            }
+        }
+        selectState = channel;
+        stats.muxSwitches++;
+        delayMicroseconds(MUX_SETTLE_US);
+    }
+
+    void startSlot(I2CBus* bus, size_t slot) {
+        if (slot >= slotCount) return;
+        slotStartUs = esp_timer_get_time();
+        stats.conversionSlots++;
+        for (size_t i = 0; i < adsCount; ++i) {
+            if (ads[i].slot != slot) continue;
+            ads[i].started = bus != nullptr &&
+                             Ads1115::startConversion(*bus, IoChannel::ADS1115_ADDRESS + ads[i].chip, ads[i].input);
+            if (ads[i].started) {
+                stats.conversions++;
+            } else {
+                stats.errors++;
+            }
+        }
+    }
+
+    // Inputs whose conversion did not start, or whose result could not be read, miss this round.
+    template<typename Sink>
+    void collectSlot(I2CBus* bus, size_t slot, Sink& sink) {
+        for (size_t i = 0; i < adsCount; ++i) {
+            if (ads[i].slot != slot || !ads[i].started) continue;
+            uint16_t value = 0;
+            if (bus != nullptr && Ads1115::readConversion(*bus, IoChannel::ADS1115_ADDRESS + ads[i].chip, value)) {
+                sink(ads[i].channel, value);
+            } else {
+                stats.errors++;
+            }
+        }
+    }
+};
+
+#endif // SCAN_PLANNER_H
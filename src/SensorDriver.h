@@ -0,0 +1,199 @@
+#ifndef SENSOR_DRIVER_H
+#define SENSOR_DRIVER_H
+
+#include <cstdint>
+#include <tuple>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "I2CBus.h"
+
+/**
+ * @brief Environment values collected from the drivers in one cycle.
+ *
+ * Each driver fills the fields it measures and sets their bits in validMask.
+ */
+struct EnvironmentReading {
+    enum : uint8_t { TEMPERATURE = 0x01, PRESSURE = 0x02, HUMIDITY = 0x04 };
+
+    uint8_t validMask = 0;
+    float temperature = 0.0f;   // °C
+    float pressure = 0.0f;      // hPa
+    float humidity = 0.0f;      // %RH
+
+    bool has(uint8_t field) const { return validMask & field; }
+};
+
+/**
+ * @class SensorDriver
+ * @brief CRTP base for sensor drivers: a non-blocking measurement state machine.
+ *
+ * start() begins a measurement, poll() advances it once the time the driver asked for has
+ * passed, and read() adds the last completed values to an EnvironmentReading. The derived class
+ * supplies, as private members made visible with `friend class SensorDriver<Derived>`:
+ *
+ * - `bool probe(I2CBus&)`: detect the device and load its calibration
+ * - `bool startMeasurement()`: kick off the first step, then call waitUs()
+ * - `bool continueMeasurement()`: run the next step; call waitUs() and return false to go on,
+ *   return finish() when done or fail() on an error
+ * - `void fill(EnvironmentReading&) const`: copy out the last completed values
+ *
+ * All calls are resolved at compile time, and drivers keep their state in members, so the
+ * per-cycle path has no virtual calls and no heap allocations.
+ */
+template<typename Derived>
+class SensorDriver {
+public:
+    // Detects the device. Drivers that are not on the I2C bus ignore the argument.
+    bool begin(I2CBus& bus) {
+        return setPresent(derived().probe(bus));
+    }
+
+    // Starts a measurement unless one is running. Returns false if the device is absent or the start failed.
+    bool start() {
+        if (!present) return false;
+        if (measuring) return true;
+        measuring = true;
+        return derived().startMeasurement() || fail();
+    }
+
+    /**
+     * @brief Advances the measurement without waiting.
+     * @return true once, when a measurement has just been completed
+     */
+    bool poll() {
+        if (!measuring || esp_timer_get_time() < readyAtUs) return false;
+        return derived().continueMeasurement();
+    }
+
+    // Adds the values of the last completed measurement, if there ever was one.
+    void read(EnvironmentReading& out) const {
+        if (hasReading) derived().fill(out);
+    }
+
+    bool isPresent() const { return present; }
+    bool isBusy() const { return measuring; }
+    uint32_t getErrors() const { return errors; }
+
+    // Time until the next step is due, 0 when idle or already due.
+    uint32_t usUntilReady() const {
+        if (!measuring) return 0;
+        const int64_t remaining = readyAtUs - esp_timer_get_time();
+        return remaining > 0 ? static_cast<uint32_t>(remaining) : 0;
+    }
+
+protected:
+    bool setPresent(bool found) {
+        measuring = false;
+        present = found;
+        return found;
+    }
+
+    void waitUs(uint32_t us) {
+        readyAtUs = esp_timer_get_time() + us;
+    }
+
+    bool finish() {
+        measuring = false;
+        hasReading = true;
+        return true;
+    }
+
+    // The previous values stay readable after a failed measurement.
+    bool fail() {
+        errors++;
+        measuring = false;
+        return false;
+    }
+
+private:
+    bool present = false;
+    bool measuring = false;
+    bool hasReading = false;
+    int64_t readyAtUs = 0;
+    uint32_t errors = 0;
+
+    Derived& derived() { return static_cast<Derived&>(*this); }
+    const Derived& derived() const { return static_cast<const Derived&>(*this); }
+};
+
+/**
+ * @class SensorRegistry
+ * @brief A fixed set of drivers, chosen at compile time, measured together.
+ *
+ * measure() starts every present driver, then sleeps until the earliest pending step and polls
+ * them all, so conversions overlap and a cycle lasts as long as its slowest driver. When several
+ * drivers report the same quantity, the one listed first wins.
+ */
+template<typename... Drivers>
+class SensorRegistry {
+public:
+    template<typename Driver>
+    Driver& get() { return std::get<Driver>(drivers); }
+
+    template<typename Driver>
+    const Driver& get() const { return std::get<Driver>(drivers); }
+
+    // Returns how many drivers found their device.
+    size_t beginAll(I2CBus& bus) {
+        return (static_cast<size_t>(std::get<Drivers>(drivers).begin(bus)) + ... + 0);
+    }
+
+    /**
+     * @brief Runs one measurement on every present driver, yielding while they convert.
+     * @return false if any present driver failed this cycle
+     */
+    bool measure() {
+        bool ok = (startOne(std::get<Drivers>(drivers)) & ... & true);
+        while ((std::get<Drivers>(drivers).isBusy() || ...)) {
+            vTaskDelay(pdMS_TO_TICKS((usUntilReady() + 999) / 1000));
+            (pollOne(std::get<Drivers>(drivers), ok), ...);
+        }
+        return ok;
+    }
+
+    // Earliest pending step over all busy drivers.
+    uint32_t usUntilReady() const {
+        uint32_t earliest = UINT32_MAX;
+        (earliestOf(std::get<Drivers>(drivers), earliest), ...);
+        return earliest == UINT32_MAX ? 0 : earliest;
+    }
+
+    EnvironmentReading collect() const {
+        EnvironmentReading out;
+        // Reverse order so the first driver's values are written last
+        collectReversed<sizeof...(Drivers)>(out);
+        return out;
+    }
+
+private:
+    std::tuple<Drivers...> drivers;
+
+    template<typename Driver>
+    static bool startOne(Driver& driver) {
+        return !driver.isPresent() || driver.start();
+    }
+
+    template<typename Driver>
+    static void pollOne(Driver& driver, bool& ok) {
+        if (!driver.isBusy()) return;
+        const uint32_t errors = driver.getErrors();
+        driver.poll();
+        if (driver.getErrors() != errors) ok = false;
+    }
+
+    template<typename Driver>
+    static void earliestOf(const Driver& driver, uint32_t& earliest) {
+        if (driver.isBusy() && driver.usUntilReady() < earliest) earliest = driver.usUntilReady();
+    }
+
+    template<size_t N>
+    void collectReversed(EnvironmentReading& out) const {
+        if constexpr (N > 0) {
+            std::get<N - 1>(drivers).read(out);
+            collectReversed<N - 1>(out);
+        }
+    }
+};
+
+#endif // SENSOR_DRIVER_H
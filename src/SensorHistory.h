@@ -0,0 +1,278 @@
+#ifndef SENSOR_HISTORY_H
+#define SENSOR_HISTORY_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include "globals.h"
+
+/**
+ * @class HistoryTier
+ * @brief Fixed-capacity ring of time buckets averaging the sensor readings that fall into them.
+ *
+ * A bucket holds moisture in half-percent steps (one byte per channel), temperature in tenths
+ * of a degree and pressure in tenths of hPa: 36 bytes per bucket. Buckets with no samples
+ * (e.g. while the sensor task was stalled) are kept as gaps so the series stays evenly spaced.
+ */
+template<size_t Capacity>
+class HistoryTier {
+public:
+    static constexpr uint8_t NO_MOISTURE = 0xFF;
+    static constexpr int16_t NO_TEMPERATURE = INT16_MIN;
+    static constexpr uint16_t NO_PRESSURE = 0;
+
+    struct Bucket {
+        std::array<uint8_t, ConfigConstants::MAX_SYSTEM_SIZE> moisture;
+        int16_t temperature;
+        uint16_t pressure;
+    };
+
+    explicit HistoryTier(uint32_t bucketSeconds) : bucketSeconds(bucketSeconds) {}
+
+    uint32_t getBucketSeconds() const { return bucketSeconds; }
+
+    void add(uint32_t nowSeconds, const std::array<int16_t, ConfigConstants::MAX_SYSTEM_SIZE>& moistureTenths,
+             uint32_t validMask, float temperature, float pressure) {
+        const int64_t index = nowSeconds / bucketSeconds;
+        if (current.index < 0) {
+            current.reset(index);
+        } else if (index > current.index) {
+            push(current.finish());
+            const int64_t gap = std::min<int64_t>(index - current.index - 1, Capacity);
+            for (int64_t i = 0; i < gap; ++i) {
+                push(Accumulator::empty());
+            }
+            current.reset(index);
+        }
+
+        for (size_t ch = 0; ch < moistureTenths.size(); ++ch) {
+            if (validMask & (1u << ch)) {
+                current.moistureSum[ch] += std::clamp<int32_t>(moistureTenths[ch], 0, 1000);
+                current.moistureCount[ch]++;
+            }
+        }
+        current.temperatureSum += static_cast<int32_t>(temperature * 10.0f);
+        current.pressureSum += static_cast<uint32_t>(pressure * 10.0f);
+        current.environmentCount++;
+    }
+
+    // Number of buckets available, including the one still being filled.
+    size_t size() const {
+        return count + (current.index >= 0 ? 1 : 0);
+    }
+
+    // Oldest first; the last bucket is the partially filled current one.
+    Bucket at(size_t i) const {
+        if (i == count) {
+            return current.finish();
+        }
+        return buckets[(head + Capacity - count + i) % Capacity];
+    }
+
+    // The series as of nowSeconds: the buckets above, followed by gaps for the buckets that passed
+    // since the last add(), with the oldest dropped as add() would drop them.
+    size_t size(uint32_t nowSeconds) const {
+        return std::min(size() + trailingGaps(nowSeconds), Capacity + 1);
+    }
+
+    Bucket at(size_t i, uint32_t nowSeconds) const {
+        const size_t stored = size();
+        const size_t skip = stored + trailingGaps(nowSeconds) - size(nowSeconds);
+        return i + skip < stored ? at(i + skip) : Accumulator::empty();
+    }
+
+private:
+    struct Accumulator {
+        int64_t index = -1;
+        std::array<uint32_t, ConfigConstants::MAX_SYSTEM_SIZE> moistureSum{};
+        std::array<uint16_t, ConfigConstants::MAX_SYSTEM_SIZE> moistureCount{};
+        int32_t temperatureSum = 0;
+        uint32_t pressureSum = 0;
+        uint16_t environmentCount = 0;
+
+        void reset(int64_t newIndex) {
+            *this = Accumulator();
+            index = newIndex;
+        }
+
+        static Bucket empty() {
+            Bucket bucket;
+            bucket.moisture.fill(NO_MOISTURE);
+            bucket.temperature = NO_TEMPERATURE;
+            bucket.pressure = NO_PRESSURE;
+            return bucket;
+        }
+
+        Bucket finish() const {
+            Bucket bucket = empty();
+            for (size_t ch = 0; ch < moistureSum.size(); ++ch) {
+                if (moistureCount[ch] > 0) {
+                    // tenths of a percent -> half-percent steps, rounded
+                    bucket.moisture[ch] = static_cast<uint8_t>((moistureSum[ch] / moistureCount[ch] + 2) / 5);
+                }
+            }
+            if (environmentCount > 0) {
+                bucket.temperature = static_cast<int16_t>(temperatureSum / environmentCount);
+                bucket.pressure = static_cast<uint16_t>(pressureSum / environmentCount);
+            }
+            return bucket;
+        }
+    };
+
+    const uint32_t bucketSeconds;
+    std::array<Bucket, Capacity> buckets;
+    size_t head = 0;
+    size_t count = 0;
+    Accumulator current;
+
+    size_t trailingGaps(uint32_t nowSeconds) const {
+        const int64_t index = nowSeconds / bucketSeconds;
+        if (current.index < 0 || index <= current.index) return 0;
+        return static_cast<size_t>(std::min<int64_t>(index - current.index - 1, Capacity)) + 1;
+    }
+
+    void push(const Bucket& bucket) {
+        buckets[head] = bucket;
+        head = (head + 1) % Capacity;
+        if (count < Capacity) count++;
+    }
+};
+
+/**
+ * @class SensorHistory
+ * @brief In-RAM multi-resolution history of the sensor snapshots.
+ *
+ * Three tiers are fed from every update, each averaging into its own bucket size:
+ * - "hour":  1-minute buckets for the last hour (raw at the default 60 s update interval)
+ * - "day":   5-minute buckets for the last 24 hours
+ * - "month": 1-hour buckets for the last 30 days
+ * The RAM budget is fixed at compile time, about 38 KB for 32 channels. Buckets are aligned to
+ * wall-clock (unix) seconds, the same clock the series are written for.
+ *
+ * @note Fed by the sensor task and read by the web server, guarded by its own mutex.
+ */
+class SensorHistory {
+public:
+    enum class Range { HOUR, DAY, MONTH };
+
+    static constexpr size_t HOUR_BUCKETS = 60;
+    static constexpr size_t DAY_BUCKETS = 288;
+    static constexpr size_t MONTH_BUCKETS = 720;
+
+    void add(uint32_t nowSeconds, const std::array<int16_t, ConfigConstants::MAX_SYSTEM_SIZE>& moistureTenths,
+             uint32_t validMask, float temperature, float pressure) {
+        std::lock_guard<std::mutex> lock(mutex);
+        hour.add(nowSeconds, moistureTenths, validMask, temperature, pressure);
+        day.add(nowSeconds, moistureTenths, validMask, temperature, pressure);
+        month.add(nowSeconds, moistureTenths, validMask, temperature, pressure);
+    }
+
+    static bool parseRange(const char* name, Range& range) {
+        if (strcmp(name, "hour") == 0) { range = Range::HOUR; return true; }
+        if (strcmp(name, "day") == 0) { range = Range::DAY; return true; }
+        if (strcmp(name, "month") == 0) { range = Range::MONTH; return true; }
+        return false;
+    }
+
+    /**
+     * @brief Stream one range as compact JSON without building a document in RAM.
+     *
+     * Output: {"range":"day","interval":600,"end":<endTime>,"moisture":[[..],..],"temperature":[..],"pressure":[..]}
+     * with one moisture array per channel, values with one decimal and null for gaps. The last value
+     * is the bucket holding endTime; buckets since the last sample are written as gaps.
+     * Consecutive buckets are averaged so that at most maxPoints values are returned per series.
+     *
+     * @tparam Out Anything with print(const char*), e.g. AsyncResponseStream
+     */
+    template<typename Out>
+    void writeJson(Out& out, Range range, size_t maxPoints, size_t channels, uint32_t endTime) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        switch (range) {
+            case Range::HOUR: writeTier(out, "hour", hour, maxPoints, channels, endTime); break;
+            case Range::DAY: writeTier(out, "day", day, maxPoints, channels, endTime); break;
+            case Range::MONTH: writeTier(out, "month", month, maxPoints, channels, endTime); break;
+        }
+    }
+
+private:
+    mutable std::mutex mutex;
+    HistoryTier<HOUR_BUCKETS> hour{60};
+    HistoryTier<DAY_BUCKETS> day{300};
+    HistoryTier<MONTH_BUCKETS> month{3600};
+
+    template<typename Out>
+    static void printTenths(Out& out, int32_t sum, int32_t n) {
+        if (n == 0) {
+            out.print("null");
+            return;
+        }
+        const int32_t tenths = (sum >= 0 ? sum + n / 2 : sum - n / 2) / n;
+        char buf[16];
+        if (tenths % 10 == 0) {
+            snprintf(buf, sizeof(buf), "%ld", static_cast<long>(tenths / 10));
+        } else {
+            snprintf(buf, sizeof(buf), "%s%ld.%ld", tenths < 0 ? "-" : "", static_cast<long>(std::abs(tenths) / 10),
+                     static_cast<long>(std::abs(tenths) % 10));
+        }
+        out.print(buf);
+    }
+
+    template<typename Out, typename Tier, typename Value>
+    static void writeSeries(Out& out, const Tier& tier, size_t group, uint32_t endTime, Value value) {
+        const size_t total = tier.size(endTime);
+        out.print("[");
+        for (size_t start = 0; start < total; start += group) {
+            int32_t sum = 0;
+            int32_t n = 0;
+            for (size_t i = start; i < start + group && i < total; ++i) {
+                int32_t v;
+                if (value(tier.at(i, endTime), v)) {
+                    sum += v;
+                    n++;
+                }
+            }
+            if (start > 0) out.print(",");
+            printTenths(out, sum, n);
+        }
+        out.print("]");
+    }
+
+    template<typename Out, typename Tier>
+    static void writeTier(Out& out, const char* name, const Tier& tier, size_t maxPoints, size_t channels, uint32_t endTime) {
+        using Bucket = typename Tier::Bucket;
+        const size_t total = tier.size(endTime);
+        const size_t group = (maxPoints == 0 || total <= maxPoints) ? 1 : (total + maxPoints - 1) / maxPoints;
+
+        char buf[96];
+        snprintf(buf, sizeof(buf), "{\"range\":\"%s\",\"interval\":%lu,\"end\":%lu,\"moisture\":[", name,
+                 static_cast<unsigned long>(tier.getBucketSeconds() * group), static_cast<unsigned long>(endTime));
+        out.print(buf);
+        for (size_t ch = 0; ch < channels && ch < ConfigConstants::MAX_SYSTEM_SIZE; ++ch) {
+            if (ch > 0) out.print(",");
+            writeSeries(out, tier, group, endTime, [ch](const Bucket& b, int32_t& v) {
+                if (b.moisture[ch] == Tier::NO_MOISTURE) return false;
+                v = b.moisture[ch] * 5;
+                return true;
+            });
+        }
+        out.print("],\"temperature\":");
+        writeSeries(out, tier, group, endTime, [](const Bucket& b, int32_t& v) {
+            if (b.temperature == Tier::NO_TEMPERATURE) return false;
+            v = b.temperature;
+            return true;
+        });
+        out.print(",\"pressure\":");
+        writeSeries(out, tier, group, endTime, [](const Bucket& b, int32_t& v) {
+            if (b.pressure == Tier::NO_PRESSURE) return false;
+            v = b.pressure;
+            return true;
+        });
+        out.print("}");
+    }
+};
+
+#endif // SENSOR_HISTORY_H
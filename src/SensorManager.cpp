@@ -1,24 +1,20 @@
-// Sensor Abstraction: Consider creating a base Sensor class with derived classes for different sensor types. 
-// This would make it easier to add new types of sensors in the future.
-// Calibration: For the moisture sensors, we might want to add a calibration mechanism.
-
 #include "SensorManager.h"
+#include "SensorTrace.h"
 
 SensorManager::SensorManager(ConfigManager& configManager)
     : configManager(configManager), 
     
       logger(Logger::instance()), 
       sensorTaskHandle(nullptr) {
-        sizeMoistureData();
-      }
+    drivers.get<MoistureSampler>().begin();
+}
 
 void SensorManager::sensorTaskFunction(void* pvParameters) {
     SensorManager* manager = static_cast<SensorManager*>(pvParameters);
-    int systemSize = manager->configManager.getHwConfig().systemSize.value();
     while (true) {
         manager->updateSensorData();
-        uint32_t updateInterval = manager->configManager.getSwConfig().sensorUpdateInterval.value();
-        vTaskDelay(pdMS_TO_TICKS(updateInterval));
+        // Sleeps until the next scheduled update, or until setActuating() wakes the task early
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(manager->scheduleNextSample()));
     }
 }
 
@@ -33,6 +29,7 @@ void SensorManager::startSensorTask() {
             &sensorTaskHandle,
             1
         );
+        floatSwitch.startTask();
         logger.log("SensorManager", LogLevel::INFO, "Sensor task started");
     } else {
         logger.log("SensorManager", LogLevel::WARNING, "Sensor task already running");
@@ -40,85 +37,257 @@ void SensorManager::startSensorTask() {
 }
 
 void SensorManager::setupFloatSwitch() {
-    const auto& hwConfig = configManager.getHwConfig();
-    floatSwitchPin = hwConfig.floatSwitchPin.value();
-    pinMode(floatSwitchPin, INPUT_PULLUP);
-    logger.log("SensorManager", LogLevel::INFO, "Float switch setup on pin %d", floatSwitchPin);
+    floatSwitch.begin(configManager.getHwConfig().floatSwitchPin.value());
 }
 
-void SensorManager::setupSensors() {
-    const auto& hwConfig = configManager.getHwConfig();
-    Wire.begin(hwConfig.sdaPin.value(), hwConfig.sclPin.value());
-    logger.log("SensorManager", LogLevel::INFO, "I2C initialized on SDA: %d, SCL: %d", hwConfig.sdaPin.value(), hwConfig.sclPin.value());
+void SensorManager::setWaterLevelCallback(FloatSwitch::LevelCallback callback) {
+    waterLevelCallback = std::move(callback);
+    floatSwitch.setCallback([this](bool waterOk) {
+        if (trace != nullptr) {
+            trace->recordFloatSwitch(waterOk);
+        }
+        if (waterLevelCallback) {
+            waterLevelCallback(waterOk);
+        }
+    });
+}
+
+void SensorManager::setTrace(SensorTraceWriter* writer) {
+    MoistureSampler& sampler = drivers.get<MoistureSampler>();
+    Bmp085& bmp = drivers.get<Bmp085>();
+    trace = writer;
+    if (writer == nullptr) {
+        sampler.setSampleTap(nullptr, nullptr);
+        bmp.setRawTap(nullptr, nullptr);
+        return;
+    }
+
+    SensorTraceConfig config = SensorTraceConfig::fromConfig(configManager);
+    config.bmpPresent = bmp.isPresent();
+    config.bmpCalibration = bmp.getCalibrationRaw();
+    if (!writer->begin(config)) {
+        logger.log("SensorManager", LogLevel::ERROR, "Could not start the sensor trace");
+        trace = nullptr;
+        return;
+    }
+    writer->recordFloatSwitch(floatSwitch.isWaterOk());
+    sampler.setSampleTap([](void* context, size_t channel, uint16_t value) {
+        static_cast<SensorTraceWriter*>(context)->recordAdcSample(channel, value);
+    }, writer);
+    bmp.setRawTap([](void* context, uint16_t ut, uint32_t result, uint8_t oversampling) {
+        static_cast<SensorTraceWriter*>(context)->recordBmp085(ut, result, oversampling);
+    }, writer);
+    if (!waterLevelCallback) {
+        setWaterLevelCallback(nullptr);
+    }
+    logger.log("SensorManager", LogLevel::INFO, "Sensor trace started");
+}
+
+bool SensorManager::settleFloatSwitch() {
+    return floatSwitch.settle();
+}
 
-    if (!bmp.begin()) {
+void SensorManager::setupSensors(I2CBus& i2cBus) {
+    const auto& hwConfig = configManager.getHwConfig();
+    drivers.get<Bmp085>().setOversampling(configManager.getSwConfig().bmpOversampling.value());
+    const size_t found = drivers.beginAll(i2cBus);
+    if (!drivers.get<Bmp085>().isPresent()) {
         logger.log("SensorManager", LogLevel::ERROR, "Could not find a valid BMP085 sensor, check wiring!");
         while (1) {}
     }
-    logger.log("SensorManager", LogLevel::INFO, "BMP085 sensor initialized");
+    logger.log("SensorManager", LogLevel::INFO, "%zu sensor drivers initialized", found);
 
+    bool usesMux = false;
     for (size_t i = 0; i < hwConfig.systemSize.value(); ++i) {
         const auto& sensorConfig = configManager.getSensorConfig(i);
         const auto& sensorPins = configManager.getHwConfig().moistureSensorPins;
         if (sensorConfig.sensorEnabled) {
-            pinMode(hwConfig.moistureSensorPins[i], INPUT);
+            const IoChannel::Channel io = IoChannel::decodeInput(sensorPins[i]);
+            if (io.kind == IoChannel::Kind::GPIO) {
+                pinMode(io.pin, INPUT);
+            } else if (io.kind == IoChannel::Kind::MUX) {
+                usesMux = true;
+            } else if (io.kind == IoChannel::Kind::NONE) {
+                logger.log("SensorManager", LogLevel::ERROR, "Moisture sensor %zu has an invalid pin %d", i, sensorPins[i]);
+                continue;
+            }
             logger.log("SensorManager", LogLevel::INFO, "Moisture sensor %zu enabled on pin %d", i, sensorPins[i]);
         }
     }
+
+    if (usesMux) {
+        for (int pin : hwConfig.muxSelectPins) {
+            pinMode(pin, OUTPUT);
+        }
+        for (int pin : hwConfig.muxSignalPins) {
+            pinMode(pin, INPUT);
+        }
+    }
 }
 
+// All drivers measure together: the moisture channels are sampled in one interleaved scan while the
+// I2C sensors convert. The readings are collected into `data`, which only the sensor task touches.
+// Readers see it once the finished snapshot is published.
 void SensorManager::updateSensorData() {
-    std::unique_lock<std::shared_mutex> lock(dataMutex);
     const auto& hwConfig = configManager.getHwConfig();
-    
-    for (size_t i = 0; i < hwConfig.systemSize.value(); ++i) {
-        const bool sensorEnabled = configManager.getSensorConfig(i).sensorEnabled.value();
-        if (sensorEnabled) {
-            data.moisture[i] = readMoistureSensor(hwConfig.moistureSensorPins[i]);
+    const size_t systemSize = hwConfig.systemSize.value();
+
+    scanEnabled.resize(systemSize);
+    for (size_t i = 0; i < systemSize; ++i) {
+        scanEnabled[i] = configManager.getSensorConfig(i).sensorEnabled.value();
+    }
+    MoistureSampler& sampler = drivers.get<MoistureSampler>();
+    sampler.setMuxPins(hwConfig.muxSelectPins, hwConfig.muxSignalPins);
+    sampler.configure(hwConfig.moistureSensorPins, scanEnabled);
+    drivers.get<Bmp085>().setOversampling(configManager.getSwConfig().bmpOversampling.value());
+    if (!drivers.measure()) {
+        logger.log("SensorManager", LogLevel::WARNING, "Sensor driver error, keeping previous environment values");
+    }
+    const std::vector<uint16_t>& scanAverages = sampler.getAverages();
+    const uint32_t sampledMask = sampler.getSampledMask();
+
+    const auto filterMode = static_cast<MoistureFilter::Mode>(configManager.getSwConfig().moistureFilter.value());
+    largestChangeTenths = 0;
+    for (size_t i = 0; i < SensorData::MAX_CHANNELS; ++i) {
+        const bool enabled = i < systemSize && scanEnabled[i];
+        const bool wasValid = data.isValid(i);
+        const int16_t previous = data.moistureTenths[i];
+        data.setEnabled(i, enabled);
+        const uint32_t bit = 1u << i;
+        if (enabled && !(sampledMask & bit)) {
+            // Its average is stale (0 on the first scan, which would read as soaking wet)
+            data.setFailed(i);
+            if (!(failedMask & bit)) {
+                logger.log("SensorManager", LogLevel::ERROR, "Moisture sensor %zu returned no samples", i);
+            }
+            failedMask |= bit;
+            continue;
+        }
+        failedMask &= ~bit;
+        if (enabled) {
+            filters[i].setMode(filterMode);
+            data.moistureRaw[i] = scanAverages[i];
+            data.setMoistureTenths(i, filters[i].update(toMoistureTenths(i, scanAverages[i])));
+            if (wasValid) {
+                largestChangeTenths = std::max<int16_t>(largestChangeTenths, std::abs(data.moistureTenths[i] - previous));
+            }
+        } else {
+            filters[i].reset();
         }
     }
 
-    data.temperature = bmp.readTemperature();
-    const auto& swConfig = configManager.getSwConfig();
-    data.temperature += swConfig.tempOffset.value();
-    data.pressure = bmp.readPressure() / 100.0F;
+    applyEnvironment(drivers.collect());
     data.waterLevel = checkWaterLevel();
 
+    data.publishedUs = esp_timer_get_time();
+    snapshot.store(data);
+    TaskHandle_t listener = snapshotListener.load();
+    if (listener != nullptr) {
+        xTaskNotifyGive(listener);
+    }
+    if (trace != nullptr) {
+        trace->recordScan(data);
+    }
+    history.add(static_cast<uint32_t>(time(nullptr)), data.moistureTenths, data.validMask,
+                data.temperature, data.pressure);
+    if (updateCallback) {
+        updateCallback(data);
+    }
+
     logger.log("SensorManager", LogLevel::DEBUG, "Sensor data updated: Temp: %.2f°C, Pressure: %.2f hPa, Water Level: %s", 
                data.temperature, data.pressure, data.waterLevel ? "OK" : "Low");
 }
 
-const SensorData& SensorManager::getSensorData() const {
-    std::shared_lock<std::shared_mutex> lock(dataMutex);
-    return data;
+uint32_t SensorManager::scheduleNextSample() {
+    const uint32_t maxInterval = configManager.getSwConfig().sensorUpdateInterval.value();
+    const uint32_t interval = scheduler.next(maxInterval, actuating.load(), largestChangeTenths);
+    if (interval != sampleIntervalMs.load()) {
+        logger.log("SensorManager", LogLevel::DEBUG, "Next sensor update in %lu ms", static_cast<unsigned long>(interval));
+    }
+    sampleIntervalMs.store(interval);
+    return interval;
+}
+
+uint32_t SensorManager::getSampleInterval() const {
+    return sampleIntervalMs.load();
 }
 
-float SensorManager::readMoistureSensor(int sensorPin) {
-    const int SAMPLES = 10;
-    float sum = 0;
-    for (int i = 0; i < SAMPLES; i++) {
-        sum += analogRead(sensorPin);
-        vTaskDelay(pdMS_TO_TICKS(10));
+void SensorManager::setActuating(bool active) {
+    const bool wasActive = actuating.exchange(active);
+    if (active && !wasActive && sensorTaskHandle != nullptr) {
+        xTaskNotifyGive(sensorTaskHandle);
     }
-    float average = sum / SAMPLES;
-    // change the map function to match your sensor's range
-    float moisturePercentage = map(average, 2592, 975, 0, 100);
-    logger.log("SensorManager", LogLevel::DEBUG, "Moisture sensor on pin %d read: %.2f%%", sensorPin, moisturePercentage);
-    return moisturePercentage;
 }
 
-bool SensorManager::checkWaterLevel() {
-    vTaskDelay(pdMS_TO_TICKS(10));  // Delay for switch debounce if needed
-    bool waterLevel = digitalRead(floatSwitchPin);
-    logger.log("SensorManager", LogLevel::DEBUG, "Water level check: %s", waterLevel ? "Low" : "OK");
-    return waterLevel;
+void SensorManager::setUpdateCallback(UpdateCallback callback) {
+    updateCallback = std::move(callback);
+}
+
+void SensorManager::setSnapshotListener(TaskHandle_t task) {
+    snapshotListener.store(task);
 }
 
-void SensorManager::sizeMoistureData() {
-    const auto size = configManager.getHwConfig().systemSize.value();
-    data.moisture.resize(size);
+SensorData SensorManager::getSensorData() const {
+    SensorData out = snapshot.load();
+    out.waterLevel = floatSwitch.isWaterOk();
+    return out;
+}
+
+uint32_t SensorManager::getSensorData(SensorData& out) const {
+    const uint32_t version = snapshot.load(out);
+    out.waterLevel = floatSwitch.isWaterOk();
+    return version;
+}
+
+uint32_t SensorManager::getSensorDataVersion() const {
+    return snapshot.version();
+}
+
+const SensorHistory& SensorManager::getHistory() const {
+    return history;
+}
+
+// The calibration is rebuilt only when the configured points change, so edits apply on the next scan.
+int16_t SensorManager::toMoistureTenths(size_t channel, uint16_t raw) {
+    const auto& sensorConfig = configManager.getSensorConfig(channel);
+    const int dryValue = sensorConfig.dryValue.value();
+    const int wetValue = sensorConfig.wetValue.value();
+    if (!calibration[channel].matches(dryValue, wetValue)) {
+        if (calibration[channel].set(dryValue, wetValue)) {
+            filters[channel].reset();  // old readings are on a different scale
+            logger.log("SensorManager", LogLevel::INFO, "Sensor %zu calibrated: dry %d, wet %d", channel, dryValue, wetValue);
+        } else {
+            logger.log("SensorManager", LogLevel::WARNING, "Ignoring invalid calibration for sensor %zu", channel);
+        }
+    }
+
+    const int16_t tenths = calibration[channel].toTenths(raw);
+    logger.log("SensorManager", LogLevel::DEBUG, "Moisture sensor %zu read: raw %u, %d.%d%%", channel, raw, tenths / 10, tenths % 10);
+    return tenths;
+}
+
+// Quantities no driver has measured yet keep their previous value.
+void SensorManager::applyEnvironment(const EnvironmentReading& reading) {
+    if (reading.has(EnvironmentReading::TEMPERATURE)) {
+        data.temperature = reading.temperature + configManager.getSwConfig().tempOffset.value();
+    }
+    if (reading.has(EnvironmentReading::PRESSURE)) {
+        data.pressure = reading.pressure;
+    }
+    if (reading.has(EnvironmentReading::HUMIDITY)) {
+        data.humidity = reading.humidity;
+    }
+}
+
+// Debounced by the float switch interrupt path, no delay or pin read needed here.
+bool SensorManager::checkWaterLevel() {
+    return floatSwitch.isWaterOk();
 }
 
 TaskHandle_t SensorManager::getTaskHandle() const {
     return sensorTaskHandle;
+}
+
+TaskHandle_t SensorManager::getFloatSwitchTaskHandle() const {
+    return floatSwitch.getTaskHandle();
 }
\ No newline at end of file
@@ -1,46 +1,167 @@
 #ifndef SENSORMANAGER_H
 #define SENSORMANAGER_H
 
-#include <mutex>
-#include <shared_mutex>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <ctime>
 #include <map>
-#include <Adafruit_BMP085.h>
+#include <Arduino.h>
+#include "Bmp085.h"
+#include "Bme280.h"
+#include "Ds18b20.h"
+#include "Sht3x.h"
+#include "SensorDriver.h"
 #include "ConfigManager.h"
+#include "FloatSwitch.h"
+#include "IoChannel.h"
+#include "MoistureCalibration.h"
+#include "MoistureFilter.h"
+#include "MoistureSampler.h"
+#include "SampleScheduler.h"
+#include "SeqLock.h"
+#include "SensorHistory.h"
+#include "esp_timer.h"
+#include "globals.h"
 #include "ESPLogger.h"
-#include <Wire.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <functional>
 #include <vector>
 
+/**
+ * @brief Fixed-size sensor snapshot, copied without touching the heap.
+ *
+ * Moisture is stored as tenths of a percent per channel, next to the averaged raw ADC reading it
+ * was converted from (shown to the user when calibrating). enabledMask and validMask hold one bit
+ * per channel: a channel is valid once the latest scan produced a reading for it.
+ * Trivially copyable so it can be published through a SeqLock.
+ */
 struct SensorData {
-    std::vector<float> moisture;
-    float temperature;
-    float pressure;
-    bool waterLevel;
+    static constexpr size_t MAX_CHANNELS = ConfigConstants::MAX_SYSTEM_SIZE;
+
+    std::array<int16_t, MAX_CHANNELS> moistureTenths{};
+    std::array<uint16_t, MAX_CHANNELS> moistureRaw{};
+    uint32_t enabledMask = 0;
+    uint32_t validMask = 0;
+    float temperature = 0.0f;
+    float pressure = 0.0f;
+    float humidity = NAN;       // NAN without a humidity sensor
+    bool waterLevel = false;
+    int64_t publishedUs = 0;    // esp_timer time the snapshot was published
+
+    float getMoisture(size_t channel) const {
+        return moistureTenths[channel] / 10.0f;
+    }
+
+    bool isEnabled(size_t channel) const {
+        return channel < MAX_CHANNELS && (enabledMask & (1u << channel));
+    }
+
+    bool isValid(size_t channel) const {
+        return channel < MAX_CHANNELS && (validMask & (1u << channel));
+    }
+
+    void setMoisture(size_t channel, float percent) {
+        const long tenths = lroundf(percent * 10.0f);
+        setMoistureTenths(channel, static_cast<int16_t>(std::clamp<long>(tenths, INT16_MIN, INT16_MAX)));
+    }
+
+    void setMoistureTenths(size_t channel, int16_t tenths) {
+        moistureTenths[channel] = tenths;
+        validMask |= (1u << channel);
+    }
+
+    // Enabled, but the latest scan produced no reading (e.g. its ADS1115 did not answer).
+    void setFailed(size_t channel) {
+        validMask &= ~(1u << channel);
+    }
+
+    void setEnabled(size_t channel, bool enabled) {
+        if (enabled) {
+            enabledMask |= (1u << channel);
+        } else {
+            enabledMask &= ~(1u << channel);
+            validMask &= ~(1u << channel);
+        }
+    }
 };
 
+static_assert(SensorData::MAX_CHANNELS <= 32, "SensorData channel masks are 32 bits wide");
+
+/**
+ * Drivers measured every cycle, resolved at compile time. To use other sensors, list them here,
+ * e.g. SensorRegistry<MoistureSampler, Sht3x, Bmp085> takes temperature and humidity from an
+ * SHT3x (listed first) and pressure from the BMP085. Drivers whose device is absent are skipped.
+ */
+using SensorDrivers = SensorRegistry<MoistureSampler, Bmp085>;
+
+class SensorTraceWriter;
+
 class SensorManager {
 private:
     SensorData data;
-    mutable std::shared_mutex dataMutex;
-    Adafruit_BMP085 bmp;
+    SeqLock<SensorData> snapshot;
+    SensorHistory history;
+    SensorDrivers drivers;
+    std::vector<bool> scanEnabled;
+    std::array<MoistureCalibration, SensorData::MAX_CHANNELS> calibration;
+    std::array<MoistureFilter, SensorData::MAX_CHANNELS> filters;
+    SampleScheduler scheduler;
+    int16_t largestChangeTenths = 0;
+    uint32_t failedMask = 0;        // channels whose last scan produced no samples, logged once
+    std::atomic<bool> actuating{false};
+    std::atomic<uint32_t> sampleIntervalMs{0};
     ConfigManager& configManager;
     Logger& logger;
     TaskHandle_t sensorTaskHandle;
-    int floatSwitchPin;
+    FloatSwitch floatSwitch;
+    std::function<void(const SensorData&)> updateCallback;
+    FloatSwitch::LevelCallback waterLevelCallback;
+    SensorTraceWriter* trace = nullptr;
+    std::atomic<TaskHandle_t> snapshotListener{nullptr};
 
     static void sensorTaskFunction(void* pvParameters);
-    float readMoistureSensor(int sensorPin);
+    int16_t toMoistureTenths(size_t channel, uint16_t raw);
     bool checkWaterLevel();
-    void updateSensorData();
-    void sizeMoistureData();
+    void applyEnvironment(const EnvironmentReading& reading);
 public:
+    using UpdateCallback = std::function<void(const SensorData&)>;
+
     SensorManager(ConfigManager& configManager);
+    // Called from the sensor task after every published update, e.g. to persist the reading.
+    void setUpdateCallback(UpdateCallback callback);
+    // Task notified (xTaskNotifyGive) after every published update; nullptr to stop.
+    void setSnapshotListener(TaskHandle_t task);
+    // One full sensor cycle, normally run by the sensor task. Public so host tests can drive it.
+    void updateSensorData();
+    // Delay before the next cycle, from relay activity and the change seen by the last cycle.
+    uint32_t scheduleNextSample();
+    uint32_t getSampleInterval() const;
+    // Called by RelayManager when a pump starts or stops; starting one wakes the sensor task.
+    void setActuating(bool active);
     void setupFloatSwitch();
-    void setupSensors();
-    const SensorData& getSensorData() const;
+    // Called from the float switch task as soon as a debounced level change is seen.
+    void setWaterLevelCallback(FloatSwitch::LevelCallback callback);
+    // Records the raw readings, float switch changes and snapshots into `writer`, which starts
+    // with the current configuration; nullptr to stop. Call before the sensor task starts.
+    void setTrace(SensorTraceWriter* writer);
+    // Runs one float switch debounce step. Public so host tests can drive it.
+    bool settleFloatSwitch();
+    // The bus must already be begun; the I2C drivers do all their I/O through it.
+    void setupSensors(I2CBus& i2cBus);
+    // Lock-free: readers get a consistent copy and never block the sensor task.
+    // waterLevel always reflects the float switch right now, not the last sensor cycle.
+    SensorData getSensorData() const;
+    // Same as above, also returning the snapshot version for change detection.
+    uint32_t getSensorData(SensorData& out) const;
+    // Incremented on every published update; compare with a previous value to detect new data.
+    uint32_t getSensorDataVersion() const;
+    const SensorHistory& getHistory() const;
     void startSensorTask();
     TaskHandle_t getTaskHandle() const;
+    TaskHandle_t getFloatSwitchTaskHandle() const;
 };
 
 #endif // SENSORMANAGER_H
\ No newline at end of file
@@ -0,0 +1,545 @@
+#ifndef SENSOR_TRACE_H
+#define SENSOR_TRACE_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "esp_timer.h"
+#include "ConfigManager.h"
+#include "SensorManager.h"
+
+/**
+ * @file SensorTrace.h
+ * @brief Capture of the raw sensor inputs of a live device, for bit-exact replay on the host.
+ *
+ * A trace holds what the firmware read from the hardware: every raw ADC sample of the moisture
+ * scans, the BMP085's raw UT and result register, float switch changes and relay switches. It
+ * also holds the snapshot the device computed from them. The native build can feed the inputs
+ * back through SensorManager and RelayManager and compare its snapshots with the recorded ones
+ * (see test/SensorTraceReplay.h).
+ *
+ * Format, all integers little endian:
+ *   header:  magic "GTR1" (4) | version (1) | config length (2) | SensorTraceConfig
+ *   record:  type (1) | µs since the previous record (LEB128, 1-5 bytes usually) | payload
+ *   ADC_SAMPLE:   channel (1) | raw value (2)
+ *   BMP085_RAW:   UT (2) | result register (3) | oversampling (1)
+ *   SCAN:         validMask (4) | temperature (4, float bits) | pressure (4, float bits)
+ *                 | water level (1) | moisture tenths (2, signed) per valid channel
+ *   FLOAT_SWITCH: water ok (1)
+ *   RELAY:        relay (1) | on (1)
+ * A 4-channel scan is 24 samples of 4-5 bytes plus an 8-byte BMP085 record and a 23-byte
+ * SCAN record, about 140 bytes. At one scan a minute that is about 200 KB a day.
+ *
+ * The settings that shape the pipeline (pins, calibration, filter, thresholds, power budget)
+ * are written once, at the start. A trace whose settings change while it is captured only
+ * replays exactly up to the change.
+ */
+
+struct SensorTraceConfig {
+    struct Zone {
+        int16_t pin = 0;
+        int16_t relayCurrent = 0;
+        bool sensorEnabled = false;
+        bool relayEnabled = false;
+        bool autoTune = false;
+        float threshold = 0.0f;
+        uint32_t activationPeriod = 0;
+        uint32_t wateringInterval = 0;
+        uint16_t dryValue = 0;
+        uint16_t wetValue = 0;
+        float targetMoisture = 0.0f;
+        float wateringGain = 0.0f;
+    };
+
+    uint8_t moistureFilter = 0;
+    uint8_t bmpOversampling = 0;
+    bool bmpPresent = false;
+    float tempOffset = 0.0f;
+    int16_t floatSwitchPin = 0;
+    int32_t powerBudget = 0;
+    int32_t inrushDelay = 0;
+    std::array<uint8_t, 22> bmpCalibration{};   // EEPROM bytes 0xAA..0xBF
+    std::vector<int> muxSelectPins;
+    std::vector<int> muxSignalPins;
+    std::vector<Zone> zones;
+
+    static SensorTraceConfig fromConfig(const ConfigManager& configManager) {
+        const auto& hw = configManager.getHwConfig();
+        const auto& sw = configManager.getSwConfig();
+        SensorTraceConfig config;
+        config.moistureFilter = static_cast<uint8_t>(sw.moistureFilter.value());
+        config.bmpOversampling = static_cast<uint8_t>(sw.bmpOversampling.value());
+        config.tempOffset = sw.tempOffset.value();
+        config.floatSwitchPin = static_cast<int16_t>(hw.floatSwitchPin.value());
+        config.powerBudget = hw.powerBudget.value();
+        config.inrushDelay = hw.inrushDelay.value();
+        config.muxSelectPins = hw.muxSelectPins;
+        config.muxSignalPins = hw.muxSignalPins;
+        config.zones.resize(hw.systemSize.value());
+        for (size_t i = 0; i < config.zones.size(); ++i) {
+            const auto& sensor = configManager.getSensorConfig(i);
+            Zone& zone = config.zones[i];
+            zone.pin = static_cast<int16_t>(hw.moistureSensorPins[i]);
+            zone.relayCurrent = static_cast<int16_t>(hw.relayCurrents[i]);
+            zone.sensorEnabled = sensor.sensorEnabled.value();
+            zone.relayEnabled = sensor.relayEnabled.value();
+            zone.autoTune = sensor.autoTune.value();
+            zone.threshold = sensor.threshold.value();
+            zone.activationPeriod = sensor.activationPeriod.value();
+            zone.wateringInterval = sensor.wateringInterval.value();
+            zone.dryValue = static_cast<uint16_t>(sensor.dryValue.value());
+            zone.wetValue = static_cast<uint16_t>(sensor.wetValue.value());
+            zone.targetMoisture = sensor.targetMoisture.value();
+            zone.wateringGain = sensor.wateringGain.value();
+        }
+        return config;
+    }
+
+    // Applies the settings; the caller sizes the system to zones.size() first.
+    void applyTo(ConfigManager& configManager) const {
+        ConfigTypes::HardwareConfig hw;
+        hw.floatSwitchPin = floatSwitchPin;
+        hw.powerBudget = powerBudget;
+        hw.inrushDelay = inrushDelay;
+        hw.muxSelectPins = muxSelectPins;
+        hw.muxSignalPins = muxSignalPins;
+        for (const Zone& zone : zones) {
+            hw.moistureSensorPins.push_back(zone.pin);
+            hw.relayCurrents.push_back(zone.relayCurrent);
+        }
+        configManager.setHardwareConfig(hw);
+
+        ConfigTypes::SoftwareConfig sw;
+        sw.moistureFilter = moistureFilter;
+        sw.bmpOversampling = bmpOversampling;
+        sw.tempOffset = tempOffset;
+        configManager.setSoftwareConfig(sw);
+
+        for (size_t i = 0; i < zones.size(); ++i) {
+            const Zone& zone = zones[i];
+            ConfigTypes::SensorConfig sensor;
+            sensor.sensorEnabled = zone.sensorEnabled;
+            sensor.relayEnabled = zone.relayEnabled;
+            sensor.autoTune = zone.autoTune;
+            sensor.threshold = zone.threshold;
+            sensor.activationPeriod = zone.activationPeriod;
+            sensor.wateringInterval = zone.wateringInterval;
+            sensor.dryValue = zone.dryValue;
+            sensor.wetValue = zone.wetValue;
+            sensor.targetMoisture = zone.targetMoisture;
+            sensor.wateringGain = zone.wateringGain;
+            configManager.setSensorConfig(sensor, i);
+        }
+    }
+
+    void encode(std::vector<uint8_t>& out) const {
+        out.push_back(static_cast<uint8_t>(zones.size()));
+        out.push_back(moistureFilter);
+        out.push_back(bmpOversampling);
+        out.push_back(bmpPresent ? 1 : 0);
+        putFloat(out, tempOffset);
+        put16(out, static_cast<uint16_t>(floatSwitchPin));
+        put32(out, static_cast<uint32_t>(powerBudget));
+        put32(out, static_cast<uint32_t>(inrushDelay));
+        out.insert(out.end(), bmpCalibration.begin(), bmpCalibration.end());
+        putPins(out, muxSelectPins);
+        putPins(out, muxSignalPins);
+        for (const Zone& zone : zones) {
+            put16(out, static_cast<uint16_t>(zone.pin));
+            put16(out, static_cast<uint16_t>(zone.relayCurrent));
+            out.push_back((zone.sensorEnabled ? 1 : 0) | (zone.relayEnabled ? 2 : 0) | (zone.autoTune ? 4 : 0));
+            putFloat(out, zone.threshold);
+            put32(out, zone.activationPeriod);
+            put32(out, zone.wateringInterval);
+            put16(out, zone.dryValue);
+            put16(out, zone.wetValue);
+            putFloat(out, zone.targetMoisture);
+            putFloat(out, zone.wateringGain);
+        }
+    }
+
+    bool decode(const uint8_t* data, size_t len) {
+        size_t pos = 0;
+        const auto need = [&](size_t n) { return pos + n <= len; };
+        if (!need(4 + 4 + 2 + 8 + 22)) return false;
+        zones.assign(data[pos++], Zone());
+        moistureFilter = data[pos++];
+        bmpOversampling = data[pos++];
+        bmpPresent = data[pos++] != 0;
+        tempOffset = getFloat(data + pos); pos += 4;
+        floatSwitchPin = static_cast<int16_t>(get16(data + pos)); pos += 2;
+        powerBudget = static_cast<int32_t>(get32(data + pos)); pos += 4;
+        inrushDelay = static_cast<int32_t>(get32(data + pos)); pos += 4;
+        memcpy(bmpCalibration.data(), data + pos, bmpCalibration.size()); pos += bmpCalibration.size();
+        if (!getPins(data, len, pos, muxSelectPins) || !getPins(data, len, pos, muxSignalPins)) return false;
+        for (Zone& zone : zones) {
+            if (!need(ZONE_BYTES)) return false;
+            zone.pin = static_cast<int16_t>(get16(data + pos)); pos += 2;
+            zone.relayCurrent = static_cast<int16_t>(get16(data + pos)); pos += 2;
+            const uint8_t flags = data[pos++];
+            zone.sensorEnabled = flags & 1;
+            zone.relayEnabled = flags & 2;
+            zone.autoTune = flags & 4;
+            zone.threshold = getFloat(data + pos); pos += 4;
+            zone.activationPeriod = get32(data + pos); pos += 4;
+            zone.wateringInterval = get32(data + pos); pos += 4;
+            zone.dryValue = get16(data + pos); pos += 2;
+            zone.wetValue = get16(data + pos); pos += 2;
+            zone.targetMoisture = getFloat(data + pos); pos += 4;
+            zone.wateringGain = getFloat(data + pos); pos += 4;
+        }
+        return pos == len;
+    }
+
+    static void put16(std::vector<uint8_t>& out, uint16_t v) {
+        out.push_back(static_cast<uint8_t>(v));
+        out.push_back(static_cast<uint8_t>(v >> 8));
+    }
+    static void put32(std::vector<uint8_t>& out, uint32_t v) {
+        put16(out, static_cast<uint16_t>(v));
+        put16(out, static_cast<uint16_t>(v >> 16));
+    }
+    static void putFloat(std::vector<uint8_t>& out, float v) {
+        uint32_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        put32(out, bits);
+    }
+    static uint16_t get16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+    static uint32_t get32(const uint8_t* p) { return get16(p) | (static_cast<uint32_t>(get16(p + 2)) << 16); }
+    static float getFloat(const uint8_t* p) {
+        const uint32_t bits = get32(p);
+        float v;
+        memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+private:
+    static constexpr size_t ZONE_BYTES = 2 + 2 + 1 + 4 + 4 + 4 + 2 + 2 + 4 + 4;
+
+    static void putPins(std::vector<uint8_t>& out, const std::vector<int>& pins) {
+        out.push_back(static_cast<uint8_t>(pins.size()));
+        for (int pin : pins) put16(out, static_cast<uint16_t>(pin));
+    }
+
+    static bool getPins(const uint8_t* data, size_t len, size_t& pos, std::vector<int>& pins) {
+        if (pos >= len) return false;
+        const size_t count = data[pos++];
+        if (pos + 2 * count > len) return false;
+        pins.clear();
+        for (size_t i = 0; i < count; ++i, pos += 2) {
+            pins.push_back(static_cast<int16_t>(get16(data + pos)));
+        }
+        return true;
+    }
+};
+
+namespace SensorTrace {
+    constexpr uint32_t MAGIC = 0x31525447;    // "GTR1"
+    constexpr uint8_t VERSION = 1;
+
+    enum RecordType : uint8_t {
+        ADC_SAMPLE = 1,
+        BMP085_RAW = 2,
+        SCAN = 3,
+        FLOAT_SWITCH = 4,
+        RELAY = 5,
+    };
+
+    // Standard base64 with padding, for sinks that only take text (MQTT payloads). Returns the
+    // encoded length, or 0 if `out` is too small for it and the terminating zero.
+    inline size_t toBase64(const uint8_t* in, size_t len, char* out, size_t outSize) {
+        static constexpr char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        const size_t encoded = (len + 2) / 3 * 4;
+        if (outSize < encoded + 1) return 0;
+        size_t o = 0;
+        for (size_t i = 0; i < len; i += 3) {
+            const uint32_t n = (in[i] << 16) | (i + 1 < len ? in[i + 1] << 8 : 0) | (i + 2 < len ? in[i + 2] : 0);
+            out[o++] = ALPHABET[(n >> 18) & 63];
+            out[o++] = ALPHABET[(n >> 12) & 63];
+            out[o++] = i + 1 < len ? ALPHABET[(n >> 6) & 63] : '=';
+            out[o++] = i + 2 < len ? ALPHABET[n & 63] : '=';
+        }
+        out[o] = '\0';
+        return o;
+    }
+}
+
+/**
+ * @class SensorTraceWriter
+ * @brief Encodes trace records into a RAM buffer and hands full buffers to a sink.
+ *
+ * The sink appends to a LittleFS file or publishes over MQTT; when it refuses data (file full,
+ * broker down) the capture stops for good, so a trace never has holes in it. With
+ * flushEveryScan the buffer goes out after every SCAN record, one message per scan for
+ * streaming; otherwise only when it is full.
+ *
+ * Only the sensor task's records (samples, BMP085 readings, scans) reach the sink. Relay and
+ * float switch records come from the esp_timer and float switch tasks with the relay mutex held,
+ * so they are only buffered; the sensor task flushes early enough to leave EVENT_RESERVE_BYTES
+ * for them, and one that still finds the buffer full is dropped and counted.
+ *
+ * @note Fed from the sensor task, relay contexts and the float switch task; guarded by a mutex.
+ *       Records are appended without allocating.
+ */
+class SensorTraceWriter {
+public:
+    using Sink = std::function<bool(const uint8_t* data, size_t len)>;
+    static constexpr size_t BUFFER_BYTES = 1024;
+    static constexpr size_t EVENT_RESERVE_BYTES = 64;
+
+    explicit SensorTraceWriter(Sink sink, bool flushEveryScan = false)
+        : sink(std::move(sink)), flushEveryScan(flushEveryScan) {}
+
+    // Writes the header; record times count from here.
+    bool begin(const SensorTraceConfig& config) {
+        std::vector<uint8_t> header = {0, 0, 0, 0, SensorTrace::VERSION, 0, 0};
+        memcpy(header.data(), &SensorTrace::MAGIC, 4);
+        config.encode(header);
+        const size_t configLen = header.size() - 7;
+        header[5] = static_cast<uint8_t>(configLen);
+        header[6] = static_cast<uint8_t>(configLen >> 8);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        used = 0;
+        lastUs = esp_timer_get_time();
+        capturing = sink(header.data(), header.size());
+        if (capturing) bytesWritten = header.size();
+        return capturing;
+    }
+
+    void recordAdcSample(size_t channel, uint16_t value) {
+        const uint8_t payload[3] = {static_cast<uint8_t>(channel), static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8)};
+        append(SensorTrace::ADC_SAMPLE, payload, sizeof(payload), true);
+    }
+
+    void recordBmp085(uint16_t ut, uint32_t result, uint8_t oversampling) {
+        const uint8_t payload[6] = {static_cast<uint8_t>(ut), static_cast<uint8_t>(ut >> 8), static_cast<uint8_t>(result),
+                                    static_cast<uint8_t>(result >> 8), static_cast<uint8_t>(result >> 16), oversampling};
+        append(SensorTrace::BMP085_RAW, payload, sizeof(payload), true);
+    }
+
+    void recordScan(const SensorData& data) {
+        uint8_t payload[13 + 2 * SensorData::MAX_CHANNELS];
+        size_t len = 0;
+        putRaw32(payload + len, data.validMask); len += 4;
+        uint32_t bits;
+        memcpy(&bits, &data.temperature, 4);
+        putRaw32(payload + len, bits); len += 4;
+        memcpy(&bits, &data.pressure, 4);
+        putRaw32(payload + len, bits); len += 4;
+        payload[len++] = data.waterLevel ? 1 : 0;
+        for (size_t ch = 0; ch < SensorData::MAX_CHANNELS; ++ch) {
+            if (data.isValid(ch)) {
+                const uint16_t tenths = static_cast<uint16_t>(data.moistureTenths[ch]);
+                payload[len++] = static_cast<uint8_t>(tenths);
+                payload[len++] = static_cast<uint8_t>(tenths >> 8);
+            }
+        }
+        append(SensorTrace::SCAN, payload, len, true);
+        if (flushEveryScan) flush();
+    }
+
+    void recordFloatSwitch(bool waterOk) {
+        const uint8_t payload[1] = {static_cast<uint8_t>(waterOk ? 1 : 0)};
+        append(SensorTrace::FLOAT_SWITCH, payload, sizeof(payload), false);
+    }
+
+    void recordRelay(size_t relay, bool on) {
+        const uint8_t payload[2] = {static_cast<uint8_t>(relay), static_cast<uint8_t>(on ? 1 : 0)};
+        append(SensorTrace::RELAY, payload, sizeof(payload), false);
+    }
+
+    // Hands the buffered records to the sink.
+    bool flush() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return flushLocked();
+    }
+
+    bool isCapturing() const { return capturing; }
+    uint32_t getBytesWritten() const { return bytesWritten; }
+    uint32_t getDroppedRecords() const { return droppedRecords; }
+
+private:
+    static constexpr size_t MAX_RECORD_BYTES = 1 + 10 + 13 + 2 * SensorData::MAX_CHANNELS;
+    static constexpr size_t MAX_EVENT_BYTES = 1 + 10 + 2;
+
+    Sink sink;
+    bool flushEveryScan;
+    std::mutex mutex;
+    std::array<uint8_t, BUFFER_BYTES> buffer{};
+    size_t used = 0;
+    int64_t lastUs = 0;
+    std::atomic<bool> capturing{false};
+    std::atomic<uint32_t> bytesWritten{0};
+    std::atomic<uint32_t> droppedRecords{0};
+
+    // mayFlush only from the sensor task, see the class comment.
+    void append(uint8_t type, const uint8_t* payload, size_t len, bool mayFlush) {
+        if (!capturing) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!mayFlush) {
+            if (used + MAX_EVENT_BYTES > buffer.size()) {
+                droppedRecords++;
+                return;
+            }
+        } else if (used + MAX_RECORD_BYTES + EVENT_RESERVE_BYTES > buffer.size() && !flushLocked()) {
+            return;
+        }
+
+        const int64_t now = esp_timer_get_time();
+        uint64_t delta = static_cast<uint64_t>(std::max<int64_t>(0, now - lastUs));
+        lastUs = now;
+        buffer[used++] = type;
+        do {
+            const uint8_t byte = delta & 0x7F;
+            delta >>= 7;
+            buffer[used++] = byte | (delta ? 0x80 : 0);
+        } while (delta);
+        memcpy(buffer.data() + used, payload, len);
+        used += len;
+    }
+
+    bool flushLocked() {
+        if (!capturing) return false;
+        if (used == 0) return true;
+        if (!sink(buffer.data(), used)) {
+            capturing = false;      // rather stop than leave a hole
+            return false;
+        }
+        bytesWritten += used;
+        used = 0;
+        return true;
+    }
+
+    static void putRaw32(uint8_t* p, uint32_t v) {
+        p[0] = static_cast<uint8_t>(v);
+        p[1] = static_cast<uint8_t>(v >> 8);
+        p[2] = static_cast<uint8_t>(v >> 16);
+        p[3] = static_cast<uint8_t>(v >> 24);
+    }
+};
+
+/**
+ * @class SensorTraceReader
+ * @brief Decodes a trace held in memory, record by record.
+ */
+class SensorTraceReader {
+public:
+    struct Record {
+        uint8_t type = 0;
+        int64_t timeUs = 0;             // since the header was written
+        uint8_t index = 0;              // ADC channel or relay
+        bool flag = false;              // relay on, water ok
+        uint16_t value = 0;             // ADC raw value
+        uint16_t ut = 0;
+        uint32_t result = 0;
+        uint8_t oversampling = 0;
+        SensorData scan;                // validMask, temperature, pressure, waterLevel, moistureTenths
+    };
+
+    SensorTraceReader(const uint8_t* data, size_t len) : data(data), len(len) {}
+
+    bool readHeader(SensorTraceConfig& config) {
+        if (len < 7 || SensorTraceConfig::get32(data) != SensorTrace::MAGIC || data[4] != SensorTrace::VERSION) {
+            return false;
+        }
+        const size_t configLen = SensorTraceConfig::get16(data + 5);
+        if (7 + configLen > len || !config.decode(data + 7, configLen)) return false;
+        pos = 7 + configLen;
+        timeUs = 0;
+        return true;
+    }
+
+    // False at the end of the trace, or at a record cut off by the end of the capture.
+    bool next(Record& out) {
+        if (pos >= len) return false;
+        out.type = data[pos++];
+        uint64_t delta = 0;
+        for (int shift = 0;; shift += 7) {
+            if (pos >= len || shift > 63) return cutOff();
+            const uint8_t byte = data[pos++];
+            delta |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) break;
+        }
+        timeUs += static_cast<int64_t>(delta);
+        out.timeUs = timeUs;
+
+        const uint8_t* p = data + pos;
+        switch (out.type) {
+            case SensorTrace::ADC_SAMPLE:
+                if (!have(3)) return cutOff();
+                out.index = p[0];
+                out.value = SensorTraceConfig::get16(p + 1);
+                pos += 3;
+                return true;
+            case SensorTrace::BMP085_RAW:
+                if (!have(6)) return cutOff();
+                out.ut = SensorTraceConfig::get16(p);
+                out.result = p[2] | (p[3] << 8) | (static_cast<uint32_t>(p[4]) << 16);
+                out.oversampling = p[5];
+                pos += 6;
+                return true;
+            case SensorTrace::SCAN: {
+                if (!have(13)) return cutOff();
+                out.scan = SensorData();
+                out.scan.validMask = SensorTraceConfig::get32(p);
+                out.scan.temperature = SensorTraceConfig::getFloat(p + 4);
+                out.scan.pressure = SensorTraceConfig::getFloat(p + 8);
+                out.scan.waterLevel = p[12] != 0;
+                const size_t channels = __builtin_popcount(out.scan.validMask);
+                if (!have(13 + 2 * channels)) return cutOff();
+                size_t offset = 13;
+                for (size_t ch = 0; ch < SensorData::MAX_CHANNELS; ++ch) {
+                    if (out.scan.isValid(ch)) {
+                        out.scan.moistureTenths[ch] = static_cast<int16_t>(SensorTraceConfig::get16(p + offset));
+                        offset += 2;
+                    }
+                }
+                pos += offset;
+                return true;
+            }
+            case SensorTrace::FLOAT_SWITCH:
+                if (!have(1)) return cutOff();
+                out.flag = p[0] != 0;
+                pos += 1;
+                return true;
+            case SensorTrace::RELAY:
+                if (!have(2)) return cutOff();
+                out.index = p[0];
+                out.flag = p[1] != 0;
+                pos += 2;
+                return true;
+            default:
+                corrupt = true;
+                pos = len;
+                return false;
+        }
+    }
+
+    // Byte offset of the next record.
+    size_t position() const { return pos; }
+
+    // Set when next() stopped at an unknown record type.
+    bool isCorrupt() const { return corrupt; }
+
+private:
+    const uint8_t* data;
+    size_t len;
+    size_t pos = 0;
+    int64_t timeUs = 0;
+    bool corrupt = false;
+
+    bool have(size_t n) const { return pos + n <= len; }
+
+    bool cutOff() {
+        pos = len;
+        return false;
+    }
+};
+
+#endif // SENSOR_TRACE_H
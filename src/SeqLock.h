@@ -0,0 +1,94 @@
+#ifndef SEQ_LOCK_H
+#define SEQ_LOCK_H
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @class SeqLock
+ * @brief Single-writer, multi-reader versioned snapshot of a trivially copyable value.
+ *
+ * Two copies of the value are kept (a "latch" seqlock). The writer updates one copy while
+ * readers are steered to the other by the low bit of the sequence counter, so a reader never
+ * waits for the writer; it only retries if two publications complete while it is copying.
+ * This also means a high-priority reader cannot livelock behind a preempted writer.
+ *
+ * The payload is stored as relaxed atomic words so concurrent copies are well defined.
+ *
+ * @warning Only one thread may call store().
+ */
+template<typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock requires a trivially copyable type");
+
+public:
+    SeqLock() : SeqLock(T{}) {}
+
+    explicit SeqLock(const T& initial) {
+        writeSlot(0, initial);
+        writeSlot(1, initial);
+    }
+
+    // Publishes a new value and bumps the version returned by load() and version().
+    void store(const T& value) {
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        // Odd: readers use slot 1 while slot 0 is rewritten
+        sequence.store(seq + 1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_release);
+        writeSlot(0, value);
+        // Even: readers use slot 0 while slot 1 catches up
+        sequence.store(seq + 2, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_release);
+        writeSlot(1, value);
+    }
+
+    // Copies a consistent value into out and returns its version.
+    uint32_t load(T& out) const {
+        while (true) {
+            const uint32_t seq = sequence.load(std::memory_order_acquire);
+            readSlot(seq & 1, out);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == seq) {
+                return seq / 2;
+            }
+        }
+    }
+
+    T load() const {
+        T value;
+        load(value);
+        return value;
+    }
+
+    // Number of store() calls that completed; cheap check for "anything new since last read?".
+    uint32_t version() const {
+        return sequence.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> sequence{0};
+    std::array<std::atomic<uint32_t>, WORDS> slots[2];
+
+    void writeSlot(int slot, const T& value) {
+        uint32_t words[WORDS] = {};
+        memcpy(words, &value, sizeof(T));
+        for (size_t i = 0; i < WORDS; ++i) {
+            slots[slot][i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+    void readSlot(int slot, T& out) const {
+        uint32_t words[WORDS];
+        for (size_t i = 0; i < WORDS; ++i) {
+            words[i] = slots[slot][i].load(std::memory_order_relaxed);
+        }
+        memcpy(&out, words, sizeof(T));
+    }
+};
+
+#endif // SEQ_LOCK_H
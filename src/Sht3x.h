@@ -0,0 +1,89 @@
+#ifndef SHT3X_H
+#define SHT3X_H
+
+#include <cstdint>
+#include "I2CBus.h"
+#include "SensorDriver.h"
+
+/**
+ * @class Sht3x
+ * @brief SHT30/31/35 temperature and humidity driver using single-shot measurements.
+ *
+ * Uses the high-repeatability command without clock stretching, so the bus is free while the
+ * sensor converts. Both words are checked against their CRC before they are used.
+ */
+class Sht3x : public SensorDriver<Sht3x> {
+public:
+    static constexpr uint8_t ADDRESS = 0x44;
+
+    float getTemperature() const { return -45.0f + 175.0f * rawTemperature / 65535.0f; }
+    float getHumidity() const { return 100.0f * rawHumidity / 65535.0f; }
+
+    // CRC-8 from the datasheet: polynomial 0x31, init 0xFF.
+    static uint8_t crc8(const uint8_t* data, size_t len) {
+        uint8_t crc = 0xFF;
+        for (size_t i = 0; i < len; ++i) {
+            crc ^= data[i];
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x31) : static_cast<uint8_t>(crc << 1);
+            }
+        }
+        return crc;
+    }
+
+private:
+    friend class SensorDriver<Sht3x>;
+
+    static constexpr uint16_t CMD_MEASURE_HIGH = 0x2400;
+    static constexpr uint16_t CMD_SOFT_RESET = 0x30A2;
+    static constexpr uint32_t MEASUREMENT_US = 15500;
+
+    I2CBus* bus = nullptr;
+    uint16_t rawTemperature = 0;
+    uint16_t rawHumidity = 0;
+
+    bool probe(I2CBus& i2cBus) {
+        bus = &i2cBus;
+        if (!command(CMD_SOFT_RESET)) return false;
+        vTaskDelay(pdMS_TO_TICKS(2));  // soft reset takes up to 1.5 ms
+        return true;
+    }
+
+    bool startMeasurement() {
+        if (!command(CMD_MEASURE_HIGH)) return false;
+        waitUs(MEASUREMENT_US);
+        return true;
+    }
+
+    bool continueMeasurement() {
+        uint8_t raw[6];
+        const bool ok = bus->transact(ADDRESS, I2CBus::Priority::SENSOR, [&raw](TwoWire& wire) {
+            if (wire.requestFrom(static_cast<uint16_t>(ADDRESS), sizeof(raw), true) != sizeof(raw)) return false;
+            for (uint8_t& b : raw) {
+                b = static_cast<uint8_t>(wire.read());
+            }
+            return true;
+        });
+        if (!ok || crc8(raw, 2) != raw[2] || crc8(raw + 3, 2) != raw[5]) return fail();
+        rawTemperature = static_cast<uint16_t>((raw[0] << 8) | raw[1]);
+        rawHumidity = static_cast<uint16_t>((raw[3] << 8) | raw[4]);
+        return finish();
+    }
+
+    void fill(EnvironmentReading& out) const {
+        out.temperature = getTemperature();
+        out.humidity = getHumidity();
+        out.validMask |= EnvironmentReading::TEMPERATURE | EnvironmentReading::HUMIDITY;
+    }
+
+    bool command(uint16_t cmd) {
+        return bus->transact(ADDRESS, I2CBus::Priority::SENSOR, [cmd](TwoWire& wire) {
+            wire.beginTransmission(ADDRESS);
+            wire.write(static_cast<uint8_t>(cmd >> 8));
+            wire.write(static_cast<uint8_t>(cmd & 0xFF));
+            return wire.endTransmission() == 0;
+        });
+    }
+};
+
+#endif // SHT3X_H
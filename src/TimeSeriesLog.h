@@ -0,0 +1,455 @@
+#ifndef TIME_SERIES_LOG_H
+#define TIME_SERIES_LOG_H
+
+#include <FS.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include "ESPLogger.h"
+#include "SensorManager.h"
+
+/**
+ * @class TimeSeriesLog
+ * @brief Append-only binary log of sensor readings and relay events on LittleFS.
+ *
+ * The log lives in SEGMENT_COUNT fixed slots (<dir>/seg0.bin ...), each at most SEGMENT_BYTES.
+ * When the active segment is full the next slot is truncated and reused, so the oldest segment
+ * is dropped first and the flash budget stays fixed (256 KB, next to ~90 KB of web assets).
+ *
+ * Segment layout, all integers little endian:
+ *   header:  magic "GLG1" (4) | sequence (4) | time of first record (4)
+ *   record:  type (1) | payload length (1) | unix time (4) | payload
+ *   sensor:  flags (1, bit0 water level) | validMask (2) | temperature tenths (2, signed)
+ *            | pressure tenths of hPa (2) | moisture tenths (2, signed) per valid channel
+ *   sensor32: as sensor, with a 4-byte validMask, used when a channel above 15 is valid
+ *   relay:   relay index (1) | active (1)
+ * A 4-channel reading is 21 bytes, so the log keeps roughly a week at one reading per minute.
+ *
+ * The segment headers form the time index: begin() reads only those, and an export starts at
+ * the last segment that begins before the requested range.
+ *
+ * Records are collected in a RAM buffer and written in one append when the buffer is nearly full
+ * or the oldest buffered record is FLUSH_INTERVAL_S old, which keeps the number of flash block
+ * rewrites low. A reset loses at most that window; LittleFS commits each append atomically,
+ * so a segment never ends in a torn record.
+ *
+ * Only appendSensor() writes to flash. appendRelay() is called from the esp_timer task and the
+ * float-switch task with the relay mutex held, so it only buffers; it drops the event if a
+ * sensor record has not made room for it yet.
+ *
+ * @note Fed from the sensor task and relay contexts, read by the web server; guarded by a mutex.
+ */
+class TimeSeriesLog {
+public:
+    static constexpr size_t SEGMENT_COUNT = 8;
+    static constexpr size_t SEGMENT_BYTES = 32 * 1024;
+    static constexpr size_t BUFFER_BYTES = 1024;
+    static constexpr uint32_t FLUSH_INTERVAL_S = 10 * 60;
+    // Records stamped before the clock is synced via NTP would be meaningless after a reboot.
+    static constexpr uint32_t MIN_VALID_TIME = 1600000000;
+
+    static constexpr uint8_t RECORD_SENSOR = 1;
+    static constexpr uint8_t RECORD_RELAY = 2;
+    static constexpr uint8_t RECORD_SENSOR32 = 3;
+
+    /**
+     * @brief State of one CSV export, advanced by readCsv() until it returns 0.
+     *
+     * Holds a position (segment sequence + byte offset), not data, so a response can be
+     * produced in chunks of any size with only the formatted lines of one record in RAM.
+     */
+    struct ExportCursor {
+        uint32_t from = 0;
+        uint32_t to = 0;
+        uint32_t sequence = 0;
+        uint32_t offset = 0;
+        bool started = false;
+        bool done = false;
+        char pending[1280];
+        size_t pendingLen = 0;
+        size_t pendingPos = 0;
+    };
+
+    explicit TimeSeriesLog(fs::FS& fs, const char* dir = "/tslog")
+        : fs(fs), logger(Logger::instance()) {
+        snprintf(this->dir, sizeof(this->dir), "%s", dir);
+    }
+
+    // Call once the filesystem is mounted. Rebuilds the segment index from the slot headers.
+    bool begin() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!fs.mkdir(dir)) {
+            logger.log("TimeSeriesLog", LogLevel::ERROR, "Could not create %s", dir);
+            return false;
+        }
+
+        active = -1;
+        for (size_t slot = 0; slot < SEGMENT_COUNT; ++slot) {
+            segments[slot] = Segment();
+            char path[48];
+            segmentPath(slot, path, sizeof(path));
+            if (!fs.exists(path)) continue;
+
+            File file = fs.open(path, "r");
+            uint8_t header[HEADER_BYTES];
+            if (!file || file.read(header, sizeof(header)) != sizeof(header) || get32(header) != MAGIC) {
+                logger.log("TimeSeriesLog", LogLevel::WARNING, "Ignoring invalid segment %s", path);
+                continue;
+            }
+            segments[slot].used = true;
+            segments[slot].sequence = get32(header + 4);
+            segments[slot].firstTime = get32(header + 8);
+            segments[slot].size = file.size();
+            file.close();
+
+            if (active < 0 || segments[slot].sequence > segments[active].sequence) {
+                active = static_cast<int>(slot);
+            }
+        }
+        mounted = true;
+        logger.log("TimeSeriesLog", LogLevel::INFO, "Time-series log ready, active segment %d", active);
+        return true;
+    }
+
+    void appendSensor(uint32_t time, const SensorData& data) {
+        uint8_t payload[MAX_PAYLOAD_BYTES];
+        size_t len = 0;
+        // Logs written before zones past 16 existed only have the short mask, keep writing it when it fits.
+        const bool wide = data.validMask > 0xFFFF;
+        payload[len++] = data.waterLevel ? 1 : 0;
+        if (wide) {
+            put32(payload + len, data.validMask); len += 4;
+        } else {
+            put16(payload + len, static_cast<uint16_t>(data.validMask)); len += 2;
+        }
+        put16(payload + len, static_cast<uint16_t>(toTenths(data.temperature))); len += 2;
+        put16(payload + len, static_cast<uint16_t>(toTenths(data.pressure))); len += 2;
+        for (size_t ch = 0; ch < SensorData::MAX_CHANNELS; ++ch) {
+            if (data.isValid(ch)) {
+                put16(payload + len, static_cast<uint16_t>(data.moistureTenths[ch]));
+                len += 2;
+            }
+        }
+        append(wide ? RECORD_SENSOR32 : RECORD_SENSOR, time, payload, len, true);
+    }
+
+    // Buffers only, never touches the filesystem; see the class comment.
+    void appendRelay(uint32_t time, uint8_t relayIndex, bool active) {
+        const uint8_t payload[2] = {relayIndex, static_cast<uint8_t>(active ? 1 : 0)};
+        append(RECORD_RELAY, time, payload, sizeof(payload), false);
+    }
+
+    uint32_t getDroppedRecords() const {
+        return droppedRecords.load();
+    }
+
+    // Writes buffered records to flash now, e.g. before an export or a planned restart.
+    bool flush() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return flushLocked();
+    }
+
+    /**
+     * @brief Start a CSV export of all records with from <= time <= to.
+     *
+     * Flushes the buffer so the export includes the latest records.
+     */
+    void beginExport(ExportCursor& cursor, uint32_t from, uint32_t to) {
+        std::lock_guard<std::mutex> lock(mutex);
+        flushLocked();
+        cursor = ExportCursor();
+        cursor.from = from;
+        cursor.to = to;
+        cursor.offset = HEADER_BYTES;
+
+        int start = oldestSlot();
+        if (start < 0) {
+            cursor.done = true;
+            return;
+        }
+        // Skip segments that end before the range: their successor already starts at or before `from`.
+        for (int next = nextSlot(start); next >= 0 && segments[next].firstTime <= from; next = nextSlot(next)) {
+            start = next;
+        }
+        cursor.sequence = segments[start].sequence;
+    }
+
+    /**
+     * @brief Fill up to maxLen bytes of CSV ("time,kind,index,value" lines).
+     *
+     * @return Bytes written, 0 once the export is complete.
+     * Matches the AsyncWebServer chunked-response callback, one call per chunk.
+     */
+    size_t readCsv(ExportCursor& cursor, uint8_t* out, size_t maxLen) {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t written = 0;
+        File file;
+        int fileSlot = -1;
+
+        while (written < maxLen) {
+            if (cursor.pendingPos < cursor.pendingLen) {
+                const size_t n = std::min(cursor.pendingLen - cursor.pendingPos, maxLen - written);
+                memcpy(out + written, cursor.pending + cursor.pendingPos, n);
+                cursor.pendingPos += n;
+                written += n;
+                continue;
+            }
+            cursor.pendingLen = cursor.pendingPos = 0;
+            if (cursor.done) break;
+
+            if (!cursor.started) {
+                cursor.started = true;
+                cursor.pendingLen = snprintf(cursor.pending, sizeof(cursor.pending), "time,kind,index,value\n");
+                continue;
+            }
+
+            // Locate the cursor's segment; it may have been recycled since the previous chunk.
+            const int slot = slotFor(cursor);
+            if (slot < 0 || segments[slot].firstTime > cursor.to) {
+                cursor.done = true;
+                continue;
+            }
+            if (cursor.offset + RECORD_HEADER_BYTES > segments[slot].size) {
+                advanceSegment(cursor);
+                continue;
+            }
+            if (slot != fileSlot) {
+                char path[48];
+                segmentPath(slot, path, sizeof(path));
+                file = fs.open(path, "r");
+                fileSlot = slot;
+                if (!file || !file.seek(cursor.offset)) {
+                    advanceSegment(cursor);
+                    continue;
+                }
+            }
+
+            uint8_t record[RECORD_HEADER_BYTES + MAX_PAYLOAD_BYTES];
+            if (file.read(record, RECORD_HEADER_BYTES) != RECORD_HEADER_BYTES ||
+                record[1] > MAX_PAYLOAD_BYTES ||
+                file.read(record + RECORD_HEADER_BYTES, record[1]) != record[1]) {
+                logger.log("TimeSeriesLog", LogLevel::WARNING, "Unreadable record in segment %lu at %lu",
+                           static_cast<unsigned long>(cursor.sequence), static_cast<unsigned long>(cursor.offset));
+                advanceSegment(cursor);
+                continue;
+            }
+            cursor.offset += RECORD_HEADER_BYTES + record[1];
+
+            const uint32_t time = get32(record + 2);
+            if (time >= cursor.from && time <= cursor.to) {
+                cursor.pendingLen = formatCsv(record[0], time, record + RECORD_HEADER_BYTES, record[1],
+                                              cursor.pending, sizeof(cursor.pending));
+            }
+        }
+        return written;
+    }
+
+private:
+    static constexpr uint32_t MAGIC = 0x31474C47;  // "GLG1"
+    static constexpr size_t HEADER_BYTES = 12;
+    static constexpr size_t RECORD_HEADER_BYTES = 6;
+    static constexpr size_t MAX_PAYLOAD_BYTES = 9 + 2 * SensorData::MAX_CHANNELS;
+
+    struct Segment {
+        bool used = false;
+        uint32_t sequence = 0;
+        uint32_t firstTime = 0;
+        uint32_t size = 0;
+    };
+
+    fs::FS& fs;
+    Logger& logger;
+    char dir[24];
+    std::mutex mutex;
+    bool mounted = false;
+    std::array<Segment, SEGMENT_COUNT> segments;
+    int active = -1;
+    uint8_t buffer[BUFFER_BYTES];
+    size_t bufferLen = 0;
+    uint32_t bufferFirstTime = 0;
+    std::atomic<uint32_t> droppedRecords{0};
+
+    static void put16(uint8_t* p, uint16_t v) {
+        p[0] = v & 0xFF;
+        p[1] = v >> 8;
+    }
+    static void put32(uint8_t* p, uint32_t v) {
+        put16(p, v & 0xFFFF);
+        put16(p + 2, v >> 16);
+    }
+    static uint16_t get16(const uint8_t* p) {
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+    static uint32_t get32(const uint8_t* p) {
+        return get16(p) | (static_cast<uint32_t>(get16(p + 2)) << 16);
+    }
+    static int16_t toTenths(float value) {
+        return static_cast<int16_t>(std::clamp<long>(lroundf(value * 10.0f), INT16_MIN, INT16_MAX));
+    }
+
+    void segmentPath(size_t slot, char* path, size_t size) const {
+        snprintf(path, size, "%s/seg%u.bin", dir, static_cast<unsigned>(slot));
+    }
+
+    void append(uint8_t type, uint32_t time, const uint8_t* payload, size_t len, bool mayFlush) {
+        if (time < MIN_VALID_TIME) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!mounted) return;
+
+        if (bufferLen + RECORD_HEADER_BYTES + len > BUFFER_BYTES) {
+            if (!mayFlush) {
+                droppedRecords++;
+                return;
+            }
+            flushLocked();
+        }
+        if (bufferLen == 0) {
+            bufferFirstTime = time;
+        }
+        buffer[bufferLen] = type;
+        buffer[bufferLen + 1] = static_cast<uint8_t>(len);
+        put32(buffer + bufferLen + 2, time);
+        memcpy(buffer + bufferLen + RECORD_HEADER_BYTES, payload, len);
+        bufferLen += RECORD_HEADER_BYTES + len;
+
+        // Flush while a full sensor record still fits, leaving that much room for relay events
+        // until the next one
+        if (mayFlush && (BUFFER_BYTES - bufferLen < RECORD_HEADER_BYTES + MAX_PAYLOAD_BYTES ||
+                         time - bufferFirstTime >= FLUSH_INTERVAL_S)) {
+            flushLocked();
+        }
+    }
+
+    bool flushLocked() {
+        if (bufferLen == 0 || !mounted) return true;
+
+        if (active < 0 || segments[active].size + bufferLen > SEGMENT_BYTES) {
+            if (!rotate()) {
+                bufferLen = 0;
+                return false;
+            }
+        }
+
+        char path[48];
+        segmentPath(active, path, sizeof(path));
+        File file = fs.open(path, "a");
+        const size_t written = file ? file.write(buffer, bufferLen) : 0;
+        file.close();
+        segments[active].size += written;
+        if (written != bufferLen) {
+            logger.log("TimeSeriesLog", LogLevel::ERROR, "Short write to %s (%u of %u bytes)", path,
+                       static_cast<unsigned>(written), static_cast<unsigned>(bufferLen));
+        }
+        const bool ok = written == bufferLen;
+        bufferLen = 0;
+        return ok;
+    }
+
+    // Starts a new segment in the slot after the active one, overwriting the oldest data.
+    bool rotate() {
+        const size_t slot = active < 0 ? 0 : (active + 1) % SEGMENT_COUNT;
+        const uint32_t sequence = active < 0 ? 1 : segments[active].sequence + 1;
+
+        char path[48];
+        segmentPath(slot, path, sizeof(path));
+        uint8_t header[HEADER_BYTES];
+        put32(header, MAGIC);
+        put32(header + 4, sequence);
+        put32(header + 8, bufferFirstTime);
+
+        File file = fs.open(path, "w");
+        if (!file || file.write(header, sizeof(header)) != sizeof(header)) {
+            logger.log("TimeSeriesLog", LogLevel::ERROR, "Could not start segment %s", path);
+            segments[slot] = Segment();
+            return false;
+        }
+        file.close();
+
+        segments[slot] = Segment{true, sequence, bufferFirstTime, HEADER_BYTES};
+        active = static_cast<int>(slot);
+        logger.log("TimeSeriesLog", LogLevel::DEBUG, "Started segment %lu in %s", static_cast<unsigned long>(sequence), path);
+        return true;
+    }
+
+    int oldestSlot() const {
+        int oldest = -1;
+        for (size_t slot = 0; slot < SEGMENT_COUNT; ++slot) {
+            if (segments[slot].used && (oldest < 0 || segments[slot].sequence < segments[oldest].sequence)) {
+                oldest = static_cast<int>(slot);
+            }
+        }
+        return oldest;
+    }
+
+    // The used segment with the smallest sequence above `slot`'s, or -1.
+    int nextSlot(int slot) const {
+        int next = -1;
+        for (size_t s = 0; s < SEGMENT_COUNT; ++s) {
+            if (segments[s].used && segments[s].sequence > segments[slot].sequence &&
+                (next < 0 || segments[s].sequence < segments[next].sequence)) {
+                next = static_cast<int>(s);
+            }
+        }
+        return next;
+    }
+
+    // Slot holding the cursor's segment. If it was recycled, skips ahead to the oldest remaining one.
+    int slotFor(ExportCursor& cursor) const {
+        int candidate = -1;
+        for (size_t s = 0; s < SEGMENT_COUNT; ++s) {
+            if (!segments[s].used || segments[s].sequence < cursor.sequence) continue;
+            if (candidate < 0 || segments[s].sequence < segments[candidate].sequence) {
+                candidate = static_cast<int>(s);
+            }
+        }
+        if (candidate >= 0 && segments[candidate].sequence != cursor.sequence) {
+            cursor.sequence = segments[candidate].sequence;
+            cursor.offset = HEADER_BYTES;
+        }
+        return candidate;
+    }
+
+    static void advanceSegment(ExportCursor& cursor) {
+        cursor.sequence++;
+        cursor.offset = HEADER_BYTES;
+    }
+
+    static size_t appendTenths(char* out, size_t size, int32_t tenths) {
+        return snprintf(out, size, "%s%ld.%ld\n", tenths < 0 ? "-" : "", static_cast<long>(std::abs(tenths) / 10),
+                        static_cast<long>(std::abs(tenths) % 10));
+    }
+
+    static size_t formatCsv(uint8_t type, uint32_t time, const uint8_t* payload, size_t len, char* out, size_t size) {
+        const unsigned long t = time;
+        size_t n = 0;
+        if (type == RECORD_RELAY && len >= 2) {
+            return snprintf(out, size, "%lu,relay,%u,%u\n", t, payload[0], payload[1]);
+        }
+        const size_t maskBytes = type == RECORD_SENSOR32 ? 4 : 2;
+        if ((type != RECORD_SENSOR && type != RECORD_SENSOR32) || len < 5 + maskBytes) {
+            return 0;
+        }
+
+        const uint32_t validMask = maskBytes == 4 ? get32(payload + 1) : get16(payload + 1);
+        const uint8_t* environment = payload + 1 + maskBytes;
+        size_t pos = 5 + maskBytes;
+        for (size_t ch = 0; ch < SensorData::MAX_CHANNELS && pos + 2 <= len; ++ch) {
+            if (!(validMask & (1u << ch))) continue;
+            n += snprintf(out + n, size - n, "%lu,moisture,%u,", t, static_cast<unsigned>(ch));
+            n += appendTenths(out + n, size - n, static_cast<int16_t>(get16(payload + pos)));
+            pos += 2;
+        }
+        n += snprintf(out + n, size - n, "%lu,temperature,,", t);
+        n += appendTenths(out + n, size - n, static_cast<int16_t>(get16(environment)));
+        n += snprintf(out + n, size - n, "%lu,pressure,,", t);
+        n += appendTenths(out + n, size - n, get16(environment + 2));
+        n += snprintf(out + n, size - n, "%lu,water_level,,%u\n", t, payload[0] & 1u);
+        return n;
+    }
+};
+
+#endif // TIME_SERIES_LOG_H
@@ -0,0 +1,186 @@
+#ifndef WATERING_HISTORY_H
+#define WATERING_HISTORY_H
+
+#include <Preferences.h>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include "ESPLogger.h"
+#include "globals.h"
+
+/**
+ * @class WateringHistory
+ * @brief Wall-clock time of each zone's last watering, kept across reboots.
+ *
+ * The live copy is an RtcBlock in RTC slow memory (RTC_NOINIT_ATTR on the device), which
+ * survives software resets, watchdog resets and OTA restarts but not a power cycle. A
+ * magic word and checksum tell a surviving block from power-on garbage.
+ *
+ * NVS covers power loss. Waterings only mark the block dirty, and flush() writes the whole
+ * array as one blob at most once per FLUSH_INTERVAL_S. That is a few flash writes a day
+ * however often the pumps run. A power cut loses at most that window, and a zone watered in
+ * the lost window waits less than its interval once.
+ *
+ * Times are unix seconds from the NTP-synced clock. Waterings while the clock is not yet
+ * synced (before MIN_VALID_TIME) are not recorded.
+ *
+ * @note Written from whichever task switches a relay, flushed by the watering controller;
+ *       guarded by a mutex. The NVS write happens outside it.
+ */
+class WateringHistory {
+public:
+    static constexpr size_t MAX_ZONES = ConfigConstants::MAX_SYSTEM_SIZE;
+    static constexpr uint32_t FLUSH_INTERVAL_S = 60 * 60;
+    static constexpr uint32_t MIN_VALID_TIME = 1600000000;
+    static constexpr uint32_t NEVER = 0;
+    static constexpr uint32_t MAGIC = 0x31534857;   // "WHS1"
+
+    struct RtcBlock {
+        uint32_t magic;
+        uint32_t wateredAt[MAX_ZONES];
+        uint32_t checksum;
+    };
+
+    using Clock = uint32_t (*)();
+
+    static uint32_t systemTime() {
+        return static_cast<uint32_t>(time(nullptr));
+    }
+
+    explicit WateringHistory(RtcBlock& rtc, Clock clock = systemTime, const char* ns = "history")
+        : rtc(rtc), clock(clock), logger(Logger::instance()) {
+        snprintf(this->ns, sizeof(this->ns), "%s", ns);
+    }
+
+    /**
+     * @brief Load the history at boot.
+     *
+     * Keeps the RTC block if it survived the reset, since it is at least as new as the last
+     * flush, and marks it dirty if it holds waterings NVS does not have yet, so the next flush()
+     * saves them. Otherwise reloads the last flush from NVS.
+     *
+     * @return true if the RTC block survived
+     */
+    bool begin() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!preferences.begin(ns, false)) {
+            logger.log("WateringHistory", LogLevel::ERROR, "Could not open NVS namespace %s", ns);
+        }
+        if (rtc.magic == MAGIC && rtc.checksum == checksum(rtc)) {
+            uint32_t stored[MAX_ZONES] = {};
+            if (preferences.getBytesLength(KEY) == sizeof(stored)) {
+                preferences.getBytes(KEY, stored, sizeof(stored));
+            }
+            dirty = memcmp(stored, rtc.wateredAt, sizeof(stored)) != 0;
+            logger.log("WateringHistory", LogLevel::INFO, "Watering history kept in RTC memory%s",
+                       dirty ? ", not yet in NVS" : "");
+            return true;
+        }
+
+        memset(rtc.wateredAt, 0, sizeof(rtc.wateredAt));
+        if (preferences.getBytesLength(KEY) == sizeof(rtc.wateredAt)) {
+            preferences.getBytes(KEY, rtc.wateredAt, sizeof(rtc.wateredAt));
+        }
+        seal();
+        logger.log("WateringHistory", LogLevel::INFO, "Watering history reloaded from NVS");
+        return false;
+    }
+
+    // Records a watering that starts now.
+    void record(size_t zone) {
+        const uint32_t now = clock();
+        if (zone >= MAX_ZONES || now < MIN_VALID_TIME) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        rtc.wateredAt[zone] = now;
+        seal();
+        dirty = true;
+    }
+
+    // Unix time of the zone's last watering, NEVER if none is known.
+    uint32_t lastWatered(size_t zone) const {
+        if (zone >= MAX_ZONES) return NEVER;
+        std::lock_guard<std::mutex> lock(mutex);
+        return rtc.wateredAt[zone];
+    }
+
+    uint32_t now() const {
+        return clock();
+    }
+
+    bool clockValid() const {
+        return clock() >= MIN_VALID_TIME;
+    }
+
+    /**
+     * @brief Write the history to NVS if it changed and the last write is old enough.
+     *
+     * @param force Write a pending change now, e.g. before a planned power-down
+     * @return true if NVS was written
+     */
+    bool flush(bool force = false) {
+        uint32_t copy[MAX_ZONES];
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!dirty || (!force && flushDueInS() > 0)) return false;
+            memcpy(copy, rtc.wateredAt, sizeof(copy));
+            dirty = false;
+            lastFlush = clock();
+        }
+        if (preferences.putBytes(KEY, copy, sizeof(copy)) != sizeof(copy)) {
+            logger.log("WateringHistory", LogLevel::ERROR, "Could not write the watering history to NVS");
+            std::lock_guard<std::mutex> lock(mutex);
+            dirty = true;
+            return false;
+        }
+        flushes++;
+        return true;
+    }
+
+    // Seconds until flush() would write a pending change, UINT32_MAX if nothing is pending.
+    uint32_t nextFlushInS() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return dirty ? flushDueInS() : UINT32_MAX;
+    }
+
+    uint32_t getFlushCount() const {
+        return flushes;
+    }
+
+private:
+    static constexpr const char* KEY = "lastWatered";
+
+    RtcBlock& rtc;
+    Clock clock;
+    Logger& logger;
+    char ns[16];
+    Preferences preferences;
+    mutable std::mutex mutex;
+    bool dirty = false;
+    uint32_t lastFlush = 0;     // 0: nothing written since boot, the first change goes out at once
+    uint32_t flushes = 0;
+
+    uint32_t flushDueInS() const {
+        if (lastFlush == 0) return 0;
+        const uint32_t elapsed = clock() - lastFlush;
+        return elapsed >= FLUSH_INTERVAL_S ? 0 : FLUSH_INTERVAL_S - elapsed;
+    }
+
+    void seal() {
+        rtc.magic = MAGIC;
+        rtc.checksum = checksum(rtc);
+    }
+
+    // FNV-1a over the timestamps
+    static uint32_t checksum(const RtcBlock& block) {
+        uint32_t hash = 2166136261u;
+        for (uint32_t value : block.wateredAt) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                hash = (hash ^ ((value >> shift) & 0xFF)) * 16777619u;
+            }
+        }
+        return hash;
+    }
+};
+
+#endif // WATERING_HISTORY_H
@@ -0,0 +1,125 @@
+#ifndef WATERING_QUEUE_H
+#define WATERING_QUEUE_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include "globals.h"
+
+/**
+ * @class WateringQueue
+ * @brief Dry zones waiting for a pump, served one at a time by priority.
+ *
+ * Pumps run together only while their relay currents fit the power budget, so zones that are
+ * dry at the same moment queue up until their relay current fits in the remaining budget. The
+ * next zone is the one with the highest score:
+ *
+ *   score = dryness deficit in tenths of a percent + AGE_WEIGHT_TENTHS per hour since the
+ *           zone was last watered (capped at MAX_AGE_HOURS, never watered counts as the cap)
+ *
+ * The deficit puts the driest plant first; the age term keeps a slightly dry zone from being
+ * passed over forever by a zone that keeps drying out faster. Ties go to the zone queued first.
+ *
+ * Wait times run from the moment a zone is queued to the moment it is popped for watering.
+ *
+ * @note Fixed arrays, no allocation. Not thread safe; only the watering controller uses it.
+ */
+class WateringQueue {
+public:
+    static constexpr size_t MAX_ZONES = ConfigConstants::MAX_SYSTEM_SIZE;
+    static constexpr int32_t AGE_WEIGHT_TENTHS = 5;       // 0.5 % deficit per hour
+    static constexpr int64_t MAX_AGE_HOURS = 48;
+    // Restored history can predate boot, so valid esp_timer times may be negative.
+    static constexpr int64_t NEVER_WATERED = INT64_MIN;
+
+    struct Stats {
+        uint32_t served = 0;
+        uint32_t lastWaitMs = 0;
+        uint32_t maxWaitMs = 0;
+        uint64_t totalWaitMs = 0;
+        uint8_t maxDepth = 0;
+    };
+
+    /**
+     * @brief Queue a zone, or refresh the priority of a zone already queued.
+     *
+     * @param zone Zone index
+     * @param deficitTenths How far the reading is below the threshold
+     * @param lastWateredUs esp_timer time of the last watering, NEVER_WATERED if none
+     * @param nowUs Current esp_timer time; becomes the queue time of a newly queued zone
+     */
+    void push(size_t zone, int32_t deficitTenths, int64_t lastWateredUs, int64_t nowUs) {
+        if (zone >= MAX_ZONES) return;
+        Entry& entry = entries[zone];
+        if (!entry.queued) {
+            entry.queued = true;
+            entry.queuedUs = nowUs;
+            depth++;
+            stats.maxDepth = std::max<uint8_t>(stats.maxDepth, static_cast<uint8_t>(depth));
+        }
+        entry.deficitTenths = deficitTenths;
+        entry.lastWateredUs = lastWateredUs;
+    }
+
+    // Drops a zone that is no longer dry or no longer enabled.
+    void remove(size_t zone) {
+        if (zone < MAX_ZONES && entries[zone].queued) {
+            entries[zone].queued = false;
+            depth--;
+        }
+    }
+
+    // Highest priority zone, or -1 when the queue is empty. The zone stays queued.
+    int peek(int64_t nowUs) const {
+        int best = -1;
+        int64_t bestScore = 0;
+        for (size_t zone = 0; zone < MAX_ZONES; ++zone) {
+            const Entry& entry = entries[zone];
+            if (!entry.queued) continue;
+            const int64_t s = score(entry, nowUs);
+            if (best < 0 || s > bestScore || (s == bestScore && entry.queuedUs < entries[best].queuedUs)) {
+                best = static_cast<int>(zone);
+                bestScore = s;
+            }
+        }
+        return best;
+    }
+
+    // Removes a zone that is being watered and records how long it waited.
+    void serve(size_t zone, int64_t nowUs) {
+        if (zone >= MAX_ZONES || !entries[zone].queued) return;
+        const int64_t waitMs = std::max<int64_t>(0, (nowUs - entries[zone].queuedUs) / 1000);
+        stats.lastWaitMs = static_cast<uint32_t>(std::min<int64_t>(waitMs, UINT32_MAX));
+        stats.maxWaitMs = std::max(stats.maxWaitMs, stats.lastWaitMs);
+        stats.totalWaitMs += stats.lastWaitMs;
+        stats.served++;
+        remove(zone);
+    }
+
+    bool contains(size_t zone) const { return zone < MAX_ZONES && entries[zone].queued; }
+    size_t size() const { return depth; }
+    bool empty() const { return depth == 0; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct Entry {
+        bool queued = false;
+        int32_t deficitTenths = 0;
+        int64_t lastWateredUs = NEVER_WATERED;
+        int64_t queuedUs = 0;
+    };
+
+    std::array<Entry, MAX_ZONES> entries{};
+    size_t depth = 0;
+    Stats stats;
+
+    static int64_t score(const Entry& entry, int64_t nowUs) {
+        static constexpr int64_t US_PER_HOUR = 3600LL * 1000000;
+        const int64_t ageHours = entry.lastWateredUs == NEVER_WATERED
+                                     ? MAX_AGE_HOURS
+                                     : std::min(MAX_AGE_HOURS, (nowUs - entry.lastWateredUs) / US_PER_HOUR);
+        return entry.deficitTenths + AGE_WEIGHT_TENTHS * ageHours;
+    }
+};
+
+#endif // WATERING_QUEUE_H
@@ -0,0 +1,139 @@
+#ifndef WATERING_TUNER_H
+#define WATERING_TUNER_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include "globals.h"
+
+/**
+ * @class WateringTuner
+ * @brief Learns how much each zone's moisture rises per second of watering, and sizes the next
+ *        watering to reach a target moisture.
+ *
+ * For a zone in feedback mode, every automatic watering is a measurement: the reading before
+ * the pump started, and the first reading at least SOAK_MS after it stopped, once the water
+ * has spread to the sensor. The rise divided by the pump time is the zone's gain, smoothed
+ * over waterings:
+ *
+ *   gain     += GAIN_SMOOTHING * (rise / seconds - gain)
+ *   duration  = (target - reading at the start) / gain
+ *
+ * The duration moves at most by MAX_STEP per watering and stays within the configured
+ * activationPeriod limits. A watering that raised moisture by less than MIN_RISE_TENTHS says
+ * nothing about the gain, and the next one runs MAX_STEP times longer. Watering the zone
+ * again restarts the measurement; a missing reading after the soak drops it.
+ *
+ * @note Fixed arrays, no allocation. Not thread safe; only the watering controller uses it.
+ */
+class WateringTuner {
+public:
+    static constexpr size_t MAX_ZONES = ConfigConstants::MAX_SYSTEM_SIZE;
+    static constexpr int64_t SOAK_MS = 10 * 60 * 1000;
+    static constexpr int16_t MIN_RISE_TENTHS = 5;
+    static constexpr float GAIN_SMOOTHING = 0.5f;
+    static constexpr float MAX_STEP = 2.0f;
+
+    struct Limits {
+        uint32_t minDurationMs;
+        uint32_t maxDurationMs;
+    };
+
+    struct Result {
+        uint32_t durationMs;
+        float gain;     // tenths of a percent per second of watering
+    };
+
+    /**
+     * @brief Start a measurement when a zone's pump switches on.
+     *
+     * @param zone Zone index
+     * @param durationMs Pump time
+     * @param startTenths Moisture when the pump started
+     * @param gain Learned gain so far, 0 if none
+     * @param targetPercent Moisture the watering should reach
+     */
+    void start(size_t zone, uint32_t durationMs, int16_t startTenths, float gain, float targetPercent) {
+        if (zone >= MAX_ZONES) return;
+        Measurement& m = measurements[zone];
+        m = Measurement();
+        m.active = true;
+        m.durationMs = durationMs;
+        m.startTenths = startTenths;
+        m.gain = gain;
+        m.targetTenths = targetPercent * 10.0f;
+    }
+
+    void cancel(size_t zone) {
+        if (zone < MAX_ZONES) measurements[zone].active = false;
+    }
+
+    bool measuring(size_t zone) const {
+        return zone < MAX_ZONES && measurements[zone].active;
+    }
+
+    /**
+     * @brief Feed the zone's state on every controller pass while measuring.
+     *
+     * @param relayOn Whether the zone's pump is still running
+     * @param nowUs Current esp_timer time
+     * @param readingUs esp_timer time the reading was taken
+     * @param valid Whether the reading is usable
+     * @return true once the measurement is complete and `out` holds the new settings
+     */
+    bool observe(size_t zone, bool relayOn, int64_t nowUs, int64_t readingUs, bool valid, int16_t moistureTenths,
+                 const Limits& limits, Result& out) {
+        if (!measuring(zone)) return false;
+        Measurement& m = measurements[zone];
+        if (relayOn) {
+            m.stoppedUs = -1;
+            return false;
+        }
+        if (m.stoppedUs < 0) {
+            m.stoppedUs = nowUs;
+        }
+        if (readingUs - m.stoppedUs < SOAK_MS * 1000) {
+            return false;
+        }
+        m.active = false;
+        if (!valid) {
+            return false;
+        }
+        out = next(m, moistureTenths, limits);
+        return true;
+    }
+
+private:
+    struct Measurement {
+        bool active = false;
+        uint32_t durationMs = 0;
+        int16_t startTenths = 0;
+        float gain = 0.0f;
+        float targetTenths = 0.0f;
+        int64_t stoppedUs = -1;
+    };
+
+    std::array<Measurement, MAX_ZONES> measurements{};
+
+    static Result next(const Measurement& m, int16_t endTenths, const Limits& limits) {
+        const float rise = static_cast<float>(endTenths - m.startTenths);
+        const float lower = m.durationMs / MAX_STEP;
+        const float upper = m.durationMs * MAX_STEP;
+        float duration;
+        float gain = m.gain;
+
+        if (rise < MIN_RISE_TENTHS || m.durationMs == 0) {
+            duration = upper;
+        } else {
+            const float measured = rise / (m.durationMs / 1000.0f);
+            gain = gain > 0.0f ? gain + GAIN_SMOOTHING * (measured - gain) : measured;
+            const float needed = std::max(0.0f, m.targetTenths - m.startTenths);
+            duration = std::clamp(needed / gain * 1000.0f, lower, upper);
+        }
+        duration = std::clamp(duration, static_cast<float>(limits.minDurationMs), static_cast<float>(limits.maxDurationMs));
+        return Result{static_cast<uint32_t>(lroundf(duration)), gain};
+    }
+};
+
+#endif // WATERING_TUNER_H
@@ -21,6 +21,7 @@ namespace ConfigConstants {
     constexpr uint32_t MAX_WATERING_INTERVAL = 432000000; // 120 hours
     constexpr uint32_t MIN_SENSOR_PUBLISH_INTERVAL = 10000;
     constexpr uint32_t MAX_SENSOR_PUBLISH_INTERVAL = 3600000;
+    constexpr int MAX_SYSTEM_SIZE = 32;
 
     // Default values
     constexpr float DEFAULT_TEMP_OFFSET = 0.0f;
@@ -38,6 +39,17 @@ namespace ConfigConstants {
     constexpr int DEFAULT_FLOAT_SWITCH_PIN = 32;
     constexpr std::array<int, 4> DEFAULT_MOISTURE_SENSOR_PINS = {34, 35, 36, 39};
     constexpr std::array<int, 4> DEFAULT_RELAY_PINS = {33, 25, 17, 16};
+    constexpr std::array<int, 4> DEFAULT_MUX_SELECT_PINS = {13, 14, 26, 27};
+    // ADC1 only, ADC2 is taken by WiFi. 32-36 and 39 are taken by the pins above; WROOM-32 boards
+    // do not break out GPIO 37, so set muxSignalPins there when wiring a mux.
+    constexpr std::array<int, 1> DEFAULT_MUX_SIGNAL_PINS = {37};
+
+    // Pump supply; the defaults run one 1 A pump at a time, as on a 5 V / 1 A adapter
+    constexpr int DEFAULT_RELAY_CURRENT = 1000;   // mA per relay
+    constexpr std::array<int, 4> DEFAULT_RELAY_CURRENTS = {DEFAULT_RELAY_CURRENT, DEFAULT_RELAY_CURRENT,
+                                                           DEFAULT_RELAY_CURRENT, DEFAULT_RELAY_CURRENT};
+    constexpr int DEFAULT_POWER_BUDGET = 1000;    // mA for all relays together
+    constexpr int DEFAULT_INRUSH_DELAY = 500;     // ms between two pump starts
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+/**
+ * @file Ads1115Sim.h
+ * @brief Native HAL: register-level ADS1115 model for hal::sim::attachI2C().
+ *
+ * Writing the config register with the OS bit set starts a single-shot conversion of the
+ * selected input, which completes after one sample period at the configured data rate on the
+ * hal::sim clock. Reading the conversion register earlier returns the previous result and is
+ * counted in earlyReads. Inputs are set in counts (125 µV each at ±4.096 V).
+ */
+
+#ifndef HAL_NATIVE_ADS1115_SIM_H
+#define HAL_NATIVE_ADS1115_SIM_H
+
+#include <array>
+#include <cstdint>
+#include "HalSim.h"
+
+namespace hal::sim {
+
+    class Ads1115Device : public I2CDevice {
+    public:
+        static constexpr uint8_t ADDRESS = 0x48;
+
+        std::array<int16_t, 4> inputs{};    // single-ended AIN0..3
+
+        int conversions = 0;
+        int earlyReads = 0;
+        int failReads = 0;                  // NACK this many reads of the conversion register
+
+        void onWrite(const uint8_t* data, size_t len) override {
+            if (len == 0) return;
+            pointer = data[0] & 0x03;
+            if (pointer != 0x01 || len < 3) return;
+            const uint16_t config = static_cast<uint16_t>((data[1] << 8) | data[2]);
+            if (!(config & 0x8000)) return;
+            const uint8_t mux = (config >> 12) & 0x07;
+            static constexpr int64_t PERIOD_US[8] = {125000, 62500, 31250, 15625, 7813, 4000, 2105, 1163};
+            conversions++;
+            pendingInput = mux >= 4 ? mux - 4 : -1;
+            readyAtUs = nowUs() + PERIOD_US[(config >> 5) & 0x07];
+        }
+
+        size_t onRead(uint8_t* data, size_t len) override {
+            if (pointer != 0x00 || len < 2) return 0;
+            if (failReads > 0) {
+                failReads--;
+                return 0;
+            }
+            if (pendingInput >= 0) {
+                if (nowUs() < readyAtUs) {
+                    earlyReads++;
+                } else {
+                    result = inputs[pendingInput];
+                    pendingInput = -1;
+                }
+            }
+            data[0] = static_cast<uint8_t>(static_cast<uint16_t>(result) >> 8);
+            data[1] = static_cast<uint8_t>(result & 0xFF);
+            return 2;
+        }
+
+    private:
+        uint8_t pointer = 0;
+        int pendingInput = -1;
+        int64_t readyAtUs = 0;
+        int16_t result = 0;
+    };
+
+} // namespace hal::sim
+
+#endif // HAL_NATIVE_ADS1115_SIM_H
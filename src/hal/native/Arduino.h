@@ -0,0 +1,184 @@
+/**
+ * @file Arduino.h
+ * @brief Native HAL: the subset of the Arduino core used by the managers.
+ *
+ * GPIO and ADC calls read and write hal::sim state, millis()/delay() follow the HAL clock.
+ * String is a thin wrapper over std::string so ArduinoJson can be built with
+ * ARDUINOJSON_ENABLE_ARDUINO_STRING on the host.
+ */
+
+#ifndef HAL_NATIVE_ARDUINO_H
+#define HAL_NATIVE_ARDUINO_H
+
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "HalSim.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT          0x01
+#define OUTPUT         0x03
+#define INPUT_PULLUP   0x05
+#define INPUT_PULLDOWN 0x09
+
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+
+#define IRAM_ATTR
+
+inline void pinMode(int pin, int mode) {
+    std::lock_guard<std::recursive_mutex> lock(hal::sim::state().mutex);
+    hal::sim::state().pinModes[pin] = mode;
+    if (mode == INPUT_PULLUP && !hal::sim::state().digitalLevels.count(pin)) {
+        hal::sim::state().digitalLevels[pin] = HIGH;
+    }
+}
+
+inline void digitalWrite(int pin, int level) {
+    hal::sim::setDigital(pin, level ? HIGH : LOW);
+}
+
+inline int digitalRead(int pin) {
+    int level = hal::sim::getDigital(pin);
+    return level < 0 ? LOW : level;
+}
+
+inline int digitalPinToInterrupt(int pin) {
+    return pin;
+}
+
+inline void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode) {
+    std::lock_guard<std::recursive_mutex> lock(hal::sim::state().mutex);
+    hal::sim::state().interrupts[pin] = hal::sim::Interrupt{handler, arg, mode};
+}
+
+inline void attachInterrupt(uint8_t pin, void (*handler)(), int mode) {
+    attachInterruptArg(pin, [](void* fn) { reinterpret_cast<void (*)()>(fn)(); }, reinterpret_cast<void*>(handler), mode);
+}
+
+inline void detachInterrupt(uint8_t pin) {
+    std::lock_guard<std::recursive_mutex> lock(hal::sim::state().mutex);
+    hal::sim::state().interrupts.erase(pin);
+}
+
+inline uint16_t analogRead(int pin) {
+    std::lock_guard<std::recursive_mutex> lock(hal::sim::state().mutex);
+    auto& s = hal::sim::state();
+    if (s.analogSource) {
+        return static_cast<uint16_t>(s.analogSource(pin));
+    }
+    auto it = s.analogValues.find(pin);
+    return it == s.analogValues.end() ? 0 : static_cast<uint16_t>(it->second);
+}
+
+inline unsigned long millis() {
+    return static_cast<unsigned long>(hal::sim::nowUs() / 1000);
+}
+
+inline unsigned long micros() {
+    return static_cast<unsigned long>(hal::sim::nowUs());
+}
+
+inline void delay(uint32_t ms) {
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+// Busy-waits on the device; on the host it moves the clock like delay().
+inline void delayMicroseconds(uint32_t us) {
+    if (hal::sim::state().virtualClock) {
+        hal::sim::advanceUs(us);
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+}
+
+inline long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    const long run = in_max - in_min;
+    if (run == 0) {
+        return -1;
+    }
+    return (x - in_min) * (out_max - out_min) / run + out_min;
+}
+
+class String {
+public:
+    String(const char* s = "") : str(s ? s : "") {}
+    String(const std::string& s) : str(s) {}
+    String(char c) : str(1, c) {}
+    String(int v) : str(std::to_string(v)) {}
+    String(unsigned int v) : str(std::to_string(v)) {}
+    String(long v) : str(std::to_string(v)) {}
+    String(unsigned long v) : str(std::to_string(v)) {}
+    String(float v, unsigned int decimals = 2) : String(static_cast<double>(v), decimals) {}
+    String(double v, unsigned int decimals = 2) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+        str = buf;
+    }
+
+    String& operator=(const char* s) { str = s ? s : ""; return *this; }
+    const char* c_str() const { return str.c_str(); }
+    unsigned int length() const { return static_cast<unsigned int>(str.size()); }
+    bool reserve(unsigned int size) { str.reserve(size); return true; }
+    bool concat(const char* s) { if (s) str += s; return true; }
+    bool concat(const char* s, unsigned int n) { if (s) str.append(s, n); return true; }
+    bool concat(char c) { str += c; return true; }
+    bool concat(const String& s) { str += s.str; return true; }
+
+    String& operator+=(const String& rhs) { str += rhs.str; return *this; }
+    bool operator==(const String& rhs) const { return str == rhs.str; }
+    bool operator==(const char* rhs) const { return str == (rhs ? rhs : ""); }
+    bool operator!=(const String& rhs) const { return str != rhs.str; }
+
+private:
+    std::string str;
+};
+
+// Result type of String concatenation, as in the Arduino core (ArduinoJson adapts it too).
+class StringSumHelper : public String {
+public:
+    StringSumHelper(const String& s) : String(s) {}
+};
+
+inline StringSumHelper operator+(const String& lhs, const String& rhs) { String s(lhs); s.concat(rhs); return s; }
+inline StringSumHelper operator+(const char* lhs, const String& rhs) { String s(lhs); s.concat(rhs); return s; }
+inline StringSumHelper operator+(const String& lhs, const char* rhs) { String s(lhs); s.concat(rhs); return s; }
+
+class HardwareSerial {
+public:
+    void begin(unsigned long) {}
+    size_t print(const char* s) { return fputs(s, stdout) >= 0 ? strlen(s) : 0; }
+    size_t print(const String& s) { return print(s.c_str()); }
+    size_t println(const char* s = "") { size_t n = print(s); putchar('\n'); return n + 1; }
+    size_t println(const String& s) { return println(s.c_str()); }
+    size_t printf(const char* fmt, ...) {
+        va_list args;
+        va_start(args, fmt);
+        int n = vprintf(fmt, args);
+        va_end(args);
+        return n < 0 ? 0 : static_cast<size_t>(n);
+    }
+};
+
+inline HardwareSerial Serial;
+
+class EspClass {
+public:
+    // There is nothing to reboot on the host, the call is only counted.
+    void restart() {
+        std::lock_guard<std::recursive_mutex> lock(hal::sim::state().mutex);
+        hal::sim::state().restartCount++;
+    }
+    uint32_t getFreeHeap() const { return 0; }
+};
+
+inline EspClass ESP;
+
+#endif // HAL_NATIVE_ARDUINO_H
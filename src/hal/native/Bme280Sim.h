@@ -0,0 +1,93 @@
+/**
+ * @file Bme280Sim.h
+ * @brief Native HAL: register-level BME280 model for hal::sim::attachI2C().
+ *
+ * A forced-mode trigger in ctrl_meas completes after the datasheet maximum measurement time for
+ * the configured oversampling; until then the status register reports measuring and a data read
+ * returns the previous results and counts as an early read. The temperature and pressure
+ * calibration and raw values are the worked example from the Bosch BMP280 datasheet
+ * (25.08 °C, 100653 Pa); the humidity calibration comes from a real part.
+ */
+
+#ifndef HAL_NATIVE_BME280_SIM_H
+#define HAL_NATIVE_BME280_SIM_H
+
+#include <array>
+#include <cstdint>
+#include "HalSim.h"
+
+namespace hal::sim {
+
+    class Bme280Device : public I2CDevice {
+    public:
+        static constexpr uint8_t ADDRESS = 0x76;
+
+        int32_t adcT = 519888;
+        int32_t adcP = 415148;
+        int32_t adcH = 27500;
+
+        int measurements = 0;
+        int earlyReads = 0;
+
+        Bme280Device() {
+            const uint16_t tp[12] = {27504, 26435, static_cast<uint16_t>(-1000), 36477, static_cast<uint16_t>(-10685), 3024,
+                                     2855, 140, static_cast<uint16_t>(-7), 15500, static_cast<uint16_t>(-14600), 6000};
+            for (size_t i = 0; i < 12; ++i) {
+                registers[0x88 + 2 * i] = static_cast<uint8_t>(tp[i] & 0xFF);
+                registers[0x89 + 2 * i] = static_cast<uint8_t>(tp[i] >> 8);
+            }
+            registers[0xA1] = 75;                       // H1
+            registers[0xE1] = 0x6A; registers[0xE2] = 0x01;   // H2 = 362
+            registers[0xE3] = 0;                        // H3
+            registers[0xE4] = 0x13; registers[0xE5] = 0x29; registers[0xE6] = 0x03;  // H4 = 313, H5 = 50
+            registers[0xE7] = 30;                       // H6
+            registers[0xD0] = 0x60;
+        }
+
+        void onWrite(const uint8_t* data, size_t len) override {
+            if (len == 0) return;
+            pointer = data[0];
+            if (len < 2) return;
+            registers[pointer] = data[1];
+            if (pointer == 0xF4 && (data[1] & 0x03) == 0x01) {
+                measurements++;
+                const int64_t samples = 1 << (((data[1] >> 5) & 0x07) - 1);
+                readyAtUs = nowUs() + 1250 + 2300 * samples * 3 + 575 * 2;
+                registers[0xF3] = 0x08;
+            }
+        }
+
+        size_t onRead(uint8_t* data, size_t len) override {
+            complete();
+            if (pointer >= 0xF7 && pointer <= 0xFE && (registers[0xF3] & 0x08)) {
+                earlyReads++;
+            }
+            for (size_t i = 0; i < len; ++i) {
+                data[i] = registers[static_cast<uint8_t>(pointer + i)];
+            }
+            return len;
+        }
+
+    private:
+        std::array<uint8_t, 256> registers{};
+        uint8_t pointer = 0;
+        int64_t readyAtUs = 0;
+
+        void complete() {
+            if (!(registers[0xF3] & 0x08) || nowUs() < readyAtUs) return;
+            registers[0xF3] = 0;
+            registers[0xF4] &= ~0x03;   // back to sleep mode
+            registers[0xF7] = static_cast<uint8_t>(adcP >> 12);
+            registers[0xF8] = static_cast<uint8_t>(adcP >> 4);
+            registers[0xF9] = static_cast<uint8_t>((adcP & 0x0F) << 4);
+            registers[0xFA] = static_cast<uint8_t>(adcT >> 12);
+            registers[0xFB] = static_cast<uint8_t>(adcT >> 4);
+            registers[0xFC] = static_cast<uint8_t>((adcT & 0x0F) << 4);
+            registers[0xFD] = static_cast<uint8_t>(adcH >> 8);
+            registers[0xFE] = static_cast<uint8_t>(adcH & 0xFF);
+        }
+    };
+
+} // namespace hal::sim
+
+#endif // HAL_NATIVE_BME280_SIM_H
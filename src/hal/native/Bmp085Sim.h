@@ -0,0 +1,109 @@
+/**
+ * @file Bmp085Sim.h
+ * @brief Native HAL: register-level BMP085 model for hal::sim::attachI2C().
+ *
+ * Serves the chip id, the calibration EEPROM and the control / result registers. A conversion
+ * started through the control register completes after its datasheet conversion time on the
+ * hal::sim clock; reading the result earlier returns the previous result and is counted in
+ * earlyReads. Defaults are the worked example from the datasheet: UT 27898 and UP 23843 give
+ * 15.0 °C and 69964 Pa.
+ */
+
+#ifndef HAL_NATIVE_BMP085_SIM_H
+#define HAL_NATIVE_BMP085_SIM_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include "HalSim.h"
+
+namespace hal::sim {
+
+    class Bmp085Device : public I2CDevice {
+    public:
+        static constexpr uint8_t ADDRESS = 0x77;
+
+        uint16_t ut = 27898;
+        uint32_t up = 23843;          // at ULTRALOWPOWER; the model scales it for other modes
+        int32_t result = -1;          // raw 24-bit result register, replaces the up model when set
+
+        int temperatureConversions = 0;
+        int pressureConversions = 0;
+        int earlyReads = 0;
+        uint8_t lastOversampling = 0;
+
+        Bmp085Device() {
+            const int16_t calibration[11] = {408, -72, -14383, static_cast<int16_t>(32741), static_cast<int16_t>(32757),
+                                             23153, 6190, 4, -32768, -8711, 2868};
+            for (size_t i = 0; i < 11; ++i) {
+                registers[0xAA + 2 * i] = static_cast<uint8_t>(calibration[i] >> 8);
+                registers[0xAB + 2 * i] = static_cast<uint8_t>(calibration[i] & 0xFF);
+            }
+            registers[0xD0] = 0x55;
+        }
+
+        // Calibration EEPROM contents, registers 0xAA..0xBF.
+        void setCalibration(const uint8_t* raw22) {
+            std::copy(raw22, raw22 + 22, registers.begin() + 0xAA);
+        }
+
+        void onWrite(const uint8_t* data, size_t len) override {
+            if (len == 0) return;
+            pointer = data[0];
+            if (len < 2 || pointer != 0xF4) return;
+
+            const uint8_t command = data[1];
+            pendingCommand = command;
+            int64_t conversionUs;
+            if (command == 0x2E) {
+                temperatureConversions++;
+                conversionUs = 4500;
+            } else if ((command & 0x3F) == 0x34) {
+                pressureConversions++;
+                lastOversampling = command >> 6;
+                static constexpr int64_t PRESSURE_US[4] = {4500, 7500, 13500, 25500};
+                conversionUs = PRESSURE_US[lastOversampling];
+            } else {
+                return;
+            }
+            registers[0xF4] = command | 0x20;   // Sco: conversion running
+            readyAtUs = nowUs() + conversionUs;
+        }
+
+        size_t onRead(uint8_t* data, size_t len) override {
+            completeConversion();
+            if (pointer >= 0xF6 && pointer <= 0xF8 && (registers[0xF4] & 0x20)) {
+                earlyReads++;
+            }
+            for (size_t i = 0; i < len; ++i) {
+                data[i] = registers[static_cast<uint8_t>(pointer + i)];
+            }
+            return len;
+        }
+
+    private:
+        std::array<uint8_t, 256> registers{};
+        uint8_t pointer = 0;
+        uint8_t pendingCommand = 0;
+        int64_t readyAtUs = 0;
+
+        void completeConversion() {
+            if (!(registers[0xF4] & 0x20) || nowUs() < readyAtUs) return;
+            registers[0xF4] &= ~0x20;
+            if (pendingCommand == 0x2E) {
+                registers[0xF6] = static_cast<uint8_t>(ut >> 8);
+                registers[0xF7] = static_cast<uint8_t>(ut & 0xFF);
+                registers[0xF8] = 0;
+            } else {
+                // The driver reads UP = result >> (8 - oss), so this yields up << oss.
+                const uint32_t value = result >= 0 ? static_cast<uint32_t>(result) : up << 8;
+                registers[0xF6] = static_cast<uint8_t>(value >> 16);
+                registers[0xF7] = static_cast<uint8_t>(value >> 8);
+                registers[0xF8] = static_cast<uint8_t>(value & 0xFF);
+            }
+        }
+    };
+
+} // namespace hal::sim
+
+#endif // HAL_NATIVE_BMP085_SIM_H
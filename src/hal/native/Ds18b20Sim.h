@@ -0,0 +1,99 @@
+/**
+ * @file Ds18b20Sim.h
+ * @brief Native HAL: DS18B20 model for hal::sim::attachOneWire().
+ *
+ * Understands Skip ROM, Convert T, Read Scratchpad and Write Scratchpad. A conversion takes
+ * the datasheet time for the configured resolution; reading the scratchpad before it is done
+ * returns the previous temperature and counts as an early read.
+ */
+
+#ifndef HAL_NATIVE_DS18B20_SIM_H
+#define HAL_NATIVE_DS18B20_SIM_H
+
+#include <cmath>
+#include <cstdint>
+#include <OneWire.h>
+#include "HalSim.h"
+
+namespace hal::sim {
+
+    class Ds18b20Device : public OneWireDevice {
+    public:
+        float temperature = 21.0f;
+
+        int conversions = 0;
+        int earlyReads = 0;
+
+        Ds18b20Device() {
+            scratchpad[0] = 0x50;   // power-on value, 85 °C
+            scratchpad[1] = 0x05;
+            scratchpad[4] = 0x7F;   // 12 bits
+        }
+
+        uint8_t resolutionBits() const { return static_cast<uint8_t>(9 + ((scratchpad[4] >> 5) & 0x03)); }
+
+        void onReset() override {
+            phase = Phase::ROM;
+        }
+
+        void onWrite(uint8_t data) override {
+            switch (phase) {
+                case Phase::ROM:
+                    phase = data == 0xCC ? Phase::FUNCTION : Phase::IDLE;
+                    break;
+                case Phase::FUNCTION:
+                    if (data == 0x44) {
+                        conversions++;
+                        readyAtUs = nowUs() + (750000 >> (12 - resolutionBits()));
+                        converting = true;
+                        phase = Phase::IDLE;
+                    } else if (data == 0xBE) {
+                        complete();
+                        if (converting) earlyReads++;
+                        readIndex = 0;
+                        phase = Phase::READ;
+                    } else if (data == 0x4E) {
+                        writeIndex = 2;
+                        phase = Phase::WRITE;
+                    } else {
+                        phase = Phase::IDLE;
+                    }
+                    break;
+                case Phase::WRITE:
+                    // TH, TL, then the configuration register whose low five bits always read as 1
+                    scratchpad[writeIndex] = writeIndex == 4 ? static_cast<uint8_t>(data | 0x1F) : data;
+                    if (++writeIndex > 4) phase = Phase::IDLE;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        uint8_t onRead() override {
+            if (phase != Phase::READ || readIndex >= 9) return 0xFF;
+            if (readIndex == 0) scratchpad[8] = OneWire::crc8(scratchpad, 8);
+            return scratchpad[readIndex++];
+        }
+
+    private:
+        enum class Phase { IDLE, ROM, FUNCTION, READ, WRITE };
+
+        Phase phase = Phase::IDLE;
+        uint8_t scratchpad[9] = {};
+        int readIndex = 0;
+        int writeIndex = 0;
+        bool converting = false;
+        int64_t readyAtUs = 0;
+
+        void complete() {
+            if (!converting || nowUs() < readyAtUs) return;
+            converting = false;
+            const int16_t raw = static_cast<int16_t>(std::lround(temperature * 16.0f));
+            scratchpad[0] = static_cast<uint8_t>(raw & 0xFF);
+            scratchpad[1] = static_cast<uint8_t>((raw >> 8) & 0xFF);
+        }
+    };
+
+} // namespace hal::sim
+
+#endif // HAL_NATIVE_DS18B20_SIM_H
@@ -0,0 +1,74 @@
+/**
+ * @file ESPLogger.h
+ * @brief Native HAL: stand-in for the ESP-Arduino-Utils Logger, printing to stderr.
+ *
+ * The host filter level defaults to WARNING so test output stays readable; observers
+ * receive every message that passes the filter, as on the device.
+ */
+
+#ifndef HAL_NATIVE_ESP_LOGGER_H
+#define HAL_NATIVE_ESP_LOGGER_H
+
+#include <cstdarg>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+class Logger {
+public:
+    enum class Level { DEBUG, INFO, WARNING, ERROR };
+    using LogObserver = std::function<void(std::string_view, Level, std::string_view)>;
+
+    static Logger& instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    void setFilterLevel(Level level) { filterLevel = level; }
+    Level getFilterLevel() const { return filterLevel; }
+
+    void addLogObserver(LogObserver observer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        observers.push_back(std::move(observer));
+    }
+
+    void log(std::string_view tag, Level level, const char* format, ...) {
+        if (level < filterLevel) return;
+        char message[256];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(message, sizeof(message), format, args);
+        va_end(args);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        fprintf(stderr, "[%s] %.*s: %s\n", levelName(level), static_cast<int>(tag.size()), tag.data(), message);
+        logCount++;
+        for (const auto& observer : observers) {
+            observer(tag, level, message);
+        }
+    }
+
+    size_t getLogCount() const { return logCount; }
+
+private:
+    Level filterLevel = Level::WARNING;
+    std::mutex mutex;
+    std::vector<LogObserver> observers;
+    size_t logCount = 0;
+
+    static const char* levelName(Level level) {
+        switch (level) {
+            case Level::DEBUG: return "DEBUG";
+            case Level::INFO: return "INFO";
+            case Level::WARNING: return "WARNING";
+            case Level::ERROR: return "ERROR";
+        }
+        return "?";
+    }
+};
+
+using LogLevel = Logger::Level;
+
+#endif // HAL_NATIVE_ESP_LOGGER_H
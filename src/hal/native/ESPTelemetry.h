@@ -0,0 +1,39 @@
+/**
+ * @file ESPTelemetry.h
+ * @brief Native HAL: stand-in for ESPTelemetry that publishes its custom data as key=value pairs.
+ */
+
+#ifndef HAL_NATIVE_ESP_TELEMETRY_H
+#define HAL_NATIVE_ESP_TELEMETRY_H
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "MQTTManager.h"
+#include "freertos/FreeRTOS.h"
+
+class ESPTelemetry {
+public:
+    ESPTelemetry(ESPMQTTManager& mqttManager, const char* topic) : mqttManager(mqttManager), topic(topic) {}
+
+    template<typename F>
+    void addCustomData(const std::string& name, F getter) {
+        customData.emplace_back(name, [getter]() { return std::to_string(getter()); });
+    }
+
+    bool publishTelemetry() {
+        std::string payload;
+        for (const auto& [name, getter] : customData) {
+            payload += name + "=" + getter() + ";";
+        }
+        return mqttManager.publish(topic.c_str(), payload.c_str());
+    }
+
+private:
+    ESPMQTTManager& mqttManager;
+    std::string topic;
+    std::vector<std::pair<std::string, std::function<std::string()>>> customData;
+};
+
+#endif // HAL_NATIVE_ESP_TELEMETRY_H
@@ -0,0 +1,85 @@
+/**
+ * @file FS.h
+ * @brief Native HAL: Arduino fs::FS / fs::File over a directory of the host filesystem.
+ *
+ * Paths are resolved below hal::sim::state().fsRoot. Only the calls the firmware uses are
+ * provided: open/exists/remove/mkdir/rename and sequential or seeking file I/O.
+ */
+
+#ifndef HAL_NATIVE_FS_H
+#define HAL_NATIVE_FS_H
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include "HalSim.h"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File {
+public:
+    File() = default;
+    explicit File(FILE* f) : handle(f, [](FILE* p) { fclose(p); }) {}
+
+    explicit operator bool() const { return handle != nullptr; }
+
+    size_t write(const uint8_t* buf, size_t size) { return handle ? fwrite(buf, 1, size, handle.get()) : 0; }
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t read(uint8_t* buf, size_t size) { return handle ? fread(buf, 1, size, handle.get()) : 0; }
+    int read() {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+
+    bool seek(uint32_t pos, SeekMode mode = SeekSet) {
+        return handle && fseek(handle.get(), pos, mode == SeekSet ? SEEK_SET : mode == SeekCur ? SEEK_CUR : SEEK_END) == 0;
+    }
+    size_t position() const { return handle ? static_cast<size_t>(ftell(handle.get())) : 0; }
+    size_t size() const {
+        if (!handle) return 0;
+        long pos = ftell(handle.get());
+        fseek(handle.get(), 0, SEEK_END);
+        long end = ftell(handle.get());
+        fseek(handle.get(), pos, SEEK_SET);
+        return static_cast<size_t>(end);
+    }
+    int available() const { return static_cast<int>(size() - position()); }
+    void flush() { if (handle) fflush(handle.get()); }
+    void close() { handle.reset(); }
+
+private:
+    std::shared_ptr<FILE> handle;
+};
+
+class FS {
+public:
+    File open(const char* path, const char* mode = "r") {
+        const char* hostMode = mode[0] == 'w' ? "wb+" : mode[0] == 'a' ? "ab+" : "rb";
+        return File(fopen(resolve(path).c_str(), hostMode));
+    }
+    File open(const std::string& path, const char* mode = "r") { return open(path.c_str(), mode); }
+
+    bool exists(const char* path) {
+        struct stat st;
+        return stat(resolve(path).c_str(), &st) == 0;
+    }
+    bool remove(const char* path) { return ::remove(resolve(path).c_str()) == 0; }
+    bool rename(const char* from, const char* to) { return ::rename(resolve(from).c_str(), resolve(to).c_str()) == 0; }
+    bool mkdir(const char* path) { return ::mkdir(resolve(path).c_str(), 0755) == 0 || exists(path); }
+
+private:
+    static std::string resolve(const char* path) {
+        std::lock_guard<std::recursive_mutex> lock(hal::sim::state().mutex);
+        return hal::sim::state().fsRoot + path;
+    }
+};
+
+} // namespace fs
+
+using fs::FS;
+using fs::File;
+
+#endif // HAL_NATIVE_FS_H
@@ -0,0 +1,263 @@
+/**
+ * @file HalSim.h
+ * @brief Host-side state behind the native HAL shims (GPIO, ADC, clock, timers, NVS, I2C, 1-Wire, FS).
+ *
+ * The headers in src/hal/native shadow the Arduino / ESP-IDF headers the managers include
+ * (Arduino.h, freertos/task.h, esp_timer.h, Preferences.h, nvs_flash.h, Wire.h, OneWire.h, FS.h) when building
+ * the [env:native] target. All of them share the state defined here, and tests drive it
+ * through the hal::sim namespace.
+ *
+ * @note The clock runs in real time by default. Tests call useVirtualClock() to get a
+ *       deterministic clock where vTaskDelay() and advanceUs() move time forward and fire
+ *       any esp_timer that became due on the calling thread.
+ */
+
+#ifndef HAL_SIM_H
+#define HAL_SIM_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hal::sim {
+
+    struct Timer {
+        void (*callback)(void*) = nullptr;
+        void* arg = nullptr;
+        int64_t deadlineUs = -1;     // -1 when not armed
+        int64_t periodUs = 0;        // 0 for one-shot timers
+    };
+
+    struct NvsEntry {
+        char type;                   // 'i', 'u', 'f', 'b', 'y' (bytes)
+        std::vector<uint8_t> bytes;
+    };
+
+    struct Interrupt {
+        void (*handler)(void*) = nullptr;
+        void* arg = nullptr;
+        int mode = 0;                // RISING, FALLING or CHANGE
+    };
+
+    class I2CDevice {
+    public:
+        virtual ~I2CDevice() = default;
+        // Called with the bytes of one write transaction (register pointer + payload).
+        virtual void onWrite(const uint8_t* data, size_t len) = 0;
+        // Called for a read transaction, returns the number of bytes produced.
+        virtual size_t onRead(uint8_t* data, size_t len) = 0;
+    };
+
+    class OneWireDevice {
+    public:
+        virtual ~OneWireDevice() = default;
+        // Called on a bus reset; an attached device always answers with a presence pulse.
+        virtual void onReset() = 0;
+        virtual void onWrite(uint8_t data) = 0;
+        virtual uint8_t onRead() = 0;
+    };
+
+    struct State {
+        std::recursive_mutex mutex;
+        std::condition_variable_any timerCv;
+
+        bool virtualClock = false;
+        int64_t virtualNowUs = 0;
+        std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+        std::map<int, int> pinModes;
+        std::map<int, int> digitalLevels;
+        std::map<int, Interrupt> interrupts;
+        std::map<int, int> analogValues;
+        std::function<int(int)> analogSource;
+
+        std::vector<Timer*> timers;
+        bool timerThreadStarted = false;
+
+        std::map<std::string, std::map<std::string, NvsEntry>> nvs;
+
+        std::map<uint8_t, I2CDevice*> i2cDevices;
+        std::map<int, OneWireDevice*> oneWireDevices;
+
+        // Host directory that LittleFS paths are resolved against; tests point it at a temp dir.
+        std::string fsRoot = "/tmp/garduino-littlefs";
+
+        int restartCount = 0;
+    };
+
+    // Never destroyed: detached task and timer threads may still touch it during process exit.
+    inline State& state() {
+        static State* s = new State();
+        return *s;
+    }
+
+    inline int64_t nowUs() {
+        State& s = state();
+        std::lock_guard<std::recursive_mutex> lock(s.mutex);
+        if (s.virtualClock) {
+            return s.virtualNowUs;
+        }
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - s.epoch).count();
+    }
+
+    // Fires every armed timer whose deadline is <= now, in deadline order.
+    inline void fireDueTimers(int64_t now) {
+        State& s = state();
+        while (true) {
+            Timer* due = nullptr;
+            {
+                std::lock_guard<std::recursive_mutex> lock(s.mutex);
+                for (Timer* t : s.timers) {
+                    if (t->deadlineUs >= 0 && t->deadlineUs <= now &&
+                        (due == nullptr || t->deadlineUs < due->deadlineUs)) {
+                        due = t;
+                    }
+                }
+                if (due == nullptr) return;
+                due->deadlineUs = due->periodUs > 0 ? due->deadlineUs + due->periodUs : -1;
+            }
+            due->callback(due->arg);
+        }
+    }
+
+    inline void useVirtualClock(bool enabled = true) {
+        State& s = state();
+        std::lock_guard<std::recursive_mutex> lock(s.mutex);
+        s.virtualClock = enabled;
+        s.virtualNowUs = 0;
+        s.epoch = std::chrono::steady_clock::now();
+    }
+
+    // Moves the virtual clock forward, firing timers at their deadlines along the way.
+    inline void advanceUs(int64_t deltaUs) {
+        State& s = state();
+        int64_t target;
+        {
+            std::lock_guard<std::recursive_mutex> lock(s.mutex);
+            target = s.virtualNowUs + deltaUs;
+        }
+        while (true) {
+            int64_t next = target;
+            {
+                std::lock_guard<std::recursive_mutex> lock(s.mutex);
+                for (Timer* t : s.timers) {
+                    if (t->deadlineUs >= 0 && t->deadlineUs < next) next = t->deadlineUs;
+                }
+                if (next > s.virtualNowUs) s.virtualNowUs = next;
+            }
+            fireDueTimers(next);
+            if (next >= target) break;
+        }
+    }
+
+    // Real-clock timers are dispatched from a single background thread, like ESP_TIMER_TASK.
+    inline void ensureTimerThread() {
+        State& s = state();
+        if (s.timerThreadStarted) return;
+        s.timerThreadStarted = true;
+        std::thread([]() {
+            State& s = state();
+            while (true) {
+                {
+                    std::unique_lock<std::recursive_mutex> lock(s.mutex);
+                    int64_t next = -1;
+                    for (Timer* t : s.timers) {
+                        if (t->deadlineUs >= 0 && (next < 0 || t->deadlineUs < next)) next = t->deadlineUs;
+                    }
+                    if (s.virtualClock || next < 0) {
+                        s.timerCv.wait_for(lock, std::chrono::milliseconds(50));
+                        continue;
+                    }
+                    s.timerCv.wait_until(lock, s.epoch + std::chrono::microseconds(next));
+                }
+                if (!state().virtualClock) fireDueTimers(nowUs());
+            }
+        }).detach();
+    }
+
+    inline void setAnalog(int pin, int value) {
+        std::lock_guard<std::recursive_mutex> lock(state().mutex);
+        state().analogValues[pin] = value;
+    }
+
+    // Overrides setAnalog() for every pin, e.g. to replay a recorded trace.
+    inline void setAnalogSource(std::function<int(int)> source) {
+        std::lock_guard<std::recursive_mutex> lock(state().mutex);
+        state().analogSource = std::move(source);
+    }
+
+    // Sets a pin level; an attached interrupt whose edge matches runs on the calling thread.
+    inline void setDigital(int pin, int level) {
+        Interrupt isr;
+        {
+            std::lock_guard<std::recursive_mutex> lock(state().mutex);
+            auto& levels = state().digitalLevels;
+            const auto previous = levels.find(pin);
+            const bool changed = previous == levels.end() || previous->second != level;
+            levels[pin] = level;
+            auto it = state().interrupts.find(pin);
+            if (!changed || it == state().interrupts.end()) return;
+            const int edge = level ? 0x01 : 0x02;  // RISING : FALLING
+            if (!(it->second.mode & edge)) return;
+            isr = it->second;
+        }
+        isr.handler(isr.arg);
+    }
+
+    inline int getDigital(int pin) {
+        std::lock_guard<std::recursive_mutex> lock(state().mutex);
+        auto it = state().digitalLevels.find(pin);
+        return it == state().digitalLevels.end() ? -1 : it->second;
+    }
+
+    inline void attachI2C(uint8_t address, I2CDevice* device) {
+        std::lock_guard<std::recursive_mutex> lock(state().mutex);
+        if (device) {
+            state().i2cDevices[address] = device;
+        } else {
+            state().i2cDevices.erase(address);
+        }
+    }
+
+    inline void attachOneWire(int pin, OneWireDevice* device) {
+        std::lock_guard<std::recursive_mutex> lock(state().mutex);
+        if (device) {
+            state().oneWireDevices[pin] = device;
+        } else {
+            state().oneWireDevices.erase(pin);
+        }
+    }
+
+    inline void setFsRoot(const std::string& root) {
+        std::lock_guard<std::recursive_mutex> lock(state().mutex);
+        state().fsRoot = root;
+    }
+
+    // Clears pins, NVS, I2C devices and timers. Call between tests.
+    inline void reset() {
+        State& s = state();
+        std::lock_guard<std::recursive_mutex> lock(s.mutex);
+        s.pinModes.clear();
+        s.digitalLevels.clear();
+        s.interrupts.clear();
+        s.analogValues.clear();
+        s.analogSource = nullptr;
+        s.timers.clear();
+        s.nvs.clear();
+        s.i2cDevices.clear();
+        s.oneWireDevices.clear();
+        s.restartCount = 0;
+        s.virtualNowUs = 0;
+    }
+
+} // namespace hal::sim
+
+#endif // HAL_SIM_H
@@ -0,0 +1,84 @@
+/**
+ * @file IoExpanderSim.h
+ * @brief Native HAL: PCF8574 and MCP23017 output models for hal::sim::attachI2C().
+ *
+ * Both keep their output latch and count the write transactions they receive, so tests can
+ * check the state of each relay input and how many bus writes switching took.
+ */
+
+#ifndef HAL_NATIVE_IO_EXPANDER_SIM_H
+#define HAL_NATIVE_IO_EXPANDER_SIM_H
+
+#include <array>
+#include <cstdint>
+#include "HalSim.h"
+
+namespace hal::sim {
+
+    // Quasi-bidirectional port: every write byte replaces the latch. Powers up high.
+    class Pcf8574Device : public I2CDevice {
+    public:
+        uint8_t latch = 0xFF;
+        int writes = 0;
+
+        bool isLow(int bit) const { return !(latch & (1u << bit)); }
+
+        void onWrite(const uint8_t* data, size_t len) override {
+            if (len == 0) return;
+            writes++;
+            latch = data[len - 1];
+        }
+
+        size_t onRead(uint8_t* data, size_t len) override {
+            if (len == 0) return 0;
+            data[0] = latch;
+            return 1;
+        }
+    };
+
+    // Register file in BANK 0 layout with sequential addressing. Powers up as all inputs.
+    class Mcp23017Device : public I2CDevice {
+    public:
+        static constexpr uint8_t IODIRA = 0x00;
+        static constexpr uint8_t OLATA = 0x14;
+
+        std::array<uint8_t, 0x16> registers{};
+        int writes = 0;
+
+        Mcp23017Device() {
+            registers[IODIRA] = 0xFF;
+            registers[IODIRA + 1] = 0xFF;
+        }
+
+        // An output pin driven low; input pins float and read as not low.
+        bool isLow(int pin) const {
+            const int port = pin / 8;
+            const uint8_t mask = static_cast<uint8_t>(1u << (pin % 8));
+            return !(registers[IODIRA + port] & mask) && !(registers[OLATA + port] & mask);
+        }
+
+        void onWrite(const uint8_t* data, size_t len) override {
+            if (len == 0) return;
+            pointer = data[0];
+            if (len > 1) writes++;
+            for (size_t i = 1; i < len; ++i) {
+                if (pointer < registers.size()) registers[pointer] = data[i];
+                pointer++;
+            }
+        }
+
+        size_t onRead(uint8_t* data, size_t len) override {
+            for (size_t i = 0; i < len; ++i) {
+                data[i] = pointer < registers.size() ? registers[pointer] : 0;
+                pointer++;
+            }
+            return len;
+        }
+
+    private:
+        uint8_t pointer = 0;
+    };
+
+} // namespace hal::sim
+
+#endif // HAL_NATIVE_IO_EXPANDER_SIM_H
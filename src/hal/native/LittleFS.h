@@ -0,0 +1,27 @@
+/**
+ * @file LittleFS.h
+ * @brief Native HAL: the LittleFS mount, backed by the host directory behind FS.h.
+ */
+
+#ifndef HAL_NATIVE_LITTLEFS_H
+#define HAL_NATIVE_LITTLEFS_H
+
+#include "FS.h"
+
+namespace fs {
+
+class LittleFSFS : public FS {
+public:
+    bool begin(bool formatOnFail = false, const char* /*basePath*/ = "/littlefs", uint8_t /*maxOpenFiles*/ = 10,
+               const char* /*partitionLabel*/ = "spiffs") {
+        (void)formatOnFail;
+        return mkdir("");
+    }
+    void end() {}
+};
+
+} // namespace fs
+
+inline fs::LittleFSFS LittleFS;
+
+#endif // HAL_NATIVE_LITTLEFS_H
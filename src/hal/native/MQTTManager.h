@@ -0,0 +1,61 @@
+/**
+ * @file MQTTManager.h
+ * @brief Native HAL: stand-in for ESPMQTTManager that records published messages.
+ *
+ * Long simulations turn recording off with setKeepMessages(false) and only count publishes.
+ */
+
+#ifndef HAL_NATIVE_MQTT_MANAGER_H
+#define HAL_NATIVE_MQTT_MANAGER_H
+
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+class ESPMQTTManager {
+public:
+    struct Config {
+        const char* server;
+        int port;
+        const char* username;
+        const char* password;
+        const char* rootCA;
+        const char* clientCert;
+        const char* clientKey;
+        const char* clientID;
+    };
+
+    explicit ESPMQTTManager(const Config& config = {}) : config(config) {}
+
+    void begin() {}
+
+    bool publish(const char* topic, const char* payload) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!connected) return false;
+        publishCount++;
+        if (keepMessages) {
+            published.emplace_back(topic, payload);
+        }
+        return true;
+    }
+
+    void setConnected(bool state) { connected = state; }
+    void setKeepMessages(bool keep) { keepMessages = keep; }
+    size_t getPublishCount() const { return publishCount; }
+
+    std::vector<std::pair<std::string, std::string>> getPublished() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return published;
+    }
+
+private:
+    Config config;
+    bool connected = true;
+    bool keepMessages = true;
+    size_t publishCount = 0;
+    std::mutex mutex;
+    std::vector<std::pair<std::string, std::string>> published;
+};
+
+#endif // HAL_NATIVE_MQTT_MANAGER_H
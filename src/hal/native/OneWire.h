@@ -0,0 +1,69 @@
+/**
+ * @file OneWire.h
+ * @brief Native HAL: byte-level OneWire routed to devices registered with hal::sim::attachOneWire().
+ *
+ * reset() returns 0 (no presence pulse) when nothing is attached to the pin, and read()
+ * returns 0xFF, as an idle pulled-up bus would.
+ */
+
+#ifndef HAL_NATIVE_ONEWIRE_H
+#define HAL_NATIVE_ONEWIRE_H
+
+#include <cstdint>
+#include "HalSim.h"
+
+class OneWire {
+public:
+    OneWire() = default;
+    explicit OneWire(uint8_t pin) { begin(pin); }
+
+    void begin(uint8_t dataPin) { pin = dataPin; }
+
+    uint8_t reset() {
+        hal::sim::OneWireDevice* device = deviceAt(pin);
+        if (device == nullptr) return 0;
+        device->onReset();
+        return 1;
+    }
+
+    void skip() { write(0xCC); }
+
+    void write(uint8_t value, uint8_t /*power*/ = 0) {
+        if (hal::sim::OneWireDevice* device = deviceAt(pin)) device->onWrite(value);
+    }
+
+    uint8_t read() {
+        hal::sim::OneWireDevice* device = deviceAt(pin);
+        return device ? device->onRead() : 0xFF;
+    }
+
+    void read_bytes(uint8_t* buf, uint16_t count) {
+        for (uint16_t i = 0; i < count; ++i) buf[i] = read();
+    }
+
+    // Dallas/Maxim CRC-8 (polynomial x^8 + x^5 + x^4 + 1, LSB first).
+    static uint8_t crc8(const uint8_t* addr, uint8_t len) {
+        uint8_t crc = 0;
+        while (len--) {
+            uint8_t inbyte = *addr++;
+            for (uint8_t i = 8; i; i--) {
+                const uint8_t mix = (crc ^ inbyte) & 0x01;
+                crc >>= 1;
+                if (mix) crc ^= 0x8C;
+                inbyte >>= 1;
+            }
+        }
+        return crc;
+    }
+
+private:
+    uint8_t pin = 0xFF;
+
+    static hal::sim::OneWireDevice* deviceAt(int pin) {
+        std::lock_guard<std::recursive_mutex> lock(hal::sim::state().mutex);
+        auto it = hal::sim::state().oneWireDevices.find(pin);
+        return it == hal::sim::state().oneWireDevices.end() ? nullptr : it->second;
+    }
+};
+
+#endif // HAL_NATIVE_ONEWIRE_H
@@ -0,0 +1,119 @@
+/**
+ * @file Preferences.h
+ * @brief Native HAL: in-memory Preferences/NVS backed by hal::sim::state().nvs.
+ *
+ * Mirrors the NVS rules that matter for the firmware: keys are limited to 15 characters,
+ * a key keeps the type it was written with, and getters fall back to the default on a
+ * missing key or a type mismatch.
+ */
+
+#ifndef HAL_NATIVE_PREFERENCES_H
+#define HAL_NATIVE_PREFERENCES_H
+
+#include <cmath>
+#include <cstring>
+#include <string>
+#include "HalSim.h"
+
+class Preferences {
+public:
+    static constexpr size_t NVS_KEY_NAME_MAX_SIZE = 16;
+
+    bool begin(const char* name, bool readOnly = false, const char* /*partition*/ = nullptr) {
+        if (name == nullptr || strlen(name) >= NVS_KEY_NAME_MAX_SIZE) {
+            return false;
+        }
+        ns = name;
+        this->readOnly = readOnly;
+        started = true;
+        return true;
+    }
+
+    void end() { started = false; }
+
+    bool clear() {
+        if (!writable()) return false;
+        std::lock_guard<std::recursive_mutex> lock(hal::sim::state().mutex);
+        hal::sim::state().nvs[ns].clear();
+        return true;
+    }
+
+    bool remove(const char* key) {
+        if (!writable() || !validKey(key)) return false;
+        std::lock_guard<std::recursive_mutex> lock(hal::sim::state().mutex);
+        return hal::sim::state().nvs[ns].erase(key) > 0;
+    }
+
+    bool isKey(const char* key) {
+        if (!started || !validKey(key)) return false;
+        std::lock_guard<std::recursive_mutex> lock(hal::sim::state().mutex);
+        return hal::sim::state().nvs[ns].count(key) > 0;
+    }
+
+    size_t putInt(const char* key, int32_t value) { return put(key, 'i', &value, sizeof(value)); }
+    size_t putUInt(const char* key, uint32_t value) { return put(key, 'u', &value, sizeof(value)); }
+    size_t putLong64(const char* key, int64_t value) { return put(key, 'l', &value, sizeof(value)); }
+    size_t putFloat(const char* key, float value) { return put(key, 'f', &value, sizeof(value)); }
+    size_t putBool(const char* key, bool value) { uint8_t v = value; return put(key, 'b', &v, sizeof(v)); }
+    size_t putBytes(const char* key, const void* value, size_t len) { return put(key, 'y', value, len); }
+
+    int32_t getInt(const char* key, int32_t defaultValue = 0) { return get(key, 'i', defaultValue); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return get(key, 'u', defaultValue); }
+    int64_t getLong64(const char* key, int64_t defaultValue = 0) { return get(key, 'l', defaultValue); }
+    float getFloat(const char* key, float defaultValue = NAN) { return get(key, 'f', defaultValue); }
+    bool getBool(const char* key, bool defaultValue = false) { return get<uint8_t>(key, 'b', defaultValue) != 0; }
+
+    size_t getBytesLength(const char* key) {
+        const hal::sim::NvsEntry* entry = find(key, 'y');
+        return entry ? entry->bytes.size() : 0;
+    }
+
+    size_t getBytes(const char* key, void* buf, size_t maxLen) {
+        const hal::sim::NvsEntry* entry = find(key, 'y');
+        if (entry == nullptr) return 0;
+        if (buf == nullptr || maxLen == 0) return entry->bytes.size();
+        if (maxLen < entry->bytes.size()) return 0;
+        memcpy(buf, entry->bytes.data(), entry->bytes.size());
+        return entry->bytes.size();
+    }
+
+private:
+    std::string ns;
+    bool readOnly = false;
+    bool started = false;
+
+    bool writable() const { return started && !readOnly; }
+
+    static bool validKey(const char* key) {
+        return key != nullptr && strlen(key) > 0 && strlen(key) < NVS_KEY_NAME_MAX_SIZE;
+    }
+
+    size_t put(const char* key, char type, const void* value, size_t len) {
+        if (!writable() || !validKey(key)) return 0;
+        std::lock_guard<std::recursive_mutex> lock(hal::sim::state().mutex);
+        auto& entry = hal::sim::state().nvs[ns][key];
+        entry.type = type;
+        entry.bytes.assign(static_cast<const uint8_t*>(value), static_cast<const uint8_t*>(value) + len);
+        return len;
+    }
+
+    const hal::sim::NvsEntry* find(const char* key, char type) {
+        if (!started || !validKey(key)) return nullptr;
+        std::lock_guard<std::recursive_mutex> lock(hal::sim::state().mutex);
+        auto& space = hal::sim::state().nvs[ns];
+        auto it = space.find(key);
+        if (it == space.end() || it->second.type != type) return nullptr;
+        return &it->second;
+    }
+
+    template<typename T>
+    T get(const char* key, char type, T defaultValue) {
+        const hal::sim::NvsEntry* entry = find(key, type);
+        if (entry == nullptr || entry->bytes.size() != sizeof(T)) return defaultValue;
+        T value;
+        memcpy(&value, entry->bytes.data(), sizeof(T));
+        return value;
+    }
+};
+
+#endif // HAL_NATIVE_PREFERENCES_H
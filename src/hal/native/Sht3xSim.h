@@ -0,0 +1,79 @@
+/**
+ * @file Sht3xSim.h
+ * @brief Native HAL: command-level SHT3x model for hal::sim::attachI2C().
+ *
+ * A single-shot measurement (0x2400) is ready after the 15 ms datasheet maximum. Reading
+ * earlier is NACKed, as the real sensor does without clock stretching, and counted in
+ * earlyReads. Set corruptNextCrc to flip a CRC bit in the next result.
+ */
+
+#ifndef HAL_NATIVE_SHT3X_SIM_H
+#define HAL_NATIVE_SHT3X_SIM_H
+
+#include <cstdint>
+#include "HalSim.h"
+
+namespace hal::sim {
+
+    class Sht3xDevice : public I2CDevice {
+    public:
+        static constexpr uint8_t ADDRESS = 0x44;
+
+        uint16_t rawTemperature = 0x6666;   // 25.0 °C
+        uint16_t rawHumidity = 0x8000;      // 50.0 %RH
+        bool corruptNextCrc = false;
+
+        int measurements = 0;
+        int earlyReads = 0;
+
+        void onWrite(const uint8_t* data, size_t len) override {
+            if (len < 2) return;
+            const uint16_t command = static_cast<uint16_t>((data[0] << 8) | data[1]);
+            if (command == 0x2400) {
+                measurements++;
+                pending = true;
+                readyAtUs = nowUs() + 15000;
+            } else if (command == 0x30A2) {
+                pending = false;
+            }
+        }
+
+        size_t onRead(uint8_t* data, size_t len) override {
+            if (!pending) return 0;
+            if (nowUs() < readyAtUs) {
+                earlyReads++;
+                return 0;
+            }
+            pending = false;
+            uint8_t result[6] = {static_cast<uint8_t>(rawTemperature >> 8), static_cast<uint8_t>(rawTemperature), 0,
+                                 static_cast<uint8_t>(rawHumidity >> 8), static_cast<uint8_t>(rawHumidity), 0};
+            result[2] = crc8(result, 2);
+            result[5] = crc8(result + 3, 2);
+            if (corruptNextCrc) {
+                result[5] ^= 0x01;
+                corruptNextCrc = false;
+            }
+            const size_t n = len < sizeof(result) ? len : sizeof(result);
+            for (size_t i = 0; i < n; ++i) data[i] = result[i];
+            return n;
+        }
+
+    private:
+        bool pending = false;
+        int64_t readyAtUs = 0;
+
+        static uint8_t crc8(const uint8_t* data, size_t len) {
+            uint8_t crc = 0xFF;
+            for (size_t i = 0; i < len; ++i) {
+                crc ^= data[i];
+                for (int bit = 0; bit < 8; ++bit) {
+                    crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x31) : static_cast<uint8_t>(crc << 1);
+                }
+            }
+            return crc;
+        }
+    };
+
+} // namespace hal::sim
+
+#endif // HAL_NATIVE_SHT3X_SIM_H
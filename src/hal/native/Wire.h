@@ -0,0 +1,84 @@
+/**
+ * @file Wire.h
+ * @brief Native HAL: TwoWire routed to simulated devices registered with hal::sim::attachI2C().
+ *
+ * endTransmission() returns 2 (address NACK) when no device is attached at the address,
+ * as the ESP32 core does for an absent slave.
+ */
+
+#ifndef HAL_NATIVE_WIRE_H
+#define HAL_NATIVE_WIRE_H
+
+#include <cstdint>
+#include <vector>
+#include "HalSim.h"
+
+class TwoWire {
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) {
+        sdaPin = sda;
+        sclPin = scl;
+        if (frequency) clock = frequency;
+        return true;
+    }
+
+    void setClock(uint32_t frequency) { clock = frequency; }
+    uint32_t getClock() const { return clock; }
+
+    void beginTransmission(uint8_t address) {
+        txAddress = address;
+        txBuffer.clear();
+    }
+
+    size_t write(uint8_t data) {
+        txBuffer.push_back(data);
+        return 1;
+    }
+
+    size_t write(const uint8_t* data, size_t len) {
+        txBuffer.insert(txBuffer.end(), data, data + len);
+        return len;
+    }
+
+    uint8_t endTransmission(bool /*sendStop*/ = true) {
+        hal::sim::I2CDevice* device = deviceAt(txAddress);
+        if (device == nullptr) return 2;
+        device->onWrite(txBuffer.data(), txBuffer.size());
+        txBuffer.clear();
+        return 0;
+    }
+
+    uint8_t requestFrom(uint8_t address, size_t quantity, bool /*sendStop*/ = true) {
+        rxBuffer.assign(quantity, 0);
+        rxIndex = 0;
+        hal::sim::I2CDevice* device = deviceAt(address);
+        if (device == nullptr) {
+            rxBuffer.clear();
+            return 0;
+        }
+        rxBuffer.resize(device->onRead(rxBuffer.data(), quantity));
+        return static_cast<uint8_t>(rxBuffer.size());
+    }
+
+    int available() const { return static_cast<int>(rxBuffer.size() - rxIndex); }
+    int read() { return rxIndex < rxBuffer.size() ? rxBuffer[rxIndex++] : -1; }
+
+private:
+    int sdaPin = -1;
+    int sclPin = -1;
+    uint32_t clock = 100000;
+    uint8_t txAddress = 0;
+    std::vector<uint8_t> txBuffer;
+    std::vector<uint8_t> rxBuffer;
+    size_t rxIndex = 0;
+
+    static hal::sim::I2CDevice* deviceAt(uint8_t address) {
+        std::lock_guard<std::recursive_mutex> lock(hal::sim::state().mutex);
+        auto it = hal::sim::state().i2cDevices.find(address);
+        return it == hal::sim::state().i2cDevices.end() ? nullptr : it->second;
+    }
+};
+
+inline TwoWire Wire;
+
+#endif // HAL_NATIVE_WIRE_H
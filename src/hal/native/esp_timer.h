@@ -0,0 +1,117 @@
+/**
+ * @file esp_timer.h
+ * @brief Native HAL: esp_timer on top of the hal::sim clock.
+ *
+ * With the virtual clock, callbacks run from advanceUs()/vTaskDelay() on the calling thread.
+ * Otherwise they run on a single dispatcher thread, like ESP_TIMER_TASK dispatch on the device.
+ */
+
+#ifndef HAL_NATIVE_ESP_TIMER_H
+#define HAL_NATIVE_ESP_TIMER_H
+
+#include <algorithm>
+#include <cstdint>
+#include "HalSim.h"
+
+typedef int esp_err_t;
+#define ESP_OK                0
+#define ESP_FAIL              -1
+#define ESP_ERR_INVALID_ARG   0x102
+#define ESP_ERR_INVALID_STATE 0x103
+
+typedef void (*esp_timer_cb_t)(void* arg);
+typedef hal::sim::Timer* esp_timer_handle_t;
+
+typedef enum {
+    ESP_TIMER_TASK,
+    ESP_TIMER_ISR,
+} esp_timer_dispatch_t;
+
+typedef struct {
+    esp_timer_cb_t callback;
+    void* arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char* name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+inline int64_t esp_timer_get_time() {
+    return hal::sim::nowUs();
+}
+
+inline esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out) {
+    if (args == nullptr || args->callback == nullptr || out == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    auto* timer = new hal::sim::Timer();
+    timer->callback = args->callback;
+    timer->arg = args->arg;
+    std::lock_guard<std::recursive_mutex> lock(hal::sim::state().mutex);
+    hal::sim::state().timers.push_back(timer);
+    *out = timer;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_timer_start_impl(esp_timer_handle_t timer, uint64_t timeoutUs, uint64_t periodUs) {
+    if (timer == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    auto& s = hal::sim::state();
+    {
+        std::lock_guard<std::recursive_mutex> lock(s.mutex);
+        if (timer->deadlineUs >= 0) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        if (std::find(s.timers.begin(), s.timers.end(), timer) == s.timers.end()) {
+            s.timers.push_back(timer);
+        }
+        timer->deadlineUs = hal::sim::nowUs() + static_cast<int64_t>(timeoutUs);
+        timer->periodUs = static_cast<int64_t>(periodUs);
+        if (!s.virtualClock) {
+            hal::sim::ensureTimerThread();
+        }
+    }
+    s.timerCv.notify_all();
+    return ESP_OK;
+}
+
+inline esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs) {
+    return esp_timer_start_impl(timer, timeoutUs, 0);
+}
+
+inline esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+    return esp_timer_start_impl(timer, periodUs, periodUs);
+}
+
+inline esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (timer == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard<std::recursive_mutex> lock(hal::sim::state().mutex);
+    if (timer->deadlineUs < 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->deadlineUs = -1;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (timer == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    auto& s = hal::sim::state();
+    std::lock_guard<std::recursive_mutex> lock(s.mutex);
+    if (timer->deadlineUs >= 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s.timers.erase(std::remove(s.timers.begin(), s.timers.end(), timer), s.timers.end());
+    delete timer;
+    return ESP_OK;
+}
+
+inline bool esp_timer_is_active(esp_timer_handle_t timer) {
+    std::lock_guard<std::recursive_mutex> lock(hal::sim::state().mutex);
+    return timer != nullptr && timer->deadlineUs >= 0;
+}
+
+#endif // HAL_NATIVE_ESP_TIMER_H
@@ -0,0 +1,26 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Native HAL: FreeRTOS base types and tick conversion (1 tick = 1 ms, as on the ESP32 Arduino core).
+ */
+
+#ifndef HAL_NATIVE_FREERTOS_H
+#define HAL_NATIVE_FREERTOS_H
+
+#include <cstdint>
+#include "../HalSim.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY      ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(xTimeInMs) ((TickType_t)(((uint64_t)(xTimeInMs) * configTICK_RATE_HZ) / 1000U))
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE  ((BaseType_t)1)
+#define pdPASS  pdTRUE
+#define pdFAIL  pdFALSE
+
+#endif // HAL_NATIVE_FREERTOS_H
@@ -0,0 +1,115 @@
+/**
+ * @file task.h
+ * @brief Native HAL: FreeRTOS tasks backed by detached std::threads.
+ *
+ * Direct-to-task notifications (xTaskNotifyGive / ulTaskNotifyTake) are supported. With the
+ * virtual clock, ulTaskNotifyTake() returns immediately if a notification is pending and
+ * otherwise advances time by the full timeout like vTaskDelay(); with portMAX_DELAY it blocks
+ * until notified on either clock.
+ *
+ * @warning Host tasks cannot be killed; vTaskDelete() only releases the handle. Tests should
+ *          call the managers' work functions directly instead of starting their task loops.
+ */
+
+#ifndef HAL_NATIVE_FREERTOS_TASK_H
+#define HAL_NATIVE_FREERTOS_TASK_H
+
+#include <condition_variable>
+#include <thread>
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void*);
+
+struct HostTask {
+    const char* name;
+    uint32_t notifications = 0;
+    std::condition_variable_any notified;
+};
+typedef HostTask* TaskHandle_t;
+
+// The task running on this thread; nullptr on threads not started through xTaskCreate.
+inline thread_local TaskHandle_t currentHostTask = nullptr;
+
+inline BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t /*stackDepth*/,
+                              void* params, UBaseType_t /*priority*/, TaskHandle_t* handle) {
+    TaskHandle_t task = new HostTask{name};
+    if (handle) {
+        *handle = task;
+    }
+    std::thread([fn, params, task]() {
+        currentHostTask = task;
+        fn(params);
+    }).detach();
+    return pdPASS;
+}
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                          void* params, UBaseType_t priority, TaskHandle_t* handle,
+                                          BaseType_t /*core*/) {
+    return xTaskCreate(fn, name, stackDepth, params, priority, handle);
+}
+
+inline void vTaskDelete(TaskHandle_t task) {
+    delete task;
+}
+
+inline void vTaskDelay(TickType_t ticks) {
+    const int64_t us = static_cast<int64_t>(ticks) * portTICK_PERIOD_MS * 1000;
+    if (hal::sim::state().virtualClock) {
+        hal::sim::advanceUs(us);
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    std::lock_guard<std::recursive_mutex> lock(hal::sim::state().mutex);
+    task->notifications++;
+    task->notified.notify_all();
+    return pdPASS;
+}
+
+#define portYIELD_FROM_ISR(woken) ((void)(woken))
+
+inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+    xTaskNotifyGive(task);
+    if (woken) *woken = pdTRUE;
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+    TaskHandle_t self = currentHostTask;
+    if (self == nullptr) {
+        vTaskDelay(ticks);
+        return 0;
+    }
+
+    hal::sim::State& s = hal::sim::state();
+    std::unique_lock<std::recursive_mutex> lock(s.mutex);
+    if (self->notifications == 0) {
+        if (ticks == portMAX_DELAY) {
+            self->notified.wait(lock, [self]() { return self->notifications > 0; });
+        } else if (s.virtualClock) {
+            lock.unlock();
+            vTaskDelay(ticks);
+            lock.lock();
+        } else {
+            self->notified.wait_for(lock, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS),
+                                    [self]() { return self->notifications > 0; });
+        }
+    }
+    const uint32_t value = self->notifications;
+    if (value > 0) {
+        self->notifications = clearOnExit ? 0 : value - 1;
+    }
+    return value;
+}
+
+inline TickType_t xTaskGetTickCount() {
+    return static_cast<TickType_t>(hal::sim::nowUs() / 1000 / portTICK_PERIOD_MS);
+}
+
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t /*task*/) {
+    return 0;
+}
+
+#endif // HAL_NATIVE_FREERTOS_TASK_H
@@ -0,0 +1,52 @@
+/**
+ * @file nvs_flash.h
+ * @brief Native HAL: NVS partition init/erase and statistics over hal::sim::state().nvs.
+ */
+
+#ifndef HAL_NATIVE_NVS_FLASH_H
+#define HAL_NATIVE_NVS_FLASH_H
+
+#include <cstddef>
+#include "esp_timer.h"
+#include "HalSim.h"
+
+typedef struct {
+    size_t used_entries;
+    size_t free_entries;
+    size_t total_entries;
+    size_t namespace_count;
+} nvs_stats_t;
+
+// Matches the 0x5000 byte "nvs" partition in partitions.csv: 5 pages of 126 entries.
+constexpr size_t HAL_NATIVE_NVS_TOTAL_ENTRIES = 5 * 126;
+
+inline esp_err_t nvs_flash_init() {
+    return ESP_OK;
+}
+
+inline esp_err_t nvs_flash_erase() {
+    std::lock_guard<std::recursive_mutex> lock(hal::sim::state().mutex);
+    hal::sim::state().nvs.clear();
+    return ESP_OK;
+}
+
+// One NVS entry holds 32 bytes; blobs take a header entry plus their data entries.
+inline esp_err_t nvs_get_stats(const char* /*partition*/, nvs_stats_t* stats) {
+    if (stats == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard<std::recursive_mutex> lock(hal::sim::state().mutex);
+    size_t used = 0;
+    for (const auto& space : hal::sim::state().nvs) {
+        for (const auto& entry : space.second) {
+            used += entry.second.type == 'y' ? 2 + (entry.second.bytes.size() + 31) / 32 : 1;
+        }
+    }
+    stats->used_entries = used;
+    stats->total_entries = HAL_NATIVE_NVS_TOTAL_ENTRIES;
+    stats->free_entries = used < HAL_NATIVE_NVS_TOTAL_ENTRIES ? HAL_NATIVE_NVS_TOTAL_ENTRIES - used : 0;
+    stats->namespace_count = hal::sim::state().nvs.size();
+    return ESP_OK;
+}
+
+#endif // HAL_NATIVE_NVS_FLASH_H
@@ -1,5 +1,4 @@
 #include <Wire.h>
-#include <Adafruit_BMP085.h>
 #include <LiquidCrystal_I2C.h>
 #include <WiFi.h>
 #include <SPI.h>
@@ -11,9 +10,12 @@
 #include "secrets.h"
 #include "webserver.h"
 #include "SensorManager.h"
+#include "I2CBus.h"
 #include "LCDManager.h"
 #include "PublishManager.h"
 #include "RelayManager.h"
+#include "SensorTrace.h"
+#include "TimeSeriesLog.h"
 #include "globals.h"
 #include "PreferencesHandler.h"
 #include "nvs_flash.h" 
@@ -36,8 +38,9 @@ ESPTelemetry espTelemetry(mqttManager, "plant-friend/telemetry");
 ESPTimeSetup timeSetup("pool.ntp.org", 0, 3600);
 OTAManager otaManager;
 
-Adafruit_BMP085 bmp;
-LiquidCrystal_I2C lcd(0x27, 16, 2);
+constexpr uint8_t LCD_ADDRESS = 0x27;
+LiquidCrystal_I2C lcd(LCD_ADDRESS, 16, 2);
+I2CBus i2cBus(Wire);
 PreferencesHandler* prefsHandler = nullptr;
 ConfigManager* configManager = nullptr;
 SensorManager* sensorManager = nullptr;
@@ -45,6 +48,39 @@ RelayManager* relayManager = nullptr;
 LCDManager* lcdManager = nullptr;
 PublishManager* publishManager = nullptr;
 ESP32WebServer* webServer = nullptr;
+TimeSeriesLog timeSeriesLog(LittleFS);
+RTC_NOINIT_ATTR WateringHistory::RtcBlock wateringHistoryRtc;
+WateringHistory wateringHistory(wateringHistoryRtc);
+
+#ifdef SENSOR_TRACE
+// Raw sensor capture for replay on the host, see SensorTrace.h. Goes to /trace.bin, which the
+// web server serves, or with SENSOR_TRACE_MQTT to plant-friend/trace as one base64 message per scan.
+constexpr const char* SENSOR_TRACE_PATH = "/trace.bin";
+// The 544 KB littlefs partition holds ~92 KB of web assets and the 256 KB TimeSeriesLog budget,
+// leaving ~196 KB; LittleFS needs some of that free for its copy-on-write blocks. 128 KB is about
+// 15 hours of 4-zone scans at one a minute, use SENSOR_TRACE_MQTT for longer captures.
+constexpr size_t SENSOR_TRACE_MAX_BYTES = 128 * 1024;
+
+bool writeSensorTrace(const uint8_t* data, size_t len) {
+#ifdef SENSOR_TRACE_MQTT
+  static char encoded[2048];
+  return SensorTrace::toBase64(data, len, encoded, sizeof(encoded)) > 0 &&
+         mqttManager.publish("plant-friend/trace", encoded);
+#else
+  File file = LittleFS.open(SENSOR_TRACE_PATH, FILE_APPEND);
+  if (!file) return false;
+  const bool ok = file.size() + len <= SENSOR_TRACE_MAX_BYTES && file.write(data, len) == len;
+  file.close();
+  return ok;
+#endif
+}
+
+#ifdef SENSOR_TRACE_MQTT
+SensorTraceWriter sensorTrace(writeSensorTrace, true);
+#else
+SensorTraceWriter sensorTrace(writeSensorTrace);
+#endif
+#endif
 
 void setupLittleFS() {
   if (!LittleFS.begin(false, "/littlefs", 10, "littlefs")) {
@@ -67,20 +103,43 @@ void setup() {
   configManager->initializeConfigurations();
 
   sensorManager = new SensorManager(*configManager);
-  relayManager = new RelayManager(*configManager, *sensorManager);
-  lcdManager = new LCDManager(lcd, *sensorManager, *configManager);
-  webServer = new ESP32WebServer(80, *relayManager, *sensorManager, *configManager);
+  relayManager = new RelayManager(*configManager, *sensorManager, i2cBus);
+  lcdManager = new LCDManager(lcd, LCD_ADDRESS, *sensorManager, *configManager, i2cBus);
+  webServer = new ESP32WebServer(80, *relayManager, *sensorManager, *configManager, timeSeriesLog);
 
   otaManager.begin();
   timeSetup.begin();
   mqttManager.begin();
 
   setupLittleFS();
+  timeSeriesLog.begin();
+  sensorManager->setUpdateCallback([](const SensorData& data) {
+    timeSeriesLog.appendSensor(static_cast<uint32_t>(time(nullptr)), data);
+  });
+  // Runs in the esp_timer and float-switch tasks with relayMutex held: appendRelay() only buffers,
+  // the sensor task's appendSensor() writes to flash
+  relayManager->setRelayEventCallback([](int relayIndex, bool active) {
+    timeSeriesLog.appendRelay(static_cast<uint32_t>(time(nullptr)), static_cast<uint8_t>(relayIndex), active);
+#ifdef SENSOR_TRACE
+    sensorTrace.recordRelay(relayIndex, active);
+#endif
+  });
+
+  const auto& hwConfig = configManager->getHwConfig();
+  i2cBus.begin(hwConfig.sdaPin.value(), hwConfig.sclPin.value());
+  i2cBus.startTask();
 
   relayManager->init();
+  wateringHistory.begin();
+  relayManager->setWateringHistory(&wateringHistory);
   sensorManager->setupFloatSwitch();
-  sensorManager->setupSensors();
+  sensorManager->setupSensors(i2cBus);
+#ifdef SENSOR_TRACE
+  LittleFS.remove(SENSOR_TRACE_PATH);
+  sensorManager->setTrace(&sensorTrace);
+#endif
   sensorManager->startSensorTask();
+  relayManager->startControlWateringTask();
   webServer->begin();
   lcdManager->start();
   
@@ -100,6 +159,80 @@ void setup() {
         return uxTaskGetStackHighWaterMark(sensorManager->getTaskHandle());
   });
 
+  espTelemetry.addCustomData("float_switch_stack_hwm", []() -> UBaseType_t {
+        return uxTaskGetStackHighWaterMark(sensorManager->getFloatSwitchTaskHandle());
+  });
+
+  espTelemetry.addCustomData("sensor_sample_interval_ms", []() -> uint32_t {
+        return sensorManager->getSampleInterval();
+  });
+
+  espTelemetry.addCustomData("watering_latency_us", []() -> uint32_t {
+        return relayManager->getActuationLatencyUs();
+  });
+
+  espTelemetry.addCustomData("watering_max_latency_us", []() -> uint32_t {
+        return relayManager->getMaxActuationLatencyUs();
+  });
+
+  espTelemetry.addCustomData("watering_queue_depth", []() -> uint32_t {
+        return relayManager->getQueueDepth();
+  });
+
+  espTelemetry.addCustomData("watering_queue_max_wait_ms", []() -> uint32_t {
+        return relayManager->getMaxQueueWaitMs();
+  });
+
+  espTelemetry.addCustomData("watering_queue_last_wait_ms", []() -> uint32_t {
+        return relayManager->getLastQueueWaitMs();
+  });
+
+  espTelemetry.addCustomData("relays_active_current_ma", []() -> int {
+        return relayManager->getActiveCurrentMa();
+  });
+
+  espTelemetry.addCustomData("relay_events", []() -> uint32_t {
+        return relayManager->getRelayEventCount();
+  });
+
+  espTelemetry.addCustomData("watering_history_flushes", []() -> uint32_t {
+        return wateringHistory.getFlushCount();
+  });
+
+  espTelemetry.addCustomData("tslog_dropped_records", []() -> uint32_t {
+        return timeSeriesLog.getDroppedRecords();
+  });
+
+#ifdef SENSOR_TRACE
+  espTelemetry.addCustomData("sensor_trace_bytes", []() -> uint32_t {
+        return sensorTrace.isCapturing() ? sensorTrace.getBytesWritten() : 0;
+  });
+
+  espTelemetry.addCustomData("sensor_trace_dropped_records", []() -> uint32_t {
+        return sensorTrace.getDroppedRecords();
+  });
+#endif
+
+  espTelemetry.addCustomData("i2c_bmp085_errors", []() -> uint32_t {
+        I2CBus::DeviceStats stats;
+        return i2cBus.getStats(Bmp085::ADDRESS, stats) ? stats.errors : 0;
+  });
+
+  espTelemetry.addCustomData("i2c_bmp085_max_latency_us", []() -> uint32_t {
+        I2CBus::DeviceStats stats;
+        return i2cBus.getStats(Bmp085::ADDRESS, stats) ? stats.maxLatencyUs : 0;
+  });
+
+  espTelemetry.addCustomData("i2c_lcd_errors", []() -> uint32_t {
+        I2CBus::DeviceStats stats;
+        return i2cBus.getStats(LCD_ADDRESS, stats) ? stats.errors : 0;
+  });
+
+  espTelemetry.addCustomData("i2c_lcd_max_latency_us", []() -> uint32_t {
+        I2CBus::DeviceStats stats;
+        return i2cBus.getStats(LCD_ADDRESS, stats) ? stats.maxLatencyUs : 0;
+  });
+
 
   logger.log("Main", LogLevel::INFO, "Setup complete");   
 }
@@ -10,8 +10,11 @@
 #include "SensorManager.h"
 #include "ConfigManager.h"
 #include "RelayManager.h"
-#include "Globals.h"
+#include "TimeSeriesLog.h"
+#include "globals.h"
 #include <vector>
+#include <algorithm>
+#include <memory>
 #include <AsyncJson.h>
 #include "ESPLogger.h"
 #include "WebsocketManager.h"
@@ -25,9 +28,12 @@ private:
     RelayManager& relayManager;
     SensorManager& sensorManager; 
     ConfigManager& configManager; 
+    TimeSeriesLog& timeSeriesLog;
     AsyncEventSource* events;
     WebSocketManager wsManager;
     JsonHandler jsonHandler;
+    static constexpr size_t HISTORY_DEFAULT_POINTS = 120;
+    static constexpr uint32_t EXPORT_DEFAULT_SECONDS = 24 * 3600;
 
     void setupRoutes() {
         server.on("/favicon.ico", HTTP_GET, [this](AsyncWebServerRequest *request){
@@ -42,6 +48,8 @@ private:
         server.on("/api/logs", HTTP_GET, std::bind(&ESP32WebServer::handleGetLogs, this, std::placeholders::_1));
         server.on("/api/config", HTTP_GET, std::bind(&ESP32WebServer::handleGetConfig, this, std::placeholders::_1));
         server.on("/api/sensorData", HTTP_GET, std::bind(&ESP32WebServer::handleGetSensorData, this, std::placeholders::_1));
+        server.on("/api/history", HTTP_GET, std::bind(&ESP32WebServer::handleGetHistory, this, std::placeholders::_1));
+        server.on("/api/export", HTTP_GET, std::bind(&ESP32WebServer::handleGetExport, this, std::placeholders::_1));
         server.on("/api/resetToDefault", HTTP_GET, std::bind(&ESP32WebServer::handleResetToDefault, this, std::placeholders::_1));
         server.on("/api/setup", HTTP_GET, std::bind(&ESP32WebServer::handleGetSetup, this, std::placeholders::_1));
         server.on("/api/resetSetup", HTTP_POST, std::bind(&ESP32WebServer::handlePostResetSetup, this, std::placeholders::_1));
@@ -157,6 +165,49 @@ private:
         request->send(response);
     }
 
+    // GET /api/history?range=hour|day|month&points=N
+    // Streams the series straight from the history buffers, no JsonDocument is built.
+    void handleGetHistory(AsyncWebServerRequest *request) {
+        SensorHistory::Range range = SensorHistory::Range::HOUR;
+        if (request->hasParam("range") && !SensorHistory::parseRange(request->getParam("range")->value().c_str(), range)) {
+            request->send(400, "application/json", "{\"status\":\"error\",\"message\":\"Invalid range\"}");
+            return;
+        }
+
+        size_t points = HISTORY_DEFAULT_POINTS;
+        if (request->hasParam("points")) {
+            long requested = request->getParam("points")->value().toInt();
+            points = std::clamp<long>(requested, 1, SensorHistory::MONTH_BUCKETS);
+        }
+
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        sensorManager.getHistory().writeJson(*response, range, points, configManager.getHwConfig().systemSize.value(),
+                                             static_cast<uint32_t>(time(nullptr)));
+        request->send(response);
+    }
+
+    // GET /api/export?from=<unix>&to=<unix>, defaults to the last 24 hours.
+    // Chunked CSV read from the LittleFS log one buffer at a time; only the cursor is kept in RAM.
+    void handleGetExport(AsyncWebServerRequest *request) {
+        const uint32_t to = request->hasParam("to") ? strtoul(request->getParam("to")->value().c_str(), nullptr, 10)
+                                                    : static_cast<uint32_t>(time(nullptr));
+        const uint32_t from = request->hasParam("from") ? strtoul(request->getParam("from")->value().c_str(), nullptr, 10)
+                                                        : (to > EXPORT_DEFAULT_SECONDS ? to - EXPORT_DEFAULT_SECONDS : 0);
+        if (from > to) {
+            request->send(400, "application/json", "{\"status\":\"error\",\"message\":\"Invalid time range\"}");
+            return;
+        }
+
+        auto cursor = std::make_shared<TimeSeriesLog::ExportCursor>();
+        timeSeriesLog.beginExport(*cursor, from, to);
+        AsyncWebServerResponse *response = request->beginChunkedResponse("text/csv",
+            [this, cursor](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                return timeSeriesLog.readCsv(*cursor, buffer, maxLen);
+            });
+        response->addHeader("Content-Disposition", "attachment; filename=\"garduino.csv\"");
+        request->send(response);
+    }
+
     void handlePostRelay(AsyncWebServerRequest *request, JsonVariant &json) {
         if (json.is<JsonObject>()) {
             JsonObject jsonObj = json.as<JsonObject>();
@@ -207,13 +258,15 @@ private:
     }
       
 public:
-    ESP32WebServer(int port, RelayManager& relayManager, SensorManager& sensorManager, ConfigManager& configManager)
+    ESP32WebServer(int port, RelayManager& relayManager, SensorManager& sensorManager, ConfigManager& configManager,
+                   TimeSeriesLog& timeSeriesLog)
         :   server(port), 
             logger(Logger::instance()),
             relayManager(relayManager), 
             serverPort(port), 
             sensorManager(sensorManager), 
             configManager(configManager),
+            timeSeriesLog(timeSeriesLog),
             wsManager(server) 
         {
             setupRoutes();
@@ -0,0 +1,20 @@
+/**
+ * @file AllocationCounter.h
+ * @brief Heap allocations of the test binary, counted by the operator new replacement in
+ *        test_main.cpp. Tests compare the counters before and after the code under test.
+ */
+
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <atomic>
+#include <cstdint>
+
+struct AllocationCounter {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> bytes{0};
+};
+
+AllocationCounter& allocationCounter();
+
+#endif // ALLOCATION_COUNTER_H
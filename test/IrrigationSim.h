@@ -0,0 +1,378 @@
+/**
+ * @file IrrigationSim.h
+ * @brief Deterministic host simulation of the whole irrigation loop.
+ *
+ * Runs ConfigManager, SensorManager, RelayManager and PublishManager on the hal::sim virtual
+ * clock against a soil model per zone and a reservoir, so weeks or months of operation take
+ * seconds. No task is started: the harness calls the managers' work functions in the order
+ * their tasks would run them:
+ *
+ *   sensor task      updateSensorData(), then sleeps scheduleNextSample() ms, woken early when
+ *                    a pump starts
+ *   controller task  evaluateZones() after every snapshot and every relay switching off, and
+ *                    when its returned deadline runs out
+ *   publish tasks    publishSensorDataOnce() / publishTelemetryOnce() at their intervals
+ *
+ * Deactivation timers and the float switch debounce fire from the virtual clock as on the
+ * device. The soil and reservoir models step in fixed chunks (1 s while a pump runs), and sensor
+ * noise comes from a seeded generator, so a scenario always produces the same Report.
+ *
+ * Soil model, per zone, with m the true moisture in percent:
+ *   pumped water enters an infiltration store and reaches the probe with time constant
+ *   infiltrationS; absorbed water raises m by 100 * ml / capacityMl, anything above 100 % runs
+ *   off; evapotranspiration takes dryingPerDay * m / 50 % per day, scaled by a day curve that
+ *   peaks at noon and averages 1.
+ *
+ * Allocation counts come from allocationCounter(), see AllocationCounter.h.
+ */
+
+#ifndef IRRIGATION_SIM_H
+#define IRRIGATION_SIM_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "AllocationCounter.h"
+#include "SimTestSetup.h"
+#include "ConfigManager.h"
+#include "MQTTManager.h"
+#include "PublishManager.h"
+#include "RelayManager.h"
+#include "SensorManager.h"
+
+namespace sim {
+
+struct ZoneParams {
+    float initialMoisture = 45.0f;      // %
+    float capacityMl = 1000.0f;         // water that takes the soil from 0 to 100 %
+    float dryingPerDay = 8.0f;          // % per day at 50 % moisture, daily average
+    float infiltrationS = 300.0f;       // time constant for pumped water to reach the probe
+    float pumpFlowMlPerS = 25.0f;       // 1.5 l/min
+};
+
+struct ReservoirParams {
+    float capacityMl = 20000.0f;
+    float floatSwitchMl = 1500.0f;      // the float switch reports low water below this
+    uint32_t refillEveryDays = 14;      // 0: never refilled
+};
+
+struct Scenario {
+    std::vector<ZoneParams> zones = std::vector<ZoneParams>(4);
+    ReservoirParams reservoir;
+    uint32_t days = 30;
+    uint32_t seed = 1;
+    // Applied after the defaults, e.g. thresholds, intervals or the power budget under test.
+    std::function<void(ConfigManager&)> configure;
+};
+
+struct Allocations {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+};
+
+struct ZoneReport {
+    double waterMl = 0;
+    double runoffMl = 0;
+    double belowThresholdS = 0;
+    double relayOnS = 0;
+    float minMoisture = 100.0f;
+    float maxMoisture = 0.0f;
+    uint32_t waterings = 0;
+};
+
+struct Report {
+    double simulatedS = 0;
+    std::vector<ZoneReport> zones;
+    double reservoirUsedMl = 0;
+    uint32_t refills = 0;
+    double lowWaterS = 0;
+    double dryRunS = 0;             // pump on with an empty reservoir
+    uint64_t samples = 0;
+    uint64_t controllerPasses = 0;
+    uint64_t publishes = 0;
+    uint32_t relayEvents = 0;
+    Allocations setup;              // construction and configuration
+    Allocations sensor;             // updateSensorData() and scheduleNextSample()
+    Allocations controller;         // evaluateZones() and the relay timers it arms
+    Allocations publish;
+    double wallS = 0;
+
+    double dutyCycle(size_t zone) const {
+        return simulatedS > 0 ? zones[zone].relayOnS / simulatedS : 0;
+    }
+
+    void print(FILE* out) const {
+        const double days = simulatedS / 86400.0;
+        fprintf(out, "Simulated %.1f days in %.2f s\n", days, wallS);
+        fprintf(out, "zone  water_l  runoff_l  waterings  duty_%%  below_thr_h  moisture_%%\n");
+        for (size_t i = 0; i < zones.size(); ++i) {
+            const ZoneReport& z = zones[i];
+            fprintf(out, "%4zu  %7.2f  %8.2f  %9u  %6.3f  %11.1f  %4.1f..%4.1f\n", i, z.waterMl / 1000, z.runoffMl / 1000,
+                    z.waterings, 100 * dutyCycle(i), z.belowThresholdS / 3600, z.minMoisture, z.maxMoisture);
+        }
+        fprintf(out, "reservoir: %.2f l used, %u refills, low water %.1f h, dry run %.1f s\n", reservoirUsedMl / 1000,
+                refills, lowWaterS / 3600, dryRunS);
+        fprintf(out, "work: %llu samples, %llu controller passes, %llu publishes, %u relay events\n",
+                static_cast<unsigned long long>(samples), static_cast<unsigned long long>(controllerPasses),
+                static_cast<unsigned long long>(publishes), relayEvents);
+        const auto line = [&](const char* name, const Allocations& a) {
+            fprintf(out, "allocations %-10s %10llu (%llu bytes, %.1f per day)\n", name,
+                    static_cast<unsigned long long>(a.count), static_cast<unsigned long long>(a.bytes),
+                    days > 0 ? a.count / days : 0.0);
+        };
+        line("setup", setup);
+        line("sensor", sensor);
+        line("controller", controller);
+        line("publish", publish);
+    }
+};
+
+class IrrigationSim {
+public:
+    static constexpr int64_t DAY_US = 86400LL * 1000000;
+    static constexpr int64_t PUMP_STEP_US = 1000000;
+    static constexpr int64_t SOAK_STEP_US = 10 * 1000000;
+    static constexpr int64_t IDLE_STEP_US = 60 * 1000000;
+    static constexpr int DRY_RAW = 2592;    // default MoistureCalibration
+    static constexpr int WET_RAW = 975;
+
+    explicit IrrigationSim(const Scenario& scenario) : scenario(scenario), rng(scenario.seed) {}
+
+    Report run() {
+        const auto wallStart = std::chrono::steady_clock::now();
+        const Logger::Level logLevel = Logger::instance().getFilterLevel();
+        Logger::instance().setFilterLevel(Logger::Level::ERROR);
+
+        Report report;
+        {
+            Meter meter(report.setup);
+            setUp();
+        }
+        report.zones.resize(zones.size());
+        runLoop(report);
+
+        report.simulatedS = static_cast<double>(modelUs) / 1e6;
+        report.relayEvents = relays->getRelayEventCount();
+        report.publishes = mqtt.getPublishCount();
+        report.wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        Logger::instance().setFilterLevel(logLevel);
+        return report;
+    }
+
+private:
+    struct Zone {
+        ZoneParams params;
+        float moisture = 0;
+        float pendingMl = 0;
+    };
+
+    // Adds the allocations made during its lifetime to a phase
+    class Meter {
+    public:
+        explicit Meter(Allocations& into)
+            : into(into), count(allocationCounter().count.load()), bytes(allocationCounter().bytes.load()) {}
+        ~Meter() {
+            into.count += allocationCounter().count.load() - count;
+            into.bytes += allocationCounter().bytes.load() - bytes;
+        }
+    private:
+        Allocations& into;
+        uint64_t count;
+        uint64_t bytes;
+    };
+
+    Scenario scenario;
+    uint32_t rng;
+    std::vector<Zone> zones;
+    float reservoirMl = 0;
+    bool floatLow = false;
+    int64_t modelUs = 0;
+
+    PreferencesHandler prefs;
+    std::unique_ptr<ConfigManager> config;
+    std::unique_ptr<SensorManager> sensors;
+    I2CBus i2cBus;
+    std::unique_ptr<RelayManager> relays;
+    ESPMQTTManager mqtt;
+    std::unique_ptr<PublishManager> publisher;
+
+    void setUp() {
+        resetSim();
+        mqtt.setKeepMessages(false);
+
+        config = std::make_unique<ConfigManager>(prefs);
+        config->begin("cfg");
+        ConfigTypes::HardwareConfig hw;
+        hw.systemSize = static_cast<int>(scenario.zones.size());
+        config->setHardwareConfig(hw);
+        config->begin("cfg");       // creates the settings of the added zones
+        if (scenario.configure) {
+            scenario.configure(*config);
+        }
+
+        for (const ZoneParams& params : scenario.zones) {
+            Zone zone;
+            zone.params = params;
+            zone.moisture = params.initialMoisture;
+            zones.push_back(zone);
+        }
+        reservoirMl = scenario.reservoir.capacityMl;
+        hal::sim::setDigital(config->getHwConfig().floatSwitchPin.value(), HIGH);
+        writeProbes();
+
+        sensors = std::make_unique<SensorManager>(*config);
+        relays = std::make_unique<RelayManager>(*config, *sensors, i2cBus);
+        relays->init();
+        sensors->setupFloatSwitch();
+        publisher = std::make_unique<PublishManager>(*sensors, mqtt, *config);
+        modelUs = hal::sim::nowUs();
+    }
+
+    void runLoop(Report& report) {
+        const int64_t endUs = modelUs + static_cast<int64_t>(scenario.days) * DAY_US;
+        const int64_t refillUs = static_cast<int64_t>(scenario.reservoir.refillEveryDays) * DAY_US;
+        int64_t nextSampleUs = modelUs;
+        int64_t nextControlUs = modelUs;
+        int64_t nextPublishUs = modelUs;
+        int64_t nextTelemetryUs = modelUs;
+        int64_t nextRefillUs = refillUs > 0 ? modelUs + refillUs : INT64_MAX;
+        uint32_t relayMask = 0;
+
+        while (modelUs < endUs) {
+            const int64_t target = std::min({nextSampleUs, nextControlUs, nextPublishUs, nextTelemetryUs, endUs});
+            while (modelUs < target) {
+                step(report, target);
+                if (modelUs >= nextRefillUs) {
+                    reservoirMl = scenario.reservoir.capacityMl;
+                    report.refills++;
+                    nextRefillUs += refillUs;
+                    updateFloatSwitch();
+                }
+                // A relay switching off wakes the controller; stop stepping at that point
+                const uint32_t mask = relays->getRelayMask();
+                if (relayMask & ~mask) {
+                    relayMask = mask;
+                    nextControlUs = modelUs;
+                    break;
+                }
+                relayMask = mask;
+            }
+            const int64_t now = modelUs;
+
+            if (now >= nextSampleUs) {
+                Meter meter(report.sensor);
+                sensors->updateSensorData();
+                report.samples++;
+                nextSampleUs = hal::sim::nowUs() + static_cast<int64_t>(sensors->scheduleNextSample()) * 1000;
+                nextControlUs = now;
+            }
+            if (now >= nextControlUs) {
+                uint32_t waitMs;
+                {
+                    Meter meter(report.controller);
+                    waitMs = relays->evaluateZones();
+                }
+                report.controllerPasses++;
+                nextControlUs = waitMs == RelayManager::NO_DEADLINE ? INT64_MAX
+                                                                   : hal::sim::nowUs() + static_cast<int64_t>(waitMs) * 1000;
+                const uint32_t mask = relays->getRelayMask();
+                if (mask & ~relayMask) {
+                    nextSampleUs = now;     // setActuating() wakes the sensor task
+                    for (size_t i = 0; i < zones.size(); ++i) {
+                        if ((mask & ~relayMask) & (1u << i)) report.zones[i].waterings++;
+                    }
+                }
+                relayMask = mask;
+            }
+            if (now >= nextPublishUs) {
+                Meter meter(report.publish);
+                nextPublishUs = now + static_cast<int64_t>(publisher->publishSensorDataOnce()) * 1000;
+            }
+            if (now >= nextTelemetryUs) {
+                Meter meter(report.publish);
+                nextTelemetryUs = now + static_cast<int64_t>(publisher->publishTelemetryOnce()) * 1000;
+            }
+        }
+    }
+
+    // Advances the clock and the models by one chunk, at most to `target`.
+    void step(Report& report, int64_t target) {
+        const uint32_t mask = relays->getRelayMask();
+        bool soaking = false;
+        for (const Zone& zone : zones) {
+            soaking |= zone.pendingMl > 1.0f;
+        }
+        const int64_t chunk = mask ? PUMP_STEP_US : soaking ? SOAK_STEP_US : IDLE_STEP_US;
+        const int64_t to = std::min(target, modelUs + chunk);
+        if (hal::sim::nowUs() < to) {
+            hal::sim::advanceUs(to - hal::sim::nowUs());    // fires deactivation timers on the way
+        }
+        const float dt = static_cast<float>(to - modelUs) / 1e6f;
+        const float dayCurve = 1.0f + 0.8f * std::sin(2.0f * static_cast<float>(M_PI) *
+                                                      (static_cast<float>(modelUs % DAY_US) / DAY_US - 0.25f));
+
+        for (size_t i = 0; i < zones.size(); ++i) {
+            Zone& zone = zones[i];
+            ZoneReport& zr = report.zones[i];
+            if (mask & (1u << i)) {
+                zr.relayOnS += dt;
+                const float pumped = std::min(zone.params.pumpFlowMlPerS * dt, reservoirMl);
+                if (pumped <= 0.0f) report.dryRunS += dt;
+                reservoirMl -= pumped;
+                report.reservoirUsedMl += pumped;
+                zr.waterMl += pumped;
+                zone.pendingMl += pumped;
+            }
+            const float absorbed = zone.pendingMl * (1.0f - std::exp(-dt / zone.params.infiltrationS));
+            zone.pendingMl -= absorbed;
+            zone.moisture += 100.0f * absorbed / zone.params.capacityMl;
+            if (zone.moisture > 100.0f) {
+                zr.runoffMl += (zone.moisture - 100.0f) * zone.params.capacityMl / 100.0f;
+                zone.moisture = 100.0f;
+            }
+            const float drying = zone.params.dryingPerDay / 86400.0f * (zone.moisture / 50.0f) * dayCurve * dt;
+            zone.moisture = std::max(0.0f, zone.moisture - drying);
+
+            if (zone.moisture < config->getSensorConfig(i).threshold.value()) zr.belowThresholdS += dt;
+            zr.minMoisture = std::min(zr.minMoisture, zone.moisture);
+            zr.maxMoisture = std::max(zr.maxMoisture, zone.moisture);
+        }
+        if (floatLow) report.lowWaterS += dt;
+        modelUs = to;
+        writeProbes();
+        updateFloatSwitch();
+    }
+
+    void writeProbes() {
+        const auto& pins = config->getHwConfig().moistureSensorPins;
+        for (size_t i = 0; i < zones.size() && i < pins.size(); ++i) {
+            const float raw = DRY_RAW - zones[i].moisture / 100.0f * (DRY_RAW - WET_RAW);
+            hal::sim::setAnalog(pins[i], static_cast<int>(std::lround(raw)) + noise());
+        }
+    }
+
+    void updateFloatSwitch() {
+        const bool low = reservoirMl < scenario.reservoir.floatSwitchMl;
+        if (low == floatLow) return;
+        floatLow = low;
+        hal::sim::setDigital(config->getHwConfig().floatSwitchPin.value(), low ? LOW : HIGH);
+        sensors->settleFloatSwitch();
+    }
+
+    // -3..3 ADC counts, xorshift32
+    int noise() {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return static_cast<int>(rng % 7) - 3;
+    }
+};
+
+}  // namespace sim
+
+#endif // IRRIGATION_SIM_H
@@ -0,0 +1,299 @@
+/**
+ * @file SensorTraceReplay.h
+ * @brief Replays a sensor trace (see SensorTrace.h) through the native SensorManager and
+ *        RelayManager and compares the outcome with what the device computed.
+ *
+ * The managers are rebuilt from the configuration in the trace header on the hal::sim virtual
+ * clock, with a BMP085 model serving the recorded calibration. Then, in trace time order:
+ *
+ *   scans         the recorded ADC samples are served to analogRead() in the order the device
+ *                 read them and the recorded UT and result register to the BMP085 model; one
+ *                 updateSensorData() must then produce the recorded snapshot bit for bit
+ *   float switch  recorded level changes are applied to the pin and debounced; a change that
+ *                 fell inside a scan is applied before it, as the device saw it at the scan end
+ *   controller    evaluateZones() runs after every snapshot, after every relay switching off and
+ *                 at the deadline it returns, as the watering task does
+ *
+ * The relay switches of the replay are collected next to the recorded ones. They match as long
+ * as nobody switched a relay by hand during the capture; manual switches are recorded but not
+ * replayed. ADS1115 channels are not replayed (their samples do not come from analogRead()).
+ */
+
+#ifndef SENSOR_TRACE_REPLAY_H
+#define SENSOR_TRACE_REPLAY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "SimTestSetup.h"
+#include "Bmp085Sim.h"
+#include "ConfigManager.h"
+#include "RelayManager.h"
+#include "SensorManager.h"
+#include "SensorTrace.h"
+
+namespace sim {
+
+/**
+ * Runs the watering controller the way its task does: after a snapshot, after a relay switched
+ * off (checked every CHUNK_US of clock) and at the returned deadline. Shared by the replay and
+ * by tests that capture a trace on the host, so both sides switch relays at the same points.
+ */
+class ControllerDriver {
+public:
+    static constexpr int64_t CHUNK_US = 1000000;
+
+    explicit ControllerDriver(RelayManager& relays) : relays(relays) {}
+
+    // Advances the clock to `us`, firing relay timers and controller passes on the way.
+    void advanceTo(int64_t us) {
+        while (hal::sim::nowUs() < us) {
+            const int64_t to = std::min({us, nextControlUs, hal::sim::nowUs() + CHUNK_US});
+            if (to > hal::sim::nowUs()) {
+                hal::sim::advanceUs(to - hal::sim::nowUs());
+            }
+            const uint32_t mask = relays.getRelayMask();
+            if ((relayMask & ~mask) || hal::sim::nowUs() >= nextControlUs) {
+                evaluate();
+            } else {
+                relayMask = mask;
+            }
+        }
+    }
+
+    void evaluate() {
+        const uint32_t waitMs = relays.evaluateZones();
+        nextControlUs = waitMs == RelayManager::NO_DEADLINE ? INT64_MAX
+                                                            : hal::sim::nowUs() + static_cast<int64_t>(waitMs) * 1000;
+        relayMask = relays.getRelayMask();
+    }
+
+private:
+    RelayManager& relays;
+    int64_t nextControlUs = INT64_MAX;
+    uint32_t relayMask = 0;
+};
+
+struct ReplayReport {
+    bool headerValid = false;
+    uint32_t scans = 0;
+    uint32_t mismatches = 0;            // snapshots that differ from the recorded one
+    int64_t firstMismatchUs = -1;       // trace time of the first of them
+    uint32_t samples = 0;
+    uint32_t missingSamples = 0;        // analogRead() calls beyond the samples recorded for a scan
+    uint32_t floatSwitchChanges = 0;
+    std::vector<std::pair<uint8_t, bool>> recordedRelays;
+    std::vector<std::pair<uint8_t, bool>> replayedRelays;
+
+    bool relaysMatch() const {
+        return recordedRelays == replayedRelays;
+    }
+
+    void print(FILE* out) const {
+        fprintf(out, "replayed %u scans (%u samples, %u missing), %u float switch changes\n", scans, samples,
+                missingSamples, floatSwitchChanges);
+        fprintf(out, "snapshot mismatches: %u", mismatches);
+        if (mismatches > 0) fprintf(out, ", first at %.3f s", firstMismatchUs / 1e6);
+        fprintf(out, "\nrelay switches: %zu recorded, %zu replayed, %s\n", recordedRelays.size(),
+                replayedRelays.size(), relaysMatch() ? "identical" : "DIFFERENT");
+    }
+};
+
+class SensorTraceReplay {
+public:
+    SensorTraceReplay(const uint8_t* data, size_t len) : data(data), len(len) {}
+
+    ReplayReport run() {
+        ReplayReport report;
+        SensorTraceReader reader(data, len);
+        if (!reader.readHeader(traceConfig)) return report;
+        report.headerValid = true;
+        parse(reader, report);
+
+        const Logger::Level logLevel = Logger::instance().getFilterLevel();
+        Logger::instance().setFilterLevel(Logger::Level::ERROR);
+        setUp(report);
+
+        size_t edge = 0;
+        for (const Scan& scan : scans) {
+            for (; edge < edges.size() && edges[edge].timeUs <= scan.startUs; ++edge) {
+                applyEdge(edges[edge], report);
+            }
+            controller->advanceTo(baseUs + scan.startUs);
+            runScan(scan, report);
+        }
+        for (; edge < edges.size(); ++edge) {
+            applyEdge(edges[edge], report);
+        }
+
+        hal::sim::setAnalogSource(nullptr);
+        relays->setRelayEventCallback(nullptr);
+        hal::sim::attachI2C(hal::sim::Bmp085Device::ADDRESS, nullptr);
+        Logger::instance().setFilterLevel(logLevel);
+        return report;
+    }
+
+private:
+    struct Scan {
+        int64_t startUs = 0;        // trace time of its first sample
+        int64_t endUs = 0;
+        size_t firstSample = 0;
+        size_t sampleCount = 0;
+        bool hasBmp = false;
+        uint16_t ut = 0;
+        uint32_t result = 0;
+        SensorData recorded;
+    };
+
+    struct Edge {
+        int64_t timeUs = 0;
+        bool waterOk = true;
+    };
+
+    const uint8_t* data;
+    size_t len;
+    SensorTraceConfig traceConfig;
+    std::vector<uint16_t> samples;
+    std::vector<Scan> scans;
+    std::vector<Edge> edges;
+
+    PreferencesHandler prefs;
+    std::unique_ptr<ConfigManager> config;
+    std::unique_ptr<SensorManager> sensors;
+    I2CBus i2cBus;
+    std::unique_ptr<RelayManager> relays;
+    std::unique_ptr<ControllerDriver> controller;
+    hal::sim::Bmp085Device bmp;
+    int64_t baseUs = 0;
+    size_t nextSample = 0;
+    size_t sampleEnd = 0;
+    SensorData replayed;
+
+    void parse(SensorTraceReader& reader, ReplayReport& report) {
+        SensorTraceReader::Record record;
+        Scan scan;
+        bool scanOpen = false;
+        while (reader.next(record)) {
+            switch (record.type) {
+                case SensorTrace::ADC_SAMPLE:
+                case SensorTrace::BMP085_RAW:
+                    if (!scanOpen) {
+                        scan = Scan();
+                        scan.startUs = record.timeUs;
+                        scan.firstSample = samples.size();
+                        scanOpen = true;
+                    }
+                    if (record.type == SensorTrace::ADC_SAMPLE) {
+                        samples.push_back(record.value);
+                        scan.sampleCount++;
+                    } else {
+                        scan.hasBmp = true;
+                        scan.ut = record.ut;
+                        scan.result = record.result;
+                    }
+                    break;
+                case SensorTrace::SCAN:
+                    if (!scanOpen) {
+                        scan = Scan();
+                        scan.startUs = record.timeUs;
+                        scan.firstSample = samples.size();
+                    }
+                    scan.endUs = record.timeUs;
+                    scan.recorded = record.scan;
+                    scans.push_back(scan);
+                    scanOpen = false;
+                    break;
+                case SensorTrace::FLOAT_SWITCH:
+                    // The device saw a change during a scan at its end; apply it before the scan
+                    edges.push_back({scanOpen ? scan.startUs : record.timeUs, record.flag});
+                    break;
+                case SensorTrace::RELAY:
+                    report.recordedRelays.emplace_back(record.index, record.flag);
+                    break;
+            }
+        }
+    }
+
+    void setUp(ReplayReport& report) {
+        resetSim();
+
+        config = std::make_unique<ConfigManager>(prefs);
+        config->begin("replay");
+        ConfigTypes::HardwareConfig hw;
+        hw.systemSize = static_cast<int>(traceConfig.zones.size());
+        config->setHardwareConfig(hw);
+        config->begin("replay");    // creates the settings of the added zones
+        traceConfig.applyTo(*config);
+
+        // The first record is the level when the capture started
+        const bool waterOk = edges.empty() || edges.front().waterOk;
+        hal::sim::setDigital(traceConfig.floatSwitchPin, waterOk ? HIGH : LOW);
+        hal::sim::setAnalogSource([this, &report](int) -> int {
+            if (nextSample >= sampleEnd) {
+                report.missingSamples++;
+                return 0;
+            }
+            report.samples++;
+            return samples[nextSample++];
+        });
+
+        sensors = std::make_unique<SensorManager>(*config);
+        sensors->setupFloatSwitch();
+        if (traceConfig.bmpPresent) {
+            bmp.setCalibration(traceConfig.bmpCalibration.data());
+            hal::sim::attachI2C(hal::sim::Bmp085Device::ADDRESS, &bmp);
+            sensors->setupSensors(i2cBus);
+        }
+        sensors->setUpdateCallback([this](const SensorData& snapshot) { replayed = snapshot; });
+        relays = std::make_unique<RelayManager>(*config, *sensors, i2cBus);
+        relays->setRelayEventCallback([&report](int relay, bool on) {
+            report.replayedRelays.emplace_back(static_cast<uint8_t>(relay), on);
+        });
+        relays->init();
+        controller = std::make_unique<ControllerDriver>(*relays);
+        baseUs = hal::sim::nowUs();
+    }
+
+    void applyEdge(const Edge& edge, ReplayReport& report) {
+        controller->advanceTo(baseUs + edge.timeUs);
+        hal::sim::setDigital(traceConfig.floatSwitchPin, edge.waterOk ? HIGH : LOW);
+        if (sensors->settleFloatSwitch()) {
+            report.floatSwitchChanges++;
+        }
+    }
+
+    void runScan(const Scan& scan, ReplayReport& report) {
+        nextSample = scan.firstSample;
+        sampleEnd = scan.firstSample + scan.sampleCount;
+        if (scan.hasBmp) {
+            bmp.ut = scan.ut;
+            bmp.result = static_cast<int32_t>(scan.result);
+        }
+        sensors->updateSensorData();
+        report.scans++;
+        if (!sameSnapshot(scan.recorded, replayed)) {
+            if (report.mismatches++ == 0) report.firstMismatchUs = scan.endUs;
+        }
+        controller->evaluate();
+    }
+
+    static bool sameSnapshot(const SensorData& recorded, const SensorData& replayed) {
+        if (recorded.validMask != replayed.validMask || recorded.waterLevel != replayed.waterLevel ||
+            memcmp(&recorded.temperature, &replayed.temperature, sizeof(float)) != 0 ||
+            memcmp(&recorded.pressure, &replayed.pressure, sizeof(float)) != 0) {
+            return false;
+        }
+        for (size_t ch = 0; ch < SensorData::MAX_CHANNELS; ++ch) {
+            if (recorded.isValid(ch) && recorded.moistureTenths[ch] != replayed.moistureTenths[ch]) return false;
+        }
+        return true;
+    }
+};
+
+}  // namespace sim
+
+#endif // SENSOR_TRACE_REPLAY_H
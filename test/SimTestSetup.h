@@ -0,0 +1,46 @@
+/**
+ * @file SimTestSetup.h
+ * @brief Setup shared by the tests that run on the simulated board: a freshly reset simulator
+ *        on the virtual clock, and a ConfigManager holding the defaults of a first boot.
+ */
+
+#ifndef SIM_TEST_SETUP_H
+#define SIM_TEST_SETUP_H
+
+#include <gtest/gtest.h>
+#include "HalSim.h"
+#include "ConfigManager.h"
+
+// Clears pins, I2C devices, NVS and files; time then only moves on hal::sim::advanceUs().
+inline void resetSim() {
+    hal::sim::reset();
+    hal::sim::useVirtualClock();
+}
+
+// Readings are used as sampled, so one scan moves a zone's moisture.
+inline void disableMoistureFilter(ConfigManager& config) {
+    ConfigTypes::SoftwareConfig sw;
+    sw.moistureFilter = 0;
+    config.setSoftwareConfig(sw);
+}
+
+class SimTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        resetSim();
+    }
+};
+
+// A reset board after its first boot, with the default settings written to NVS.
+class ConfiguredSimTest : public SimTest {
+protected:
+    PreferencesHandler prefs;
+    ConfigManager config{prefs};
+
+    void SetUp() override {
+        SimTest::SetUp();
+        ASSERT_TRUE(config.begin("cfg"));
+    }
+};
+
+#endif // SIM_TEST_SETUP_H
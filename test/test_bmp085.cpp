@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "SimTestSetup.h"
+#include "Bmp085Sim.h"
+#include "Bmp085.h"
+#include "SensorManager.h"
+
+class Bmp085Test : public ConfiguredSimTest {
+protected:
+    hal::sim::Bmp085Device device;
+    I2CBus bus;
+
+    void SetUp() override {
+        ConfiguredSimTest::SetUp();
+        hal::sim::attachI2C(hal::sim::Bmp085Device::ADDRESS, &device);
+    }
+
+    void TearDown() override {
+        hal::sim::attachI2C(hal::sim::Bmp085Device::ADDRESS, nullptr);
+    }
+
+    // Polls every millisecond until the reading completes, returns the elapsed time in us.
+    static int64_t runReading(Bmp085& bmp) {
+        const int64_t start = hal::sim::nowUs();
+        EXPECT_TRUE(bmp.start());
+        while (!bmp.poll()) {
+            EXPECT_TRUE(bmp.isBusy());
+            hal::sim::advanceUs(1000);
+        }
+        return hal::sim::nowUs() - start;
+    }
+};
+
+TEST_F(Bmp085Test, MatchesDatasheetExample) {
+    Bmp085 bmp;
+    ASSERT_TRUE(bmp.begin(bus, Bmp085::ULTRALOWPOWER));
+    runReading(bmp);
+
+    EXPECT_FLOAT_EQ(bmp.getTemperature(), 15.0f);
+    EXPECT_EQ(bmp.getPressure(), 69964);
+    EXPECT_EQ(device.earlyReads, 0);
+}
+
+TEST_F(Bmp085Test, StartAndPollNeverBlock) {
+    Bmp085 bmp;
+    ASSERT_TRUE(bmp.begin(bus, Bmp085::ULTRAHIGHRES));
+
+    const int64_t start = hal::sim::nowUs();
+    ASSERT_TRUE(bmp.start());
+    EXPECT_FALSE(bmp.poll());
+    EXPECT_EQ(bmp.getState(), Bmp085::State::TEMPERATURE);
+    EXPECT_EQ(bmp.usUntilReady(), 4500u);
+    EXPECT_EQ(hal::sim::nowUs(), start);
+}
+
+TEST_F(Bmp085Test, OversamplingSetsConversionTimeAndKeepsResult) {
+    const int64_t expectedUs[4] = {10000, 13000, 19000, 31000};  // both conversions, rounded up to the 1 ms poll
+    for (uint8_t mode = Bmp085::ULTRALOWPOWER; mode <= Bmp085::ULTRAHIGHRES; ++mode) {
+        Bmp085 bmp;
+        ASSERT_TRUE(bmp.begin(bus, mode));
+        EXPECT_EQ(runReading(bmp), expectedUs[mode]) << "mode " << int(mode);
+        EXPECT_EQ(device.lastOversampling, mode);
+        EXPECT_NEAR(bmp.getPressure(), 69964, 2) << "mode " << int(mode);
+    }
+    EXPECT_EQ(device.earlyReads, 0);
+}
+
+TEST_F(Bmp085Test, PressureSharesTheTemperatureConversion) {
+    Bmp085 bmp;
+    ASSERT_TRUE(bmp.begin(bus));
+    for (int i = 0; i < 3; ++i) {
+        runReading(bmp);
+    }
+    EXPECT_EQ(device.temperatureConversions, 3);
+    EXPECT_EQ(device.pressureConversions, 3);
+}
+
+TEST_F(Bmp085Test, MissingSensorIsReported) {
+    hal::sim::attachI2C(hal::sim::Bmp085Device::ADDRESS, nullptr);
+    Bmp085 bmp;
+    EXPECT_FALSE(bmp.begin(bus));
+    EXPECT_FALSE(bmp.start());
+    EXPECT_FALSE(bmp.isBusy());
+}
+
+TEST_F(Bmp085Test, BusErrorMidReadingCountsAndRecovers) {
+    Bmp085 bmp;
+    ASSERT_TRUE(bmp.begin(bus));
+    ASSERT_TRUE(bmp.start());
+    hal::sim::attachI2C(hal::sim::Bmp085Device::ADDRESS, nullptr);
+    hal::sim::advanceUs(5000);
+    EXPECT_FALSE(bmp.poll());
+    EXPECT_FALSE(bmp.isBusy());
+    EXPECT_EQ(bmp.getErrors(), 1u);
+
+    hal::sim::attachI2C(hal::sim::Bmp085Device::ADDRESS, &device);
+    runReading(bmp);
+    EXPECT_NEAR(bmp.getPressure(), 69964, 2);
+    EXPECT_EQ(bmp.getErrors(), 1u);
+}
+
+TEST_F(Bmp085Test, ReadingOverlapsTheMoistureScan) {
+    SensorManager sensors(config);
+    sensors.setupFloatSwitch();
+    sensors.setupSensors(bus);
+
+    const int64_t start = hal::sim::nowUs();
+    sensors.updateSensorData();
+    const int64_t scanUs = (MoistureSampler::SAMPLES - 1) * MoistureSampler::SAMPLE_PERIOD_MS * 1000;
+    EXPECT_EQ(hal::sim::nowUs() - start, scanUs);
+    EXPECT_FLOAT_EQ(sensors.getSensorData().temperature, 15.0f);
+    EXPECT_EQ(device.earlyReads, 0);
+}
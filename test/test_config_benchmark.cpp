@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include "AllocationCounter.h"
+#include "SimTestSetup.h"
+
+// Microbenchmarks of the NVS-backed configuration. Timings go to stdout for comparison between
+// builds; only the allocation counts are asserted.
+
+namespace {
+
+struct Cost {
+    double us = 0;
+    double allocations = 0;
+};
+
+template<typename Fn>
+Cost measure(int iterations, Fn&& fn) {
+    const uint64_t allocations = allocationCounter().count.load();
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn(i);
+    }
+    const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return {us / iterations, static_cast<double>(allocationCounter().count.load() - allocations) / iterations};
+}
+
+class ConfigBenchmark : public ConfiguredSimTest {};
+
+}  // namespace
+
+// What every boot does once NVS holds the settings the fixture's first boot wrote: check each key,
+// then load every value.
+TEST_F(ConfigBenchmark, BootTimeLoad) {
+    const Cost boot = measure(2000, [&](int) { config.begin("cfg"); });
+    printf("ConfigManager::begin, %d zones: %.2f us, %.1f allocations per boot\n",
+           config.getHwConfig().systemSize.value(), boot.us, boot.allocations);
+
+    // Left: one vector per pin and current list, rebuilt on every load
+    EXPECT_LE(boot.allocations, 5.0);
+}
+
+TEST_F(ConfigBenchmark, ScalarSettingsNeedNoHeap) {
+
+    const Cost write = measure(1000, [&](int i) {
+        ConfigTypes::SensorConfig sensor;
+        sensor.threshold = 30.0f + ((i / 4) & 1);
+        sensor.activationPeriod = 4000 + ((i / 4) & 1);
+        config.setSensorConfig(sensor, static_cast<size_t>(i) % 4);
+    });
+    const Cost read = measure(1000, [&](int) { config.initializeConfigurations(); });
+    printf("setSensorConfig: %.2f us, %.1f allocations; initializeConfigurations: %.2f us\n", write.us,
+           write.allocations, read.us);
+    EXPECT_EQ(write.allocations, 0.0);
+}
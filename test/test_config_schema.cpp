@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include <type_traits>
+#include "SimTestSetup.h"
+
+// The schema is resolved at compile time and needs no static constructor
+static_assert(std::is_trivially_destructible_v<ConfigInfo>);
+static_assert(configInfo(ConfigKey::SYSTEM_SIZE).intMax == ConfigConstants::MAX_SYSTEM_SIZE);
+static_assert(configInfo(ConfigKey::SENSOR_THRESHOLD).valueType == ConfigValueType::FLOAT);
+static_assert(configAccepts<uint32_t>(configInfo(ConfigKey::SENSOR_ACTIVATION_PERIOD).valueType));
+static_assert(!configAccepts<float>(configInfo(ConfigKey::SENSOR_ACTIVATION_PERIOD).valueType));
+
+namespace {
+
+class ConfigSchemaTest : public ConfiguredSimTest {};
+
+}  // namespace
+
+TEST_F(ConfigSchemaTest, FirstBeginLoadsSchemaDefaults) {
+    const auto& hw = config.getHwConfig();
+    EXPECT_EQ(hw.systemSize.value(), 4);
+    EXPECT_EQ(hw.moistureSensorPins, (std::vector<int>{34, 35, 36, 39}));
+    EXPECT_EQ(hw.muxSignalPins, (std::vector<int>{37}));
+    EXPECT_EQ(hw.powerBudget.value(), 1000);
+    EXPECT_EQ(config.getSwConfig().lcdUpdateInterval.value(), 5000u);
+    EXPECT_FLOAT_EQ(config.getSwConfig().tempOffset.value(), 0.0f);
+    EXPECT_FLOAT_EQ(config.getSensorConfig(3).threshold.value(), 25.0f);
+    EXPECT_EQ(config.getSensorConfig(3).wateringInterval.value(), 86400000u);
+    EXPECT_TRUE(config.getSensorConfig(3).sensorEnabled.value());
+}
+
+TEST_F(ConfigSchemaTest, GrowingTheSystemExtendsListsFromTheirDefaults) {
+    ConfigTypes::HardwareConfig hw;
+    hw.systemSize = 6;
+    ASSERT_TRUE(config.setHardwareConfig(hw));
+    config.begin("cfg");
+    EXPECT_EQ(config.getHwConfig().moistureSensorPins, (std::vector<int>{34, 35, 36, 39, 34, 35}));
+    EXPECT_EQ(config.getHwConfig().relayCurrents.size(), 6u);
+    EXPECT_EQ(config.getSensorConfig(5).activationPeriod.value(), 5000u);
+}
+
+TEST_F(ConfigSchemaTest, ValuesOutsideTheBoundsAreRejected) {
+    ConfigTypes::SoftwareConfig sw;
+    sw.moistureFilter = 4;
+    EXPECT_FALSE(config.setSoftwareConfig(sw));
+    EXPECT_EQ(config.getSwConfig().moistureFilter.value(), 3);
+
+    ConfigTypes::SensorConfig sensor;
+    sensor.threshold = 75.5f;
+    EXPECT_FALSE(config.setSensorConfig(sensor, 0));
+    sensor.threshold = 75.0f;
+    EXPECT_TRUE(config.setSensorConfig(sensor, 0));
+
+    sensor = ConfigTypes::SensorConfig();
+    sensor.wateringInterval = 604800001u;
+    EXPECT_FALSE(config.setSensorConfig(sensor, 0));
+
+    // Unbounded settings take any value of their type
+    ConfigTypes::HardwareConfig hw;
+    hw.sdaPin = 4;
+    EXPECT_TRUE(config.setHardwareConfig(hw));
+
+    // Survives a reload from NVS
+    config.begin("cfg");
+    EXPECT_FLOAT_EQ(config.getSensorConfig(0).threshold.value(), 75.0f);
+    EXPECT_EQ(config.getHwConfig().sdaPin.value(), 4);
+}
+
+TEST(ConfigSchemaKeys, SensorSettingsAreStoredPerZone) {
+    EXPECT_STREQ(PreferencesHandler::getPrefKey(ConfigKey::SENSOR_THRESHOLD, 3).c_str(), "th3");
+    EXPECT_STREQ(PreferencesHandler::getPrefKey(ConfigKey::SENSOR_THRESHOLD, 31).c_str(), "th31");
+    EXPECT_STREQ(PreferencesHandler::getPrefKey(ConfigKey::SYSTEM_SIZE, 3).c_str(), "size");
+    EXPECT_STREQ(PreferencesHandler::getPrefKey(ConfigKey::RELAY_CURRENT, 0, PreferencesHandler::SIZE_SUFFIX).c_str(), "rc_size");
+    EXPECT_STREQ(configInfo(ConfigKey::INRUSH_DELAY).confKey, "inrushDelay");
+}
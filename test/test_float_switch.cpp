@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "SimTestSetup.h"
+#include "RelayManager.h"
+
+class FloatSwitchTest : public ConfiguredSimTest {
+protected:
+    static constexpr int PIN = 16;
+
+    void SetUp() override {
+        ConfiguredSimTest::SetUp();
+        hal::sim::setDigital(PIN, HIGH);
+    }
+};
+
+TEST_F(FloatSwitchTest, FallingEdgeStopsThePump) {
+    SensorManager sensors(config);
+    I2CBus i2cBus;
+    RelayManager relays(config, sensors, i2cBus);
+    relays.init();
+    sensors.setupFloatSwitch();
+
+    ASSERT_TRUE(relays.activateRelay(0));
+    ASSERT_TRUE(relays.getRelayState(0));
+
+    hal::sim::setDigital(PIN, LOW);
+    const int64_t start = hal::sim::nowUs();
+    EXPECT_TRUE(sensors.settleFloatSwitch());
+
+    EXPECT_FALSE(relays.getRelayState(0));
+    EXPECT_FALSE(sensors.getSensorData().waterLevel);
+    EXPECT_LE(hal::sim::nowUs() - start, FloatSwitch::DEBOUNCE_MS * 1000);
+    EXPECT_FALSE(relays.activateRelay(0));
+}
+
+TEST_F(FloatSwitchTest, GlitchDoesNotChangeLevel) {
+    FloatSwitch floatSwitch;
+    int changes = 0;
+    floatSwitch.setCallback([&](bool) { changes++; });
+    floatSwitch.begin(PIN);
+
+    hal::sim::setDigital(PIN, LOW);
+    hal::sim::setDigital(PIN, HIGH);
+    EXPECT_EQ(floatSwitch.getEdgeCount(), 2u);
+    EXPECT_FALSE(floatSwitch.settle());
+    EXPECT_TRUE(floatSwitch.isWaterOk());
+    EXPECT_EQ(changes, 0);
+}
+
+TEST_F(FloatSwitchTest, WaitsUntilBouncingStops) {
+    FloatSwitch floatSwitch;
+    floatSwitch.begin(PIN);
+
+    // The contact chatters for 80 ms after the level drops, then stays low.
+    esp_timer_handle_t bounce;
+    int level = LOW;
+    int bounces = 0;
+    esp_timer_create_args_t args = {};
+    args.callback = [](void* arg) {
+        auto* state = static_cast<std::pair<int*, int*>*>(arg);
+        if (*state->second == 8) return;
+        *state->first = *state->first == LOW ? HIGH : LOW;
+        hal::sim::setDigital(PIN, *state->first);
+        ++*state->second;
+    };
+    std::pair<int*, int*> state{&level, &bounces};
+    args.arg = &state;
+    args.name = "bounce";
+    esp_timer_create(&args, &bounce);
+
+    hal::sim::setDigital(PIN, LOW);
+    esp_timer_start_periodic(bounce, 10 * 1000);
+    const int64_t start = hal::sim::nowUs();
+    EXPECT_TRUE(floatSwitch.settle());
+    esp_timer_stop(bounce);
+    esp_timer_delete(bounce);
+
+    EXPECT_EQ(bounces, 8);
+    EXPECT_FALSE(floatSwitch.isWaterOk());
+    EXPECT_GE(hal::sim::nowUs() - start, (80 + FloatSwitch::DEBOUNCE_MS) * 1000);
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "SimTestSetup.h"
+#include "Bmp085Sim.h"
+#include "I2CBus.h"
+
+class I2CBusTest : public SimTest {};
+
+TEST_F(I2CBusTest, CountsTransactionsErrorsAndBusTimePerDevice) {
+    hal::sim::Bmp085Device device;
+    hal::sim::attachI2C(hal::sim::Bmp085Device::ADDRESS, &device);
+    I2CBus bus;
+
+    auto ping = [](uint8_t address) {
+        return [address](TwoWire& wire) {
+            wire.beginTransmission(address);
+            hal::sim::advanceUs(100);
+            return wire.endTransmission() == 0;
+        };
+    };
+    EXPECT_TRUE(bus.transact(0x77, I2CBus::Priority::SENSOR, ping(0x77)));
+    EXPECT_TRUE(bus.transact(0x77, I2CBus::Priority::SENSOR, ping(0x77)));
+    EXPECT_FALSE(bus.transact(0x27, I2CBus::Priority::DISPLAY, ping(0x27)));
+
+    I2CBus::DeviceStats stats;
+    ASSERT_TRUE(bus.getStats(0x77, stats));
+    EXPECT_EQ(stats.transactions, 2u);
+    EXPECT_EQ(stats.errors, 0u);
+    EXPECT_EQ(stats.busTimeUs, 200u);
+    EXPECT_EQ(stats.maxLatencyUs, 100u);
+
+    ASSERT_TRUE(bus.getStats(0x27, stats));
+    EXPECT_EQ(stats.transactions, 1u);
+    EXPECT_EQ(stats.errors, 1u);
+    EXPECT_FALSE(bus.getStats(0x40, stats));
+    EXPECT_EQ(bus.getQueueDepth(), 0u);
+
+    hal::sim::attachI2C(hal::sim::Bmp085Device::ADDRESS, nullptr);
+}
+
+// While one transaction holds the bus, a display refresh and then a sensor read are queued.
+// The sensor read must run first, and the display waits for both.
+TEST_F(I2CBusTest, SensorReadsGoBeforeDisplayRefresh) {
+    I2CBus bus;
+    std::mutex orderMutex;
+    std::vector<const char*> order;
+    std::atomic<bool> running{false};
+    std::atomic<bool> release{false};
+    auto log = [&](const char* name) {
+        std::lock_guard<std::mutex> lock(orderMutex);
+        order.push_back(name);
+    };
+
+    std::thread holder([&]() {
+        bus.transact(0x10, I2CBus::Priority::DISPLAY, [&](TwoWire&) {
+            running.store(true);
+            while (!release.load()) std::this_thread::yield();
+            log("holder");
+            return true;
+        });
+    });
+    while (!running.load()) std::this_thread::yield();
+
+    std::thread display([&]() {
+        bus.transact(0x27, I2CBus::Priority::DISPLAY, [&](TwoWire&) { log("display"); return true; });
+    });
+    while (bus.getQueueDepth() < 1) std::this_thread::yield();
+    std::thread sensor([&]() {
+        bus.transact(0x77, I2CBus::Priority::SENSOR, [&](TwoWire&) { log("sensor"); return true; });
+    });
+    while (bus.getQueueDepth() < 2) std::this_thread::yield();
+
+    release.store(true);
+    holder.join();
+    display.join();
+    sensor.join();
+
+    ASSERT_EQ(order.size(), 3u);
+    EXPECT_STREQ(order[0], "holder");
+    EXPECT_STREQ(order[1], "sensor");
+    EXPECT_STREQ(order[2], "display");
+
+    I2CBus::DeviceStats stats;
+    ASSERT_TRUE(bus.getStats(0x27, stats));
+    EXPECT_EQ(stats.transactions, 1u);
+}
@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+#include <climits>
+#include "SimTestSetup.h"
+#include "Ads1115Sim.h"
+#include "Bmp085Sim.h"
+#include "IoExpanderSim.h"
+#include "IoChannel.h"
+#include "MoistureSampler.h"
+#include "RelayOutputs.h"
+#include "SensorManager.h"
+
+namespace {
+const std::vector<int> SELECT_PINS = {13, 14, 26, 27};
+const std::vector<int> SIGNAL_PINS = {32, 33};
+
+// Runs one measurement through the SensorDriver path, advancing the clock exactly to each step.
+void measure(MoistureSampler& sampler) {
+    ASSERT_TRUE(sampler.start());
+    while (sampler.isBusy()) {
+        hal::sim::advanceUs(sampler.usUntilReady());
+        sampler.poll();
+    }
+}
+
+// Two CD74HC4067s on shared select lines: input c of mux m reads 1000 + 500 * m + 20 * c.
+void wireMuxes() {
+    hal::sim::setAnalogSource([](int pin) {
+        int channel = 0;
+        for (size_t line = 0; line < SELECT_PINS.size(); ++line) {
+            channel |= (hal::sim::getDigital(SELECT_PINS[line]) == HIGH) << line;
+        }
+        return pin == SIGNAL_PINS[0] ? 1000 + 20 * channel : pin == SIGNAL_PINS[1] ? 1500 + 20 * channel : 0;
+    });
+}
+}
+
+class IoExpanderTest : public ConfiguredSimTest {};
+
+TEST_F(IoExpanderTest, DecodesPinCodes) {
+    EXPECT_EQ(IoChannel::decodeInput(34).kind, IoChannel::Kind::GPIO);
+    const IoChannel::Channel mux = IoChannel::decodeInput(IoChannel::mux(1, 5));
+    EXPECT_EQ(mux.kind, IoChannel::Kind::MUX);
+    EXPECT_EQ(mux.device, 1);
+    EXPECT_EQ(mux.index, 5);
+    const IoChannel::Channel ads = IoChannel::decodeInput(IoChannel::ads1115(3, 2));
+    EXPECT_EQ(ads.kind, IoChannel::Kind::ADS1115);
+    EXPECT_EQ(ads.device, 3);
+    EXPECT_EQ(ads.index, 2);
+    EXPECT_EQ(IoChannel::decodeInput(IoChannel::ads1115(4, 0)).kind, IoChannel::Kind::NONE);
+
+    const IoChannel::Channel mcp = IoChannel::decodeOutput(IoChannel::mcp23017(7, 15));
+    EXPECT_EQ(mcp.kind, IoChannel::Kind::MCP23017);
+    EXPECT_EQ(mcp.device, 7);
+    EXPECT_EQ(mcp.index, 15);
+    EXPECT_EQ(IoChannel::decodeOutput(IoChannel::pcf8574(2, 7)).kind, IoChannel::Kind::PCF8574);
+    EXPECT_EQ(IoChannel::decodeOutput(-1).kind, IoChannel::Kind::NONE);
+}
+
+TEST_F(IoExpanderTest, MuxInputsShareOneSwitchPerChannel) {
+    wireMuxes();
+    std::vector<int> pins;
+    for (int m = 0; m < 2; ++m) {
+        for (int c = 0; c < IoChannel::MUX_CHANNELS; ++c) pins.push_back(IoChannel::mux(m, c));
+    }
+    const std::vector<bool> enabled(pins.size(), true);
+
+    MoistureSampler sampler;
+    sampler.begin();
+    sampler.setMuxPins(SELECT_PINS, SIGNAL_PINS);
+    sampler.configure(pins, enabled);
+    const int64_t start = hal::sim::nowUs();
+    measure(sampler);
+    const std::vector<uint16_t>& averages = sampler.getAverages();
+
+    for (int c = 0; c < IoChannel::MUX_CHANNELS; ++c) {
+        EXPECT_EQ(averages[c], 1000 + 20 * c);
+        EXPECT_EQ(averages[16 + c], 1500 + 20 * c);
+    }
+    const ScanPlanner::Stats& stats = sampler.getRoundStats();
+    EXPECT_EQ(stats.muxReads, 32);
+    EXPECT_EQ(stats.muxSwitches, 16);      // not 32: both muxes are read after each switch
+    EXPECT_EQ(stats.selectPinWrites, 16);  // Gray-code order, one line per switch
+    // Settling is the only cost mux inputs add to the sample period.
+    EXPECT_EQ(hal::sim::nowUs() - start,
+              (MoistureSampler::SAMPLES - 1) * MoistureSampler::SAMPLE_PERIOD_MS * 1000 + 16 * ScanPlanner::MUX_SETTLE_US);
+}
+
+TEST_F(IoExpanderTest, Ads1115ConversionsRunInParallelSlots) {
+    hal::sim::Ads1115Device adcs[IoChannel::MAX_ADS1115];
+    std::vector<int> pins = {34};
+    hal::sim::setAnalog(34, 3000);
+    for (int n = 0; n < IoChannel::MAX_ADS1115; ++n) {
+        hal::sim::attachI2C(IoChannel::ADS1115_ADDRESS + n, &adcs[n]);
+        for (int c = 0; c < IoChannel::ADS1115_CHANNELS; ++c) {
+            adcs[n].inputs[c] = static_cast<int16_t>(2640 * (n * 4 + c + 1));   // 0.33 V steps
+            pins.push_back(IoChannel::ads1115(n, c));
+        }
+    }
+    adcs[3].inputs[3] = INT16_MAX;
+    const std::vector<bool> enabled(pins.size(), true);
+
+    I2CBus bus;
+    MoistureSampler sampler;
+    sampler.begin(bus);
+    sampler.configure(pins, enabled);
+    const int64_t start = hal::sim::nowUs();
+    measure(sampler);
+
+    const std::vector<uint16_t>& averages = sampler.getAverages();
+    EXPECT_EQ(averages[0], 3000);
+    EXPECT_EQ(averages[1], 410);      // 0.33 V on the 12-bit scale
+    EXPECT_EQ(averages[10], 4095);    // 3.3 V
+    EXPECT_EQ(averages[16], 4095);    // 4.096 V, clamped
+
+    const ScanPlanner::Stats& stats = sampler.getRoundStats();
+    EXPECT_EQ(stats.conversionSlots, 4);
+    EXPECT_EQ(stats.conversions, 16);
+    EXPECT_EQ(stats.errors, 0);
+    EXPECT_EQ(stats.roundUs, 4 * Ads1115::CONVERSION_US);
+    for (const auto& adc : adcs) {
+        EXPECT_EQ(adc.earlyReads, 0);
+        EXPECT_EQ(adc.conversions, 4 * MoistureSampler::SAMPLES);
+    }
+    // Rounds still start one sample period apart; only the last round's conversions add up.
+    EXPECT_EQ(hal::sim::nowUs() - start,
+              (MoistureSampler::SAMPLES - 1) * MoistureSampler::SAMPLE_PERIOD_MS * 1000 + 4 * Ads1115::CONVERSION_US);
+}
+
+TEST_F(IoExpanderTest, FailedAds1115ReadOnlyDropsThatSample) {
+    hal::sim::Ads1115Device adc;
+    adc.inputs[2] = 13200;
+    adc.failReads = 1;
+    hal::sim::attachI2C(IoChannel::ADS1115_ADDRESS, &adc);
+
+    I2CBus bus;
+    MoistureSampler sampler;
+    sampler.begin(bus);
+    const std::vector<int> pins = {IoChannel::ads1115(0, 2)};
+    const std::vector<bool> enabled = {true};
+    std::vector<uint16_t> averages;
+    sampler.scan(pins, enabled, averages);
+    EXPECT_EQ(averages[0], 2048);
+    EXPECT_EQ(sampler.getSampledMask(), 1u);
+}
+
+TEST_F(IoExpanderTest, DeadAds1115InvalidatesItsZones) {
+    hal::sim::Ads1115Device adc;
+    adc.inputs[1] = 13200;
+    adc.failReads = INT_MAX;
+    hal::sim::attachI2C(IoChannel::ADS1115_ADDRESS, &adc);
+    hal::sim::Bmp085Device bmp;
+    hal::sim::attachI2C(hal::sim::Bmp085Device::ADDRESS, &bmp);
+    hal::sim::setAnalog(34, 2000);
+
+    ConfigTypes::HardwareConfig hw;
+    hw.moistureSensorPins = {34, IoChannel::ads1115(0, 1), 35, 36};
+    ASSERT_TRUE(config.setHardwareConfig(hw));
+    config.initializeConfigurations();
+
+    I2CBus bus;
+    SensorManager sensors(config);
+    sensors.setupFloatSwitch();
+    sensors.setupSensors(bus);
+    sensors.updateSensorData();
+
+    SensorData data = sensors.getSensorData();
+    EXPECT_TRUE(data.isEnabled(1));
+    EXPECT_FALSE(data.isValid(1));   // not 100 % from a raw 0
+    EXPECT_TRUE(data.isValid(0));
+
+    adc.failReads = 0;
+    sensors.updateSensorData();
+    data = sensors.getSensorData();
+    EXPECT_TRUE(data.isValid(1));
+    EXPECT_EQ(data.moistureRaw[1], 2048);
+}
+
+TEST_F(IoExpanderTest, RelayExpandersWriteOneLatchPerSwitch) {
+    hal::sim::Pcf8574Device pcf;
+    hal::sim::Mcp23017Device mcp;
+    hal::sim::attachI2C(0x20, &pcf);
+    hal::sim::attachI2C(0x21, &mcp);
+
+    I2CBus bus;
+    RelayOutputs outputs(bus);
+    const int pcfRelay = IoChannel::pcf8574(0, 3);
+    const int mcpRelay = IoChannel::mcp23017(1, 12);
+    ASSERT_TRUE(outputs.begin({33, pcfRelay, IoChannel::pcf8574(0, 4), mcpRelay}));
+    EXPECT_EQ(pcf.writes, 1);   // both PCF8574 relays switched off together
+    EXPECT_EQ(pcf.latch, 0xFF);
+    EXPECT_FALSE(mcp.isLow(12));
+    EXPECT_EQ(mcp.registers[hal::sim::Mcp23017Device::IODIRA + 1], 0x00);
+    EXPECT_EQ(hal::sim::getDigital(33), HIGH);
+
+    ASSERT_TRUE(outputs.set(pcfRelay, true));
+    EXPECT_TRUE(pcf.isLow(3));
+    EXPECT_FALSE(pcf.isLow(4));
+    EXPECT_EQ(pcf.writes, 2);
+
+    const int mcpWrites = mcp.writes;
+    ASSERT_TRUE(outputs.set(mcpRelay, true));
+    EXPECT_TRUE(mcp.isLow(12));
+    EXPECT_EQ(mcp.writes, mcpWrites + 1);
+    ASSERT_TRUE(outputs.set(mcpRelay, false));
+    EXPECT_FALSE(mcp.isLow(12));
+
+    outputs.set(33, true);
+    EXPECT_EQ(hal::sim::getDigital(33), LOW);
+
+    hal::sim::attachI2C(0x20, nullptr);
+    EXPECT_FALSE(outputs.set(pcfRelay, false));
+}
+
+TEST_F(IoExpanderTest, SensorManagerReadsZonesPastSixteen) {
+    wireMuxes();
+    ConfigTypes::HardwareConfig hw;
+    hw.systemSize = 20;
+    for (int zone = 0; zone < 20; ++zone) hw.moistureSensorPins.push_back(IoChannel::mux(zone / 16, zone % 16));
+    hw.muxSignalPins = SIGNAL_PINS;
+    ASSERT_TRUE(config.setHardwareConfig(hw));
+    config.initializeConfigurations();
+
+    SensorManager sensors(config);
+    sensors.setupFloatSwitch();
+    sensors.updateSensorData();
+
+    const SensorData data = sensors.getSensorData();
+    EXPECT_TRUE(data.isValid(19));
+    EXPECT_EQ(data.moistureRaw[5], 1100);
+    EXPECT_EQ(data.moistureRaw[19], 1560);   // mux 1, input 3
+    EXPECT_FALSE(data.isEnabled(20));
+}
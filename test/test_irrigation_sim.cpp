@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include "IrrigationSim.h"
+
+namespace {
+
+sim::Scenario fourZones(uint32_t days) {
+    sim::Scenario scenario;
+    scenario.days = days;
+    scenario.zones[0].dryingPerDay = 5.0f;      // shady
+    scenario.zones[1].dryingPerDay = 10.0f;
+    scenario.zones[2].dryingPerDay = 16.0f;     // full sun, small pot
+    scenario.zones[2].capacityMl = 800.0f;
+    scenario.zones[3].initialMoisture = 15.0f;  // planted dry
+    return scenario;
+}
+
+}  // namespace
+
+TEST(IrrigationSimTest, NinetyDaysKeepEveryZoneWatered) {
+    const sim::Report report = sim::IrrigationSim(fourZones(90)).run();
+    report.print(stdout);
+
+    EXPECT_NEAR(report.simulatedS, 90 * 86400.0, 1.0);
+    double waterMl = 0;
+    for (size_t i = 0; i < report.zones.size(); ++i) {
+        const sim::ZoneReport& zone = report.zones[i];
+        waterMl += zone.waterMl;
+        EXPECT_GT(zone.waterings, 0u) << i;
+        // A zone only sits below its threshold while drying towards the next sample and watering
+        EXPECT_LT(zone.belowThresholdS, 0.05 * report.simulatedS) << i;
+    }
+    EXPECT_NEAR(report.reservoirUsedMl, waterMl, 1.0);
+    EXPECT_EQ(report.dryRunS, 0.0);
+    EXPECT_EQ(report.controller.count, 0u);
+}
+
+TEST(IrrigationSimTest, SameScenarioSameReport) {
+    const sim::Report a = sim::IrrigationSim(fourZones(10)).run();
+    const sim::Report b = sim::IrrigationSim(fourZones(10)).run();
+
+    EXPECT_EQ(a.samples, b.samples);
+    EXPECT_EQ(a.controllerPasses, b.controllerPasses);
+    EXPECT_EQ(a.relayEvents, b.relayEvents);
+    EXPECT_EQ(a.reservoirUsedMl, b.reservoirUsedMl);
+    EXPECT_EQ(a.controller.count, b.controller.count);
+    for (size_t i = 0; i < a.zones.size(); ++i) {
+        EXPECT_EQ(a.zones[i].waterMl, b.zones[i].waterMl);
+        EXPECT_EQ(a.zones[i].belowThresholdS, b.zones[i].belowThresholdS);
+        EXPECT_EQ(a.zones[i].minMoisture, b.zones[i].minMoisture);
+    }
+}
+
+TEST(IrrigationSimTest, EmptyReservoirStopsThePumps) {
+    sim::Scenario scenario = fourZones(30);
+    scenario.reservoir.capacityMl = 5000.0f;
+    scenario.reservoir.refillEveryDays = 0;
+    const sim::Report report = sim::IrrigationSim(scenario).run();
+
+    EXPECT_GT(report.lowWaterS, 0.0);
+    EXPECT_LE(report.reservoirUsedMl, scenario.reservoir.capacityMl);
+    EXPECT_EQ(report.dryRunS, 0.0);     // the float switch stops them before the reservoir is empty
+}
+
+TEST(IrrigationSimTest, ConfigurationChangesAreComparable) {
+    sim::Scenario scenario = fourZones(30);
+    const sim::Report base = sim::IrrigationSim(scenario).run();
+
+    scenario.configure = [](ConfigManager& config) {
+        for (size_t i = 0; i < 4; ++i) {
+            ConfigTypes::SensorConfig update;
+            update.threshold = 40.0f;
+            config.setSensorConfig(update, i);
+        }
+    };
+    const sim::Report wetter = sim::IrrigationSim(scenario).run();
+    EXPECT_GT(wetter.reservoirUsedMl, base.reservoirUsedMl);
+    EXPECT_GT(wetter.zones[2].minMoisture, base.zones[2].minMoisture);
+}
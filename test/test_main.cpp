@@ -0,0 +1,24 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <new>
+#include "AllocationCounter.h"
+
+AllocationCounter& allocationCounter() {
+    static AllocationCounter counter;
+    return counter;
+}
+
+void* operator new(size_t size) {
+    allocationCounter().count.fetch_add(1, std::memory_order_relaxed);
+    allocationCounter().bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include "SimTestSetup.h"
+#include "MoistureCalibration.h"
+#include "SensorManager.h"
+
+TEST(MoistureCalibrationTest, ConvertsBetweenCalibrationPoints) {
+    MoistureCalibration calibration;
+    ASSERT_TRUE(calibration.set(2592, 975));
+    EXPECT_EQ(calibration.toTenths(2592), 0);
+    EXPECT_EQ(calibration.toTenths(975), 1000);
+    EXPECT_EQ(calibration.toTenths(1784), 500);   // (2592 - 1784) / 1617 = 49.97 %
+    EXPECT_EQ(calibration.toTenths(4095), 0);     // drier than calibrated
+    EXPECT_EQ(calibration.toTenths(0), 1000);     // wetter than calibrated
+}
+
+TEST(MoistureCalibrationTest, MatchesFloatMapWithinRounding) {
+    MoistureCalibration calibration;
+    ASSERT_TRUE(calibration.set(3000, 1200));
+    for (int raw = 1200; raw <= 3000; ++raw) {
+        const float expected = (3000 - raw) * 1000.0f / 1800.0f;
+        EXPECT_NEAR(calibration.toTenths(raw), expected, 0.5f) << "raw " << raw;
+    }
+}
+
+TEST(MoistureCalibrationTest, SupportsRisingProbesAndRejectsInvalidPoints) {
+    MoistureCalibration calibration;
+    ASSERT_TRUE(calibration.set(500, 3000));
+    EXPECT_EQ(calibration.toTenths(500), 0);
+    EXPECT_EQ(calibration.toTenths(1750), 500);
+    EXPECT_EQ(calibration.toTenths(3000), 1000);
+
+    EXPECT_FALSE(calibration.set(1000, 1000));
+    EXPECT_FALSE(calibration.set(5000, 1000));
+    EXPECT_TRUE(calibration.matches(500, 3000));
+}
+
+class SensorCalibrationTest : public ConfiguredSimTest {};
+
+TEST_F(SensorCalibrationTest, SensorManagerAppliesCalibrationChangesLive) {
+    EXPECT_EQ(config.getSensorConfig(0).dryValue.value(), 2592);
+    EXPECT_EQ(config.getSensorConfig(0).wetValue.value(), 975);
+    hal::sim::setAnalog(34, 2000);
+
+    SensorManager sensors(config);
+    sensors.setupFloatSwitch();
+    sensors.updateSensorData();
+    EXPECT_FLOAT_EQ(sensors.getSensorData().getMoisture(0), 36.6f);
+    EXPECT_EQ(sensors.getSensorData().moistureRaw[0], 2000);
+
+    ConfigTypes::SensorConfig update;
+    update.dryValue = 3000;
+    update.wetValue = 1000;
+    ASSERT_TRUE(config.setSensorConfig(update, 0));
+    sensors.updateSensorData();
+    EXPECT_FLOAT_EQ(sensors.getSensorData().getMoisture(0), 50.0f);
+    EXPECT_FLOAT_EQ(sensors.getSensorData().getMoisture(1), 100.0f);  // pin 35 reads 0, default calibration
+
+    ConfigTypes::SensorConfig invalid;
+    invalid.wetValue = 3000;
+    EXPECT_FALSE(config.setSensorConfig(invalid, 0));
+    EXPECT_EQ(config.getSensorConfig(0).wetValue.value(), 1000);
+    EXPECT_EQ(hal::sim::state().nvs["cfg"].count("dv0"), 1u);
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "MoistureFilter.h"
+
+namespace {
+struct TracePoint {
+    int16_t truth;
+    int16_t measured;
+};
+
+constexpr size_t STEP_AT = 300;
+
+// Soil drying slowly from 60 %, watered back up by 25 % at STEP_AT, with 1.5 % Gaussian noise and
+// a +-30 % spike every 37 readings (loose connector). Generated with a fixed LCG so the trace is
+// identical on every platform.
+std::vector<TracePoint> noisyTrace() {
+    uint32_t state = 12345;
+    auto uniform = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return ((state >> 8) + 0.5) / 16777216.0;
+    };
+
+    std::vector<TracePoint> trace;
+    for (size_t i = 0; i < 600; ++i) {
+        const double truth = 600.0 - 0.2 * i + (i >= STEP_AT ? 250.0 : 0.0);
+        double noise = 15.0 * std::sqrt(-2.0 * std::log(uniform())) * std::cos(2.0 * M_PI * uniform());
+        if (i % 37 == 36) noise += (i % 2 ? 300.0 : -300.0);
+        trace.push_back({static_cast<int16_t>(std::lround(truth)), static_cast<int16_t>(std::lround(truth + noise))});
+    }
+    return trace;
+}
+
+struct Errors {
+    double rms;
+    int maxError;
+};
+
+// Errors against the truth, skipping the readings right after the watering step.
+Errors run(MoistureFilter::Mode mode, const std::vector<TracePoint>& trace) {
+    MoistureFilter filter;
+    filter.setMode(mode);
+    double sumSquares = 0;
+    int maxError = 0;
+    size_t n = 0;
+    for (size_t i = 0; i < trace.size(); ++i) {
+        const int error = std::abs(filter.update(trace[i].measured) - trace[i].truth);
+        if (i < 10 || (i >= STEP_AT && i < STEP_AT + 10)) continue;
+        sumSquares += static_cast<double>(error) * error;
+        maxError = std::max(maxError, error);
+        n++;
+    }
+    return {std::sqrt(sumSquares / n), maxError};
+}
+}
+
+TEST(MoistureFilterTest, RawTraceHasSpikes) {
+    const Errors raw = run(MoistureFilter::Mode::NONE, noisyTrace());
+    EXPECT_GT(raw.maxError, 250);
+    EXPECT_GT(raw.rms, 40.0);
+}
+
+TEST(MoistureFilterTest, EveryModeRejectsSpikesAndReducesNoise) {
+    const auto trace = noisyTrace();
+    const Errors raw = run(MoistureFilter::Mode::NONE, trace);
+    for (auto mode : {MoistureFilter::Mode::MEDIAN, MoistureFilter::Mode::EMA, MoistureFilter::Mode::KALMAN}) {
+        const Errors filtered = run(mode, trace);
+        EXPECT_LT(filtered.maxError, 60) << "mode " << static_cast<int>(mode);
+        EXPECT_LT(filtered.rms, raw.rms / 2) << "mode " << static_cast<int>(mode);
+    }
+    EXPECT_LT(run(MoistureFilter::Mode::KALMAN, trace).rms, 10.0);
+}
+
+TEST(MoistureFilterTest, FollowsRealStepAfterRejectingIt) {
+    for (auto mode : {MoistureFilter::Mode::EMA, MoistureFilter::Mode::KALMAN}) {
+        MoistureFilter filter;
+        filter.setMode(mode);
+        for (int i = 0; i < 20; ++i) filter.update(300);
+
+        for (int i = 0; i < MoistureFilter::MAX_REJECTS - 1; ++i) {
+            EXPECT_EQ(filter.update(600), 300);
+        }
+        EXPECT_EQ(filter.update(600), 600);
+        EXPECT_EQ(filter.getRejects(), 0);
+    }
+}
+
+TEST(MoistureFilterTest, ResetsWhenModeChanges) {
+    MoistureFilter filter;
+    filter.setMode(MoistureFilter::Mode::MEDIAN);
+    filter.update(100);
+    filter.update(900);
+    EXPECT_EQ(filter.update(200), 200);  // median of 100, 900, 200
+
+    filter.setMode(MoistureFilter::Mode::EMA);
+    EXPECT_EQ(filter.update(500), 500);
+}
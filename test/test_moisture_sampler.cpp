@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include "SimTestSetup.h"
+#include "MoistureSampler.h"
+#include "SensorManager.h"
+
+class MoistureSamplerTest : public SimTest {
+protected:
+    static int64_t timeUpdate(int systemSize) {
+        resetSim();
+        PreferencesHandler prefs;
+        ConfigManager config(prefs);
+        config.begin("cfg");
+        ConfigTypes::HardwareConfig hw;
+        hw.systemSize = systemSize;
+        config.setHardwareConfig(hw);
+        config.initializeConfigurations();
+
+        SensorManager sensors(config);
+        sensors.setupFloatSwitch();
+        const int64_t start = hal::sim::nowUs();
+        sensors.updateSensorData();
+        return hal::sim::nowUs() - start;
+    }
+};
+
+TEST_F(MoistureSamplerTest, AveragesEachChannelIndependently) {
+    int calls = 0;
+    int pin34Reads = 0;
+    hal::sim::setAnalogSource([&](int pin) {
+        calls++;
+        return pin == 34 ? 1000 + (pin34Reads++ % 2) * 11 : 2000;
+    });
+
+    MoistureSampler sampler;
+    std::vector<uint16_t> averages;
+    sampler.scan({34, 35, 36}, {true, true, false}, averages);
+
+    ASSERT_EQ(averages.size(), 3u);
+    EXPECT_EQ(averages[0], 1006);  // 1005.5 rounded
+    EXPECT_EQ(averages[1], 2000);
+    EXPECT_EQ(calls, 2 * MoistureSampler::SAMPLES);
+}
+
+TEST_F(MoistureSamplerTest, DropsSingleSpikePerChannel) {
+    int reads = 0;
+    hal::sim::setAnalogSource([&](int) { return reads++ == 2 ? 4095 : 1500; });
+
+    MoistureSampler sampler;
+    std::vector<uint16_t> averages;
+    sampler.scan({34}, {true}, averages);
+    EXPECT_EQ(averages[0], 1500);
+}
+
+TEST_F(MoistureSamplerTest, ScanTimeIsOneSamplePeriodPerRound) {
+    MoistureSampler sampler;
+    std::vector<uint16_t> averages;
+    const int64_t start = hal::sim::nowUs();
+    sampler.scan(std::vector<int>(16, 34), std::vector<bool>(16, true), averages);
+    EXPECT_EQ(hal::sim::nowUs() - start,
+              (MoistureSampler::SAMPLES - 1) * MoistureSampler::SAMPLE_PERIOD_MS * 1000LL);
+}
+
+TEST_F(MoistureSamplerTest, CycleTimeIsIndependentOfSystemSize) {
+    const int64_t one = timeUpdate(1);
+    const int64_t four = timeUpdate(4);
+    const int64_t sixteen = timeUpdate(16);
+
+    EXPECT_EQ(one, four);
+    EXPECT_EQ(one, sixteen);
+    // The old serial reader needed SAMPLES * 10 ms per enabled channel.
+    EXPECT_LT(sixteen, 16LL * MoistureSampler::SAMPLES * 10 * 1000);
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "SimTestSetup.h"
+#include "Bmp085Sim.h"
+#include "SensorManager.h"
+#include "RelayManager.h"
+
+class NativeHalTest : public ConfiguredSimTest {};
+
+TEST_F(NativeHalTest, ConfigManagerInitializesDefaultsInNvs) {
+    EXPECT_EQ(config.getHwConfig().systemSize.value(), 4);
+    EXPECT_EQ(config.getHwConfig().moistureSensorPins, (std::vector<int>{34, 35, 36, 39}));
+    EXPECT_EQ(config.getSwConfig().sensorUpdateInterval.value(), 60000u);
+    EXPECT_FLOAT_EQ(config.getSensorConfig(3).threshold.value(), 25.0f);
+    EXPECT_EQ(hal::sim::state().nvs["cfg"].count("th3"), 1u);
+}
+
+TEST_F(NativeHalTest, ConfigManagerPersistsSensorConfigAcrossRestart) {
+    ConfigTypes::SensorConfig update;
+    update.threshold = 40.0f;
+    EXPECT_TRUE(config.setSensorConfig(update, 1));
+
+    PreferencesHandler rebootedPrefs;
+    ConfigManager rebooted(rebootedPrefs);
+    ASSERT_TRUE(rebooted.begin("cfg"));
+    EXPECT_FLOAT_EQ(rebooted.getSensorConfig(1).threshold.value(), 40.0f);
+    EXPECT_FLOAT_EQ(rebooted.getSensorConfig(0).threshold.value(), 25.0f);
+}
+
+TEST_F(NativeHalTest, SensorManagerReadsSimulatedAdc) {
+    hal::sim::setAnalog(34, 2592);  // dry end of the default calibration
+    hal::sim::setAnalog(35, 975);   // wet end
+    hal::sim::Bmp085Device bmp;
+    hal::sim::attachI2C(hal::sim::Bmp085Device::ADDRESS, &bmp);
+
+    SensorManager sensors(config);
+    sensors.setupFloatSwitch();
+    I2CBus i2cBus;
+    sensors.setupSensors(i2cBus);
+    sensors.updateSensorData();
+
+    const SensorData& data = sensors.getSensorData();
+    EXPECT_FLOAT_EQ(data.getMoisture(0), 0.0f);
+    EXPECT_FLOAT_EQ(data.getMoisture(1), 100.0f);
+    EXPECT_FLOAT_EQ(data.temperature, 15.0f);
+    EXPECT_NEAR(data.pressure, 699.64f, 0.05f);
+    EXPECT_EQ(bmp.earlyReads, 0);
+    hal::sim::attachI2C(hal::sim::Bmp085Device::ADDRESS, nullptr);
+    EXPECT_TRUE(data.waterLevel);
+}
+
+TEST_F(NativeHalTest, RelayDeactivatesWhenTimerFires) {
+    SensorManager sensors(config);
+    sensors.setupFloatSwitch();
+    sensors.updateSensorData();
+
+    I2CBus i2cBus;
+    RelayManager relays(config, sensors, i2cBus);
+    relays.init();
+    const int pin = config.getHwConfig().relayPins[0];
+    ASSERT_TRUE(relays.activateRelay(0));
+    EXPECT_EQ(hal::sim::getDigital(pin), LOW);
+
+    const uint32_t period = config.getSensorConfig(0).activationPeriod.value();
+    hal::sim::advanceUs((period - 1) * 1000LL);
+    EXPECT_TRUE(relays.getRelayState(0));
+    hal::sim::advanceUs(1000);
+    EXPECT_FALSE(relays.getRelayState(0));
+    EXPECT_EQ(hal::sim::getDigital(pin), HIGH);
+}
+
+TEST_F(NativeHalTest, RelayTimersArePreallocatedPerRelay) {
+    SensorManager sensors(config);
+    sensors.setupFloatSwitch();
+    sensors.updateSensorData();
+
+    I2CBus i2cBus;
+    RelayManager relays(config, sensors, i2cBus);
+    relays.init();
+    const size_t timers = hal::sim::state().timers.size();
+    const uint32_t period = config.getSensorConfig(1).activationPeriod.value();
+
+    ASSERT_TRUE(relays.activateRelay(0));
+    hal::sim::advanceUs(1000000);
+    ASSERT_TRUE(relays.activateRelay(1));   // switches relay 0 off and cancels its timer
+    EXPECT_FALSE(relays.getRelayState(0));
+    EXPECT_EQ(hal::sim::state().timers.size(), timers);
+
+    // Relay 1 runs its own full period, relay 0's old deadline does not cut it short
+    hal::sim::advanceUs((period - 1) * 1000LL);
+    EXPECT_TRUE(relays.getRelayState(1));
+    ASSERT_TRUE(relays.activateRelay(1));   // already on, deadline unchanged
+    hal::sim::advanceUs(1000);
+    EXPECT_FALSE(relays.getRelayState(1));
+    EXPECT_EQ(hal::sim::state().timers.size(), timers);
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include "RelayEventRing.h"
+
+namespace {
+RelayEvent makeEvent(uint32_t timeMs, uint8_t relay, bool on, RelayEvent::Cause cause) {
+    RelayEvent event;
+    event.timeMs = timeMs;
+    event.relay = relay;
+    event.on = on;
+    event.cause = cause;
+    return event;
+}
+}
+
+TEST(RelayEventRingTest, PackRoundTrips) {
+    const RelayEvent event = makeEvent(123456, 3, true, RelayEvent::Cause::PREEMPTED);
+    const RelayEvent back = RelayEvent::unpack(event.timeMs, event.packInfo());
+    EXPECT_EQ(back.timeMs, 123456u);
+    EXPECT_EQ(back.relay, 3);
+    EXPECT_TRUE(back.on);
+    EXPECT_EQ(back.cause, RelayEvent::Cause::PREEMPTED);
+}
+
+TEST(RelayEventRingTest, ReturnsEventsOldestFirst) {
+    RelayEventRing ring;
+    ring.push(makeEvent(10, 0, true, RelayEvent::Cause::MANUAL));
+    ring.push(makeEvent(20, 0, false, RelayEvent::Cause::TIMER));
+    ring.push(makeEvent(30, 1, true, RelayEvent::Cause::CONTROLLER));
+
+    RelayEvent out[8];
+    ASSERT_EQ(ring.copyRecent(out, 8), 3u);
+    EXPECT_EQ(out[0].timeMs, 10u);
+    EXPECT_EQ(out[1].cause, RelayEvent::Cause::TIMER);
+    EXPECT_EQ(out[2].relay, 1);
+
+    // A smaller buffer gets the newest ones
+    ASSERT_EQ(ring.copyRecent(out, 2), 2u);
+    EXPECT_EQ(out[0].timeMs, 20u);
+    EXPECT_EQ(out[1].timeMs, 30u);
+    EXPECT_EQ(ring.total(), 3u);
+}
+
+TEST(RelayEventRingTest, WrapsAroundKeepingTheNewest) {
+    RelayEventRing ring;
+    const uint32_t pushed = RelayEventRing::CAPACITY * 3 + 5;
+    for (uint32_t i = 0; i < pushed; ++i) {
+        ring.push(makeEvent(i, static_cast<uint8_t>(i % 4), i % 2, RelayEvent::Cause::CONTROLLER));
+    }
+
+    RelayEvent out[RelayEventRing::CAPACITY];
+    const size_t count = ring.copyRecent(out, RelayEventRing::CAPACITY);
+    ASSERT_EQ(count, RelayEventRing::CAPACITY - 1);
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(out[i].timeMs, pushed - count + i);
+    }
+    EXPECT_EQ(ring.total(), pushed);
+}
+
+TEST(RelayEventRingTest, ReadersNeverSeeTornEvents) {
+    RelayEventRing ring;
+    std::atomic<bool> done{false};
+
+    // Every event carries its timestamp in the relay field too, so a torn slot shows up
+    std::thread writer([&]() {
+        for (uint32_t i = 0; i < 200000; ++i) {
+            ring.push(makeEvent(i, static_cast<uint8_t>(i), true, RelayEvent::Cause::CONTROLLER));
+        }
+        done = true;
+    });
+
+    RelayEvent out[RelayEventRing::CAPACITY];
+    while (!done) {
+        const size_t count = ring.copyRecent(out, RelayEventRing::CAPACITY);
+        for (size_t i = 0; i < count; ++i) {
+            ASSERT_EQ(out[i].relay, static_cast<uint8_t>(out[i].timeMs));
+            if (i > 0) {
+                ASSERT_EQ(out[i].timeMs, out[i - 1].timeMs + 1);
+            }
+        }
+    }
+    writer.join();
+}
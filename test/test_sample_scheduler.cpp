@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include "SimTestSetup.h"
+#include "RelayManager.h"
+#include "SampleScheduler.h"
+#include "SensorManager.h"
+
+TEST(SampleSchedulerTest, BacksOffExponentiallyUpToConfiguredInterval) {
+    SampleScheduler scheduler;
+    EXPECT_EQ(scheduler.next(60000, false, 0), 60000u);  // starts at the configured interval
+
+    EXPECT_EQ(scheduler.next(60000, false, SampleScheduler::CHANGE_THRESHOLD_TENTHS), SampleScheduler::MIN_INTERVAL_MS);
+    EXPECT_EQ(scheduler.next(60000, false, 2), 10000u);
+    EXPECT_EQ(scheduler.next(60000, false, 0), 20000u);
+    EXPECT_EQ(scheduler.next(60000, false, 0), 40000u);
+    EXPECT_EQ(scheduler.next(60000, false, 0), 60000u);
+    EXPECT_EQ(scheduler.next(60000, false, 0), 60000u);
+}
+
+TEST(SampleSchedulerTest, StaysFastWhileActuatingAndFollowsIntervalChanges) {
+    SampleScheduler scheduler;
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(scheduler.next(60000, true, 0), SampleScheduler::MIN_INTERVAL_MS);
+    }
+    EXPECT_EQ(scheduler.next(60000, false, 0), 10000u);
+    EXPECT_EQ(scheduler.next(15000, false, 0), 15000u);   // lowered upper bound applies at once
+    EXPECT_EQ(scheduler.next(3000, true, 0), 3000u);      // never faster than the configured interval
+}
+
+class AdaptiveSamplingTest : public ConfiguredSimTest {
+protected:
+    void SetUp() override {
+        ConfiguredSimTest::SetUp();
+        disableMoistureFilter(config);
+        hal::sim::setAnalog(34, 2000);
+        sensors.setupFloatSwitch();
+    }
+
+    SensorManager sensors{config};
+};
+
+TEST_F(AdaptiveSamplingTest, SpeedsUpWhileMoistureChanges) {
+    sensors.updateSensorData();
+    EXPECT_EQ(sensors.scheduleNextSample(), 60000u);
+
+    hal::sim::setAnalog(34, 1500);  // watering front reaches the probe
+    sensors.updateSensorData();
+    EXPECT_EQ(sensors.scheduleNextSample(), SampleScheduler::MIN_INTERVAL_MS);
+
+    sensors.updateSensorData();
+    EXPECT_EQ(sensors.scheduleNextSample(), 10000u);
+    EXPECT_EQ(sensors.getSampleInterval(), 10000u);
+}
+
+TEST_F(AdaptiveSamplingTest, RelayActivityForcesFastSampling) {
+    sensors.updateSensorData();
+    I2CBus i2cBus;
+    RelayManager relays(config, sensors, i2cBus);
+    relays.init();
+
+    ASSERT_TRUE(relays.activateRelay(0));
+    sensors.updateSensorData();
+    EXPECT_EQ(sensors.scheduleNextSample(), SampleScheduler::MIN_INTERVAL_MS);
+
+    relays.deactivateRelay(0);
+    sensors.updateSensorData();
+    EXPECT_EQ(sensors.scheduleNextSample(), 10000u);
+}
+
+TEST(TaskNotifyTest, NotificationWakesWaitingTask) {
+    hal::sim::reset();
+    hal::sim::useVirtualClock(false);
+    static std::atomic<uint32_t> woken{0};
+    TaskHandle_t task = nullptr;
+    xTaskCreate([](void*) { woken = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(60000)) + 1; }, "waiter", 2048, nullptr, 1, &task);
+
+    const auto start = std::chrono::steady_clock::now();
+    while (woken == 0 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+        xTaskNotifyGive(task);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_GE(woken.load(), 2u);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    hal::sim::useVirtualClock();
+}
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include "AllocationCounter.h"
+#include "SimTestSetup.h"
+#include "SensorManager.h"
+
+class SensorDataTest : public ConfiguredSimTest {};
+
+TEST_F(SensorDataTest, StoresTenthsAndChannelBits) {
+    SensorData data;
+    EXPECT_FALSE(data.isValid(3));
+    data.setEnabled(3, true);
+    data.setMoisture(3, 42.26f);
+    EXPECT_TRUE(data.isEnabled(3));
+    EXPECT_TRUE(data.isValid(3));
+    EXPECT_EQ(data.moistureTenths[3], 423);
+    EXPECT_FLOAT_EQ(data.getMoisture(3), 42.3f);
+
+    data.setEnabled(3, false);
+    EXPECT_FALSE(data.isEnabled(3));
+    EXPECT_FALSE(data.isValid(3));
+    EXPECT_FALSE(data.isValid(SensorData::MAX_CHANNELS));
+}
+
+TEST_F(SensorDataTest, DisabledChannelsAreNotValid) {
+    ConfigTypes::SensorConfig disabled;
+    disabled.sensorEnabled = false;
+    config.setSensorConfig(disabled, 2);
+
+    SensorManager sensors(config);
+    sensors.setupFloatSwitch();
+    sensors.updateSensorData();
+
+    const SensorData data = sensors.getSensorData();
+    EXPECT_EQ(data.enabledMask, 0b1011);
+    EXPECT_EQ(data.validMask, 0b1011);
+}
+
+TEST_F(SensorDataTest, SteadyStateReadsAndUpdatesDoNotAllocate) {
+    SensorManager sensors(config);
+    sensors.setupFloatSwitch();
+    sensors.updateSensorData();  // warm-up sizes the sampler buffers
+
+    const uint64_t before = allocationCounter().count.load();
+    float sum = 0.0f;
+    for (int i = 0; i < 1000; ++i) {
+        SensorData data = sensors.getSensorData();
+        sum += data.getMoisture(i % 4);
+    }
+    sensors.updateSensorData();
+    EXPECT_EQ(allocationCounter().count.load() - before, 0u);
+    EXPECT_GE(sum, 0.0f);
+}
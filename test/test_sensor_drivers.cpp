@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "SimTestSetup.h"
+#include "Bme280Sim.h"
+#include "Bmp085Sim.h"
+#include "Ds18b20Sim.h"
+#include "Sht3xSim.h"
+#include "Bme280.h"
+#include "Bmp085.h"
+#include "Ds18b20.h"
+#include "Sht3x.h"
+#include "SensorDriver.h"
+
+class SensorDriversTest : public SimTest {
+protected:
+    static constexpr int DS18B20_PIN = 4;
+
+    hal::sim::Bme280Device bme;
+    hal::sim::Bmp085Device bmp;
+    hal::sim::Sht3xDevice sht;
+    hal::sim::Ds18b20Device ds;
+    I2CBus bus;
+
+    void TearDown() override {
+        hal::sim::reset();
+    }
+
+    // Same measure loop as SensorRegistry, for a single driver. Returns the elapsed time in us.
+    template<typename Driver>
+    static int64_t measure(Driver& driver) {
+        const int64_t start = hal::sim::nowUs();
+        EXPECT_TRUE(driver.start());
+        while (driver.isBusy()) {
+            vTaskDelay(pdMS_TO_TICKS((driver.usUntilReady() + 999) / 1000));
+            driver.poll();
+        }
+        return hal::sim::nowUs() - start;
+    }
+
+    // Floating point humidity compensation from the BME280 datasheet, as an independent reference.
+    static double referenceHumidity(double tFine, double adcH) {
+        const double h1 = 75, h2 = 362, h3 = 0, h4 = 313, h5 = 50, h6 = 30;
+        double h = tFine - 76800.0;
+        h = (adcH - (h4 * 64.0 + h5 / 16384.0 * h)) *
+            (h2 / 65536.0 * (1.0 + h6 / 67108864.0 * h * (1.0 + h3 / 67108864.0 * h)));
+        h = h * (1.0 - h1 * h / 524288.0);
+        return std::clamp(h, 0.0, 100.0);
+    }
+};
+
+TEST_F(SensorDriversTest, Bme280MatchesDatasheetCompensation) {
+    hal::sim::attachI2C(hal::sim::Bme280Device::ADDRESS, &bme);
+    Bme280 driver;
+    ASSERT_TRUE(driver.begin(bus));
+    const int64_t elapsed = measure(driver);
+
+    EXPECT_FLOAT_EQ(driver.getTemperature(), 25.08f);
+    EXPECT_NEAR(driver.getPressure(), 100653.27f, 0.05f);  // datasheet floating point result
+    // t_fine for the datasheet example is 128422
+    EXPECT_NEAR(driver.getHumidity(), referenceHumidity(128422, bme.adcH), 0.01);
+    EXPECT_EQ(elapsed, 10000);   // 9.3 ms maximum, rounded up to the tick
+    EXPECT_EQ(bme.earlyReads, 0);
+}
+
+TEST_F(SensorDriversTest, Bme280OversamplingStretchesMeasurement) {
+    hal::sim::attachI2C(hal::sim::Bme280Device::ADDRESS, &bme);
+    Bme280 driver;
+    driver.setOversampling(16);
+    ASSERT_TRUE(driver.begin(bus));
+    EXPECT_EQ(measure(driver), 113000);   // 1.25 + 3 * 36.8 + 1.15 ms
+    EXPECT_EQ(bme.earlyReads, 0);
+}
+
+TEST_F(SensorDriversTest, Sht3xConvertsAndChecksCrc) {
+    EXPECT_EQ(Sht3x::crc8(reinterpret_cast<const uint8_t*>("\xBE\xEF"), 2), 0x92);  // datasheet example
+
+    hal::sim::attachI2C(hal::sim::Sht3xDevice::ADDRESS, &sht);
+    Sht3x driver;
+    ASSERT_TRUE(driver.begin(bus));
+    EXPECT_EQ(measure(driver), 16000);
+    EXPECT_NEAR(driver.getTemperature(), 25.0f, 0.01f);
+    EXPECT_NEAR(driver.getHumidity(), 50.0f, 0.01f);
+    EXPECT_EQ(sht.earlyReads, 0);
+
+    sht.rawTemperature = 0x7000;
+    sht.corruptNextCrc = true;
+    measure(driver);
+    EXPECT_EQ(driver.getErrors(), 1u);
+    EXPECT_NEAR(driver.getTemperature(), 25.0f, 0.01f);   // previous value kept
+}
+
+TEST_F(SensorDriversTest, Ds18b20UsesConfiguredResolution) {
+    hal::sim::attachOneWire(DS18B20_PIN, &ds);
+    ds.temperature = 21.3f;
+    Ds18b20 driver;
+    driver.setPin(DS18B20_PIN);
+    ASSERT_TRUE(driver.begin(bus));
+    EXPECT_EQ(ds.resolutionBits(), 10);
+
+    EXPECT_EQ(measure(driver), 188000);   // 187.5 ms at 10 bits
+    EXPECT_FLOAT_EQ(driver.getTemperature(), 21.25f);   // 0.25 °C steps
+    EXPECT_EQ(ds.conversions, 1);
+    EXPECT_EQ(ds.earlyReads, 0);
+}
+
+TEST_F(SensorDriversTest, Ds18b20WithoutProbeIsAbsent) {
+    Ds18b20 driver;
+    driver.setPin(DS18B20_PIN);
+    EXPECT_FALSE(driver.begin(bus));
+    EXPECT_FALSE(driver.start());
+}
+
+TEST_F(SensorDriversTest, RegistryOverlapsDriversAndPrefersFirstListed) {
+    hal::sim::attachI2C(hal::sim::Sht3xDevice::ADDRESS, &sht);
+    hal::sim::attachI2C(hal::sim::Bmp085Device::ADDRESS, &bmp);
+    SensorRegistry<Sht3x, Bmp085, Bme280> registry;
+    EXPECT_EQ(registry.beginAll(bus), 2u);   // no BME280 attached
+
+    const int64_t start = hal::sim::nowUs();
+    EXPECT_TRUE(registry.measure());
+    // SHT3x 15.5 ms and BMP085 4.5 + 25.5 ms run side by side
+    EXPECT_EQ(hal::sim::nowUs() - start, 31000);
+
+    const EnvironmentReading reading = registry.collect();
+    EXPECT_EQ(reading.validMask, EnvironmentReading::TEMPERATURE | EnvironmentReading::PRESSURE | EnvironmentReading::HUMIDITY);
+    EXPECT_NEAR(reading.temperature, 25.0f, 0.01f);    // SHT3x, not the BMP085's 15.0
+    EXPECT_NEAR(reading.pressure, 699.64f, 0.05f);
+    EXPECT_NEAR(reading.humidity, 50.0f, 0.01f);
+    EXPECT_EQ(sht.earlyReads + bmp.earlyReads, 0);
+}
+
+TEST_F(SensorDriversTest, RegistryReportsFailedDriver) {
+    hal::sim::attachI2C(hal::sim::Sht3xDevice::ADDRESS, &sht);
+    SensorRegistry<Sht3x> registry;
+    ASSERT_EQ(registry.beginAll(bus), 1u);
+    sht.corruptNextCrc = true;
+    EXPECT_FALSE(registry.measure());
+    EXPECT_EQ(registry.collect().validMask, 0);
+    EXPECT_TRUE(registry.measure());
+    EXPECT_TRUE(registry.collect().has(EnvironmentReading::HUMIDITY));
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "SensorHistory.h"
+
+namespace {
+struct StringOut {
+    std::string text;
+    void print(const char* s) { text += s; }
+};
+
+std::array<int16_t, ConfigConstants::MAX_SYSTEM_SIZE> moisture(int16_t ch0, int16_t ch1) {
+    std::array<int16_t, ConfigConstants::MAX_SYSTEM_SIZE> values{};
+    values[0] = ch0;
+    values[1] = ch1;
+    return values;
+}
+}
+
+TEST(SensorHistoryTest, AveragesSamplesIntoBuckets) {
+    HistoryTier<4> tier(60);
+    tier.add(0, moisture(400, 0), 0b01, 20.0f, 1000.0f);
+    tier.add(30, moisture(420, 0), 0b01, 21.0f, 1002.0f);
+    tier.add(60, moisture(300, 0), 0b01, 22.0f, 1004.0f);
+
+    ASSERT_EQ(tier.size(), 2u);
+    const auto first = tier.at(0);
+    EXPECT_EQ(first.moisture[0], 82);   // 41.0% in half-percent steps
+    EXPECT_EQ(first.moisture[1], HistoryTier<4>::NO_MOISTURE);
+    EXPECT_EQ(first.temperature, 205);
+    EXPECT_EQ(first.pressure, 10010);
+    EXPECT_EQ(tier.at(1).moisture[0], 60);  // current, partially filled bucket
+}
+
+TEST(SensorHistoryTest, KeepsGapsAndDropsOldestBuckets) {
+    HistoryTier<4> tier(60);
+    tier.add(0, moisture(100, 0), 0b01, 20.0f, 1000.0f);
+    tier.add(180, moisture(200, 0), 0b01, 20.0f, 1000.0f);
+    ASSERT_EQ(tier.size(), 4u);
+    EXPECT_EQ(tier.at(0).moisture[0], 20);
+    EXPECT_EQ(tier.at(1).moisture[0], HistoryTier<4>::NO_MOISTURE);
+    EXPECT_EQ(tier.at(2).temperature, HistoryTier<4>::NO_TEMPERATURE);
+    EXPECT_EQ(tier.at(3).moisture[0], 40);
+
+    for (uint32_t t = 240; t <= 600; t += 60) {
+        tier.add(t, moisture(500, 0), 0b01, 20.0f, 1000.0f);
+    }
+    ASSERT_EQ(tier.size(), 5u);  // capacity plus the current bucket
+    EXPECT_EQ(tier.at(0).moisture[0], 100);
+}
+
+TEST(SensorHistoryTest, StreamsDownsampledJson) {
+    SensorHistory history;
+    for (uint32_t minute = 0; minute < 4; ++minute) {
+        history.add(minute * 60, moisture(100 * (minute + 1), 555), 0b11, 20.0f + minute, 1000.0f);
+    }
+
+    StringOut out;
+    history.writeJson(out, SensorHistory::Range::HOUR, 2, 2, 230);
+    EXPECT_EQ(out.text,
+              "{\"range\":\"hour\",\"interval\":120,\"end\":230,"
+              "\"moisture\":[[15,35],[55.5,55.5]],"
+              "\"temperature\":[20.5,22.5],\"pressure\":[1000,1000]}");
+
+    StringOut day;
+    history.writeJson(day, SensorHistory::Range::DAY, 100, 1, 0);
+    EXPECT_EQ(day.text,
+              "{\"range\":\"day\",\"interval\":300,\"end\":0,"
+              "\"moisture\":[[25]],\"temperature\":[21.5],\"pressure\":[1000]}");
+}
+
+TEST(SensorHistoryTest, WritesGapsUpToTheEndTime) {
+    const uint32_t start = 1700000040;
+    SensorHistory history;
+    history.add(start, moisture(400, 0), 0b01, 20.0f, 1000.0f);
+    history.add(start + 60, moisture(500, 0), 0b01, 20.0f, 1000.0f);
+
+    // The sensor task stalled; the last two minutes have no samples
+    StringOut out;
+    history.writeJson(out, SensorHistory::Range::HOUR, 100, 1, start + 190);
+    EXPECT_EQ(out.text,
+              "{\"range\":\"hour\",\"interval\":60,\"end\":1700000230,"
+              "\"moisture\":[[40,50,null,null]],\"temperature\":[20,20,null,null],\"pressure\":[1000,1000,null,null]}");
+
+    // Gaps past the capacity push out the samples, as the next add() would
+    HistoryTier<4> tier(60);
+    tier.add(0, moisture(100, 0), 0b01, 20.0f, 1000.0f);
+    tier.add(60, moisture(200, 0), 0b01, 20.0f, 1000.0f);
+    ASSERT_EQ(tier.size(180), 4u);
+    EXPECT_EQ(tier.at(1, 180).moisture[0], 40);
+    EXPECT_EQ(tier.at(2, 180).moisture[0], HistoryTier<4>::NO_MOISTURE);
+    ASSERT_EQ(tier.size(600), 5u);
+    EXPECT_EQ(tier.at(0, 600).moisture[0], HistoryTier<4>::NO_MOISTURE);
+    EXPECT_EQ(tier.size(30), 2u);   // clock set back: nothing is padded
+}
+
+TEST(SensorHistoryTest, ParsesRangeNames) {
+    SensorHistory::Range range = SensorHistory::Range::HOUR;
+    EXPECT_TRUE(SensorHistory::parseRange("month", range));
+    EXPECT_EQ(range, SensorHistory::Range::MONTH);
+    EXPECT_FALSE(SensorHistory::parseRange("year", range));
+}
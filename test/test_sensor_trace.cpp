@@ -0,0 +1,344 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include "SimTestSetup.h"
+#include "Bmp085Sim.h"
+#include "SensorTrace.h"
+#include "SensorTraceReplay.h"
+
+namespace {
+
+constexpr int DRY = 2592;   // 0 % with the default calibration
+constexpr int WET = 975;    // 100 %
+
+SensorTraceWriter::Sink appendTo(std::vector<uint8_t>& out) {
+    return [&out](const uint8_t* data, size_t len) {
+        out.insert(out.end(), data, data + len);
+        return true;
+    };
+}
+
+// Runs the managers for a few simulated hours with drying soil, pumps that wet it and a
+// reservoir that runs low once, capturing a trace the way the firmware does.
+class TraceCapture {
+public:
+    static constexpr int64_t SCAN_PERIOD_US = 60 * 1000000LL;
+
+    std::vector<uint8_t> trace;
+    uint32_t relaySwitches = 0;
+
+    void run(int hours) {
+        resetSim();
+        ConfigManager config(prefs);
+        config.begin("cfg");
+        ConfigTypes::HardwareConfig hw;
+        hw.systemSize = 3;
+        config.setHardwareConfig(hw);
+        config.begin("cfg");
+        for (size_t i = 0; i < 3; ++i) {
+            ConfigTypes::SensorConfig sensor;
+            sensor.threshold = 40.0f + 5.0f * i;
+            sensor.activationPeriod = 20000;
+            sensor.wateringInterval = 1800;
+            sensor.relayEnabled = true;
+            config.setSensorConfig(sensor, i);
+        }
+        const int floatPin = config.getHwConfig().floatSwitchPin.value();
+        const auto pins = config.getHwConfig().moistureSensorPins;
+        hal::sim::setDigital(floatPin, HIGH);
+        hal::sim::attachI2C(hal::sim::Bmp085Device::ADDRESS, &bmp);
+
+        SensorManager sensors(config);
+        sensors.setupFloatSwitch();
+        sensors.setupSensors(bus);
+        RelayManager relays(config, sensors, bus);
+        relays.init();
+        SensorTraceWriter writer(appendTo(trace));
+        sensors.setTrace(&writer);
+        relays.setRelayEventCallback([&](int relay, bool on) {
+            writer.recordRelay(relay, on);
+            relaySwitches++;
+        });
+        sim::ControllerDriver controller(relays);
+
+        float moisture[3] = {48.0f, 52.0f, 60.0f};
+        const int64_t startUs = hal::sim::nowUs();
+        for (int scan = 0; scan < hours * 60; ++scan) {
+            const uint32_t mask = relays.getRelayMask();
+            for (size_t i = 0; i < 3; ++i) {
+                moisture[i] += (mask & (1u << i)) ? 1.5f : -0.04f * (i + 1);
+                hal::sim::setAnalog(pins[i], static_cast<int>(DRY - moisture[i] / 100.0f * (DRY - WET)) + noise());
+            }
+            bmp.ut = static_cast<uint16_t>(27898 + noise() * 20);
+            bmp.up = static_cast<uint32_t>(23843 + noise() * 50);
+            if (scan == 100 || scan == 130) {
+                hal::sim::setDigital(floatPin, scan == 100 ? LOW : HIGH);
+                sensors.settleFloatSwitch();
+            }
+            controller.advanceTo(startUs + scan * SCAN_PERIOD_US);
+            sensors.updateSensorData();
+            controller.evaluate();
+        }
+        writer.flush();
+        sensors.setTrace(nullptr);
+        relays.setRelayEventCallback(nullptr);
+        hal::sim::attachI2C(hal::sim::Bmp085Device::ADDRESS, nullptr);
+    }
+
+private:
+    PreferencesHandler prefs;
+    I2CBus bus;
+    hal::sim::Bmp085Device bmp;
+    uint32_t rng = 7;
+
+    // -3..3, xorshift32
+    int noise() {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return static_cast<int>(rng % 7) - 3;
+    }
+};
+
+class SensorTraceTest : public SimTest {};
+
+}  // namespace
+
+TEST_F(SensorTraceTest, RecordsRoundTrip) {
+    SensorTraceConfig config;
+    config.moistureFilter = 2;
+    config.bmpOversampling = 3;
+    config.bmpPresent = true;
+    config.tempOffset = -1.25f;
+    config.floatSwitchPin = 23;
+    config.powerBudget = 1500;
+    config.inrushDelay = 250;
+    config.bmpCalibration[0] = 0x01;
+    config.bmpCalibration[21] = 0xB4;
+    config.muxSelectPins = {13, 14, 26, 27};
+    config.muxSignalPins = {32};
+    config.zones.resize(2);
+    config.zones[1].pin = -1;
+    config.zones[1].relayEnabled = true;
+    config.zones[1].autoTune = true;
+    config.zones[1].threshold = 37.5f;
+    config.zones[1].activationPeriod = 123456;
+    config.zones[1].dryValue = 2600;
+    config.zones[1].wateringGain = 0.75f;
+
+    std::vector<uint8_t> trace;
+    SensorTraceWriter writer(appendTo(trace));
+    ASSERT_TRUE(writer.begin(config));
+    writer.recordAdcSample(5, 4095);
+    hal::sim::advanceUs(10LL * 86400 * 1000000);    // a delta that needs a 7-byte varint
+    writer.recordBmp085(27898, 0xABCDEF, 3);
+    SensorData data;
+    data.setEnabled(0, true);
+    data.setEnabled(7, true);
+    data.setMoistureTenths(0, -12);
+    data.setMoistureTenths(7, 1000);
+    data.temperature = 21.37f;
+    data.pressure = 1013.25f;
+    data.waterLevel = true;
+    writer.recordScan(data);
+    hal::sim::advanceUs(150);
+    writer.recordFloatSwitch(false);
+    writer.recordRelay(3, true);
+    ASSERT_TRUE(writer.flush());
+    EXPECT_EQ(writer.getBytesWritten(), trace.size());
+
+    SensorTraceReader reader(trace.data(), trace.size());
+    SensorTraceConfig decoded;
+    ASSERT_TRUE(reader.readHeader(decoded));
+    EXPECT_TRUE(decoded.bmpPresent);
+    EXPECT_EQ(decoded.moistureFilter, 2);
+    EXPECT_EQ(decoded.tempOffset, -1.25f);
+    EXPECT_EQ(decoded.floatSwitchPin, 23);
+    EXPECT_EQ(decoded.powerBudget, 1500);
+    EXPECT_EQ(decoded.bmpCalibration, config.bmpCalibration);
+    EXPECT_EQ(decoded.muxSelectPins, config.muxSelectPins);
+    ASSERT_EQ(decoded.zones.size(), 2u);
+    EXPECT_EQ(decoded.zones[1].pin, -1);
+    EXPECT_TRUE(decoded.zones[1].autoTune);
+    EXPECT_FALSE(decoded.zones[1].sensorEnabled);
+    EXPECT_EQ(decoded.zones[1].threshold, 37.5f);
+    EXPECT_EQ(decoded.zones[1].activationPeriod, 123456u);
+    EXPECT_EQ(decoded.zones[1].dryValue, 2600);
+    EXPECT_EQ(decoded.zones[1].wateringGain, 0.75f);
+
+    SensorTraceReader::Record record;
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.type, SensorTrace::ADC_SAMPLE);
+    EXPECT_EQ(record.index, 5);
+    EXPECT_EQ(record.value, 4095);
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.type, SensorTrace::BMP085_RAW);
+    EXPECT_EQ(record.timeUs, 10LL * 86400 * 1000000);
+    EXPECT_EQ(record.ut, 27898);
+    EXPECT_EQ(record.result, 0xABCDEFu);
+    EXPECT_EQ(record.oversampling, 3);
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.type, SensorTrace::SCAN);
+    EXPECT_EQ(record.scan.validMask, data.validMask);
+    EXPECT_EQ(record.scan.moistureTenths[0], -12);
+    EXPECT_EQ(record.scan.moistureTenths[7], 1000);
+    EXPECT_EQ(record.scan.temperature, 21.37f);
+    EXPECT_EQ(record.scan.pressure, 1013.25f);
+    EXPECT_TRUE(record.scan.waterLevel);
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.type, SensorTrace::FLOAT_SWITCH);
+    EXPECT_EQ(record.timeUs, 10LL * 86400 * 1000000 + 150);
+    EXPECT_FALSE(record.flag);
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.type, SensorTrace::RELAY);
+    EXPECT_EQ(record.index, 3);
+    EXPECT_TRUE(record.flag);
+    EXPECT_FALSE(reader.next(record));
+    EXPECT_FALSE(reader.isCorrupt());
+}
+
+TEST_F(SensorTraceTest, FailingSinkStopsCaptureWithoutHoles) {
+    std::vector<uint8_t> trace;
+    bool accept = true;
+    SensorTraceWriter writer([&](const uint8_t* data, size_t len) {
+        if (!accept) return false;
+        trace.insert(trace.end(), data, data + len);
+        return true;
+    });
+    ASSERT_TRUE(writer.begin(SensorTraceConfig()));
+    for (int i = 0; i < 1000; ++i) {
+        writer.recordAdcSample(0, static_cast<uint16_t>(i));
+    }
+    accept = false;
+    writer.recordRelay(0, true);
+    EXPECT_FALSE(writer.flush());
+    EXPECT_FALSE(writer.isCapturing());
+    accept = true;
+    writer.recordRelay(0, false);
+    writer.flush();
+
+    // Only whole buffers made it out, and they decode to consecutive samples
+    SensorTraceReader reader(trace.data(), trace.size());
+    SensorTraceConfig config;
+    ASSERT_TRUE(reader.readHeader(config));
+    SensorTraceReader::Record record;
+    uint16_t expected = 0;
+    while (reader.next(record)) {
+        ASSERT_EQ(record.type, SensorTrace::ADC_SAMPLE);
+        EXPECT_EQ(record.value, expected++);
+    }
+    EXPECT_GT(expected, 0);
+    EXPECT_LT(expected, 1000);
+    EXPECT_EQ(writer.getBytesWritten(), trace.size());
+}
+
+TEST_F(SensorTraceTest, RelayAndFloatSwitchRecordsNeverReachTheSink) {
+    std::vector<uint8_t> trace;
+    int sinkCalls = 0;
+    SensorTraceWriter writer([&](const uint8_t* data, size_t len) {
+        sinkCalls++;
+        trace.insert(trace.end(), data, data + len);
+        return true;
+    });
+    ASSERT_TRUE(writer.begin(SensorTraceConfig()));
+    sinkCalls = 0;
+
+    // Far more than fit the buffer: the overflow is dropped, not flushed
+    for (int i = 0; i < 1000; ++i) {
+        writer.recordRelay(i % 4, i & 1);
+        writer.recordFloatSwitch(i & 1);
+    }
+    EXPECT_EQ(sinkCalls, 0);
+    EXPECT_GT(writer.getDroppedRecords(), 0u);
+    EXPECT_TRUE(writer.isCapturing());
+
+    // The sensor task's next record flushes them
+    writer.recordAdcSample(0, 1234);
+    EXPECT_EQ(sinkCalls, 1);
+    writer.flush();
+    SensorTraceReader reader(trace.data(), trace.size());
+    SensorTraceConfig config;
+    ASSERT_TRUE(reader.readHeader(config));
+    SensorTraceReader::Record record;
+    uint32_t events = 0;
+    while (reader.next(record) && record.type != SensorTrace::ADC_SAMPLE) {
+        events++;
+    }
+    EXPECT_EQ(record.value, 1234);
+    EXPECT_EQ(events + writer.getDroppedRecords(), 2000u);
+}
+
+TEST_F(SensorTraceTest, Base64ForMqtt) {
+    char out[16];
+    EXPECT_EQ(SensorTrace::toBase64(reinterpret_cast<const uint8_t*>("Man"), 3, out, sizeof(out)), 4u);
+    EXPECT_STREQ(out, "TWFu");
+    EXPECT_EQ(SensorTrace::toBase64(reinterpret_cast<const uint8_t*>("Ma"), 2, out, sizeof(out)), 4u);
+    EXPECT_STREQ(out, "TWE=");
+    EXPECT_EQ(SensorTrace::toBase64(reinterpret_cast<const uint8_t*>("M"), 1, out, sizeof(out)), 4u);
+    EXPECT_STREQ(out, "TQ==");
+    EXPECT_EQ(SensorTrace::toBase64(reinterpret_cast<const uint8_t*>("ManMan"), 6, out, 8), 0u);
+}
+
+TEST_F(SensorTraceTest, HostCaptureReplaysBitExact) {
+    TraceCapture capture;
+    capture.run(6);
+
+    sim::SensorTraceReplay replay(capture.trace.data(), capture.trace.size());
+    const sim::ReplayReport report = replay.run();
+    report.print(stdout);
+
+    ASSERT_TRUE(report.headerValid);
+    EXPECT_EQ(report.scans, 6u * 60);
+    EXPECT_EQ(report.samples, 6u * 60 * 3 * MoistureSampler::SAMPLES);
+    EXPECT_EQ(report.missingSamples, 0u);
+    EXPECT_EQ(report.floatSwitchChanges, 2u);
+    EXPECT_EQ(report.mismatches, 0u);
+    EXPECT_GT(capture.relaySwitches, 4u);
+    EXPECT_EQ(report.recordedRelays.size(), capture.relaySwitches);
+    EXPECT_TRUE(report.relaysMatch());
+}
+
+TEST_F(SensorTraceTest, ReplayDetectsAlteredSamples) {
+    TraceCapture capture;
+    capture.run(1);
+
+    // Shift every sample of the first scan by 100 counts, about 6 %
+    SensorTraceReader reader(capture.trace.data(), capture.trace.size());
+    SensorTraceConfig config;
+    ASSERT_TRUE(reader.readHeader(config));
+    SensorTraceReader::Record record;
+    size_t start = reader.position();
+    while (reader.next(record) && record.type != SensorTrace::SCAN) {
+        if (record.type == SensorTrace::ADC_SAMPLE) {
+            const size_t valueAt = reader.position() - 2;
+            const uint16_t value = static_cast<uint16_t>(record.value + 100);
+            capture.trace[valueAt] = static_cast<uint8_t>(value);
+            capture.trace[valueAt + 1] = static_cast<uint8_t>(value >> 8);
+        }
+        start = reader.position();
+    }
+    ASSERT_GT(start, 0u);
+
+    sim::SensorTraceReplay replay(capture.trace.data(), capture.trace.size());
+    const sim::ReplayReport report = replay.run();
+    EXPECT_GE(report.mismatches, 1u);
+    EXPECT_GE(report.firstMismatchUs, 0);
+    EXPECT_LT(report.firstMismatchUs, TraceCapture::SCAN_PERIOD_US);
+}
+
+// Replays a trace downloaded from a device: SENSOR_TRACE=/path/to/trace.bin
+TEST_F(SensorTraceTest, ReplaysCapturedFile) {
+    const char* path = std::getenv("SENSOR_TRACE");
+    if (path == nullptr) GTEST_SKIP() << "set SENSOR_TRACE to a captured trace file";
+    std::ifstream file(path, std::ios::binary);
+    ASSERT_TRUE(file) << path;
+    const std::vector<uint8_t> trace((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    sim::SensorTraceReplay replay(trace.data(), trace.size());
+    const sim::ReplayReport report = replay.run();
+    report.print(stdout);
+    ASSERT_TRUE(report.headerValid);
+    EXPECT_EQ(report.mismatches, 0u);
+    EXPECT_EQ(report.missingSamples, 0u);
+}
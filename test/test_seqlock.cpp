@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include "SeqLock.h"
+#include "SensorManager.h"
+
+namespace {
+struct Sample {
+    uint32_t values[8];
+};
+}
+
+TEST(SeqLockTest, VersionAdvancesOnEveryStore) {
+    SeqLock<Sample> lock;
+    Sample s{};
+    EXPECT_EQ(lock.load(s), 0u);
+    s.values[0] = 7;
+    lock.store(s);
+    lock.store(s);
+    Sample out{};
+    EXPECT_EQ(lock.load(out), 2u);
+    EXPECT_EQ(lock.version(), 2u);
+    EXPECT_EQ(out.values[0], 7u);
+}
+
+TEST(SeqLockTest, ReadersNeverSeeTornValues) {
+    SeqLock<Sample> lock;
+    std::atomic<bool> done{false};
+
+    std::thread writer([&]() {
+        Sample s{};
+        for (uint32_t n = 1; n <= 200000; ++n) {
+            for (auto& v : s.values) v = n;
+            lock.store(s);
+        }
+        done = true;
+    });
+
+    uint32_t lastVersion = 0;
+    while (!done) {
+        Sample s;
+        const uint32_t version = lock.load(s);
+        for (auto v : s.values) {
+            ASSERT_EQ(v, s.values[0]);
+        }
+        ASSERT_EQ(s.values[0], version);
+        ASSERT_GE(version, lastVersion);
+        lastVersion = version;
+    }
+    writer.join();
+}
+
+TEST(SeqLockTest, SensorDataIsSnapshotable) {
+    static_assert(std::is_trivially_copyable_v<SensorData>);
+    SeqLock<SensorData> lock;
+    SensorData data;
+    data.setMoisture(15, 42.0f);
+    data.waterLevel = true;
+    lock.store(data);
+    EXPECT_FLOAT_EQ(lock.load().getMoisture(15), 42.0f);
+    EXPECT_TRUE(lock.load().waterLevel);
+}
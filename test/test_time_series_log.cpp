@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <string>
+#include "SimTestSetup.h"
+#include "LittleFS.h"
+#include "TimeSeriesLog.h"
+
+namespace {
+constexpr uint32_t T0 = 1700000000;
+
+SensorData reading(float moisture0, float moisture1) {
+    SensorData data;
+    data.setEnabled(0, true);
+    data.setEnabled(1, true);
+    data.setMoisture(0, moisture0);
+    data.setMoisture(1, moisture1);
+    data.temperature = 21.5f;
+    data.pressure = 1013.2f;
+    data.waterLevel = true;
+    return data;
+}
+
+// Drains an export in chunks of `chunk` bytes, as the chunked HTTP response does.
+std::string exportCsv(TimeSeriesLog& log, uint32_t from, uint32_t to, size_t chunk) {
+    TimeSeriesLog::ExportCursor cursor;
+    log.beginExport(cursor, from, to);
+    std::string csv;
+    uint8_t buf[512];
+    while (size_t n = log.readCsv(cursor, buf, chunk)) {
+        csv.append(reinterpret_cast<char*>(buf), n);
+    }
+    return csv;
+}
+
+size_t countLines(const std::string& text, const std::string& needle) {
+    size_t count = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) count++;
+    return count;
+}
+}
+
+class TimeSeriesLogTest : public SimTest {
+protected:
+    std::string root;
+
+    void SetUp() override {
+        SimTest::SetUp();
+        char dir[] = "/tmp/tslog-XXXXXX";
+        root = mkdtemp(dir);
+        hal::sim::setFsRoot(root);
+        ASSERT_TRUE(LittleFS.begin());
+    }
+
+    void TearDown() override {
+        std::string cmd = "rm -rf " + root;
+        EXPECT_EQ(system(cmd.c_str()), 0);
+    }
+};
+
+TEST_F(TimeSeriesLogTest, BatchesWritesAndExportsCsv) {
+    TimeSeriesLog log(LittleFS);
+    ASSERT_TRUE(log.begin());
+
+    log.appendSensor(T0, reading(41.5f, 12.0f));
+    log.appendRelay(T0 + 5, 1, true);
+    EXPECT_FALSE(LittleFS.exists("/tslog/seg0.bin"));  // still buffered
+
+    log.appendSensor(T0 + TimeSeriesLog::FLUSH_INTERVAL_S, reading(40.0f, 12.0f));
+    EXPECT_TRUE(LittleFS.exists("/tslog/seg0.bin"));
+    log.appendSensor(100, reading(1.0f, 1.0f));  // clock not synced yet, dropped
+
+    EXPECT_EQ(exportCsv(log, T0, T0 + 5, 512),
+              "time,kind,index,value\n"
+              "1700000000,moisture,0,41.5\n"
+              "1700000000,moisture,1,12.0\n"
+              "1700000000,temperature,,21.5\n"
+              "1700000000,pressure,,1013.2\n"
+              "1700000000,water_level,,1\n"
+              "1700000005,relay,1,1\n");
+}
+
+TEST_F(TimeSeriesLogTest, RelayEventsNeverWriteToFlash) {
+    TimeSeriesLog log(LittleFS);
+    ASSERT_TRUE(log.begin());
+
+    // Neither an old buffer nor a full one makes a relay event flush
+    const uint32_t events = TimeSeriesLog::BUFFER_BYTES / 8 + 10;
+    for (uint32_t i = 0; i < events; ++i) {
+        log.appendRelay(T0 + i * TimeSeriesLog::FLUSH_INTERVAL_S, i % 4, i & 1);
+    }
+    EXPECT_FALSE(LittleFS.exists("/tslog/seg0.bin"));
+    EXPECT_EQ(log.getDroppedRecords(), 10u);
+
+    // The next sensor record flushes them, and leaves room for more
+    log.appendSensor(T0 + events * TimeSeriesLog::FLUSH_INTERVAL_S, reading(40.0f, 12.0f));
+    EXPECT_TRUE(LittleFS.exists("/tslog/seg0.bin"));
+    log.appendRelay(T0 + events * TimeSeriesLog::FLUSH_INTERVAL_S + 1, 0, true);
+    EXPECT_EQ(log.getDroppedRecords(), 10u);
+    EXPECT_EQ(countLines(exportCsv(log, 0, UINT32_MAX, 512), ",relay,"), events - 10 + 1);
+}
+
+TEST_F(TimeSeriesLogTest, SurvivesRestartAndStreamsInSmallChunks) {
+    {
+        TimeSeriesLog log(LittleFS);
+        ASSERT_TRUE(log.begin());
+        for (uint32_t i = 0; i < 100; ++i) {
+            log.appendSensor(T0 + i * 60, reading(i * 0.5f, -1.0f));
+        }
+        log.flush();
+    }
+
+    TimeSeriesLog log(LittleFS);
+    ASSERT_TRUE(log.begin());
+    log.appendRelay(T0 + 100 * 60, 0, false);
+
+    const std::string whole = exportCsv(log, 0, UINT32_MAX, 512);
+    EXPECT_EQ(countLines(whole, ",moisture,0,"), 100u);
+    EXPECT_EQ(countLines(whole, ",relay,0,0"), 1u);
+    EXPECT_NE(whole.find(",moisture,1,-1.0\n"), std::string::npos);
+    EXPECT_EQ(exportCsv(log, 0, UINT32_MAX, 7), whole);
+
+    const std::string window = exportCsv(log, T0 + 10 * 60, T0 + 19 * 60, 512);
+    EXPECT_EQ(countLines(window, ",moisture,0,"), 10u);
+    EXPECT_EQ(window.find("1700000540,"), std::string::npos);
+}
+
+TEST_F(TimeSeriesLogTest, RotatesSegmentsAndDropsOldestData) {
+    TimeSeriesLog log(LittleFS);
+    ASSERT_TRUE(log.begin());
+
+    // 21-byte records at one per minute: enough to wrap all segments at least once.
+    const uint32_t perSegment = TimeSeriesLog::SEGMENT_BYTES / 21;
+    const uint32_t total = perSegment * (TimeSeriesLog::SEGMENT_COUNT + 2);
+    for (uint32_t i = 0; i < total; ++i) {
+        log.appendSensor(T0 + i * 60, reading(50.0f, 50.0f));
+    }
+    log.flush();
+
+    for (size_t slot = 0; slot < TimeSeriesLog::SEGMENT_COUNT; ++slot) {
+        const std::string path = "/tslog/seg" + std::to_string(slot) + ".bin";
+        File file = LittleFS.open(path, "r");
+        ASSERT_TRUE(static_cast<bool>(file));
+        EXPECT_LE(file.size(), TimeSeriesLog::SEGMENT_BYTES);
+    }
+
+    const std::string csv = exportCsv(log, 0, UINT32_MAX, 512);
+    EXPECT_EQ(csv.find("1700000000,"), std::string::npos);  // oldest segment was recycled
+    const std::string last = std::to_string(T0 + (total - 1) * 60) + ",water_level,,1\n";
+    EXPECT_EQ(csv.substr(csv.size() - last.size()), last);
+
+    // A late range starts from the index instead of scanning every segment.
+    const uint32_t from = T0 + (total - 5) * 60;
+    EXPECT_EQ(countLines(exportCsv(log, from, UINT32_MAX, 512), ",temperature,"), 5u);
+}
+
+TEST_F(TimeSeriesLogTest, LogsChannelsPastSixteen) {
+    TimeSeriesLog log(LittleFS);
+    ASSERT_TRUE(log.begin());
+
+    SensorData data = reading(41.5f, 12.0f);
+    data.setEnabled(20, true);
+    data.setMoisture(20, 33.3f);
+    log.appendSensor(T0, data);
+    log.appendSensor(T0 + 1, reading(40.0f, 11.0f));
+
+    const std::string csv = exportCsv(log, T0, T0 + 1, 512);
+    EXPECT_NE(csv.find("1700000000,moisture,20,33.3\n"), std::string::npos);
+    EXPECT_NE(csv.find("1700000000,pressure,,1013.2\n"), std::string::npos);
+    EXPECT_NE(csv.find("1700000001,moisture,1,11.0\n"), std::string::npos);
+    EXPECT_EQ(countLines(csv, ",pressure,"), 2u);
+}
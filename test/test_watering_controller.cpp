@@ -0,0 +1,358 @@
+#include <gtest/gtest.h>
+#include "SimTestSetup.h"
+#include "SensorManager.h"
+#include "RelayManager.h"
+
+namespace {
+
+constexpr int DRY = 2592;   // 0 % with the default calibration
+constexpr int WET = 975;    // 100 %
+
+class WateringControllerTest : public ConfiguredSimTest {
+protected:
+    std::unique_ptr<SensorManager> sensors;
+    I2CBus i2cBus;
+    std::unique_ptr<RelayManager> relays;
+
+    void SetUp() override {
+        ConfiguredSimTest::SetUp();
+        disableMoistureFilter(config);
+        for (int pin : config.getHwConfig().moistureSensorPins) {
+            hal::sim::setAnalog(pin, WET);
+        }
+        sensors = std::make_unique<SensorManager>(config);
+        sensors->setupFloatSwitch();
+        relays = std::make_unique<RelayManager>(config, *sensors, i2cBus);
+        relays->init();
+    }
+
+    void setZone(size_t zone, int raw) {
+        hal::sim::setAnalog(config.getHwConfig().moistureSensorPins[zone], raw);
+    }
+
+    int64_t activationUs(size_t zone) {
+        return config.getSensorConfig(zone).activationPeriod.value() * 1000LL;
+    }
+};
+
+}  // namespace
+
+TEST_F(WateringControllerTest, NewSnapshotNotifiesListener) {
+    HostTask listener{"controller"};
+    sensors->setSnapshotListener(&listener);
+    sensors->updateSensorData();
+    sensors->updateSensorData();
+    EXPECT_EQ(listener.notifications, 2u);
+
+    sensors->setSnapshotListener(nullptr);
+    sensors->updateSensorData();
+    EXPECT_EQ(listener.notifications, 2u);
+}
+
+TEST_F(WateringControllerTest, DryZoneIsWateredWithMeasuredLatency) {
+    setZone(1, DRY);
+    sensors->updateSensorData();
+    hal::sim::advanceUs(1500);
+
+    EXPECT_EQ(relays->evaluateZones(), RelayManager::MAX_WAIT_MS);
+    EXPECT_EQ(relays->getZonesEvaluated(), 4u);
+    EXPECT_TRUE(relays->getRelayState(1));
+    EXPECT_EQ(relays->getActuationLatencyUs(), 1500u);
+    EXPECT_EQ(relays->getMaxActuationLatencyUs(), 1500u);
+}
+
+TEST_F(WateringControllerTest, OnlyChangedZonesAreEvaluated) {
+    sensors->updateSensorData();
+    relays->evaluateZones();
+    EXPECT_EQ(relays->getZonesEvaluated(), 4u);
+
+    // Same readings: nothing to look at
+    sensors->updateSensorData();
+    relays->evaluateZones();
+    EXPECT_EQ(relays->getZonesEvaluated(), 0u);
+
+    setZone(2, DRY);
+    sensors->updateSensorData();
+    relays->evaluateZones();
+    EXPECT_EQ(relays->getZonesEvaluated(), 1u);
+    EXPECT_TRUE(relays->getRelayState(2));
+
+    // A settings change counts as changed input
+    ConfigTypes::SensorConfig update;
+    update.threshold = 50.0f;
+    ASSERT_TRUE(config.setSensorConfig(update, 3));
+    relays->evaluateZones();
+    EXPECT_EQ(relays->getZonesEvaluated(), 2u);   // zone 3, and zone 2 waiting for its interval
+}
+
+TEST_F(WateringControllerTest, WaitingZoneRunsOnceThePumpIsFree) {
+    setZone(0, DRY);
+    sensors->updateSensorData();
+    relays->evaluateZones();
+    ASSERT_TRUE(relays->getRelayState(0));
+    const uint32_t latency = relays->getActuationLatencyUs();
+
+    // Zone 3 dries out while zone 0 waters: it waits instead of cutting zone 0 short
+    setZone(3, DRY);
+    sensors->updateSensorData();
+    hal::sim::advanceUs(1000);
+    relays->evaluateZones();
+    EXPECT_TRUE(relays->getRelayState(0));
+    EXPECT_FALSE(relays->getRelayState(3));
+
+    hal::sim::advanceUs(activationUs(0));
+    EXPECT_FALSE(relays->getRelayState(0));
+    relays->evaluateZones();   // woken by the relay switching off, not by a new snapshot
+    EXPECT_TRUE(relays->getRelayState(3));
+    EXPECT_EQ(relays->getActuationLatencyUs(), latency);
+}
+
+TEST_F(WateringControllerTest, WateringIntervalSetsTheNextWake) {
+    ConfigTypes::SensorConfig update;
+    update.wateringInterval = 3600000;
+    ASSERT_TRUE(config.setSensorConfig(update, 0));
+
+    setZone(0, DRY);
+    sensors->updateSensorData();
+    relays->evaluateZones();
+    ASSERT_TRUE(relays->getRelayState(0));
+    const int64_t wateredUs = hal::sim::nowUs();
+    hal::sim::advanceUs(activationUs(0));
+    ASSERT_FALSE(relays->getRelayState(0));
+
+    // Still dry, but watered too recently
+    sensors->updateSensorData();
+    const uint32_t waitMs = relays->evaluateZones();
+    EXPECT_FALSE(relays->getRelayState(0));
+    EXPECT_EQ(waitMs, (wateredUs + 3600000000LL - hal::sim::nowUs() + 999) / 1000);
+
+    // The reading never changed; the zone is watered again because it was left waiting
+    hal::sim::advanceUs(waitMs * 1000LL);
+    EXPECT_EQ(relays->evaluateZones(), 3600000u);
+    EXPECT_EQ(relays->getZonesEvaluated(), 1u);
+    EXPECT_TRUE(relays->getRelayState(0));
+}
+
+TEST_F(WateringControllerTest, QueuedZonesAreServedBackToBackByDryness) {
+    setZone(0, 2300);   // 18 %, a little below the 25 % threshold
+    setZone(1, DRY);
+    setZone(3, 2450);   // 9 %
+    sensors->updateSensorData();
+    relays->evaluateZones();
+    EXPECT_TRUE(relays->getRelayState(1));
+    EXPECT_EQ(relays->getQueueDepth(), 2u);
+
+    const int64_t periodUs = activationUs(0);
+    int served[2] = {-1, -1};
+    for (int &zone : served) {
+        hal::sim::advanceUs(periodUs);
+        relays->evaluateZones();   // the relay switching off wakes the controller
+        for (int i = 0; i < 4; ++i) {
+            if (relays->getRelayState(i)) zone = i;
+        }
+    }
+    EXPECT_EQ(served[0], 3);
+    EXPECT_EQ(served[1], 0);
+    EXPECT_EQ(relays->getQueueDepth(), 0u);
+    EXPECT_EQ(relays->getLastQueueWaitMs(), 2 * periodUs / 1000);
+    EXPECT_EQ(relays->getMaxQueueWaitMs(), 2 * periodUs / 1000);
+}
+
+TEST_F(WateringControllerTest, ZoneThatRecoversLeavesTheQueue) {
+    setZone(0, DRY);
+    setZone(2, 2450);
+    sensors->updateSensorData();
+    relays->evaluateZones();
+    ASSERT_TRUE(relays->getRelayState(0));
+    EXPECT_EQ(relays->getQueueDepth(), 1u);
+
+    setZone(2, WET);
+    sensors->updateSensorData();
+    relays->evaluateZones();
+    EXPECT_EQ(relays->getQueueDepth(), 0u);
+
+    hal::sim::advanceUs(activationUs(0));
+    relays->evaluateZones();
+    EXPECT_FALSE(relays->getRelayState(2));
+}
+
+TEST_F(WateringControllerTest, PumpsShareThePowerBudgetWithStaggeredStarts) {
+    ConfigTypes::HardwareConfig hw;
+    hw.relayCurrents = {800, 800, 800, 800};
+    hw.powerBudget = 2000;
+    hw.inrushDelay = 300;
+    ASSERT_TRUE(config.setHardwareConfig(hw));
+
+    for (size_t zone = 0; zone < 4; ++zone) {
+        setZone(zone, DRY);
+    }
+    sensors->updateSensorData();
+    EXPECT_EQ(relays->evaluateZones(), 300u);
+    EXPECT_EQ(relays->getActiveRelayCount(), 1);
+
+    hal::sim::advanceUs(300000);
+    relays->evaluateZones();
+    EXPECT_EQ(relays->getActiveRelayCount(), 2);
+    EXPECT_EQ(relays->getActiveCurrentMa(), 1600);
+
+    // A third pump would draw 2400 mA: it waits for a relay to switch off
+    hal::sim::advanceUs(300000);
+    EXPECT_EQ(relays->evaluateZones(), RelayManager::MAX_WAIT_MS);
+    EXPECT_EQ(relays->getActiveRelayCount(), 2);
+    EXPECT_EQ(relays->getQueueDepth(), 2u);
+}
+
+TEST_F(WateringControllerTest, FullCycleTimeShrinksWithTheBudget) {
+    const auto cycleUs = [this](int budget) {
+        ConfigTypes::HardwareConfig hw;
+        hw.powerBudget = budget;
+        hw.inrushDelay = 0;
+        EXPECT_TRUE(config.setHardwareConfig(hw));
+        relays = std::make_unique<RelayManager>(config, *sensors, i2cBus);
+        relays->init();
+
+        const int64_t start = hal::sim::nowUs();
+        relays->evaluateZones();
+        while (relays->getActiveRelayCount() > 0) {
+            hal::sim::advanceUs(1000);
+            relays->evaluateZones();
+        }
+        return hal::sim::nowUs() - start;
+    };
+
+    for (size_t zone = 0; zone < 4; ++zone) {
+        setZone(zone, DRY);
+    }
+    sensors->updateSensorData();
+    const int64_t period = activationUs(0);
+    EXPECT_NEAR(cycleUs(1000), 4 * period, 4000);
+    EXPECT_NEAR(cycleUs(2000), 2 * period, 2000);
+    EXPECT_NEAR(cycleUs(4000), period, 1000);
+}
+
+TEST_F(WateringControllerTest, ManualStartMakesRoomWithinTheBudget) {
+    ConfigTypes::HardwareConfig hw;
+    hw.relayCurrents = {500, 500, 1500, 500};
+    hw.powerBudget = 1000;
+    ASSERT_TRUE(config.setHardwareConfig(hw));
+
+    const int64_t inrushUs = config.getHwConfig().inrushDelay.value() * 1000LL;
+    ASSERT_TRUE(relays->activateRelay(0));
+    hal::sim::advanceUs(inrushUs);
+    ASSERT_TRUE(relays->activateRelay(1));
+    EXPECT_TRUE(relays->getRelayState(0));
+    EXPECT_EQ(relays->getActiveCurrentMa(), 1000);
+
+    // More than the whole budget: runs, but alone
+    hal::sim::advanceUs(inrushUs);
+    ASSERT_TRUE(relays->activateRelay(2));
+    EXPECT_FALSE(relays->getRelayState(0));
+    EXPECT_FALSE(relays->getRelayState(1));
+    EXPECT_EQ(relays->getActiveRelayCount(), 1);
+    EXPECT_EQ(relays->getActiveCurrentMa(), 1500);
+}
+
+TEST_F(WateringControllerTest, ManualStartWaitsForTheInrushDelay) {
+    ConfigTypes::HardwareConfig hw;
+    hw.relayCurrents = {500, 500, 500, 500};
+    hw.powerBudget = 2000;
+    hw.inrushDelay = 300;
+    ASSERT_TRUE(config.setHardwareConfig(hw));
+
+    setZone(0, DRY);
+    sensors->updateSensorData();
+    relays->evaluateZones();
+    ASSERT_TRUE(relays->getRelayState(0));
+
+    // The budget has room, but the controller's pump is still starting
+    hal::sim::advanceUs(299000);
+    EXPECT_FALSE(relays->activateRelay(1));
+    EXPECT_EQ(relays->getRelayMask(), 0b0001u);
+
+    hal::sim::advanceUs(1000);
+    EXPECT_TRUE(relays->activateRelay(1));
+    EXPECT_EQ(relays->getRelayMask(), 0b0011u);
+}
+
+TEST_F(WateringControllerTest, FeedbackModePersistsTheTunedPeriod) {
+    ConfigTypes::SensorConfig update;
+    update.autoTune = true;
+    update.activationPeriod = 10000;
+    update.targetMoisture = 40.0f;
+    ASSERT_TRUE(config.setSensorConfig(update, 0));
+
+    setZone(0, DRY);
+    sensors->updateSensorData();
+    relays->evaluateZones();
+    ASSERT_TRUE(relays->getRelayState(0));
+    hal::sim::advanceUs(activationUs(0));
+    relays->evaluateZones();   // sees the pump stop
+
+    // 20 % after 10 s of watering, once soaked in
+    setZone(0, DRY - 1617 / 5);
+    hal::sim::advanceUs(WateringTuner::SOAK_MS * 1000);
+    sensors->updateSensorData();
+    relays->evaluateZones();
+    EXPECT_NEAR(config.getSensorConfig(0).activationPeriod.value(), 20000u, 200);
+    EXPECT_NEAR(config.getSensorConfig(0).wateringGain.value(), 20.0f, 0.2f);
+
+    ConfigManager restarted(prefs);
+    ASSERT_TRUE(restarted.begin("cfg"));
+    EXPECT_EQ(restarted.getSensorConfig(0).activationPeriod.value(), config.getSensorConfig(0).activationPeriod.value());
+    EXPECT_FLOAT_EQ(restarted.getSensorConfig(0).wateringGain.value(), config.getSensorConfig(0).wateringGain.value());
+}
+
+TEST_F(WateringControllerTest, EveryRelaySwitchIsRecordedWithItsCause) {
+    ConfigTypes::HardwareConfig hw;
+    hw.relayCurrents = {600, 600, 600, 600};
+    hw.powerBudget = 1000;
+    ASSERT_TRUE(config.setHardwareConfig(hw));
+
+    ASSERT_TRUE(relays->activateRelay(0));
+    EXPECT_EQ(relays->getRelayMask(), 0b0001u);
+    EXPECT_EQ(relays->getRemainingMs(0), config.getSensorConfig(0).activationPeriod.value());
+    EXPECT_EQ(relays->getRemainingMs(1), 0u);
+
+    hal::sim::advanceUs(1000000);
+    EXPECT_EQ(relays->getRemainingMs(0), config.getSensorConfig(0).activationPeriod.value() - 1000);
+
+    // Relay 1 does not fit next to relay 0
+    ASSERT_TRUE(relays->activateRelay(1));
+    EXPECT_EQ(relays->getRelayMask(), 0b0010u);
+    hal::sim::advanceUs(activationUs(1));
+    EXPECT_EQ(relays->getRelayMask(), 0u);
+
+    setZone(2, DRY);
+    sensors->updateSensorData();
+    relays->evaluateZones();
+    ASSERT_TRUE(relays->deactivateRelay(2));
+
+    RelayEvent events[8];
+    ASSERT_EQ(relays->getRecentEvents(events, 8), 6u);
+    EXPECT_EQ(relays->getRelayEventCount(), 6u);
+    const struct { uint8_t relay; bool on; RelayEvent::Cause cause; } expected[] = {
+        {0, true, RelayEvent::Cause::MANUAL},
+        {0, false, RelayEvent::Cause::PREEMPTED},
+        {1, true, RelayEvent::Cause::MANUAL},
+        {1, false, RelayEvent::Cause::TIMER},
+        {2, true, RelayEvent::Cause::CONTROLLER},
+        {2, false, RelayEvent::Cause::MANUAL},
+    };
+    for (size_t i = 0; i < 6; ++i) {
+        EXPECT_EQ(events[i].relay, expected[i].relay) << i;
+        EXPECT_EQ(events[i].on, expected[i].on) << i;
+        EXPECT_EQ(events[i].cause, expected[i].cause) << i;
+    }
+    EXPECT_EQ(events[1].timeMs, 1000u + events[0].timeMs);
+}
+
+TEST_F(WateringControllerTest, LowWaterStopIsRecorded) {
+    ASSERT_TRUE(relays->activateRelay(3));
+    hal::sim::setDigital(config.getHwConfig().floatSwitchPin.value(), LOW);
+    ASSERT_TRUE(sensors->settleFloatSwitch());
+    EXPECT_EQ(relays->getRelayMask(), 0u);
+
+    RelayEvent events[4];
+    ASSERT_EQ(relays->getRecentEvents(events, 4), 2u);
+    EXPECT_EQ(events[1].cause, RelayEvent::Cause::LOW_WATER);
+}
@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include "SimTestSetup.h"
+#include "SensorManager.h"
+#include "RelayManager.h"
+#include "WateringHistory.h"
+
+namespace {
+
+constexpr uint32_t T0 = 1700000000;
+uint32_t fakeTime = T0;
+uint32_t fakeClock() { return fakeTime; }
+
+class WateringHistoryTest : public ConfiguredSimTest {
+protected:
+    WateringHistory::RtcBlock rtc;
+
+    void SetUp() override {
+        ConfiguredSimTest::SetUp();
+        memset(&rtc, 0xA5, sizeof(rtc));    // what RTC memory holds after power-on
+        fakeTime = T0;
+    }
+};
+
+}  // namespace
+
+TEST_F(WateringHistoryTest, SurvivesAResetInRtcMemory) {
+    {
+        WateringHistory history(rtc, fakeClock);
+        EXPECT_FALSE(history.begin());
+        EXPECT_EQ(history.lastWatered(2), WateringHistory::NEVER);
+        history.record(2);
+    }
+    WateringHistory rebooted(rtc, fakeClock);
+    EXPECT_TRUE(rebooted.begin());
+    EXPECT_EQ(rebooted.lastWatered(2), T0);
+}
+
+TEST_F(WateringHistoryTest, PowerLossFallsBackToTheLastFlush) {
+    {
+        WateringHistory history(rtc, fakeClock);
+        history.begin();
+        history.record(0);
+        EXPECT_TRUE(history.flush());
+        fakeTime += 60;
+        history.record(1);      // not flushed yet
+    }
+    memset(&rtc, 0xA5, sizeof(rtc));
+
+    WateringHistory rebooted(rtc, fakeClock);
+    EXPECT_FALSE(rebooted.begin());
+    EXPECT_EQ(rebooted.lastWatered(0), T0);
+    EXPECT_EQ(rebooted.lastWatered(1), WateringHistory::NEVER);
+}
+
+TEST_F(WateringHistoryTest, UnflushedWateringsSurvivingAResetReachNvs) {
+    {
+        WateringHistory history(rtc, fakeClock);
+        history.begin();
+        history.record(0);
+        EXPECT_TRUE(history.flush());
+        fakeTime += 60;
+        history.record(1);      // reset before the hourly flush
+    }
+    {
+        WateringHistory rebooted(rtc, fakeClock);
+        EXPECT_TRUE(rebooted.begin());
+        EXPECT_EQ(rebooted.nextFlushInS(), 0u);
+        EXPECT_TRUE(rebooted.flush());
+    }
+    memset(&rtc, 0xA5, sizeof(rtc));    // then the power goes
+
+    WateringHistory afterPowerLoss(rtc, fakeClock);
+    EXPECT_FALSE(afterPowerLoss.begin());
+    EXPECT_EQ(afterPowerLoss.lastWatered(0), T0);
+    EXPECT_EQ(afterPowerLoss.lastWatered(1), T0 + 60);
+
+    // A block NVS already holds is not written again
+    WateringHistory again(rtc, fakeClock);
+    EXPECT_TRUE(again.begin());
+    EXPECT_EQ(again.nextFlushInS(), UINT32_MAX);
+}
+
+TEST_F(WateringHistoryTest, FlushesAreCoalesced) {
+    WateringHistory history(rtc, fakeClock);
+    history.begin();
+    EXPECT_FALSE(history.flush());     // nothing changed
+    EXPECT_EQ(history.nextFlushInS(), UINT32_MAX);
+
+    history.record(0);
+    EXPECT_TRUE(history.flush());      // the first change after boot goes out at once
+
+    for (int i = 0; i < 10; ++i) {
+        fakeTime += 60;
+        history.record(i % 4);
+        EXPECT_FALSE(history.flush());
+    }
+    EXPECT_EQ(history.nextFlushInS(), WateringHistory::FLUSH_INTERVAL_S - 600);
+
+    fakeTime = T0 + WateringHistory::FLUSH_INTERVAL_S;
+    EXPECT_TRUE(history.flush());
+    EXPECT_EQ(history.getFlushCount(), 2u);
+
+    history.record(3);
+    EXPECT_TRUE(history.flush(true));
+    EXPECT_EQ(history.getFlushCount(), 3u);
+}
+
+TEST_F(WateringHistoryTest, UnsyncedClockIsNotRecorded) {
+    WateringHistory history(rtc, fakeClock);
+    history.begin();
+    fakeTime = 10;
+    history.record(0);
+    EXPECT_EQ(history.lastWatered(0), WateringHistory::NEVER);
+    EXPECT_EQ(history.nextFlushInS(), UINT32_MAX);
+}
+
+namespace {
+
+constexpr int DRY = 2592;
+
+class RestoredControllerTest : public WateringHistoryTest {
+protected:
+    std::unique_ptr<SensorManager> sensors;
+    I2CBus i2cBus;
+    std::unique_ptr<RelayManager> relays;
+
+    void SetUp() override {
+        WateringHistoryTest::SetUp();
+        disableMoistureFilter(config);
+        ConfigTypes::SensorConfig update;
+        update.wateringInterval = 3600000;
+        ASSERT_TRUE(config.setSensorConfig(update, 0));
+        hal::sim::setAnalog(config.getHwConfig().moistureSensorPins[0], DRY);
+
+        sensors = std::make_unique<SensorManager>(config);
+        sensors->setupFloatSwitch();
+        relays = std::make_unique<RelayManager>(config, *sensors, i2cBus);
+        relays->init();
+    }
+
+    // Zone 0 was watered `agoS` before this boot
+    void bootWithHistory(uint32_t agoS, WateringHistory& history) {
+        const uint32_t now = fakeTime;
+        fakeTime = T0 - agoS;
+        {
+            WateringHistory previous(rtc, fakeClock);
+            previous.begin();
+            previous.record(0);
+        }
+        fakeTime = now;
+        ASSERT_TRUE(history.begin());
+        relays->setWateringHistory(&history);
+    }
+};
+
+}  // namespace
+
+TEST_F(RestoredControllerTest, IntervalCountsFromTheWateringBeforeTheReboot) {
+    WateringHistory history(rtc, fakeClock);
+    bootWithHistory(40 * 60, history);
+
+    sensors->updateSensorData();
+    const uint32_t waitMs = relays->evaluateZones();
+    EXPECT_FALSE(relays->getRelayState(0));
+    EXPECT_NEAR(waitMs, 20 * 60 * 1000, 1000);
+
+    hal::sim::advanceUs(waitMs * 1000LL);
+    fakeTime += waitMs / 1000;
+    relays->evaluateZones();
+    EXPECT_TRUE(relays->getRelayState(0));
+    EXPECT_EQ(history.lastWatered(0), fakeTime);
+}
+
+TEST_F(RestoredControllerTest, UnsyncedClockHoldsOffUntilTheRealTimeIsKnown) {
+    WateringHistory history(rtc, fakeClock);
+    fakeTime = T0 - 2 * 3600;
+    {
+        WateringHistory previous(rtc, fakeClock);
+        previous.begin();
+        previous.record(0);
+    }
+    fakeTime = 10;      // NTP not there yet
+    history.begin();
+    relays->setWateringHistory(&history);
+
+    // Counted from boot while the clock is unknown
+    sensors->updateSensorData();
+    EXPECT_NEAR(relays->evaluateZones(), RelayManager::MAX_WAIT_MS, 1000);
+    EXPECT_FALSE(relays->getRelayState(0));
+
+    // Two hours ago is past the interval
+    fakeTime = T0;
+    relays->evaluateZones();
+    EXPECT_TRUE(relays->getRelayState(0));
+}
+
+TEST_F(RestoredControllerTest, WateringsReachNvsInOneWrite) {
+    WateringHistory history(rtc, fakeClock);
+    history.begin();
+    relays->setWateringHistory(&history);
+
+    sensors->updateSensorData();
+    relays->evaluateZones();
+    ASSERT_TRUE(relays->getRelayState(0));
+    EXPECT_EQ(history.getFlushCount(), 1u);
+
+    const int64_t inrushUs = config.getHwConfig().inrushDelay.value() * 1000LL;
+    hal::sim::advanceUs(inrushUs);
+    ASSERT_TRUE(relays->activateRelay(1));
+    fakeTime += 60;
+    hal::sim::advanceUs(inrushUs);
+    ASSERT_TRUE(relays->activateRelay(2));
+    EXPECT_EQ(relays->evaluateZones(), (WateringHistory::FLUSH_INTERVAL_S - 60) * 1000);
+    EXPECT_EQ(history.getFlushCount(), 1u);
+
+    fakeTime = T0 + WateringHistory::FLUSH_INTERVAL_S;
+    relays->evaluateZones();
+    EXPECT_EQ(history.getFlushCount(), 2u);
+}
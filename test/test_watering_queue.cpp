@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include "WateringQueue.h"
+
+namespace {
+constexpr int64_t HOUR_US = 3600LL * 1000000;
+}
+
+TEST(WateringQueueTest, DriestZoneFirst) {
+    WateringQueue queue;
+    const int64_t now = 100 * HOUR_US;
+    queue.push(0, 20, now - HOUR_US, now);
+    queue.push(5, 80, now - HOUR_US, now);
+    queue.push(9, 40, now - HOUR_US, now);
+    EXPECT_EQ(queue.size(), 3u);
+    EXPECT_EQ(queue.peek(now), 5);
+
+    queue.serve(5, now);
+    EXPECT_EQ(queue.peek(now), 9);
+    queue.serve(9, now);
+    EXPECT_EQ(queue.peek(now), 0);
+    queue.serve(0, now);
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.peek(now), -1);
+}
+
+TEST(WateringQueueTest, TimeSinceWateringOutweighsSmallDeficit) {
+    WateringQueue queue;
+    const int64_t now = 100 * HOUR_US;
+    queue.push(0, 50, now - HOUR_US, now);           // 50 + 5
+    queue.push(1, 30, now - 10 * HOUR_US, now);      // 30 + 50
+    EXPECT_EQ(queue.peek(now), 1);
+
+    // A never watered zone counts as watered MAX_AGE_HOURS ago
+    queue.push(2, 0, WateringQueue::NEVER_WATERED, now);
+    EXPECT_EQ(queue.peek(now), 2);
+}
+
+TEST(WateringQueueTest, TiesGoToTheZoneQueuedFirst) {
+    WateringQueue queue;
+    queue.push(3, 40, WateringQueue::NEVER_WATERED, 2000);
+    queue.push(1, 40, WateringQueue::NEVER_WATERED, 3000);
+    EXPECT_EQ(queue.peek(3000), 3);
+
+    // Refreshing a queued zone keeps its place in line
+    queue.push(3, 40, WateringQueue::NEVER_WATERED, 4000);
+    EXPECT_EQ(queue.peek(4000), 3);
+    EXPECT_EQ(queue.size(), 2u);
+}
+
+TEST(WateringQueueTest, RecordsWaitTimes) {
+    WateringQueue queue;
+    queue.push(0, 10, WateringQueue::NEVER_WATERED, 0);
+    queue.push(1, 10, WateringQueue::NEVER_WATERED, 0);
+    queue.serve(0, 1000000);
+    queue.serve(1, 4000000);
+    queue.remove(1);            // already served, no effect
+
+    const WateringQueue::Stats& stats = queue.getStats();
+    EXPECT_EQ(stats.served, 2u);
+    EXPECT_EQ(stats.lastWaitMs, 4000u);
+    EXPECT_EQ(stats.maxWaitMs, 4000u);
+    EXPECT_EQ(stats.totalWaitMs, 5000u);
+    EXPECT_EQ(stats.maxDepth, 2u);
+    EXPECT_TRUE(queue.empty());
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include "WateringTuner.h"
+
+namespace {
+
+constexpr WateringTuner::Limits LIMITS{1000, 60000};
+constexpr int64_t SOAK_US = WateringTuner::SOAK_MS * 1000;
+
+// Runs one watering of `durationMs` from `startTenths`, read back at `endTenths` after the soak.
+bool water(WateringTuner& tuner, uint32_t durationMs, int16_t startTenths, int16_t endTenths, float gain,
+           WateringTuner::Result& out, float target = 40.0f) {
+    tuner.start(0, durationMs, startTenths, gain, target);
+    EXPECT_FALSE(tuner.observe(0, true, 0, 0, true, startTenths, LIMITS, out));
+    const int64_t stopped = durationMs * 1000LL;
+    EXPECT_FALSE(tuner.observe(0, false, stopped, stopped, true, endTenths, LIMITS, out));
+    return tuner.observe(0, false, stopped + SOAK_US, stopped + SOAK_US, true, endTenths, LIMITS, out);
+}
+
+}  // namespace
+
+TEST(WateringTunerTest, FirstWateringLearnsTheGain) {
+    WateringTuner tuner;
+    WateringTuner::Result result;
+    // 10 % in 10 s, 20 % still missing to the 40 % target
+    ASSERT_TRUE(water(tuner, 10000, 200, 300, 0.0f, result));
+    EXPECT_FLOAT_EQ(result.gain, 10.0f);
+    EXPECT_EQ(result.durationMs, 20000u);
+    EXPECT_FALSE(tuner.measuring(0));
+}
+
+TEST(WateringTunerTest, GainIsSmoothedOverWaterings) {
+    WateringTuner tuner;
+    WateringTuner::Result result;
+    ASSERT_TRUE(water(tuner, 10000, 200, 400, 10.0f, result));   // measured 20 per second
+    EXPECT_FLOAT_EQ(result.gain, 15.0f);
+    EXPECT_NEAR(result.durationMs, 13333u, 1);
+}
+
+TEST(WateringTunerTest, DurationStepsAreBounded) {
+    WateringTuner tuner;
+    WateringTuner::Result result;
+    // Needs 400 s at the measured gain: at most twice as long, and within the limits
+    ASSERT_TRUE(water(tuner, 10000, 0, 10, 0.0f, result));
+    EXPECT_EQ(result.durationMs, 20000u);
+    ASSERT_TRUE(water(tuner, 40000, 0, 10, 0.0f, result));
+    EXPECT_EQ(result.durationMs, 60000u);
+
+    // Already wetter than the target: as short as allowed
+    ASSERT_TRUE(water(tuner, 1500, 500, 600, 0.0f, result));
+    EXPECT_EQ(result.durationMs, 1000u);
+}
+
+TEST(WateringTunerTest, NoResponseWatersLongerWithoutLearning) {
+    WateringTuner tuner;
+    WateringTuner::Result result;
+    ASSERT_TRUE(water(tuner, 5000, 200, 202, 12.0f, result));
+    EXPECT_FLOAT_EQ(result.gain, 12.0f);
+    EXPECT_EQ(result.durationMs, 10000u);
+}
+
+TEST(WateringTunerTest, WaitsForAReadingTakenAfterTheSoak) {
+    WateringTuner tuner;
+    WateringTuner::Result result;
+    tuner.start(0, 10000, 200, 0.0f, 40.0f);
+    EXPECT_FALSE(tuner.observe(0, false, 0, 0, true, 200, LIMITS, result));
+    // Woken after the soak, but the newest reading predates it
+    EXPECT_FALSE(tuner.observe(0, false, SOAK_US + 1000, SOAK_US - 1000, true, 300, LIMITS, result));
+    EXPECT_TRUE(tuner.measuring(0));
+
+    // A missing reading drops the measurement
+    EXPECT_FALSE(tuner.observe(0, false, SOAK_US + 2000, SOAK_US + 2000, false, 0, LIMITS, result));
+    EXPECT_FALSE(tuner.measuring(0));
+}